@@ -1,33 +1,84 @@
-QT       += core gui
+QT       += core gui network
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 CONFIG += c++17
 
+# Zeitmessung mit TRACE_SPAN einschalten: qmake CONFIG+=tracing (siehe tracing.h)
+tracing: DEFINES += U3_TRACING
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    batchenvironment.cpp \
+    boardexport.cpp \
+    boardkernels.cpp \
+    boardplane.cpp \
+    boardrenderer.cpp \
+    boardview.cpp \
+    botserver.cpp \
+    botsession.cpp \
     cell.cpp \
+    deltarecorder.cpp \
+    difficultyestimator.cpp \
+    framemonitor.cpp \
     game.cpp \
+    gamearena.cpp \
+    gameengine.cpp \
+    gamejournal.cpp \
+    gamesnapshot.cpp \
+    gamesolver.cpp \
     gamestatistics.cpp \
     helpdialog.cpp \
+    hintservice.cpp \
+    latencyhistogram.cpp \
     main.cpp \
     mainwindow.cpp \
-    qminerpushbutton.cpp \
+    replayplayer.cpp \
+    replayrecorder.cpp \
+    replayverifier.cpp \
     settingsdialog.cpp \
-    statisticsdialog.cpp
+    statisticsdialog.cpp \
+    tracing.cpp
 
 HEADERS += \
+    batchenvironment.h \
+    boardexport.h \
+    boardkernels.h \
+    boardlayout.h \
+    boardplane.h \
+    boardrenderer.h \
+    boardview.h \
+    botprotocol.h \
+    botserver.h \
+    botsession.h \
     cell.h \
+    deltaformat.h \
+    deltarecorder.h \
+    difficultyestimator.h \
+    framemonitor.h \
     game.h \
+    gamearena.h \
+    gameclock.h \
+    gameengine.h \
+    gamejournal.h \
+    gamesnapshot.h \
+    gamesolver.h \
     gamestatistics.h \
     helpdialog.h \
+    hintservice.h \
+    latencyhistogram.h \
     mainwindow.h \
-    qminerpushbutton.h \
+    replayformat.h \
+    replayplayer.h \
+    replayrecorder.h \
+    replayverifier.h \
     settingsdialog.h \
-    statisticsdialog.h
+    spscqueue.h \
+    statisticsdialog.h \
+    tracing.h
 
 FORMS += \
     helpdialog.ui \
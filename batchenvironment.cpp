@@ -0,0 +1,341 @@
+#include "batchenvironment.h"
+#include "boardlayout.h"
+#include "boardplane.h"
+#include "tracing.h"
+#include <QtConcurrent>
+
+/**
+ * @brief Nächster Wert eines SplitMix64-Generators.
+ * @param state Zustand des Generators, wird weitergezählt.
+ * @return 64 Zufallsbits.
+ */
+static inline quint64 splitMix64(quint64 &state) {
+    quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Gleichverteilte Zahl in [0, bound) ohne Division (Multiplikation mit 32 Bit).
+ * @param state Zustand des Generators.
+ * @param bound Obergrenze (exklusiv).
+ * @return Zufallszahl.
+ */
+static inline int bounded(quint64 &state, int bound) {
+    return int((quint64(quint32(splitMix64(state))) * quint64(bound)) >> 32);
+}
+
+/**
+ * @brief Konstruktor für BatchEnvironment.
+ * @param boards Anzahl der Spielfelder.
+ * @param length Anzahl der Zeilen jedes Spielfelds.
+ * @param width Anzahl der Spalten jedes Spielfelds.
+ * @param minesNumber Anzahl der Minen; höchstens eine Zelle weniger als das Spielfeld hat.
+ * @param seed Grundseed.
+ */
+BatchEnvironment::BatchEnvironment(int boards, int length, int width, int minesNumber, quint64 seed)
+    : boards(qMax(1, boards))
+    , length(qMax(1, length))
+    , width(qMax(1, width))
+    , cells(this->length * this->width)
+    , seed(seed)
+{
+    this->minesNumber = qBound(0, minesNumber, cells - 1);
+
+    neighbours.fill(-1, cells * BoardLayout::NEIGHBOURS);
+    for (int row = 0; row < this->length; row++) {
+        for (int col = 0; col < this->width; col++) {
+            for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+                const int r = row + BoardLayout::NEIGHBOUR_ROWS[k];
+                const int c = col + BoardLayout::NEIGHBOUR_COLS[k];
+                if (r >= 0 && r < this->length && c >= 0 && c < this->width) {
+                    neighbours[(row * this->width + col) * BoardLayout::NEIGHBOURS + k] = r * this->width + c;
+                }
+            }
+        }
+    }
+
+    solution.resize(this->boards * cells);
+    obs.resize(this->boards * cells);
+    reward.resize(this->boards);
+    done.resize(this->boards);
+    won.resize(this->boards);
+    minesPlaced.resize(this->boards);
+    hiddenSafe.resize(this->boards);
+    episodes.resize(this->boards);
+    const int shardCount = (this->boards + SHARD_SIZE - 1) / SHARD_SIZE;
+    scratch.resize(shardCount * cells);
+    for (int shard = 0; shard < shardCount; shard++) {
+        shards.append(shard);
+    }
+    reset();
+}
+
+/**
+ * @brief Beginnt auf allen Spielfeldern die erste Partie neu.
+ */
+void BatchEnvironment::reset() {
+    for (int board = 0; board < boards; board++) {
+        episodes[board] = 0;
+        resetBoard(board);
+        reward[board] = 0.0f;
+        done[board] = 0;
+        won[board] = 0;
+    }
+}
+
+/**
+ * @brief Beginnt auf einem Spielfeld eine bestimmte Partie.
+ * @param board Index des Spielfelds.
+ * @param episode Nummer der Partie.
+ */
+void BatchEnvironment::startEpisode(int board, quint32 episode) {
+    episodes[board] = episode;
+    resetBoard(board);
+}
+
+/**
+ * @brief Führt auf jedem Spielfeld eine Aktion aus.
+ * @param actions Eine Aktion pro Spielfeld.
+ * @param parallel False, um im aufrufenden Thread zu bleiben.
+ *
+ * QtConcurrent verteilt die Blöcke über den globalen Thread-Pool; der Aufruf kehrt zurück,
+ * wenn alle fertig sind.
+ */
+void BatchEnvironment::step(const qint32 *actions, bool parallel) {
+    TRACE_SPAN("batch.step");
+    if (!parallel || shards.size() == 1) {
+        for (int shard : qAsConst(shards)) {
+            stepShard(shard, actions);
+        }
+        return;
+    }
+    QtConcurrent::blockingMap(shards, [this, actions](int shard) { stepShard(shard, actions); });
+}
+
+/**
+ * @brief Gibt den Seed der laufenden Partie eines Spielfelds zurück.
+ * @param board Index des Spielfelds.
+ * @return Seed der Partie.
+ */
+quint64 BatchEnvironment::currentSeed(int board) const {
+    return episodeSeed(seed, board, episodes.at(board));
+}
+
+/**
+ * @brief Berechnet den Seed einer Partie.
+ * @param seed Grundseed der Umgebung.
+ * @param board Index des Spielfelds.
+ * @param episode Nummer der Partie auf diesem Spielfeld.
+ * @return Seed der Partie.
+ *
+ * Hängt nur von Spielfeld und Partie ab, nicht von der Reihenfolge der Threads.
+ */
+quint64 BatchEnvironment::episodeSeed(quint64 seed, int board, quint32 episode) {
+    quint64 state = seed ^ (quint64(quint32(board)) << 32 | episode);
+    return splitMix64(state);
+}
+
+/**
+ * @brief Führt die Aktionen eines Blocks von Spielfeldern aus.
+ * @param shard Index des Blocks.
+ * @param actions Aktionen aller Spielfelder.
+ *
+ * Öffnen einer aufgedeckten oder markierten Zelle und Markieren einer aufgedeckten Zelle
+ * ändern nichts und bringen keine Belohnung.
+ */
+void BatchEnvironment::stepShard(int shard, const qint32 *actions) {
+    qint32 *buffer = scratch.data() + shard * cells;
+    const float rewardPerCell = 1.0f / float(cells - minesNumber);
+    const int end = qMin(boards, (shard + 1) * SHARD_SIZE);
+    for (int board = shard * SHARD_SIZE; board < end; board++) {
+        reward[board] = 0.0f;
+        done[board] = 0;
+        won[board] = 0;
+        quint8 *cellObs = obs.data() + board * cells;
+        const qint32 action = actions[board];
+
+        if (action >= cells && action < 2 * cells) {
+            quint8 &code = cellObs[action - cells];
+            if (code == 0 || code == 2) {
+                code ^= 2; ///< verdeckt <-> markiert
+            }
+            continue;
+        }
+        if (action < 0 || action >= cells || cellObs[action] != 0) {
+            continue;
+        }
+
+        if (!minesPlaced[board]) {
+            placeMines(board, action, buffer);
+        }
+        if (solution[board * cells + action] == MINE) {
+            reward[board] = REWARD_LOSS;
+        } else {
+            const int revealed = reveal(board, action, buffer);
+            hiddenSafe[board] -= revealed;
+            reward[board] = float(revealed) * rewardPerCell;
+            if (hiddenSafe[board] > 0) {
+                continue;
+            }
+            won[board] = 1;
+        }
+        done[board] = 1;
+        episodes[board]++;
+        resetBoard(board);
+    }
+}
+
+/**
+ * @brief Beginnt die nächste Partie eines Spielfelds.
+ * @param board Index des Spielfelds.
+ *
+ * Die Minen werden erst beim ersten Öffnen gelegt, siehe placeMines().
+ */
+void BatchEnvironment::resetBoard(int board) {
+    std::fill_n(obs.data() + board * cells, cells, quint8(0));
+    minesPlaced[board] = 0;
+    hiddenSafe[board] = cells - minesNumber;
+}
+
+/**
+ * @brief Legt die Minen eines Spielfelds beim ersten Öffnen.
+ * @param board Index des Spielfelds.
+ * @param cell Zuerst geöffnete Zelle.
+ * @param scratch Hilfspuffer mit Platz für getCells() Einträge.
+ *
+ * Teilweises Fisher-Yates über alle Zellen außerhalb der geschützten Zone: genau minesNumber
+ * Ziehungen, ohne Wiederholungen. Danach zählt jede Mine ihre Nachbarn hoch.
+ */
+void BatchEnvironment::placeMines(int board, int cell, qint32 *scratch) {
+    quint8 *cellSolution = solution.data() + board * cells;
+    std::fill_n(cellSolution, cells, quint8(0));
+    const qint32 *cellNeighbours = neighbours.constData() + cell * BoardLayout::NEIGHBOURS;
+
+    ///< geschützte Zone wie in Game::protect_first_click(): 3x3, wenn außerhalb genug Platz ist
+    int zone = 1;
+    for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+        zone += cellNeighbours[k] >= 0;
+    }
+    const bool protectNeighbours = cells - zone >= minesNumber;
+    cellSolution[cell] = MINE; ///< vorübergehend als Markierung der Zone
+    if (protectNeighbours) {
+        for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+            if (cellNeighbours[k] >= 0) {
+                cellSolution[cellNeighbours[k]] = MINE;
+            }
+        }
+    }
+    int candidates = 0;
+    for (int index = 0; index < cells; index++) {
+        if (cellSolution[index] != MINE) {
+            scratch[candidates++] = index;
+        }
+    }
+    std::fill_n(cellSolution, cells, quint8(0));
+
+    quint64 state = currentSeed(board);
+    for (int placed = 0; placed < minesNumber; placed++) {
+        const int pick = placed + bounded(state, candidates - placed);
+        std::swap(scratch[placed], scratch[pick]);
+        const int mine = scratch[placed];
+        cellSolution[mine] = MINE;
+        const qint32 *mineNeighbours = neighbours.constData() + mine * BoardLayout::NEIGHBOURS;
+        for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+            const int neighbour = mineNeighbours[k];
+            if (neighbour >= 0 && cellSolution[neighbour] != MINE) {
+                cellSolution[neighbour]++;
+            }
+        }
+    }
+    minesPlaced[board] = 1;
+}
+
+/**
+ * @brief Berechnet 3BV und Öffnungen der zuletzt auf einem Spielfeld gelegten Minen.
+ * @param board Index des Spielfelds.
+ * @param openingCount Gibt die Anzahl der Öffnungen zurück, falls nicht nullptr.
+ * @return 3BV der Lösung.
+ *
+ * Jede Öffnung (zusammenhängende Nullzellen samt Rand) zählt einen Klick, jede übrige sichere
+ * Zelle ebenfalls. Besuchte Zellen werden vorübergehend mit dem obersten Bit der Lösung
+ * markiert, das sonst nie gesetzt ist. Wird nur auf Anfrage berechnet: bei jedem Legen der
+ * Minen würde es kurze Partien (z.B. Training mit Zufallszügen) etwa halb so schnell machen.
+ */
+int BatchEnvironment::getBbbv(int board, int *openingCount) {
+    constexpr quint8 VISITED = 0x80;
+    qint32 *stack = scratch.data() + board / SHARD_SIZE * cells;
+    quint8 *cellSolution = solution.data() + board * cells;
+    int clicks = 0;
+    int openingsFound = 0;
+    for (int start = 0; start < cells; start++) {
+        if (cellSolution[start] != 0) {
+            continue;
+        }
+        openingsFound++;
+        int top = 0;
+        stack[top++] = start;
+        cellSolution[start] |= VISITED;
+        while (top > 0) {
+            const qint32 *cellNeighbours = neighbours.constData() + stack[--top] * BoardLayout::NEIGHBOURS;
+            for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+                const int neighbour = cellNeighbours[k];
+                if (neighbour < 0 || (cellSolution[neighbour] & VISITED)) {
+                    continue;
+                }
+                if (cellSolution[neighbour] == 0) {
+                    stack[top++] = neighbour;
+                }
+                cellSolution[neighbour] |= VISITED;
+            }
+        }
+    }
+    for (int cell = 0; cell < cells; cell++) {
+        if (cellSolution[cell] & VISITED) {
+            cellSolution[cell] &= quint8(~VISITED);
+        } else if (cellSolution[cell] != MINE) {
+            clicks++;
+        }
+    }
+    if (openingCount) {
+        *openingCount = openingsFound;
+    }
+    return openingsFound + clicks;
+}
+
+/**
+ * @brief Öffnet eine sichere Zelle und bei 0 benachbarten Minen ihre Umgebung.
+ * @param board Index des Spielfelds.
+ * @param cell Zelle.
+ * @param stack Hilfspuffer mit Platz für getCells() Einträge.
+ * @return Anzahl der neu aufgedeckten Zellen.
+ *
+ * Eine Zelle wird schon beim Ablegen auf den Stapel aufgedeckt, kommt also höchstens einmal
+ * darauf. Markierte Zellen bleiben wie in Game verdeckt.
+ */
+int BatchEnvironment::reveal(int board, int cell, qint32 *stack) {
+    const quint8 *cellSolution = solution.constData() + board * cells;
+    quint8 *cellObs = obs.data() + board * cells;
+    int top = 0;
+    int revealed = 1;
+    cellObs[cell] = quint8(BoardPlane::OPEN_CODE + cellSolution[cell]);
+    if (cellSolution[cell] == 0) {
+        stack[top++] = cell;
+    }
+    while (top > 0) {
+        const qint32 *cellNeighbours = neighbours.constData() + stack[--top] * BoardLayout::NEIGHBOURS;
+        for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+            const int neighbour = cellNeighbours[k];
+            if (neighbour < 0 || cellObs[neighbour] != 0) {
+                continue;
+            }
+            cellObs[neighbour] = quint8(BoardPlane::OPEN_CODE + cellSolution[neighbour]);
+            revealed++;
+            if (cellSolution[neighbour] == 0) {
+                stack[top++] = neighbour;
+            }
+        }
+    }
+    return revealed;
+}
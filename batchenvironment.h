@@ -0,0 +1,200 @@
+#ifndef BATCHENVIRONMENT_H
+#define BATCHENVIRONMENT_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @file batchenvironment.h
+ * @class BatchEnvironment
+ * @brief Spielt viele gleich große Spielfelder gleichzeitig, für Bots und Simulationen.
+ *
+ * Ein Aufruf von step() nimmt eine Aktion pro Spielfeld und schreibt danach für alle
+ * Spielfelder die Beobachtung, die Belohnung und ob die Partie zu Ende ist in
+ * zusammenhängende Puffer. Beendete Spielfelder beginnen sofort eine neue Partie aus dem
+ * nächsten Seed; die Beobachtung zeigt dann schon das neue, verdeckte Spielfeld.
+ *
+ * Aktionen (eine pro Spielfeld, Index = Zeile * Breite + Spalte):
+ * - 0 bis cells-1: Zelle öffnen.
+ * - cells bis 2*cells-1: Markierung der Zelle (Aktion - cells) umschalten.
+ * - alles andere (z.B. -1): nichts tun.
+ *
+ * Beobachtung: ein Byte pro Zelle mit den Codes von BoardPlane (0 verdeckt, 2 markiert,
+ * BoardPlane::OPEN_CODE + Anzahl benachbarter Minen für aufgedeckte Zellen).
+ *
+ * Belohnung: Anteil der in diesem Schritt aufgedeckten sicheren Zellen, eine Partie bringt bis
+ * zum Sieg also insgesamt 1. Eine Mine ergibt REWARD_LOSS.
+ *
+ * Die Minen werden wie bei Game mit sicherem ersten Klick erst beim ersten Öffnen gelegt, außerhalb
+ * der 3x3-Umgebung der Zelle (oder nur außerhalb der Zelle, wenn dafür kein Platz ist).
+ *
+ * Technische Entscheidung:
+ * Structure of Arrays: Jede Eigenschaft liegt für alle Spielfelder in einem eigenen Vektor
+ * (Lösung, Beobachtung, Zähler, Seeds), statt N Game-Objekte mit Zellobjekten, Protokoll und
+ * Statistik zu halten. Ein Schritt berührt damit nur wenige zusammenhängende Bytes pro
+ * Spielfeld. Die Nachbarn jeder Zelle werden einmal vorab berechnet und von allen
+ * Spielfeldern geteilt, die Aufdeck-Schleife braucht so weder Division noch Randprüfung.
+ *
+ * Die Spielfelder werden in Blöcke zu SHARD_SIZE geteilt und mit QtConcurrent auf alle Kerne
+ * verteilt. Jeder Block schreibt nur in seine eigenen Bereiche der Puffer; das Ergebnis hängt
+ * daher nicht von der Anzahl der Threads ab. Zufall kommt aus einem kleinen SplitMix64 pro
+ * Partie statt aus QRandomGenerator, dessen Initialisierung teurer wäre als eine ganze Partie.
+ * Gleiche Seeds ergeben darum andere Spielfelder als in Game.
+ *
+ * @author Daniel Schukin
+ */
+class BatchEnvironment
+{
+public:
+    static constexpr int SHARD_SIZE = 256; ///< Spielfelder pro Arbeitspaket.
+    static constexpr float REWARD_LOSS = -1.0f; ///< Belohnung für das Öffnen einer Mine.
+    static constexpr quint8 MINE = 9; ///< Wert einer Mine in der Lösung (sonst Anzahl benachbarter Minen).
+
+    /**
+     * @brief Konstruktor für BatchEnvironment. Startet alle Spielfelder, siehe reset().
+     * @param boards Anzahl der Spielfelder.
+     * @param length Anzahl der Zeilen jedes Spielfelds.
+     * @param width Anzahl der Spalten jedes Spielfelds.
+     * @param minesNumber Anzahl der Minen jedes Spielfelds.
+     * @param seed Grundseed; jede Partie jedes Spielfelds bekommt daraus einen eigenen Seed.
+     *
+     * @author Daniel Schukin
+     */
+    BatchEnvironment(int boards, int length, int width, int minesNumber, quint64 seed);
+
+    /**
+     * @brief Beginnt auf allen Spielfeldern die erste Partie neu.
+     *
+     * @author Daniel Schukin
+     */
+    void reset();
+
+    /**
+     * @brief Beginnt auf einem Spielfeld eine bestimmte Partie, z.B. um Seeds gezielt abzuarbeiten.
+     * @param board Index des Spielfelds.
+     * @param episode Nummer der Partie; der Seed ergibt sich aus episodeSeed().
+     *
+     * @author Daniel Schukin
+     */
+    void startEpisode(int board, quint32 episode);
+
+    /**
+     * @brief Führt auf jedem Spielfeld eine Aktion aus.
+     * @param actions Eine Aktion pro Spielfeld (getBoards() Einträge).
+     * @param parallel False, um im aufrufenden Thread zu bleiben (z.B. wenn der Aufrufer selbst parallelisiert).
+     *
+     * @author Daniel Schukin
+     */
+    void step(const qint32 *actions, bool parallel = true);
+
+    /**
+     * @brief Gibt den Seed der laufenden Partie eines Spielfelds zurück.
+     * @param board Index des Spielfelds.
+     * @return Seed der Partie.
+     *
+     * @author Daniel Schukin
+     */
+    quint64 currentSeed(int board) const;
+
+    /**
+     * @brief Berechnet den Seed einer Partie.
+     * @param seed Grundseed der Umgebung.
+     * @param board Index des Spielfelds.
+     * @param episode Nummer der Partie auf diesem Spielfeld.
+     * @return Seed der Partie.
+     *
+     * @author Daniel Schukin
+     */
+    static quint64 episodeSeed(quint64 seed, int board, quint32 episode);
+
+    /**
+     * @brief Berechnet 3BV und Öffnungen der zuletzt auf einem Spielfeld gelegten Minen.
+     * @param board Index des Spielfelds.
+     * @param openingCount Gibt die Anzahl der Öffnungen zurück, falls nicht nullptr.
+     * @return 3BV der Lösung.
+     *
+     * Gilt auch nach dem Ende der Partie, bis zum ersten Öffnen der nächsten; vor dem ersten
+     * Öffnen überhaupt ist das Ergebnis bedeutungslos. Nicht während step() aufrufen.
+     *
+     * @author Daniel Schukin
+     */
+    int getBbbv(int board, int *openingCount = nullptr);
+
+    /// @name Puffer, gültig bis zum nächsten step() oder reset()
+    /// @{
+    const quint8 *observations() const { return obs.constData(); }  ///< getBoards() * getCells() Codes, Spielfeld für Spielfeld.
+    const float *rewards() const { return reward.constData(); }     ///< Belohnung des letzten Schritts pro Spielfeld.
+    const quint8 *dones() const { return done.constData(); }        ///< 1, wenn die Partie im letzten Schritt endete.
+    const quint8 *wins() const { return won.constData(); }          ///< 1, wenn die im letzten Schritt beendete Partie gewonnen wurde.
+    /// @}
+
+    /// @name Getter
+    /// @{
+    int getBoards() const { return boards; }
+    int getLength() const { return length; }
+    int getWidth() const { return width; }
+    int getMinesNumber() const { return minesNumber; }
+    int getCells() const { return cells; }
+    int getActionCount() const { return 2 * cells; }
+    /// @}
+
+private:
+    /**
+     * @brief Führt die Aktionen eines Blocks von Spielfeldern aus.
+     * @param shard Index des Blocks.
+     * @param actions Aktionen aller Spielfelder.
+     *
+     * @author Daniel Schukin
+     */
+    void stepShard(int shard, const qint32 *actions);
+
+    /**
+     * @brief Beginnt die nächste Partie eines Spielfelds.
+     * @param board Index des Spielfelds.
+     *
+     * @author Daniel Schukin
+     */
+    void resetBoard(int board);
+
+    /**
+     * @brief Legt die Minen eines Spielfelds beim ersten Öffnen.
+     * @param board Index des Spielfelds.
+     * @param cell Zuerst geöffnete Zelle.
+     * @param scratch Hilfspuffer mit Platz für getCells() Einträge.
+     *
+     * @author Daniel Schukin
+     */
+    void placeMines(int board, int cell, qint32 *scratch);
+
+    /**
+     * @brief Öffnet eine sichere Zelle und bei 0 benachbarten Minen ihre Umgebung.
+     * @param board Index des Spielfelds.
+     * @param cell Zelle.
+     * @param stack Hilfspuffer mit Platz für getCells() Einträge.
+     * @return Anzahl der neu aufgedeckten Zellen.
+     *
+     * @author Daniel Schukin
+     */
+    int reveal(int board, int cell, qint32 *stack);
+
+    int boards;      ///< Anzahl der Spielfelder.
+    int length;      ///< Anzahl der Zeilen.
+    int width;       ///< Anzahl der Spalten.
+    int minesNumber; ///< Anzahl der Minen.
+    int cells;       ///< Zellen pro Spielfeld.
+    quint64 seed;    ///< Grundseed.
+
+    QVector<qint32> neighbours;        ///< 8 Nachbarn pro Zelle, -1 außerhalb des Spielfelds; für alle Spielfelder gleich.
+    QVector<quint8> solution;          ///< MINE oder Anzahl benachbarter Minen, pro Spielfeld und Zelle.
+    QVector<quint8> obs;               ///< Beobachtung pro Spielfeld und Zelle.
+    QVector<float> reward;             ///< Belohnung pro Spielfeld.
+    QVector<quint8> done;              ///< Partie im letzten Schritt beendet, pro Spielfeld.
+    QVector<quint8> won;               ///< Beendete Partie gewonnen, pro Spielfeld.
+    QVector<quint8> minesPlaced;       ///< Minen der laufenden Partie gelegt, pro Spielfeld.
+    QVector<qint32> hiddenSafe;        ///< Noch verdeckte sichere Zellen, pro Spielfeld.
+    QVector<quint32> episodes;         ///< Nummer der laufenden Partie, pro Spielfeld.
+    QVector<qint32> scratch;           ///< Hilfspuffer, getCells() Einträge pro Block.
+    QVector<int> shards;               ///< Indizes der Blöcke, für QtConcurrent.
+};
+
+#endif // BATCHENVIRONMENT_H
@@ -0,0 +1,178 @@
+#include "boardexport.h"
+#include "gameengine.h"
+#include "tracing.h"
+#include <QDir>
+#include <algorithm>
+
+/**
+ * @brief Destruktor für BoardExport. Gibt das Segment frei.
+ */
+BoardExport::~BoardExport() {
+    close();
+}
+
+/**
+ * @brief Übernimmt die Schreiberrolle und legt das Segment an oder übernimmt ein verwaistes.
+ * @param key Name des Segments.
+ * @return False, wenn ein anderer Prozess das Segment schon beschreibt oder es nicht
+ *         angelegt werden konnte.
+ *
+ * Zuerst die Sperrdatei: erst wer sie hält, darf die Sequenznummer anfassen. Ohne Alterslimit
+ * (setStaleLockTime(0)) gilt sie nur als verwaist, wenn der Prozess mit ihrer PID nicht mehr
+ * läuft; ein lange laufendes Spiel verliert seine Rolle also nicht.
+ *
+ * Unter Unix überlebt ein Segment den Absturz seines Schreibers; create() scheitert dann mit
+ * AlreadyExists, und das alte Segment wird weiterverwendet. Eine dort stehengebliebene
+ * ungerade Sequenznummer wird übersprungen. Neue Segmente sind vom Betriebssystem genullt.
+ */
+bool BoardExport::open(const QString &key) {
+    close();
+    writerLock.reset(new QLockFile(QDir(QDir::tempPath()).filePath(key + ".lock")));
+    writerLock->setStaleLockTime(0);
+    if (!writerLock->tryLock(0)) {
+        error = writerLock->error() == QLockFile::LockFailedError
+                    ? QString("Das Spielfeld \"%1\" wird schon von einem anderen Prozess freigegeben").arg(key)
+                    : QString("Sperrdatei für \"%1\" konnte nicht angelegt werden").arg(key);
+        writerLock.reset();
+        return false;
+    }
+    memory.setKey(key);
+    if (!memory.create(SEGMENT_SIZE)) {
+        if (memory.error() != QSharedMemory::AlreadyExists || !memory.attach()) {
+            error = memory.errorString();
+            writerLock.reset();
+            return false;
+        }
+        if (memory.size() < SEGMENT_SIZE) {
+            memory.detach(); ///< fremdes oder älteres Segment
+            error = QString("Das Segment \"%1\" ist zu klein").arg(key);
+            writerLock.reset();
+            return false;
+        }
+    }
+    Header *header = static_cast<Header *>(memory.data());
+    quint64 sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->version = VERSION;
+    header->headerSize = HEADER_SIZE;
+    header->length = 0;
+    header->width = 0;
+    header->flags = 0;
+    header->reserved = 0;
+    header->magic = MAGIC;
+    header->sequence.store((sequence | 1) + 1, std::memory_order_release);
+    error.clear();
+    return true;
+}
+
+/**
+ * @brief Markiert den Stand als beendet, gibt das Segment und die Schreiberrolle frei.
+ *
+ * Ohne den letzten Header zeigten Leser, die länger angehängt bleiben, ein scheinbar
+ * laufendes Spiel. Die Sperrdatei fällt erst nach dem Abhängen, damit ein neuer Schreiber
+ * nie gleichzeitig mit diesem schreibt.
+ */
+void BoardExport::close() {
+    if (memory.isAttached()) {
+        Header *header = beginWrite();
+        header->flags = (header->flags & ~FLAG_IN_GAME) | FLAG_CLOSED;
+        endWrite(header);
+        memory.detach();
+    }
+    writerLock.reset();
+}
+
+/**
+ * @brief Schreibt ein neues oder geladenes Spielfeld vollständig.
+ * @param event BOARD-Ereignis mit Anzeigeebene und Zählern.
+ *
+ * Kostet als einziger Schreibvorgang O(Zellen); Leser erkennen das neue Spielfeld an boards
+ * und lesen dann alle Codes.
+ */
+void BoardExport::writeBoard(const EngineEvent &event) {
+    TRACE_SPAN("export.board");
+    Header *header = beginWrite();
+    const int length = event.plane.getLength();
+    const int width = event.plane.getWidth();
+    const bool fits = qint64(length) * width <= MAX_CELLS;
+    header->length = length;
+    header->width = width;
+    header->boards++;
+    header->moves = 0;
+    writeCounters(header, event);
+    if (fits) {
+        quint8 *codes = static_cast<quint8 *>(memory.data()) + CODES_OFFSET;
+        for (int row = 0; row < length; row++) {
+            for (int col = 0; col < width;) {
+                int count;
+                const quint8 *span = event.plane.rowSpan(row, col, count);
+                std::transform(span, span + count, codes + qint64(row) * width + col, BoardPlane::publicCode);
+                col += count;
+            }
+        }
+    }
+    endWrite(header);
+}
+
+/**
+ * @brief Schreibt die geänderten Zellen und Zähler eines Zugs.
+ * @param event MOVE-Ereignis.
+ *
+ * Die Codes kommen direkt aus den Zellen des Ereignisses, ohne die Anzeigeebene zu lesen.
+ */
+void BoardExport::writeMove(const EngineEvent &event) {
+    TRACE_SPAN("export.move");
+    Header *header = beginWrite();
+    header->moves++;
+    writeCounters(header, event);
+    if (!(header->flags & FLAG_TOO_LARGE)) {
+        uchar *base = static_cast<uchar *>(memory.data());
+        quint8 *codes = base + CODES_OFFSET;
+        qint32 *ring = reinterpret_cast<qint32 *>(base + RING_OFFSET);
+        const int width = header->width;
+        quint64 changes = header->changes;
+        for (const CellUpdate &cell : event.cells) {
+            const qint32 index = cell.row * width + cell.col;
+            codes[index] = BoardPlane::publicCode(BoardPlane::cellCode(cell.status, cell.minesAround));
+            ring[changes & (CHANGE_RING - 1)] = index;
+            changes++;
+        }
+        header->changes = changes;
+    }
+    endWrite(header);
+}
+
+/**
+ * @brief Beginnt einen Schreibvorgang.
+ * @return Header des Segments.
+ *
+ * Der Zaun sorgt dafür, dass die ungerade Nummer vor allen folgenden Daten sichtbar ist.
+ */
+BoardExport::Header *BoardExport::beginWrite() {
+    Header *header = static_cast<Header *>(memory.data());
+    header->sequence.store(header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return header;
+}
+
+/**
+ * @brief Beendet einen Schreibvorgang.
+ * @param header Header des Segments.
+ */
+void BoardExport::endWrite(Header *header) {
+    header->sequence.store(header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Übernimmt die Zähler eines Ereignisses in den Header.
+ * @param header Header des Segments.
+ * @param event Ereignis.
+ */
+void BoardExport::writeCounters(Header *header, const EngineEvent &event) {
+    header->minesNumber = event.setup.minesNumber;
+    header->markedCells = event.markedCells;
+    header->elapsedTime = event.elapsedTime;
+    header->flags = (event.inGame ? FLAG_IN_GAME : 0) | (event.won ? FLAG_WON : 0)
+                    | (qint64(header->length) * header->width > MAX_CELLS ? FLAG_TOO_LARGE : 0);
+}
@@ -0,0 +1,301 @@
+#ifndef BOARDEXPORT_H
+#define BOARDEXPORT_H
+
+#include <QLockFile>
+#include <QSharedMemory>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+struct EngineEvent;
+
+/**
+ * @file boardexport.h
+ * @class BoardExport
+ * @brief Veröffentlicht das laufende Spielfeld in einem Shared-Memory-Segment für andere Prozesse.
+ *
+ * Overlays und Analysewerkzeuge lesen das Spielfeld direkt aus dem Segment (siehe
+ * BoardExportReader), ohne dass das Spiel für sie etwas kopiert oder auf sie wartet. Aufbau:
+ * | Versatz       | Größe             | Inhalt                                                   |
+ * |---------------|-------------------|----------------------------------------------------------|
+ * | 0             | HEADER_SIZE       | Header: Sequenznummer, Maße, Zähler                      |
+ * | RING_OFFSET   | 4 * CHANGE_RING   | Ring der zuletzt geänderten Zellindizes (Zeile * Breite + Spalte) |
+ * | CODES_OFFSET  | MAX_CELLS         | Anzeigecode jeder Zelle (siehe BoardPlane::cellCode()), zeilenweise |
+ *
+ * Verdeckte Zellen haben wie bei BoardPlane::publicCode() nur die Codes 0 oder 2 (markiert); das
+ * Segment verrät keine Minen.
+ *
+ * Technische Entscheidung:
+ * Ein Seqlock statt einer Sperre: der Schreiber macht die Sequenznummer vor dem Schreiben
+ * ungerade und danach wieder gerade. Ein Leser liest an Ort und Stelle und prüft danach, ob
+ * sich die Nummer geändert hat; wenn ja, liest er noch einmal. Der Engine-Thread wartet so nie
+ * auf einen Leser, und ein hängender Leser kann das Spiel nicht blockieren.
+ *
+ * Ein Zug schreibt nur seine geänderten Zellen und hängt ihre Indizes an den Ring an, kostet
+ * also O(geänderte Zellen). Leser, die höchstens CHANGE_RING Zellen zurückliegen, lesen nur
+ * die Indizes seit ihrem letzten Stand; sonst lesen sie alle Codes neu. Das Segment hat eine
+ * feste Größe, damit Leser nie neu anhängen müssen; bei Spielfeldern mit mehr als MAX_CELLS
+ * Zellen werden nur die Zähler veröffentlicht (FLAG_TOO_LARGE).
+ *
+ * Der Seqlock verträgt nur einen Schreiber. Die Schreiberrolle sichert deshalb eine Sperrdatei
+ * neben dem Segment (QLockFile): ein zweites Spiel mit demselben Namen scheitert in open(),
+ * solange der erste Schreiber lebt. Die Sperrdatei trägt die PID des Schreibers; nach einem
+ * Absturz erkennt QLockFile sie als verwaist, und das nächste open() übernimmt das Segment.
+ *
+ * Abhängigkeit: schreibt nur der Engine-Thread (siehe GameEngine::publish()); Einschalten über
+ * EngineCommand::EXPORT_BOARD.
+ *
+ * @author Daniel Schukin
+ */
+class BoardExport
+{
+public:
+    static constexpr char DEFAULT_KEY[] = "u3-board"; ///< Standardname des Segments.
+    static constexpr quint32 MAGIC = 0x58423355; ///< "U3BX" in Little-Endian.
+    static constexpr quint16 VERSION = 1; ///< Version des Aufbaus.
+    static constexpr int MAX_CELLS = 1 << 22; ///< Größtes Spielfeld mit Codes im Segment (4 MiB).
+    static constexpr int CHANGE_RING = 1 << 16; ///< Plätze des Rings der geänderten Zellen (Zweierpotenz).
+    static constexpr int HEADER_SIZE = 128; ///< Platz für den Header, zwei Cache-Lines.
+    static constexpr int RING_OFFSET = HEADER_SIZE; ///< Versatz des Rings.
+    static constexpr int CODES_OFFSET = RING_OFFSET + CHANGE_RING * int(sizeof(qint32)); ///< Versatz der Codes.
+    static constexpr int SEGMENT_SIZE = CODES_OFFSET + MAX_CELLS; ///< Größe des Segments.
+
+    static constexpr quint32 FLAG_IN_GAME = 0x01;   ///< Das Spiel läuft.
+    static constexpr quint32 FLAG_WON = 0x02;       ///< Das Spiel wurde gewonnen.
+    static constexpr quint32 FLAG_TOO_LARGE = 0x04; ///< Spielfeld größer als MAX_CELLS; Codes und Ring sind ungültig.
+    static constexpr quint32 FLAG_CLOSED = 0x08;    ///< Der Schreiber hat das Segment freigegeben; der Stand ändert sich nicht mehr.
+
+    /// @brief Header am Anfang des Segments.
+    struct Header
+    {
+        quint32 magic;                  ///< MAGIC, sobald das Segment beschrieben ist.
+        quint16 version;                ///< VERSION.
+        quint16 headerSize;             ///< HEADER_SIZE.
+        std::atomic<quint64> sequence;  ///< Seqlock: ungerade, solange geschrieben wird.
+        qint32 length;                  ///< Anzahl der Zeilen.
+        qint32 width;                   ///< Anzahl der Spalten.
+        qint32 minesNumber;             ///< Anzahl der Minen.
+        qint32 markedCells;             ///< Anzahl der markierten Zellen.
+        quint32 flags;                  ///< Kombination aus FLAG_*.
+        quint32 reserved;               ///< Immer 0.
+        qint64 elapsedTime;             ///< Spielzeit in ms beim letzten Zug.
+        quint64 boards;                 ///< Nummer des Spielfelds; wächst mit jedem neuen oder geladenen Spielfeld.
+        quint64 moves;                  ///< Züge seit Beginn des Spielfelds.
+        quint64 changes;                ///< Bisher in den Ring geschriebene Zellen; der nächste Platz ist changes % CHANGE_RING.
+    };
+    static_assert(sizeof(Header) <= HEADER_SIZE, "Header passt nicht in HEADER_SIZE");
+    static_assert(std::atomic<quint64>::is_always_lock_free, "Seqlock braucht eine sperrfreie 64-Bit-Zahl");
+
+    /**
+     * @brief Konstruktor für BoardExport. Das Segment entsteht erst mit open().
+     *
+     * @author Daniel Schukin
+     */
+    BoardExport() = default;
+
+    /**
+     * @brief Destruktor für BoardExport. Gibt das Segment frei, siehe close().
+     *
+     * @author Daniel Schukin
+     */
+    ~BoardExport();
+
+    /**
+     * @brief Übernimmt die Schreiberrolle und legt das Segment an oder übernimmt ein verwaistes.
+     * @param key Name des Segments.
+     * @return False, wenn ein anderer Prozess das Segment schon beschreibt oder es nicht
+     *         angelegt werden konnte.
+     *
+     * @author Daniel Schukin
+     */
+    bool open(const QString &key);
+
+    /**
+     * @brief Markiert den Stand als beendet (FLAG_CLOSED), gibt das Segment und die
+     *        Schreiberrolle frei; das Segment verschwindet, sobald auch kein Leser mehr angehängt ist.
+     *
+     * @author Daniel Schukin
+     */
+    void close();
+
+    /**
+     * @brief Gibt zurück, ob ein Segment angelegt ist.
+     * @return True nach erfolgreichem open().
+     *
+     * @author Daniel Schukin
+     */
+    bool isOpen() const { return memory.isAttached(); }
+
+    /**
+     * @brief Gibt die Fehlermeldung des letzten open() zurück.
+     * @return Fehlermeldung der Sperrdatei oder von QSharedMemory.
+     *
+     * @author Daniel Schukin
+     */
+    QString errorString() const { return error; }
+
+    /**
+     * @brief Schreibt ein neues oder geladenes Spielfeld vollständig.
+     * @param event BOARD-Ereignis mit Anzeigeebene und Zählern.
+     *
+     * @author Daniel Schukin
+     */
+    void writeBoard(const EngineEvent &event);
+
+    /**
+     * @brief Schreibt die geänderten Zellen und Zähler eines Zugs.
+     * @param event MOVE-Ereignis.
+     *
+     * @author Daniel Schukin
+     */
+    void writeMove(const EngineEvent &event);
+
+private:
+    /**
+     * @brief Beginnt einen Schreibvorgang (Sequenznummer ungerade).
+     * @return Header des Segments.
+     *
+     * @author Daniel Schukin
+     */
+    Header *beginWrite();
+
+    /**
+     * @brief Beendet einen Schreibvorgang (Sequenznummer gerade).
+     * @param header Header des Segments.
+     *
+     * @author Daniel Schukin
+     */
+    void endWrite(Header *header);
+
+    /**
+     * @brief Übernimmt die Zähler eines Ereignisses in den Header.
+     * @param header Header des Segments.
+     * @param event Ereignis.
+     *
+     * @author Daniel Schukin
+     */
+    static void writeCounters(Header *header, const EngineEvent &event);
+
+    QSharedMemory memory; ///< Segment; angehängt zwischen open() und close().
+    std::unique_ptr<QLockFile> writerLock; ///< Sperrdatei der Schreiberrolle; gehalten zwischen open() und close().
+    QString error; ///< Fehlermeldung des letzten open().
+};
+
+/**
+ * @class BoardExportReader
+ * @brief Liest das von BoardExport veröffentlichte Spielfeld in einem anderen Prozess.
+ *
+ * Nur Header; Werkzeuge brauchen außer Qt Core nichts weiter (siehe tools/u3-watch).
+ *
+ * @author Daniel Schukin
+ */
+class BoardExportReader
+{
+public:
+    /// @brief Stand des Spielfelds während eines read(), mit Zeigern direkt ins Segment.
+    struct Snapshot
+    {
+        int length = 0;              ///< Anzahl der Zeilen.
+        int width = 0;               ///< Anzahl der Spalten; length * width <= MAX_CELLS ist garantiert.
+        int minesNumber = 0;         ///< Anzahl der Minen.
+        int markedCells = 0;         ///< Anzahl der markierten Zellen.
+        quint32 flags = 0;           ///< Kombination aus BoardExport::FLAG_*.
+        qint64 elapsedTime = 0;      ///< Spielzeit in ms beim letzten Zug.
+        quint64 boards = 0;          ///< Nummer des Spielfelds.
+        quint64 moves = 0;           ///< Züge seit Beginn des Spielfelds.
+        quint64 changes = 0;         ///< Bisher in den Ring geschriebene Zellen.
+        const quint8 *codes = nullptr;  ///< Anzeigecodes, length * width Bytes.
+        const qint32 *ring = nullptr;   ///< Ring der geänderten Zellindizes, CHANGE_RING Einträge.
+    };
+
+    /**
+     * @brief Konstruktor für BoardExportReader.
+     * @param key Name des Segments.
+     *
+     * @author Daniel Schukin
+     */
+    explicit BoardExportReader(const QString &key = BoardExport::DEFAULT_KEY)
+        : memory(key)
+    {
+    }
+
+    /**
+     * @brief Hängt sich lesend an das Segment an.
+     * @return False, wenn es (noch) kein gültiges Segment gibt; später erneut versuchen.
+     *
+     * @author Daniel Schukin
+     */
+    bool attach() {
+        if (!memory.isAttached() && !memory.attach(QSharedMemory::ReadOnly)) {
+            return false;
+        }
+        const BoardExport::Header *header = static_cast<const BoardExport::Header *>(memory.constData());
+        if (memory.size() < BoardExport::SEGMENT_SIZE || header->magic != BoardExport::MAGIC
+            || header->version != BoardExport::VERSION) {
+            memory.detach();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Gibt zurück, ob der Leser angehängt ist.
+     * @return True nach erfolgreichem attach().
+     *
+     * @author Daniel Schukin
+     */
+    bool isAttached() const { return memory.isAttached(); }
+
+    /**
+     * @brief Ruft visit mit einem in sich stimmigen Stand auf, ohne zu kopieren.
+     * @param visit Funktion mit einem Parameter `const Snapshot &`; kann mehrmals aufgerufen werden.
+     * @param attempts Höchstzahl der Versuche, falls der Schreiber dazwischenkommt.
+     * @return True, wenn der letzte Aufruf von visit einen stimmigen Stand gesehen hat.
+     *
+     * visit liest direkt im Segment und darf sich nur nach einem true auf das Gelesene
+     * verlassen; vorher kann ein Code oder ein Index des Rings halb geschrieben sein. Die Maße
+     * im Snapshot sind aber immer gültig, Zugriffe auf codes[0, length * width) also sicher;
+     * Indizes aus dem Ring muss visit selbst gegen length * width prüfen.
+     *
+     * @author Daniel Schukin
+     */
+    template<class Visitor>
+    bool read(Visitor visit, int attempts = 64) const {
+        const uchar *base = static_cast<const uchar *>(memory.constData());
+        const BoardExport::Header *header = reinterpret_cast<const BoardExport::Header *>(base);
+        for (int attempt = 0; attempt < attempts; attempt++) {
+            const quint64 before = header->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue; ///< Schreiber ist mitten in einem Zug
+            }
+            Snapshot snapshot;
+            snapshot.length = qMax(0, header->length);
+            snapshot.width = qMax(0, header->width);
+            snapshot.minesNumber = header->minesNumber;
+            snapshot.markedCells = header->markedCells;
+            snapshot.flags = header->flags;
+            snapshot.elapsedTime = header->elapsedTime;
+            snapshot.boards = header->boards;
+            snapshot.moves = header->moves;
+            snapshot.changes = header->changes;
+            if (qint64(snapshot.length) * snapshot.width > BoardExport::MAX_CELLS) {
+                snapshot.length = 0; ///< zu groß oder halb geschrieben: keine Codes
+                snapshot.width = 0;
+            }
+            snapshot.codes = base + BoardExport::CODES_OFFSET;
+            snapshot.ring = reinterpret_cast<const qint32 *>(base + BoardExport::RING_OFFSET);
+            visit(snapshot);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header->sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    QSharedMemory memory; ///< Segment, nur lesend angehängt.
+};
+
+#endif // BOARDEXPORT_H
@@ -0,0 +1,42 @@
+#include "boardkernels.h"
+
+/**
+ * @brief Erstellt die Tabelle für eine Instanz der Schleifen.
+ * @tparam Layout Speicherlayout, siehe boardlayout.h.
+ * @return Tabelle mit Zeigern auf die Instanzen.
+ */
+template <class Layout>
+static constexpr BoardKernels makeKernels() {
+    return BoardKernels{
+        &BoardKernel::countMinesAround<Layout>,
+        &BoardKernel::adjustMinesAround<Layout>,
+        &BoardKernel::labelOpenings<Layout>
+    };
+}
+
+static constexpr BoardKernels EASY_KERNELS =
+    makeKernels<BoardLayout::RowMajor<PRESET_EASY.length, PRESET_EASY.width>>();
+static constexpr BoardKernels MEDIUM_KERNELS =
+    makeKernels<BoardLayout::RowMajor<PRESET_MEDIUM.length, PRESET_MEDIUM.width>>();
+static constexpr BoardKernels HARD_KERNELS =
+    makeKernels<BoardLayout::RowMajor<PRESET_HARD.length, PRESET_HARD.width>>();
+static constexpr BoardKernels DYNAMIC_KERNELS = makeKernels<BoardLayout::RowMajor<0, 0>>();
+
+/**
+ * @brief Wählt die passende Instanz für die gegebenen Maße.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @return Spezialisierte Tabelle für einen Schwierigkeitsgrad, sonst die Laufzeitvariante.
+ */
+const BoardKernels &BoardKernels::select(int length, int width) {
+    if (length == PRESET_EASY.length && width == PRESET_EASY.width) {
+        return EASY_KERNELS;
+    }
+    if (length == PRESET_MEDIUM.length && width == PRESET_MEDIUM.width) {
+        return MEDIUM_KERNELS;
+    }
+    if (length == PRESET_HARD.length && width == PRESET_HARD.width) {
+        return HARD_KERNELS;
+    }
+    return DYNAMIC_KERNELS;
+}
@@ -0,0 +1,283 @@
+#ifndef BOARDKERNELS_H
+#define BOARDKERNELS_H
+
+#include "boardlayout.h"
+#include "cell.h"
+#include "gamearena.h"
+#include <algorithm>
+#include <utility>
+
+/**
+ * @file boardkernels.h
+ * @brief Auf die Spielfeldgröße spezialisierte Schleifen der Spiellogik.
+ *
+ * Die rechenintensiven Schleifen (Minen zählen, Minenzahlen reparieren, Öffnungen beschriften)
+ * sind Templates über das Speicherlayout aus boardlayout.h. Für die Standard-Schwierigkeitsgrade
+ * werden sie mit BoardLayout::RowMajor und festen Maßen instanziiert, sodass Schleifengrenzen
+ * und Nachbarversätze Konstanten sind und der Compiler die Nachbarschaftsschleifen vollständig
+ * ausrollt. RowMajor<0, 0> liest die Maße zur Laufzeit und dient für benutzerdefinierte
+ * Spielfelder.
+ *
+ * Abhängigkeiten: wird nur vom Game-Modul verwendet. Die Auswahl der Instanz passiert einmal
+ * pro Spielfeld in Game::createMatrix() über BoardKernels::select().
+ *
+ * @author Daniel Schukin
+ */
+
+/**
+ * @struct BoardPreset
+ * @brief Maße eines Standard-Schwierigkeitsgrads.
+ *
+ * @author Daniel Schukin
+ */
+struct BoardPreset
+{
+    int length;      ///< Anzahl der Zeilen.
+    int width;       ///< Anzahl der Spalten.
+    int minesNumber; ///< Anzahl der Minen.
+};
+
+constexpr BoardPreset PRESET_EASY{10, 10, 10};   ///< Leicht (10x10, 10 Minen).
+constexpr BoardPreset PRESET_MEDIUM{14, 18, 40}; ///< Mittel (14x18, 40 Minen).
+constexpr BoardPreset PRESET_HARD{20, 24, 99};   ///< Schwer (20x24, 99 Minen).
+
+/// @brief Größe des Zellvektors (mit Rand), die für jeden Schwierigkeitsgrad ausreicht.
+constexpr int PRESET_CELLS = BoardLayout::paddedSize(PRESET_HARD.length, PRESET_HARD.width);
+
+namespace BoardKernel {
+
+/**
+ * @brief Summiert die Minen der 8 Nachbarn, zur Übersetzungszeit ausgerollt.
+ * @param cells Gepolsterter Zellvektor.
+ * @param layout Speicherlayout, siehe boardlayout.h.
+ * @param index Linearer Index der Mitte.
+ * @return Anzahl der verminten Nachbarn.
+ *
+ * Die Fold-Expression erzeugt 8 einzelne Zugriffe. Im zeilenweisen Layout mit fester Breite
+ * sind die Versätze Konstanten und werden direkt in die Adressen eingesetzt.
+ *
+ * @author Daniel Schukin
+ */
+template <class Layout, std::size_t... K>
+inline int minedNeighbours(const Cell *cells, const Layout &layout, int index,
+                           std::index_sequence<K...>) {
+    return (int(cells[layout.neighbour(index, K)].is_mined()) + ...);
+}
+
+/**
+ * @brief Ändert die Minenzahl der 8 Nachbarn um delta, zur Übersetzungszeit ausgerollt.
+ * @param cells Gepolsterter Zellvektor.
+ * @param layout Speicherlayout, siehe boardlayout.h.
+ * @param index Linearer Index der Mitte.
+ * @param delta Änderung der Minenzahl.
+ *
+ * @author Daniel Schukin
+ */
+template <class Layout, std::size_t... K>
+inline void adjustNeighbours(Cell *cells, const Layout &layout, int index, int delta,
+                             std::index_sequence<K...>) {
+    ((cells[layout.neighbour(index, K)].set_mines_around(
+          cells[layout.neighbour(index, K)].get_mines_around() + delta)), ...);
+}
+
+/**
+ * @brief Zählt die Minen um jede Zelle (die Zelle selbst mitgezählt).
+ * @tparam Layout Speicherlayout, siehe boardlayout.h.
+ * @param cells Gepolsterter Zellvektor.
+ * @param length Anzahl der Zeilen, wird bei festen Maßen ignoriert.
+ * @param width Anzahl der Spalten, wird bei festen Maßen ignoriert.
+ *
+ * @author Daniel Schukin
+ */
+template <class Layout>
+void countMinesAround(Cell *cells, int length, int width) {
+    const Layout layout(length, width);
+    for (int i = 0; i < layout.length(); i++) {
+        for (int j = 0; j < layout.width(); j++) {
+            const int index = layout.index(i, j);
+            cells[index].set_mines_around(cells[index].is_mined()
+                                          + minedNeighbours(cells, layout, index,
+                                                            std::make_index_sequence<BoardLayout::NEIGHBOURS>()));
+        }
+    }
+}
+
+/**
+ * @brief Ändert die Minenzahl einer Zelle und ihrer 8 Nachbarn um delta.
+ * @tparam Layout Speicherlayout, siehe boardlayout.h.
+ * @param cells Gepolsterter Zellvektor.
+ * @param length Anzahl der Zeilen, wird bei festen Maßen ignoriert.
+ * @param width Anzahl der Spalten, wird bei festen Maßen ignoriert.
+ * @param row Zeilenindex der Mitte.
+ * @param col Spaltenindex der Mitte.
+ * @param delta Änderung der Minenzahl.
+ *
+ * @author Daniel Schukin
+ */
+template <class Layout>
+void adjustMinesAround(Cell *cells, int length, int width, int row, int col, int delta) {
+    const Layout layout(length, width);
+    const int index = layout.index(row, col);
+    cells[index].set_mines_around(cells[index].get_mines_around() + delta);
+    ///< Randzellen dürfen mitgezählt werden, ihre Minenzahl wird nie gelesen
+    adjustNeighbours(cells, layout, index, delta, std::make_index_sequence<BoardLayout::NEIGHBOURS>());
+}
+
+/**
+ * @brief Beschriftet alle Öffnungen des Spielfelds und berechnet 3BV.
+ * @tparam Layout Speicherlayout, siehe boardlayout.h.
+ * @param cells Gepolsterter Zellvektor.
+ * @param length Anzahl der Zeilen, wird bei festen Maßen ignoriert.
+ * @param width Anzahl der Spalten, wird bei festen Maßen ignoriert.
+ * @param openingOf Ausgabe: Nummer der Öffnung pro Zelle, -1 für Rand und Zellen mit Nachbarminen.
+ * @param openingStart Ausgabe: Beginn der Zellliste jeder Öffnung (plus Endmarke).
+ * @param openingCells Ausgabe: Zellindizes aller Öffnungen inklusive Rand.
+ * @return 3BV des Spielfelds.
+ *
+ * Erster Durchlauf: Union-Find über die Nullzellen, wobei jede Zelle nur mit den schon
+ * besuchten Nachbarn (die ersten 4 Nachbarn in Zeilenreihenfolge) vereinigt wird.
+ * Zweiter Durchlauf: Größe jeder Zellliste zählen, danach die Listen füllen.
+ * Randzellen, die an mehrere Öffnungen grenzen, stehen in jeder dieser Listen.
+ *
+ * @author Daniel Schukin
+ */
+template <class Layout>
+int labelOpenings(const Cell *cells, int length, int width,
+                  ArenaVector<int> &openingOf, ArenaVector<int> &openingStart, ArenaVector<int> &openingCells) {
+    const Layout layout(length, width);
+    const int size = layout.size();
+
+    ///< Union-Find über die Nullzellen, parent[i] == -1 für Randzellen und Zellen mit Nachbarminen.
+    ///< Hilfspuffer kommen aus derselben Arena wie die Ausgaben.
+    ArenaVector<int> parent(size, -1, openingOf.get_allocator());
+    auto find = [&parent](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    for (int i = 0; i < layout.length(); i++) {
+        for (int j = 0; j < layout.width(); j++) {
+            const int index = layout.index(i, j);
+            if (cells[index].is_mined() || cells[index].get_mines_around() != 0) {
+                continue;
+            }
+            parent[index] = index;
+            ///< die ersten 4 Nachbarn sind genau die schon besuchten
+            for (int k = 0; k < 4; k++) {
+                const int neighbour = layout.neighbour(index, k);
+                if (parent[neighbour] < 0) {
+                    continue;
+                }
+                int a = find(index), b = find(neighbour);
+                parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+
+    ///< fortlaufende Nummern für die Wurzeln vergeben
+    openingOf.assign(size, -1);
+    int openings = 0;
+    for (int index = 0; index < size; index++) {
+        if (parent[index] >= 0) {
+            int root = find(index);
+            openingOf[index] = root == index ? openings++ : openingOf[root];
+        }
+    }
+
+    ///< sammelt die verschiedenen Öffnungen, an die eine Zelle grenzt (höchstens 4)
+    auto adjacent_openings = [&](int index, int *found) {
+        int count = 0;
+        for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+            int opening = openingOf[layout.neighbour(index, k)];
+            if (opening >= 0 && std::find(found, found + count, opening) == found + count) {
+                found[count++] = opening;
+            }
+        }
+        return count;
+    };
+
+    ///< Größe der Zelllisten zählen und 3BV bestimmen
+    openingStart.assign(openings + 1, 0);
+    int bbbv = openings;
+    int found[BoardLayout::NEIGHBOURS];
+    for (int i = 0; i < layout.length(); i++) {
+        for (int j = 0; j < layout.width(); j++) {
+            const int index = layout.index(i, j);
+            if (cells[index].is_mined()) {
+                continue;
+            }
+            int opening = openingOf[index];
+            if (opening >= 0) {
+                openingStart[opening + 1]++;
+                continue;
+            }
+            int count = adjacent_openings(index, found);
+            for (int k = 0; k < count; k++) {
+                openingStart[found[k] + 1]++;
+            }
+            ///< Zahlenzellen ohne angrenzende Öffnung brauchen je einen eigenen Klick
+            if (count == 0) {
+                bbbv++;
+            }
+        }
+    }
+    for (int k = 0; k < openings; k++) {
+        openingStart[k + 1] += openingStart[k];
+    }
+
+    ///< Zelllisten füllen
+    openingCells.assign(openingStart[openings], 0);
+    ArenaVector<int> next(openingStart, openingStart.get_allocator());
+    for (int i = 0; i < layout.length(); i++) {
+        for (int j = 0; j < layout.width(); j++) {
+            const int index = layout.index(i, j);
+            if (cells[index].is_mined()) {
+                continue;
+            }
+            if (openingOf[index] >= 0) {
+                openingCells[next[openingOf[index]]++] = index;
+                continue;
+            }
+            int count = adjacent_openings(index, found);
+            for (int k = 0; k < count; k++) {
+                openingCells[next[found[k]]++] = index;
+            }
+        }
+    }
+    return bbbv;
+}
+
+}
+
+/**
+ * @struct BoardKernels
+ * @brief Tabelle der für eine Spielfeldgröße instanziierten Schleifen.
+ *
+ * Game wählt die Tabelle einmal beim Erstellen des Spielfelds und ruft die Schleifen
+ * danach nur noch über diese Zeiger auf.
+ *
+ * @author Daniel Schukin
+ */
+struct BoardKernels
+{
+    void (*countMinesAround)(Cell *cells, int length, int width); ///< siehe BoardKernel::countMinesAround().
+    void (*adjustMinesAround)(Cell *cells, int length, int width, int row, int col, int delta); ///< siehe BoardKernel::adjustMinesAround().
+    int (*labelOpenings)(const Cell *cells, int length, int width,
+                         ArenaVector<int> &openingOf, ArenaVector<int> &openingStart,
+                         ArenaVector<int> &openingCells); ///< siehe BoardKernel::labelOpenings().
+
+    /**
+     * @brief Wählt die passende Instanz für die gegebenen Maße.
+     * @param length Anzahl der Zeilen.
+     * @param width Anzahl der Spalten.
+     * @return Spezialisierte Tabelle für einen Schwierigkeitsgrad, sonst die Laufzeitvariante.
+     *
+     * @author Daniel Schukin
+     */
+    static const BoardKernels &select(int length, int width);
+};
+
+#endif // BOARDKERNELS_H
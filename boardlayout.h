@@ -0,0 +1,91 @@
+#ifndef BOARDLAYOUT_H
+#define BOARDLAYOUT_H
+
+/**
+ * @file boardlayout.h
+ * @brief Hilfsfunktionen für das gepolsterte Speicherlayout des Spielfelds.
+ *
+ * Das Spielfeld wird als ein zusammenhängender Vektor gespeichert, der rundherum von
+ * einem Ring aus Randzellen (Sentinels) umgeben ist. Die Zelle in Zeile row, Spalte col
+ * liegt bei (row + 1) * stride + col + 1 mit stride = Breite + 2.
+ *
+ * Technische Entscheidung:
+ * Durch den Rand hat jede echte Zelle genau 8 Nachbarn mit festem linearem Versatz.
+ * Die Nachbarschaftsschleifen brauchen so keine Grenzprüfungen mehr und können vom
+ * Compiler vollständig ausgerollt werden. Randzellen sind aufgedeckt und unvermint,
+ * sie werden also weder geöffnet noch als Mine gezählt.
+ *
+ * @author Daniel Schukin
+ */
+namespace BoardLayout {
+
+constexpr int NEIGHBOURS = 8; ///< Anzahl der Nachbarn einer Zelle.
+
+/// @brief Zeilenversatz der 8 Nachbarn.
+constexpr int NEIGHBOUR_ROWS[NEIGHBOURS] = {-1, -1, -1, 0, 0, 1, 1, 1};
+
+/// @brief Spaltenversatz der 8 Nachbarn.
+constexpr int NEIGHBOUR_COLS[NEIGHBOURS] = {-1, 0, 1, -1, 1, -1, 0, 1};
+
+/**
+ * @brief Gibt den Zeilenabstand des gepolsterten Spielfelds zurück.
+ * @param width Anzahl der Spalten ohne Rand.
+ * @return Anzahl der Zellen pro gespeicherter Zeile.
+ *
+ * @author Daniel Schukin
+ */
+constexpr int stride(int width) { return width + 2; }
+
+/**
+ * @brief Gibt die Anzahl der gespeicherten Zellen inklusive Rand zurück.
+ * @param length Anzahl der Zeilen ohne Rand.
+ * @param width Anzahl der Spalten ohne Rand.
+ * @return Größe des Zellvektors.
+ *
+ * @author Daniel Schukin
+ */
+constexpr int paddedSize(int length, int width) { return (length + 2) * (width + 2); }
+
+/**
+ * @brief Rechnet Zeile und Spalte in den linearen Index um.
+ * @param row Zeilenindex ohne Rand.
+ * @param col Spaltenindex ohne Rand.
+ * @param stride Zeilenabstand, siehe stride().
+ * @return Linearer Index im gepolsterten Zellvektor.
+ *
+ * @author Daniel Schukin
+ */
+constexpr int index(int row, int col, int stride) { return (row + 1) * stride + col + 1; }
+
+/**
+ * @struct RowMajor
+ * @brief Zeilenweises Layout mit Sentinel-Rand.
+ * @tparam Length Anzahl der Zeilen, 0 für Laufzeitwert.
+ * @tparam Width Anzahl der Spalten, 0 für Laufzeitwert.
+ *
+ * Bei festen Maßen sind alle Methoden Konstanten-Ausdrücke, die der Compiler direkt einsetzt.
+ *
+ * @author Daniel Schukin
+ */
+template <int Length, int Width>
+struct RowMajor
+{
+    int rows; ///< Anzahl der Zeilen, falls Length 0 ist.
+    int cols; ///< Anzahl der Spalten, falls Width 0 ist.
+
+    constexpr RowMajor(int length, int width) : rows(length), cols(width) {}
+
+    constexpr int length() const { return Length ? Length : rows; }
+    constexpr int width() const { return Width ? Width : cols; }
+    constexpr int size() const { return paddedSize(length(), width()); }
+    constexpr int index(int row, int col) const { return BoardLayout::index(row, col, stride(width())); }
+
+    /// @brief Index des k-ten Nachbarn über den festen linearen Versatz.
+    constexpr int neighbour(int index, int k) const {
+        return index + NEIGHBOUR_ROWS[k] * stride(width()) + NEIGHBOUR_COLS[k];
+    }
+};
+
+}
+
+#endif // BOARDLAYOUT_H
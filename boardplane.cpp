@@ -0,0 +1,22 @@
+#include "boardplane.h"
+
+/**
+ * @brief Erzeugt eine leere Ebene für ein Spielfeld; alle Zellen sind verdeckt (Code 0).
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ *
+ * Die alten Blöcke werden nicht überschrieben, sondern ersetzt; Kopien der vorigen Ebene
+ * bleiben also unverändert gültig.
+ */
+void BoardPlane::reset(int length, int width) {
+    this->length = length;
+    this->width = width;
+    const qint64 cells = qint64(length) * width;
+    const int count = int((cells + CHUNK_SIZE - 1) >> CHUNK_BITS);
+    chunks = QVector<QVector<quint8>>();
+    chunks.reserve(count);
+    for (int i = 0; i < count; i++) {
+        const int size = int(qMin<qint64>(CHUNK_SIZE, cells - qint64(i) * CHUNK_SIZE));
+        chunks.append(QVector<quint8>(size, 0));
+    }
+}
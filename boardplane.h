@@ -0,0 +1,144 @@
+#ifndef BOARDPLANE_H
+#define BOARDPLANE_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @file boardplane.h
+ * @class BoardPlane
+ * @brief Darstellung des Spielfelds als ein Byte pro Zelle, zum Lesen aus anderen Threads.
+ *
+ * Jede Zelle hat einen Anzeigecode (siehe cellCode()), aus dem allein ihr Bild folgt. Der
+ * Engine-Thread schreibt die Ebene nach jedem Zug fort und schickt eine Kopie mit dem Ereignis
+ * an die Oberfläche; der Render-Thread zeichnet aus dieser Kopie.
+ *
+ * Technische Entscheidung:
+ * Die Ebene besteht aus Blöcken zu CHUNK_SIZE Zellen in QVectors mit Copy-on-Write. Eine Kopie
+ * der Ebene kostet nur das Hochzählen der Referenzen, und wer sie liest, sieht einen festen
+ * Stand, ohne dass irgendwer sperrt. Schreibt die Engine danach in einen Block, den noch eine
+ * Kopie hält, kopiert sie nur diesen Block (64 KB) statt des ganzen Spielfelds. Die Engine
+ * wartet so nie auf den Renderer; alte Stände werden freigegeben, sobald die letzte Kopie
+ * verschwindet.
+ *
+ * @author Daniel Schukin
+ */
+class BoardPlane
+{
+public:
+    static constexpr int CHUNK_BITS = 16; ///< Zweierlogarithmus der Blockgröße.
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_BITS; ///< Zellen pro Block.
+    static constexpr quint8 OPEN_CODE = 16; ///< Code einer aufgedeckten Zelle ohne benachbarte Minen.
+    static constexpr int CODE_COUNT = OPEN_CODE + 9; ///< Anzahl möglicher Codes.
+
+    /**
+     * @brief Erzeugt eine leere Ebene für ein Spielfeld; alle Zellen sind verdeckt (Code 0).
+     * @param length Anzahl der Zeilen.
+     * @param width Anzahl der Spalten.
+     *
+     * @author Daniel Schukin
+     */
+    void reset(int length, int width);
+
+    /**
+     * @brief Berechnet den Anzeigecode einer Zelle.
+     * @param status Status der Zelle, siehe Game::getCellStatus().
+     * @param minesAround Anzahl benachbarter Minen (nur bei aufgedeckten Zellen verwendet).
+     * @return Status bei verdeckten Zellen, OPEN_CODE + minesAround bei aufgedeckten.
+     *
+     * @author Daniel Schukin
+     */
+    static quint8 cellCode(int status, int minesAround) {
+        return status == 1 ? quint8(OPEN_CODE + minesAround) : quint8(status);
+    }
+
+    /**
+     * @brief Gibt den Code zurück, den andere Prozesse oder Zuschauer sehen dürfen.
+     * @param code Anzeigecode.
+     * @return Bei verdeckten Zellen nur verdeckt (0) oder markiert (2).
+     *
+     * Die Ebene trägt bei verdeckten Zellen den ganzen Status, also auch das Minenbit einer
+     * markierten Mine; was das Programm verlässt, soll daraus keine Minen ablesen können.
+     *
+     * @author Daniel Schukin
+     */
+    static quint8 publicCode(quint8 code) {
+        return code < OPEN_CODE && !(code & 1) ? quint8(code & 2) : code;
+    }
+
+    /**
+     * @brief Setzt den Code einer Zelle; kopiert dabei höchstens ihren Block.
+     * @param row Zeilenindex der Zelle.
+     * @param col Spaltenindex der Zelle.
+     * @param code Anzeigecode.
+     *
+     * @author Daniel Schukin
+     */
+    void set(int row, int col, quint8 code) {
+        const qint64 index = qint64(row) * width + col;
+        chunks[int(index >> CHUNK_BITS)][int(index & (CHUNK_SIZE - 1))] = code;
+    }
+
+    /**
+     * @brief Gibt den Code einer Zelle zurück.
+     * @param row Zeilenindex der Zelle.
+     * @param col Spaltenindex der Zelle.
+     * @return Anzeigecode.
+     *
+     * @author Daniel Schukin
+     */
+    quint8 code(int row, int col) const {
+        const qint64 index = qint64(row) * width + col;
+        return chunks.at(int(index >> CHUNK_BITS)).at(int(index & (CHUNK_SIZE - 1)));
+    }
+
+    /**
+     * @brief Gibt die Codes einer Zeile ab einer Spalte zurück, höchstens bis zum Ende ihres Blocks.
+     * @param row Zeilenindex.
+     * @param col Erste Spalte.
+     * @param count Gibt die Anzahl der zusammenhängend lesbaren Codes zurück.
+     * @return Zeiger auf den Code der Zelle (row, col).
+     *
+     * Für den Renderer, der so ganze Zeilenstücke ohne Indexrechnung pro Zelle liest.
+     *
+     * @author Daniel Schukin
+     */
+    const quint8 *rowSpan(int row, int col, int &count) const {
+        const qint64 index = qint64(row) * width + col;
+        const int offset = int(index & (CHUNK_SIZE - 1));
+        count = int(qMin<qint64>(width - col, CHUNK_SIZE - offset));
+        return chunks.at(int(index >> CHUNK_BITS)).constData() + offset;
+    }
+
+    /**
+     * @brief Gibt die Codes einer Zeile ab einer Spalte zum Schreiben zurück, höchstens bis zum Ende ihres Blocks.
+     * @param row Zeilenindex.
+     * @param col Erste Spalte.
+     * @param count Gibt die Anzahl der zusammenhängend schreibbaren Codes zurück.
+     * @return Zeiger auf den Code der Zelle (row, col); kopiert dabei höchstens diesen Block.
+     *
+     * Für das Füllen eines ganzen Spielfelds, z.B. nach dem Laden eines Spielstands.
+     *
+     * @author Daniel Schukin
+     */
+    quint8 *rowData(int row, int col, int &count) {
+        const qint64 index = qint64(row) * width + col;
+        const int offset = int(index & (CHUNK_SIZE - 1));
+        count = int(qMin<qint64>(width - col, CHUNK_SIZE - offset));
+        return chunks[int(index >> CHUNK_BITS)].data() + offset;
+    }
+
+    /// @name Getter
+    /// @{
+    int getLength() const { return length; }
+    int getWidth() const { return width; }
+    bool isEmpty() const { return chunks.isEmpty(); }
+    /// @}
+
+private:
+    QVector<QVector<quint8>> chunks; ///< Blöcke zu CHUNK_SIZE Zellen, zeilenweise.
+    int length = 0; ///< Anzahl der Zeilen.
+    int width = 0; ///< Anzahl der Spalten.
+};
+
+#endif // BOARDPLANE_H
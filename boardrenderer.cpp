@@ -0,0 +1,172 @@
+#include "boardrenderer.h"
+#include "tracing.h"
+#include <QPainter>
+#include <QThread>
+#include <QMutexLocker>
+
+/**
+ * @brief Konstruktor für BoardRenderer. Startet den Render-Thread.
+ * @param parent Übergeordnetes Objekt.
+ */
+BoardRenderer::BoardRenderer(QObject *parent)
+    : QObject(parent)
+{
+    thread = QThread::create([this]() { run(); });
+    thread->start();
+}
+
+/**
+ * @brief Destruktor für BoardRenderer. Beendet den Render-Thread.
+ *
+ * Ein gerade laufendes Bild wird noch fertig gezeichnet.
+ */
+BoardRenderer::~BoardRenderer() {
+    {
+        QMutexLocker locker(&mutex);
+        quitting = true;
+        wake.wakeOne();
+    }
+    thread->wait();
+    delete thread;
+}
+
+/**
+ * @brief Setzt die Bilder der Zellen.
+ * @param sprites Ein Bild der Größe cellSize x cellSize pro Anzeigecode.
+ * @param cellSize Kantenlänge einer Zelle in Pixeln.
+ *
+ * Die nächste Anforderung wird auch bei unverändertem Stand neu gezeichnet.
+ */
+void BoardRenderer::setSprites(const QVector<QImage> &sprites, int cellSize) {
+    QMutexLocker locker(&mutex);
+    this->sprites = sprites;
+    this->cellSize = cellSize;
+    requestedArea = QRect();
+}
+
+/**
+ * @brief Fordert ein neues Bild an; wartet nie auf den Render-Thread.
+ * @param plane Stand der Anzeigeebene.
+ * @param area Ausschnitt in Pixeln des ganzen Spielfelds.
+ * @param generation Nummer des Stands.
+ *
+ * Die Sperre wird nur zum Ablegen der Anforderung gehalten; der Render-Thread hält sie nie
+ * während des Zeichnens.
+ */
+void BoardRenderer::request(const BoardPlane &plane, const QRect &area, quint64 generation) {
+    QMutexLocker locker(&mutex);
+    if (generation == requestedGeneration && area == requestedArea) {
+        return; ///< schon angefordert oder gezeichnet
+    }
+    requestedPlane = plane;
+    requestedArea = area;
+    requestedGeneration = generation;
+    pending = true;
+    wake.wakeOne();
+}
+
+/**
+ * @brief Kopiert das zuletzt fertige Bild auf den Bildschirm.
+ * @param painter Painter des Widgets, das das ganze Spielfeld zeigt.
+ * @param area Zu zeichnender Bereich.
+ * @param generation Aktuelle Nummer des Stands.
+ * @return True, wenn das Bild diesen Stand zeigt und den Bereich ganz abdeckt.
+ *
+ * Nicht abgedeckte Teile bleiben, wie der Painter sie vorfindet; der Aufrufer fordert dann ein
+ * neues Bild an.
+ */
+bool BoardRenderer::paint(QPainter &painter, const QRect &area, quint64 generation) {
+    QMutexLocker locker(&mutex);
+    const Frame &frame = frames[front];
+    if (frame.image.isNull()) {
+        return false;
+    }
+    const QRect covered = area & frame.area;
+    painter.drawImage(covered.topLeft(), frame.image, covered.translated(-frame.area.topLeft()));
+    return frame.generation == generation && frame.area.contains(area);
+}
+
+/**
+ * @brief Schleife des Render-Threads.
+ *
+ * Holt die neueste Anforderung, zeichnet sie ohne Sperre in den hinteren Puffer und macht ihn
+ * zum vorderen.
+ */
+void BoardRenderer::run() {
+    while (true) {
+        BoardPlane plane;
+        QRect area;
+        quint64 generation;
+        QVector<QImage> cellSprites;
+        int size;
+        int back;
+        {
+            QMutexLocker locker(&mutex);
+            while (!pending && !quitting) {
+                wake.wait(&mutex);
+            }
+            if (quitting) {
+                return;
+            }
+            plane = requestedPlane;
+            area = requestedArea;
+            generation = requestedGeneration;
+            cellSprites = sprites;
+            size = cellSize;
+            back = 1 - front;
+            pending = false;
+        }
+
+        render(frames[back], plane, area, cellSprites, size); ///< die Oberfläche liest nur frames[front]
+        frames[back].generation = generation;
+
+        {
+            QMutexLocker locker(&mutex);
+            front = back;
+        }
+        emit frameReady();
+    }
+}
+
+/**
+ * @brief Zeichnet einen Ausschnitt in ein Bild.
+ * @param frame Zielbild; wird bei gleicher Größe wiederverwendet.
+ * @param plane Stand der Anzeigeebene.
+ * @param area Ausschnitt in Pixeln.
+ * @param sprites Bild pro Anzeigecode.
+ * @param cellSize Kantenlänge einer Zelle in Pixeln.
+ *
+ * Gezeichnet werden nur die Zellen, die den Ausschnitt schneiden; die Codes einer Zeile
+ * werden blockweise am Stück aus der Ebene gelesen.
+ */
+void BoardRenderer::render(Frame &frame, const BoardPlane &plane, const QRect &area,
+                           const QVector<QImage> &sprites, int cellSize) {
+    TRACE_SPAN("render.board");
+    if (frame.image.size() != area.size()) {
+        frame.image = QImage(area.size(), QImage::Format_ARGB32_Premultiplied);
+    }
+    frame.area = area;
+    frame.image.fill(Qt::lightGray);
+    if (plane.isEmpty() || area.isEmpty() || sprites.size() < BoardPlane::CODE_COUNT) {
+        return;
+    }
+
+    const int firstRow = qMax(0, area.top() / cellSize);
+    const int lastRow = qMin(plane.getLength() - 1, area.bottom() / cellSize);
+    const int firstCol = qMax(0, area.left() / cellSize);
+    const int lastCol = qMin(plane.getWidth() - 1, area.right() / cellSize);
+    QPainter painter(&frame.image);
+    painter.translate(-area.topLeft());
+    for (int row = firstRow; row <= lastRow; row++) {
+        int col = firstCol;
+        while (col <= lastCol) {
+            int count;
+            const quint8 *codes = plane.rowSpan(row, col, count);
+            count = qMin(count, lastCol - col + 1);
+            for (int i = 0; i < count; i++) {
+                painter.drawImage(QPoint((col + i) * cellSize, row * cellSize), sprites.at(codes[i]));
+            }
+            col += count;
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef BOARDRENDERER_H
+#define BOARDRENDERER_H
+
+#include "boardplane.h"
+#include <QObject>
+#include <QImage>
+#include <QRect>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+
+class QPainter;
+class QThread;
+
+/**
+ * @file boardrenderer.h
+ * @class BoardRenderer
+ * @brief Zeichnet den sichtbaren Ausschnitt des Spielfelds in einem eigenen Thread.
+ *
+ * Die Oberfläche fordert mit request() ein Bild eines Ausschnitts für einen Stand der
+ * Anzeigeebene an. Der Render-Thread zeichnet es in den hinteren von zwei Puffern, tauscht die
+ * Puffer und sendet frameReady(). Die Oberfläche kopiert in paint() nur noch den vorderen Puffer
+ * auf den Bildschirm.
+ *
+ * Technische Entscheidung:
+ * Doppelpuffer: der Render-Thread schreibt nur in den hinteren, die Oberfläche liest nur den
+ * vorderen Puffer. Die Sperre schützt nur den Tausch und das Kopieren auf den Bildschirm, nie
+ * das Zeichnen der Zellen. Kommen Anforderungen schneller, als gezeichnet werden kann, gilt nur
+ * die neueste; Zwischenstände werden übersprungen. Der Renderer liest aus seiner eigenen Kopie
+ * der BoardPlane (Copy-on-Write), die Engine wartet also nie auf ihn.
+ *
+ * Abhängigkeit: Die Zellbilder kommen von BoardView, das sie aus den Icons erzeugt.
+ *
+ * @author Daniel Schukin
+ */
+class BoardRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor für BoardRenderer. Startet den Render-Thread.
+     * @param parent Übergeordnetes Objekt.
+     *
+     * @author Daniel Schukin
+     */
+    explicit BoardRenderer(QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor für BoardRenderer. Beendet den Render-Thread.
+     *
+     * @author Daniel Schukin
+     */
+    ~BoardRenderer();
+
+    /**
+     * @brief Setzt die Bilder der Zellen.
+     * @param sprites Ein Bild der Größe cellSize x cellSize pro Anzeigecode (BoardPlane::CODE_COUNT).
+     * @param cellSize Kantenlänge einer Zelle in Pixeln.
+     *
+     * @author Daniel Schukin
+     */
+    void setSprites(const QVector<QImage> &sprites, int cellSize);
+
+    /**
+     * @brief Fordert ein neues Bild an; wartet nie auf den Render-Thread.
+     * @param plane Stand der Anzeigeebene.
+     * @param area Ausschnitt in Pixeln des ganzen Spielfelds.
+     * @param generation Nummer des Stands; dieselbe Anforderung wird nur einmal gezeichnet.
+     *
+     * @author Daniel Schukin
+     */
+    void request(const BoardPlane &plane, const QRect &area, quint64 generation);
+
+    /**
+     * @brief Kopiert das zuletzt fertige Bild auf den Bildschirm.
+     * @param painter Painter des Widgets, das das ganze Spielfeld zeigt.
+     * @param area Zu zeichnender Bereich.
+     * @param generation Aktuelle Nummer des Stands.
+     * @return True, wenn das Bild diesen Stand zeigt und den Bereich ganz abdeckt.
+     *
+     * @author Daniel Schukin
+     */
+    bool paint(QPainter &painter, const QRect &area, quint64 generation);
+
+signals:
+    /**
+     * @brief Wird aus dem Render-Thread gesendet, wenn ein neues Bild bereitliegt.
+     *
+     * @author Daniel Schukin
+     */
+    void frameReady();
+
+private:
+    /// @brief Ein gezeichnetes Bild mit Ausschnitt und Stand.
+    struct Frame
+    {
+        QImage image;            ///< Pixel des Ausschnitts.
+        QRect area;              ///< Ausschnitt in Pixeln des ganzen Spielfelds.
+        quint64 generation = 0;  ///< Nummer des gezeichneten Stands.
+    };
+
+    /**
+     * @brief Schleife des Render-Threads.
+     *
+     * @author Daniel Schukin
+     */
+    void run();
+
+    /**
+     * @brief Zeichnet einen Ausschnitt in ein Bild.
+     * @param frame Zielbild.
+     * @param plane Stand der Anzeigeebene.
+     * @param area Ausschnitt in Pixeln.
+     * @param sprites Bild pro Anzeigecode.
+     * @param cellSize Kantenlänge einer Zelle in Pixeln.
+     *
+     * @author Daniel Schukin
+     */
+    static void render(Frame &frame, const BoardPlane &plane, const QRect &area,
+                       const QVector<QImage> &sprites, int cellSize);
+
+    QThread *thread; ///< Render-Thread.
+    QMutex mutex; ///< Schützt Anforderung, Zellbilder und den Tausch der Puffer.
+    QWaitCondition wake; ///< Weckt den Render-Thread bei einer neuen Anforderung.
+    Frame frames[2]; ///< Vorderer und hinterer Puffer.
+    int front = 0; ///< Index des vorderen Puffers.
+    BoardPlane requestedPlane; ///< Stand der neuesten Anforderung.
+    QRect requestedArea; ///< Ausschnitt der neuesten Anforderung.
+    quint64 requestedGeneration = 0; ///< Nummer der neuesten Anforderung.
+    bool pending = false; ///< True, solange die neueste Anforderung nicht abgeholt wurde.
+    bool quitting = false; ///< True, sobald der Render-Thread enden soll.
+    QVector<QImage> sprites; ///< Bild pro Anzeigecode.
+    int cellSize = 25; ///< Kantenlänge einer Zelle in Pixeln.
+};
+
+#endif // BOARDRENDERER_H
@@ -0,0 +1,254 @@
+#include "boardview.h"
+#include "tracing.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QMoveEvent>
+#include <QElapsedTimer>
+
+/**
+ * @brief Konstruktor für BoardView.
+ * @param cellSize Kantenlänge einer Zelle in Pixeln.
+ * @param parent Übergeordnetes Widget.
+ */
+BoardView::BoardView(int cellSize, QWidget *parent)
+    : QWidget(parent)
+    , cellSize(cellSize)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent); ///< paintEvent() übermalt den ganzen Bereich selbst
+    loadSprites();
+    connect(&renderer, &BoardRenderer::frameReady, this, [this]() { update(); });
+    revealTimer.setInterval(REVEAL_INTERVAL);
+    connect(&revealTimer, &QTimer::timeout, this, &BoardView::revealStep);
+}
+
+/**
+ * @brief Zeigt einen neuen Stand des Spielfelds an.
+ * @param plane Anzeigeebene.
+ */
+void BoardView::setPlane(const BoardPlane &plane) {
+    revealTimer.stop(); ///< ein neues Spielfeld ersetzt auch ein laufendes Aufdecken
+    revealQueue.clear();
+    revealNext = 0;
+    moveInQueue = -1;
+    revealTarget = BoardPlane();
+    if (plane.getLength() != this->plane.getLength() || plane.getWidth() != this->plane.getWidth()) {
+        setFixedSize(plane.getWidth() * cellSize, plane.getLength() * cellSize);
+    }
+    this->plane = plane;
+    generation++;
+    requestRender();
+}
+
+/**
+ * @brief Zeigt den Stand nach einem Zug an, bei schrittweisem Aufdecken über mehrere Bilder.
+ * @param plane Anzeigeebene nach dem Zug.
+ * @param cells Geänderte Zellen in der Reihenfolge, in der sie erscheinen sollen.
+ *
+ * Kommt ein Zug, während noch aufgedeckt wird, wird er hinten angehängt; die Reihenfolge der
+ * Züge bleibt so auch in der Anzeige erhalten. Wartet schon ein früherer Zug auf sein Bild,
+ * bleibt dessen Stand für movePainted() maßgeblich; spätere Stände enthalten ihn ohnehin.
+ */
+void BoardView::showMove(const BoardPlane &plane, const QVector<CellUpdate> &cells) {
+    clearHighlight(); ///< ein Tipp gilt nur für den Stand, zu dem er berechnet wurde
+    const bool waiting = moveGeneration != 0 || moveInQueue >= 0;
+    if (!animatedReveal && !revealTimer.isActive()) {
+        setPlane(plane);
+        if (!waiting) {
+            moveGeneration = generation;
+        }
+        return;
+    }
+    if (!waiting) {
+        moveInQueue = revealQueue.size();
+    }
+    revealQueue.append(cells); ///< nur eine Referenz, die Zellen selbst werden nicht kopiert
+    revealTarget = plane;
+    if (!revealTimer.isActive()) {
+        revealTimer.start();
+    }
+    revealStep(); ///< der erste Schritt gleich, kleine Züge sind damit sofort fertig
+}
+
+/**
+ * @brief Schaltet das schrittweise Aufdecken ein oder aus.
+ * @param enabled True für schrittweises Aufdecken.
+ */
+void BoardView::setAnimatedReveal(bool enabled) {
+    animatedReveal = enabled;
+    if (!enabled) {
+        finishReveal();
+    }
+}
+
+/**
+ * @brief Hebt eine Zelle hervor.
+ * @param row Zeilenindex der Zelle.
+ * @param col Spaltenindex der Zelle.
+ * @param safe True für eine sichere Zelle.
+ *
+ * Der Rahmen wird in paintEvent() über das Bild des Renderers gelegt; das Bild selbst muss
+ * dafür nicht neu gezeichnet werden.
+ */
+void BoardView::setHighlight(int row, int col, bool safe) {
+    clearHighlight();
+    highlight = QPoint(row, col);
+    highlightSafe = safe;
+    update(col * cellSize, row * cellSize, cellSize, cellSize);
+}
+
+/**
+ * @brief Hebt die Hervorhebung auf.
+ */
+void BoardView::clearHighlight() {
+    if (highlight.x() < 0) {
+        return;
+    }
+    update(highlight.y() * cellSize, highlight.x() * cellSize, cellSize, cellSize);
+    highlight = QPoint(-1, -1);
+}
+
+/**
+ * @brief Übernimmt Zellen aus der Warteschlange, bis das Zeitbudget des Bilds aufgebraucht ist.
+ *
+ * Die Uhr wird nur alle REVEAL_BATCH Zellen gelesen. Ist die Warteschlange leer, wird der
+ * Endstand der Engine übernommen, der dann wieder alle Blöcke mit ihr teilt. Der erste Schritt
+ * mit Zellen des wartenden Zugs legt dessen Stand für movePainted() fest.
+ */
+void BoardView::revealStep() {
+    TRACE_SPAN("ui.revealStep");
+    constexpr int REVEAL_BATCH = 256;
+    QElapsedTimer budget;
+    budget.start();
+    bool moveShown = false;
+    while (!revealQueue.isEmpty() && budget.elapsed() < REVEAL_BUDGET) {
+        moveShown = moveShown || moveInQueue == 0;
+        const QVector<CellUpdate> &cells = revealQueue.first();
+        const int end = qMin(revealNext + REVEAL_BATCH, cells.size());
+        for (; revealNext < end; revealNext++) {
+            const CellUpdate &cell = cells.at(revealNext);
+            plane.set(cell.row, cell.col, BoardPlane::cellCode(cell.status, cell.minesAround));
+        }
+        if (revealNext == cells.size()) {
+            revealQueue.removeFirst();
+            revealNext = 0;
+            moveInQueue = qMax(-1, moveInQueue - 1);
+        }
+    }
+    if (revealQueue.isEmpty()) {
+        finishReveal();
+        if (moveShown) {
+            moveGeneration = generation;
+        }
+        return;
+    }
+    generation++;
+    if (moveShown) {
+        moveInQueue = -1;
+        moveGeneration = generation;
+    }
+    requestRender();
+}
+
+/**
+ * @brief Bricht das schrittweise Aufdecken ab und zeigt den Endstand.
+ */
+void BoardView::finishReveal() {
+    if (!revealTimer.isActive()) {
+        return;
+    }
+    const bool waiting = moveInQueue >= 0;
+    const BoardPlane target = revealTarget;
+    setPlane(target);
+    if (waiting) {
+        moveGeneration = generation; ///< der Endstand enthält alle Züge
+    }
+}
+
+/**
+ * @brief Kopiert das fertige Bild und fordert ein neues an, falls es nicht passt.
+ * @param event Zeichenereignis.
+ *
+ * Bis das neue Bild fertig ist, bleibt das alte stehen; freigelegte Teile sind grau. Erst ein
+ * Bild des aktuellen Stands meldet einen wartenden Zug mit movePainted().
+ */
+void BoardView::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+    painter.fillRect(event->rect(), Qt::lightGray);
+    if (!renderer.paint(painter, event->rect(), generation)) {
+        requestRender();
+    } else if (moveGeneration != 0 && generation >= moveGeneration) {
+        moveGeneration = 0;
+        emit movePainted();
+    }
+    if (highlight.x() >= 0) {
+        painter.setPen(QPen(highlightSafe ? Qt::green : QColor(255, 140, 0), 3));
+        painter.drawRect(highlight.y() * cellSize + 1, highlight.x() * cellSize + 1, cellSize - 3, cellSize - 3);
+    }
+}
+
+/**
+ * @brief Rechnet einen Mausklick in eine Zelle um und meldet ihn.
+ * @param event Mausereignis.
+ */
+void BoardView::mousePressEvent(QMouseEvent *event) {
+    const int row = event->pos().y() / cellSize;
+    const int col = event->pos().x() / cellSize;
+    if (row < 0 || col < 0 || row >= plane.getLength() || col >= plane.getWidth()
+        || !((Qt::LeftButton | Qt::MiddleButton | Qt::RightButton) & event->button())) {
+        return; ///< kein Klick auf eine Zelle, also auch keine Latenz
+    }
+    emit inputReceived(); ///< vor dem Klick-Signal, damit die Latenzmessung die ganze Verarbeitung umfasst
+    if (event->button() == Qt::LeftButton) {
+        emit leftClicked(row, col);
+    } else if (event->button() == Qt::MiddleButton) {
+        emit middleClicked(row, col);
+    } else if (event->button() == Qt::RightButton) {
+        emit rightClicked(row, col);
+    }
+}
+
+/**
+ * @brief Fordert beim Scrollen den neuen Ausschnitt an.
+ * @param event Verschiebeereignis.
+ */
+void BoardView::moveEvent(QMoveEvent *event) {
+    QWidget::moveEvent(event);
+    requestRender();
+}
+
+/**
+ * @brief Fordert beim Renderer den sichtbaren Ausschnitt für den aktuellen Stand an.
+ *
+ * Der Ausschnitt wird auf ganze Zellen und RENDER_MARGIN Zellen Rand erweitert, damit kleine
+ * Scrollbewegungen kein neues Bild brauchen.
+ */
+void BoardView::requestRender() {
+    const QRect visible = visibleRegion().boundingRect();
+    if (visible.isEmpty()) {
+        return;
+    }
+    const int margin = RENDER_MARGIN * cellSize;
+    QRect area(visible.left() / cellSize * cellSize - margin, visible.top() / cellSize * cellSize - margin,
+               visible.width() + 2 * margin + cellSize, visible.height() + 2 * margin + cellSize);
+    renderer.request(plane, area & rect(), generation);
+}
+
+/**
+ * @brief Erzeugt die Zellbilder aus den Icons.
+ *
+ * Die Icons werden einmal im GUI-Thread auf die Zellgröße skaliert; der Renderer kopiert dann
+ * nur noch fertige Pixel. Codes ohne eigenes Icon zeigen eine verdeckte Zelle.
+ */
+void BoardView::loadSprites() {
+    QVector<QImage> sprites(BoardPlane::CODE_COUNT);
+    for (int code = 0; code < BoardPlane::CODE_COUNT; code++) {
+        const QString path = code >= BoardPlane::OPEN_CODE
+                                 ? iconpathByNumber.value(code - BoardPlane::OPEN_CODE)
+                                 : iconpathByStatus.value(code, iconpathByStatus.value(0));
+        sprites[code] = QImage(path)
+                            .scaled(cellSize, cellSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                            .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    renderer.setSprites(sprites, cellSize);
+}
@@ -0,0 +1,226 @@
+#ifndef BOARDVIEW_H
+#define BOARDVIEW_H
+
+#include "boardplane.h"
+#include "boardrenderer.h"
+#include "gameengine.h"
+#include <QWidget>
+#include <QTimer>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+/**
+ * @file boardview.h
+ * @class BoardView
+ * @brief Zeigt das Spielfeld als ein Widget und meldet Klicks auf Zellen.
+ *
+ * Das Widget ist so groß wie das ganze Spielfeld und liegt in einer QScrollArea. Gezeichnet
+ * wird nur der sichtbare Ausschnitt (mit etwas Rand), und zwar vom BoardRenderer in dessen
+ * Thread; paintEvent() kopiert nur das fertige Bild.
+ *
+ * Technische Entscheidung:
+ * Früher war jede Zelle ein eigener QPushButton. Bei großen Spielfeldern kosteten schon das
+ * Anlegen der Widgets und das Layout Sekunden, und jedes Neuzeichnen lief im GUI-Thread. Ein
+ * einziges Widget mit einem im Hintergrund gezeichneten Bild hängt dagegen nur von der Größe
+ * des sichtbaren Ausschnitts ab.
+ *
+ * Schrittweises Aufdecken (optional): Die Engine ist nach einem Zug sofort fertig, nur die
+ * Anzeige holt in Schritten auf. Pro Bild werden höchstens REVEAL_BUDGET ms lang Zellen aus
+ * der Warteschlange übernommen, in der Reihenfolge der Engine (Breitensuche ab dem Klick). Die
+ * Ereignisschleife bleibt dazwischen frei, Klicks gehen also sofort an die Engine.
+ *
+ * Latenz: movePainted() kommt aus paintEvent(), sobald der Renderer ein Bild liefert, dessen
+ * Stand den zuletzt gezeigten Zug enthält. Beim schrittweisen Aufdecken genügt dafür der erste
+ * Schritt mit Zellen des Zugs; das weitere Aufdecken ist gewollte Animation, keine Wartezeit.
+ *
+ * Abhängigkeit: Die Zellen kommen als BoardPlane aus den Ereignissen der GameEngine.
+ *
+ * @author Daniel Schukin
+ */
+class BoardView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int RENDER_MARGIN = 8; ///< Zellen, die rund um den sichtbaren Ausschnitt mitgezeichnet werden.
+    static constexpr int REVEAL_BUDGET = 4; ///< Zeit in ms, die das Aufdecken pro Bild höchstens verwendet.
+    static constexpr int REVEAL_INTERVAL = 16; ///< Abstand der Aufdeckschritte in ms (ein Bild bei 60 Hz).
+
+    /**
+     * @brief Konstruktor für BoardView.
+     * @param cellSize Kantenlänge einer Zelle in Pixeln.
+     * @param parent Übergeordnetes Widget.
+     *
+     * @author Daniel Schukin
+     */
+    explicit BoardView(int cellSize, QWidget *parent = nullptr);
+
+    /**
+     * @brief Zeigt einen neuen Stand des Spielfelds an.
+     * @param plane Anzeigeebene; passt bei geänderter Größe auch die Größe des Widgets an.
+     *
+     * @author Daniel Schukin
+     */
+    void setPlane(const BoardPlane &plane);
+
+    /**
+     * @brief Zeigt den Stand nach einem Zug an, bei schrittweisem Aufdecken über mehrere Bilder.
+     * @param plane Anzeigeebene nach dem Zug.
+     * @param cells Geänderte Zellen in der Reihenfolge, in der sie erscheinen sollen.
+     *
+     * @author Daniel Schukin
+     */
+    void showMove(const BoardPlane &plane, const QVector<CellUpdate> &cells);
+
+    /**
+     * @brief Schaltet das schrittweise Aufdecken ein oder aus.
+     * @param enabled True für schrittweises Aufdecken; beim Ausschalten wird sofort der Endstand gezeigt.
+     *
+     * @author Daniel Schukin
+     */
+    void setAnimatedReveal(bool enabled);
+
+    /**
+     * @brief Hebt eine Zelle hervor, z.B. für einen Tipp; der nächste Zug hebt die Hervorhebung auf.
+     * @param row Zeilenindex der Zelle.
+     * @param col Spaltenindex der Zelle.
+     * @param safe True für eine sichere Zelle (grün), sonst die Zelle mit dem kleinsten Risiko (orange).
+     *
+     * @author Daniel Schukin
+     */
+    void setHighlight(int row, int col, bool safe);
+
+    /**
+     * @brief Hebt die Hervorhebung auf.
+     *
+     * @author Daniel Schukin
+     */
+    void clearHighlight();
+
+    /**
+     * @brief Gibt den angezeigten Stand zurück.
+     * @return Anzeigeebene.
+     *
+     * @author Daniel Schukin
+     */
+    const BoardPlane &getPlane() const { return plane; }
+
+signals:
+    /**
+     * @brief Wird bei jedem Mausklick auf eine Zelle vor dem Klick-Signal gesendet, für die Latenzmessung.
+     *
+     * @author Daniel Schukin
+     */
+    void inputReceived();
+
+    /**
+     * @brief Wird gesendet, sobald ein Bild mit dem zuletzt gezeigten Zug gezeichnet ist, für die Latenzmessung.
+     *
+     * @author Daniel Schukin
+     */
+    void movePainted();
+
+    /// @name Klicks auf Zellen
+    /// @author Daniel Schukin
+    /// @{
+    void leftClicked(int row, int col); ///< Linksklick auf eine Zelle.
+    void middleClicked(int row, int col); ///< Mittelklick auf eine Zelle.
+    void rightClicked(int row, int col); ///< Rechtsklick auf eine Zelle.
+    /// @}
+
+protected:
+    /**
+     * @brief Kopiert das fertige Bild und fordert ein neues an, falls es nicht passt.
+     * @param event Zeichenereignis.
+     *
+     * @author Daniel Schukin
+     */
+    void paintEvent(QPaintEvent *event) override;
+
+    /**
+     * @brief Rechnet einen Mausklick in eine Zelle um und meldet ihn.
+     * @param event Mausereignis.
+     *
+     * @author Daniel Schukin
+     */
+    void mousePressEvent(QMouseEvent *event) override;
+
+    /**
+     * @brief Fordert beim Scrollen den neuen Ausschnitt an.
+     * @param event Verschiebeereignis.
+     *
+     * @author Daniel Schukin
+     */
+    void moveEvent(QMoveEvent *event) override;
+
+private:
+    /**
+     * @brief Fordert beim Renderer den sichtbaren Ausschnitt für den aktuellen Stand an.
+     *
+     * @author Daniel Schukin
+     */
+    void requestRender();
+
+    /**
+     * @brief Übernimmt Zellen aus der Warteschlange, bis das Zeitbudget des Bilds aufgebraucht ist.
+     *
+     * @author Daniel Schukin
+     */
+    void revealStep();
+
+    /**
+     * @brief Bricht das schrittweise Aufdecken ab und zeigt den Endstand.
+     *
+     * @author Daniel Schukin
+     */
+    void finishReveal();
+
+    /**
+     * @brief Erzeugt die Zellbilder aus den Icons.
+     *
+     * @author Daniel Schukin
+     */
+    void loadSprites();
+
+    BoardRenderer renderer; ///< Zeichnet im eigenen Thread.
+    BoardPlane plane; ///< Angezeigter Stand.
+    quint64 generation = 1; ///< Nummer des angezeigten Stands, bei jedem setPlane() erhöht.
+    quint64 moveGeneration = 0; ///< Erster Stand, der den noch nicht gezeichneten Zug enthält; 0 für keinen.
+    int moveInQueue = -1; ///< Index des noch nicht angezeigten Zugs in revealQueue, -1 für keinen.
+    int cellSize; ///< Kantenlänge einer Zelle in Pixeln.
+    QPoint highlight{-1, -1}; ///< Hervorgehobene Zelle (Zeile, Spalte), (-1, -1) für keine.
+    bool highlightSafe = false; ///< True, wenn die hervorgehobene Zelle sicher ist.
+    bool animatedReveal = false; ///< True, wenn Züge schrittweise aufgedeckt werden.
+    QTimer revealTimer; ///< Taktet die Aufdeckschritte.
+    QList<QVector<CellUpdate>> revealQueue; ///< Geänderte Zellen der noch nicht ganz angezeigten Züge.
+    int revealNext = 0; ///< Index der nächsten anzuzeigenden Zelle im ersten Zug der Warteschlange.
+    BoardPlane revealTarget; ///< Endstand nach dem letzten Zug.
+
+    /// @brief Zuordnung von Spielstatus zu Icon-Pfaden.
+    QMap<int, QString> iconpathByStatus{
+        {0, ":/resources/icons/covered_cell.png"},
+        {4, ":/resources/icons/covered_cell.png"},
+        {2, ":/resources/icons/flag.png"},
+        {6, ":/resources/icons/flag.png"},
+        {3, ":/resources/icons/wrong_mark.png"},
+        {5, ":/resources/icons/mine.png"},
+        {7, ":/resources/icons/right_mark.png"},
+        {13, ":/resources/icons/exploded_mine.png"}
+    };
+
+    /// @brief Zuordnung von Zahlen zu Icon-Pfaden.
+    QMap<int, QString> iconpathByNumber{
+        {0, ":/resources/icons/opened_cell.png"},
+        {1, ":/resources/icons/number_1.png"},
+        {2, ":/resources/icons/number_2.png"},
+        {3, ":/resources/icons/number_3.png"},
+        {4, ":/resources/icons/number_4.png"},
+        {5, ":/resources/icons/number_5.png"},
+        {6, ":/resources/icons/number_6.png"},
+        {7, ":/resources/icons/number_7.png"},
+        {8, ":/resources/icons/number_8.png"}
+    };
+};
+
+#endif // BOARDVIEW_H
@@ -0,0 +1,125 @@
+#ifndef BOTPROTOCOL_H
+#define BOTPROTOCOL_H
+
+#include "replayformat.h"
+#include <QByteArray>
+#include <QtEndian>
+#include <QtGlobal>
+
+/**
+ * @file botprotocol.h
+ * @brief Gemeinsame Definitionen des Protokolls für externe Spieler (Bots).
+ *
+ * Ein Bot spricht über einen lokalen Socket (QLocalSocket, siehe BotServer) oder über
+ * stdin/stdout mit einem Game ohne Oberfläche. Beide Richtungen bestehen aus Nachrichten:
+ * | Versatz | Größe | Inhalt                                                  |
+ * |---------|-------|---------------------------------------------------------|
+ * | 0       | 4     | Länge n des Rests der Nachricht (Little-Endian)         |
+ * | 4       | 1     | Art der Anfrage (Request), die Antwort wiederholt sie   |
+ * | 5       | n - 1 | Inhalt, alle Zahlen als Varint (siehe ReplayFormat)     |
+ *
+ * Anfragen:
+ * - NEW_GAME: Zeilen, Spalten, Minen, Seed, Flags (FLAG_SAFE_OPENING).
+ *   Antwort: Status (STATUS_OK oder STATUS_INVALID), Zeilen, Spalten, Minen.
+ * - ACTIONS: Anzahl, dann pro Aktion ein Varint (Zellindex << ACTION_BITS | Action) mit den
+ *   Aktionen OPEN, UNMARK, MARK, UNDO, REDO und RESIGN aus ReplayFormat.
+ *   Antwort pro Aktion: Zustand (STATE_*), Anzahl geänderter Zellen, dann pro Zelle ein
+ *   Varint (Zickzack-Differenz zum vorherigen Zellindex, beginnend bei 0) und ein Byte mit
+ *   dem Anzeigecode (siehe BoardPlane::cellCode()).
+ * - BOARD: ohne Inhalt. Antwort: Zustand, Zeilen, Spalten, dann alle Anzeigecodes als Bytes.
+ *
+ * Bei einer fehlerhaften Anfrage antwortet der Server mit REJECTED (ohne Inhalt) und trennt die
+ * Verbindung.
+ *
+ * Technische Entscheidung:
+ * Ein Bot darf beliebig viele Anfragen senden, ohne auf die Antworten zu warten (Pipelining);
+ * der Server beantwortet sie der Reihe nach und schreibt alle Antworten eines gelesenen
+ * Blocks auf einmal. Zusammen mit mehreren Aktionen pro Anfrage kostet ein Zug damit keinen
+ * eigenen Round-Trip und keinen eigenen Systemaufruf. Antworten enthalten nur die geänderten
+ * Zellen; die Zellindizes einer Öffnung liegen zeilenweise dicht beieinander, sodass die
+ * Differenzen meist in ein Byte passen (ein Zug kostet dann 2 Bytes pro Zelle).
+ *
+ * @author Daniel Schukin
+ */
+namespace BotProtocol {
+
+constexpr int LENGTH_SIZE = 4; ///< Größe der Längenangabe einer Nachricht in Bytes.
+constexpr int MAX_MESSAGE = 64 << 20; ///< Größte erlaubte Nachricht in Bytes.
+constexpr char DEFAULT_SERVER[] = "u3-bot"; ///< Standardname des lokalen Sockets.
+constexpr qint64 MAX_CELLS = 1 << 24; ///< Größtes Spielfeld, das NEW_GAME erzeugt.
+
+/// @brief Art einer Anfrage.
+enum Request : quint8 {
+    NEW_GAME = 1, ///< Neues Spielfeld erzeugen.
+    ACTIONS = 2,  ///< Aktionen der Reihe nach ausführen.
+    BOARD = 3,    ///< Alle Anzeigecodes abfragen, z.B. nach einem Verbindungsabbruch des Bots.
+    REJECTED = 0xff ///< Antwort auf eine fehlerhafte Anfrage.
+};
+
+constexpr quint8 FLAG_SAFE_OPENING = 0x01; ///< NEW_GAME: erster Klick mit freier 3x3-Umgebung.
+
+constexpr quint8 STATUS_OK = 0;      ///< NEW_GAME: Spielfeld erzeugt.
+constexpr quint8 STATUS_INVALID = 1; ///< NEW_GAME: ungültige Maße; das alte Spielfeld bleibt.
+
+constexpr quint8 STATE_IN_GAME = 0x01; ///< Zustand: das Spiel läuft noch.
+constexpr quint8 STATE_WON = 0x02;     ///< Zustand: das Spiel wurde gewonnen.
+
+/**
+ * @brief Kodiert eine vorzeichenbehaftete Differenz als vorzeichenlose Zahl (0, -1, 1, -2, ...).
+ * @param value Differenz.
+ * @return Zickzack-kodierter Wert.
+ *
+ * @author Daniel Schukin
+ */
+constexpr quint64 zigzag(qint64 value) { return (quint64(value) << 1) ^ quint64(value >> 63); }
+
+/**
+ * @brief Dekodiert einen mit zigzag() kodierten Wert.
+ * @param value Zickzack-kodierter Wert.
+ * @return Differenz.
+ *
+ * @author Daniel Schukin
+ */
+constexpr qint64 unzigzag(quint64 value) { return qint64(value >> 1) ^ -qint64(value & 1); }
+
+/**
+ * @brief Beginnt eine Nachricht; die Länge trägt finishMessage() ein.
+ * @param out Ausgabepuffer.
+ * @param type Art der Anfrage.
+ * @return Position der Nachricht im Puffer.
+ *
+ * @author Daniel Schukin
+ */
+inline int beginMessage(QByteArray &out, Request type) {
+    const int start = out.size();
+    out.append(LENGTH_SIZE, '\0');
+    out.append(char(type));
+    return start;
+}
+
+/**
+ * @brief Trägt die Länge einer mit beginMessage() begonnenen Nachricht ein.
+ * @param out Ausgabepuffer.
+ * @param start Position der Nachricht im Puffer.
+ *
+ * @author Daniel Schukin
+ */
+inline void finishMessage(QByteArray &out, int start) {
+    qToLittleEndian<quint32>(quint32(out.size() - start - LENGTH_SIZE), out.data() + start);
+}
+
+/**
+ * @brief Hängt einen Varint an den Ausgabepuffer an.
+ * @param out Ausgabepuffer.
+ * @param value Wert.
+ *
+ * @author Daniel Schukin
+ */
+inline void appendVarint(QByteArray &out, quint64 value) {
+    uchar buffer[10];
+    out.append(reinterpret_cast<const char *>(buffer), ReplayFormat::putVarint(buffer, value));
+}
+
+}
+
+#endif // BOTPROTOCOL_H
@@ -0,0 +1,109 @@
+#include "botserver.h"
+#include "botsession.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QtEndian>
+#include <cstdio>
+#include <cstring>
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+/**
+ * @brief Konstruktor für BotServer.
+ * @param parent Übergeordnetes Objekt.
+ */
+BotServer::BotServer(QObject *parent)
+    : QObject(parent)
+    , server(new QLocalServer(this))
+{
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server, &QLocalServer::newConnection, this, &BotServer::acceptConnections);
+}
+
+/**
+ * @brief Beginnt, auf Verbindungen zu warten.
+ * @param name Name des lokalen Sockets.
+ * @return False, wenn der Socket nicht angelegt werden konnte.
+ *
+ * Nach einem Absturz bleibt unter Unix die Socket-Datei liegen; removeServer() entfernt sie,
+ * sonst scheitert listen() mit AddressInUseError.
+ */
+bool BotServer::listen(const QString &name) {
+    QLocalServer::removeServer(name);
+    return server->listen(name);
+}
+
+/**
+ * @brief Gibt die Fehlermeldung des letzten listen() zurück.
+ * @return Fehlermeldung des Sockets.
+ */
+QString BotServer::errorString() const {
+    return server->errorString();
+}
+
+/**
+ * @brief Nimmt alle wartenden Verbindungen an.
+ *
+ * Die Sitzung gehört zur Verbindung und wird mit ihr gelöscht. Der Ausgabepuffer wird von
+ * Block zu Block wiederverwendet.
+ */
+void BotServer::acceptConnections() {
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+        auto *session = new BotSession;
+        connect(socket, &QLocalSocket::readyRead, socket, [socket, session, out = QByteArray()]() mutable {
+            const QByteArray data = socket->readAll();
+            out.clear();
+            const bool valid = session->feed(data.constData(), data.size(), out);
+            socket->write(out);
+            if (!valid) {
+                socket->disconnectFromServer(); ///< schreibt REJECTED noch zu Ende
+            }
+        });
+        connect(socket, &QLocalSocket::disconnected, socket, [socket, session]() {
+            delete session;
+            socket->deleteLater();
+        });
+    }
+}
+
+/**
+ * @brief Beantwortet Anfragen von stdin auf stdout, bis stdin endet.
+ * @return 0 am Ende der Eingabe; 1 nach einer fehlerhaften Anfrage.
+ *
+ * Liest jede Nachricht mit genau ihrer Länge, damit fread() nie auf Bytes wartet, die der Bot
+ * erst nach der Antwort schickt. Die Antwort wird sofort geschrieben; Bots sparen Round-Trips
+ * hier über mehrere Aktionen pro Anfrage.
+ */
+int BotServer::serveStdio() {
+#ifdef Q_OS_WIN
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    BotSession session;
+    QByteArray message;
+    QByteArray out;
+    for (;;) {
+        uchar header[BotProtocol::LENGTH_SIZE];
+        if (std::fread(header, 1, sizeof(header), stdin) != sizeof(header)) {
+            return 0;
+        }
+        const quint32 length = qFromLittleEndian<quint32>(header);
+        message.resize(int(sizeof(header)));
+        std::memcpy(message.data(), header, sizeof(header));
+        if (length <= quint32(BotProtocol::MAX_MESSAGE)) {
+            message.resize(int(sizeof(header) + length));
+            if (std::fread(message.data() + sizeof(header), 1, length, stdin) != length) {
+                return 1; ///< Eingabe endet mitten in der Nachricht
+            }
+        } ///< sonst lehnt feed() die Längenangabe ab
+        out.clear();
+        const bool valid = session.feed(message.constData(), message.size(), out);
+        std::fwrite(out.constData(), 1, size_t(out.size()), stdout);
+        std::fflush(stdout);
+        if (!valid) {
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef BOTSERVER_H
+#define BOTSERVER_H
+
+#include <QObject>
+#include <QString>
+
+class QLocalServer;
+
+/**
+ * @file botserver.h
+ * @class BotServer
+ * @brief Nimmt Verbindungen von Bots an und verbindet jede mit einer eigenen BotSession.
+ *
+ * Der Server läuft ohne Fenster (Aufruf `U3 --serve [Name]`); jede Verbindung spielt auf
+ * ihrem eigenen Game. Für Bots, die das Spiel als Kindprozess starten, gibt es
+ * `U3 --stdio`: dasselbe Protokoll über stdin/stdout, ohne Ereignisschleife.
+ *
+ * Technische Entscheidung:
+ * Lokale Sockets (Unix Domain Socket bzw. Named Pipe) statt TCP: kein Netzwerkstapel, keine
+ * Freigabe nach außen, und der Socket ist nur für den eigenen Benutzer erreichbar. Pro
+ * gelesenem Block werden alle darin vollständigen Anfragen ausgeführt und die Antworten mit
+ * einem einzigen write() geschrieben, sodass ein Bot mit Pipelining viele Züge pro
+ * Systemaufruf bekommt.
+ *
+ * Abhängigkeit: BotSession; Protokoll siehe botprotocol.h.
+ *
+ * @author Daniel Schukin
+ */
+class BotServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor für BotServer.
+     * @param parent Übergeordnetes Objekt.
+     *
+     * @author Daniel Schukin
+     */
+    explicit BotServer(QObject *parent = nullptr);
+
+    /**
+     * @brief Beginnt, auf Verbindungen zu warten.
+     * @param name Name des lokalen Sockets; ein verwaister Socket gleichen Namens wird entfernt.
+     * @return False, wenn der Socket nicht angelegt werden konnte.
+     *
+     * @author Daniel Schukin
+     */
+    bool listen(const QString &name);
+
+    /**
+     * @brief Gibt die Fehlermeldung des letzten listen() zurück.
+     * @return Fehlermeldung des Sockets.
+     *
+     * @author Daniel Schukin
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Beantwortet Anfragen von stdin auf stdout, bis stdin endet.
+     * @return 0 am Ende der Eingabe; 1 nach einer fehlerhaften Anfrage.
+     *
+     * @author Daniel Schukin
+     */
+    static int serveStdio();
+
+private:
+    /**
+     * @brief Nimmt alle wartenden Verbindungen an.
+     *
+     * @author Daniel Schukin
+     */
+    void acceptConnections();
+
+    QLocalServer *server; ///< Lokaler Socket, auf dem der Server wartet.
+};
+
+#endif // BOTSERVER_H
@@ -0,0 +1,214 @@
+#include "botsession.h"
+#include "replayplayer.h"
+#include "tracing.h"
+
+/**
+ * @brief Konstruktor für BotSession.
+ */
+BotSession::BotSession() {
+    game.setStatisticsEnabled(false);
+}
+
+/**
+ * @brief Verarbeitet gelesene Bytes und kodiert die Antworten.
+ * @param data Gelesene Bytes.
+ * @param size Anzahl der Bytes.
+ * @param out Puffer, an den die Antworten angehängt werden.
+ * @return False nach einer fehlerhaften Anfrage.
+ *
+ * Eine unvollständige letzte Nachricht bleibt im Eingabepuffer, bis der Rest gelesen ist.
+ */
+bool BotSession::feed(const char *data, int size, QByteArray &out) {
+    TRACE_SPAN("bot.feed");
+    input.append(data, size);
+    const uchar *begin = reinterpret_cast<const uchar *>(input.constData());
+    const uchar *pos = begin;
+    const uchar *end = begin + input.size();
+    while (end - pos >= BotProtocol::LENGTH_SIZE) {
+        const quint32 length = qFromLittleEndian<quint32>(pos);
+        if (length < 1 || length > quint32(BotProtocol::MAX_MESSAGE)) {
+            pos = nullptr;
+            break;
+        }
+        if (quint32(end - pos - BotProtocol::LENGTH_SIZE) < length) {
+            break; ///< Rest der Nachricht noch nicht gelesen
+        }
+        const uchar *message = pos + BotProtocol::LENGTH_SIZE;
+        const int written = out.size();
+        if (!handle(message, message + length, out)) {
+            out.resize(written); ///< keine halbe Antwort vor REJECTED
+            pos = nullptr;
+            break;
+        }
+        pos = message + length;
+    }
+    if (pos == nullptr) {
+        input.clear();
+        BotProtocol::finishMessage(out, BotProtocol::beginMessage(out, BotProtocol::REJECTED));
+        return false;
+    }
+    input.remove(0, int(pos - begin));
+    return true;
+}
+
+/**
+ * @brief Führt eine vollständige Nachricht aus.
+ * @param pos Anfang des Inhalts.
+ * @param end Ende der Nachricht.
+ * @param out Puffer für die Antwort.
+ * @return False bei einer fehlerhaften Anfrage.
+ */
+bool BotSession::handle(const uchar *pos, const uchar *end, QByteArray &out) {
+    switch (*pos++) {
+    case BotProtocol::NEW_GAME:
+        return newGame(pos, end, out);
+    case BotProtocol::ACTIONS:
+        return started && runActions(pos, end, out);
+    case BotProtocol::BOARD:
+        if (!started || pos != end) {
+            return false;
+        }
+        writeBoard(out);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Erzeugt ein neues Spielfeld (NEW_GAME).
+ * @param pos Leseposition im Inhalt.
+ * @param end Ende der Nachricht.
+ * @param out Puffer für die Antwort.
+ * @return False bei einer fehlerhaften Anfrage.
+ *
+ * Ungültige Maße sind keine fehlerhafte Anfrage: die Antwort meldet STATUS_INVALID und das
+ * alte Spielfeld bleibt bestehen. Das Spielfeld entsteht wie bei ReplayPlayer::setupGame().
+ */
+bool BotSession::newGame(const uchar *pos, const uchar *end, QByteArray &out) {
+    quint64 length, width, minesNumber, seed, flags;
+    if (!ReplayFormat::getVarint(pos, end, length) || !ReplayFormat::getVarint(pos, end, width)
+        || !ReplayFormat::getVarint(pos, end, minesNumber) || !ReplayFormat::getVarint(pos, end, seed)
+        || !ReplayFormat::getVarint(pos, end, flags) || pos != end) {
+        return false;
+    }
+    const bool valid = length >= 1 && width >= 1 && length <= quint64(BotProtocol::MAX_CELLS)
+                       && width <= quint64(BotProtocol::MAX_CELLS)
+                       && length * width <= quint64(BotProtocol::MAX_CELLS) && minesNumber >= 1
+                       && minesNumber < length * width;
+    if (valid) {
+        game.changeLength(int(length));
+        game.changeWidth(int(width));
+        game.changeMinesNumber(int(minesNumber));
+        game.setSafeOpening(flags & BotProtocol::FLAG_SAFE_OPENING);
+        game.createMatrix(int(length), int(width));
+        game.place_mines(seed);
+        game.count_mines_around();
+        game.resetMarkedCells();
+        game.setWon(false);
+        game.setElapsedTime(0);
+        game.getChangedCells()->clear();
+        plane.reset(int(length), int(width));
+        started = true;
+    }
+    const int start = BotProtocol::beginMessage(out, BotProtocol::NEW_GAME);
+    out.append(char(valid ? BotProtocol::STATUS_OK : BotProtocol::STATUS_INVALID));
+    BotProtocol::appendVarint(out, quint64(game.getLength()));
+    BotProtocol::appendVarint(out, quint64(game.getWidth()));
+    BotProtocol::appendVarint(out, quint64(game.getMinesNumber()));
+    BotProtocol::finishMessage(out, start);
+    return true;
+}
+
+/**
+ * @brief Führt Aktionen der Reihe nach aus und kodiert die geänderten Zellen (ACTIONS).
+ * @param pos Leseposition im Inhalt.
+ * @param end Ende der Nachricht.
+ * @param out Puffer für die Antwort.
+ * @return False bei einer fehlerhaften Anfrage.
+ *
+ * Auf einem beendeten Spiel wirkt nur UNDO (wie in der Oberfläche); alle anderen Aktionen
+ * ändern dann nichts. Ein Bot, der vorausschickt, bekommt so für die Aktionen nach dem
+ * Spielende leere Antworten statt eines Fehlers.
+ */
+bool BotSession::runActions(const uchar *pos, const uchar *end, QByteArray &out) {
+    quint64 count;
+    if (!ReplayFormat::getVarint(pos, end, count) || count > quint64(end - pos)) {
+        return false; ///< jede Aktion belegt mindestens ein Byte
+    }
+    const int width = game.getWidth();
+    const quint64 cells = quint64(game.getLength()) * quint64(width);
+    ArenaVector<QPoint> *changed = game.getChangedCells();
+    const int start = BotProtocol::beginMessage(out, BotProtocol::ACTIONS);
+    for (quint64 i = 0; i < count; i++) {
+        quint64 value;
+        if (!ReplayFormat::getVarint(pos, end, value)) {
+            return false;
+        }
+        ReplayPlayer::Record record = {};
+        record.action = ReplayFormat::Action(value & ((1 << ReplayFormat::ACTION_BITS) - 1));
+        const quint64 cell = value >> ReplayFormat::ACTION_BITS;
+        if (record.action == ReplayFormat::PAUSE || record.action == ReplayFormat::RESULT
+            || (ReplayFormat::hasCell(record.action) && cell >= cells)) {
+            return false;
+        }
+        record.row = int(cell / quint64(width));
+        record.col = int(cell % quint64(width));
+        if (game.is_inGame() || record.action == ReplayFormat::UNDO) {
+            ReplayPlayer::apply(game, record);
+        }
+        actions++;
+
+        ///< Zustand, Anzahl und pro Zelle höchstens 10 Bytes Differenz + 1 Byte Code
+        const int size = int(changed->size());
+        int used = out.size();
+        out.resize(used + 1 + 10 + size * 11);
+        uchar *write = reinterpret_cast<uchar *>(out.data()) + used;
+        *write++ = state();
+        write += ReplayFormat::putVarint(write, quint64(size));
+        qint64 previous = 0;
+        for (const QPoint &coord : *changed) {
+            const qint64 index = qint64(coord.x()) * width + coord.y();
+            const quint8 code = BoardPlane::publicCode(BoardPlane::cellCode(
+                game.getCellStatus(coord.x(), coord.y()), game.getCellMinesNumber(coord.x(), coord.y())));
+            plane.set(coord.x(), coord.y(), code);
+            write += ReplayFormat::putVarint(write, BotProtocol::zigzag(index - previous));
+            *write++ = code;
+            previous = index;
+        }
+        used = int(write - reinterpret_cast<uchar *>(out.data()));
+        out.resize(used);
+        changed->clear();
+    }
+    if (pos != end) {
+        return false;
+    }
+    BotProtocol::finishMessage(out, start);
+    return true;
+}
+
+/**
+ * @brief Kodiert alle Anzeigecodes des Spielfelds (BOARD).
+ * @param out Puffer für die Antwort.
+ */
+void BotSession::writeBoard(QByteArray &out) {
+    const int start = BotProtocol::beginMessage(out, BotProtocol::BOARD);
+    out.append(char(state()));
+    BotProtocol::appendVarint(out, quint64(game.getLength()));
+    BotProtocol::appendVarint(out, quint64(game.getWidth()));
+    for (int row = 0; row < plane.getLength(); row++) {
+        for (int col = 0, count = 0; col < plane.getWidth(); col += count) {
+            const quint8 *codes = plane.rowSpan(row, col, count);
+            out.append(reinterpret_cast<const char *>(codes), count);
+        }
+    }
+    BotProtocol::finishMessage(out, start);
+}
+
+/**
+ * @brief Gibt den Zustand des Spiels für eine Antwort zurück.
+ * @return Kombination aus BotProtocol::STATE_*.
+ */
+quint8 BotSession::state() const {
+    return (game.is_inGame() ? BotProtocol::STATE_IN_GAME : 0) | (game.is_won() ? BotProtocol::STATE_WON : 0);
+}
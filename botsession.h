@@ -0,0 +1,118 @@
+#ifndef BOTSESSION_H
+#define BOTSESSION_H
+
+#include "boardplane.h"
+#include "botprotocol.h"
+#include "game.h"
+#include <QByteArray>
+
+/**
+ * @file botsession.h
+ * @class BotSession
+ * @brief Führt die Anfragen eines Bots auf einem eigenen Game-Objekt aus.
+ *
+ * Protokoll siehe botprotocol.h. Die Sitzung kennt keinen Socket: feed() bekommt gelesene
+ * Bytes in beliebigen Stücken und hängt die Antworten aller darin vollständigen Nachrichten
+ * an einen Ausgabepuffer an. BotServer verbindet sie mit einem QLocalSocket oder mit
+ * stdin/stdout.
+ *
+ * Technische Entscheidung:
+ * Das Spiel läuft direkt im Thread der Sitzung, ohne GameEngine: ohne Oberfläche gibt es
+ * niemanden, der während eines Zugs bedient werden müsste, und jede Übergabe an einen anderen
+ * Thread würde einen Zug mehr kosten als die Ausführung selbst. Die Anzeigecodes hält die
+ * Sitzung wie die Engine in einer eigenen BoardPlane, die nur an den geänderten Zellen eines
+ * Zugs nachgeführt wird.
+ * Antworten werden direkt in den Ausgabepuffer kodiert; nach dem Aufwärmen fordert ein Zug
+ * keinen Heap-Speicher mehr an.
+ *
+ * Abhängigkeit: Game ohne Statistik; die Spiele der Bots gehen nicht in statistics.json ein.
+ *
+ * @author Daniel Schukin
+ */
+class BotSession
+{
+public:
+    /**
+     * @brief Konstruktor für BotSession.
+     *
+     * @author Daniel Schukin
+     */
+    BotSession();
+
+    /**
+     * @brief Verarbeitet gelesene Bytes und kodiert die Antworten.
+     * @param data Gelesene Bytes; eine Nachricht darf über mehrere Aufrufe verteilt sein.
+     * @param size Anzahl der Bytes.
+     * @param out Puffer, an den die Antworten angehängt werden.
+     * @return False nach einer fehlerhaften Anfrage; die Verbindung soll dann getrennt werden.
+     *
+     * @author Daniel Schukin
+     */
+    bool feed(const char *data, int size, QByteArray &out);
+
+    /**
+     * @brief Gibt die Anzahl der bisher ausgeführten Aktionen zurück.
+     * @return Anzahl der Aktionen aller ACTIONS-Anfragen.
+     *
+     * @author Daniel Schukin
+     */
+    qint64 getActions() const { return actions; }
+
+private:
+    /**
+     * @brief Führt eine vollständige Nachricht aus.
+     * @param pos Anfang des Inhalts (hinter der Längenangabe).
+     * @param end Ende der Nachricht.
+     * @param out Puffer für die Antwort.
+     * @return False bei einer fehlerhaften Anfrage.
+     *
+     * @author Daniel Schukin
+     */
+    bool handle(const uchar *pos, const uchar *end, QByteArray &out);
+
+    /**
+     * @brief Erzeugt ein neues Spielfeld (NEW_GAME).
+     * @param pos Leseposition im Inhalt.
+     * @param end Ende der Nachricht.
+     * @param out Puffer für die Antwort.
+     * @return False bei einer fehlerhaften Anfrage.
+     *
+     * @author Daniel Schukin
+     */
+    bool newGame(const uchar *pos, const uchar *end, QByteArray &out);
+
+    /**
+     * @brief Führt Aktionen der Reihe nach aus und kodiert die geänderten Zellen (ACTIONS).
+     * @param pos Leseposition im Inhalt.
+     * @param end Ende der Nachricht.
+     * @param out Puffer für die Antwort.
+     * @return False bei einer fehlerhaften Anfrage.
+     *
+     * @author Daniel Schukin
+     */
+    bool runActions(const uchar *pos, const uchar *end, QByteArray &out);
+
+    /**
+     * @brief Kodiert alle Anzeigecodes des Spielfelds (BOARD).
+     * @param out Puffer für die Antwort.
+     *
+     * @author Daniel Schukin
+     */
+    void writeBoard(QByteArray &out);
+
+    /**
+     * @brief Gibt den Zustand des Spiels für eine Antwort zurück.
+     * @return Kombination aus BotProtocol::STATE_*.
+     *
+     * @author Daniel Schukin
+     */
+    quint8 state() const;
+
+    Game game; ///< Spiel der Sitzung, ohne Statistik.
+    BoardPlane plane; ///< Öffentliche Codes aller Zellen (BoardPlane::publicCode()), wie sie der Bot sieht.
+    bool started = false; ///< True, sobald NEW_GAME ein Spielfeld erzeugt hat.
+    QByteArray input; ///< Gelesene Bytes, die noch keine vollständige Nachricht ergeben.
+    qint64 actions = 0; ///< Anzahl der ausgeführten Aktionen.
+};
+
+#endif // BOTSESSION_H
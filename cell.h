@@ -14,14 +14,25 @@
  * zu initialisieren und die Zustände der einzelnen Zellen auf dem Spielfeld zu verwalten.
  *
  * Technische Entscheidung:
- * Die Cell-Klasse verwendet einfache boolesche Flags, um die Effizienz und Lesbarkeit zu erreichen.
- * Eine komplexere Lösung wie Enums war für dieses Szenario nicht notwendig.
+ * Die Zustände und die Minenzahl liegen gepackt in einem einzigen Byte (siehe die Konstanten
+ * MINES_AROUND bis EXPLODED). Ein Spielfeld mit 10000x10000 Zellen belegt so 100 MB statt 800 MB,
+ * und GameSnapshot kann die Zellen byteweise speichern und ohne Umrechnung wieder einlesen.
+ * Die Bitbelegung ist damit Teil des Spielstandformats und darf nicht verändert werden.
  *
  * @author Daniel Schukin
  */
 class Cell
 {
 public:
+    /// @name Bits des gepackten Zustands
+    /// @{
+    static constexpr unsigned char MINES_AROUND = 0x0F; ///< Anzahl der Minen um die Zelle (0 bis 9).
+    static constexpr unsigned char HIDDEN = 1 << 4;     ///< Zelle ist verdeckt.
+    static constexpr unsigned char MARKED = 1 << 5;     ///< Zelle ist markiert.
+    static constexpr unsigned char MINED = 1 << 6;      ///< Zelle enthält eine Mine.
+    static constexpr unsigned char EXPLODED = 1 << 7;   ///< Mine ist explodiert.
+    /// @}
+
     /**
      * @brief Standardkonstruktor für die Cell-Klasse.
      *
@@ -33,7 +44,7 @@ public:
      * - `exploded` = false
      * @author Daniel Schukin
      */
-    Cell() : mines_around(0), hidden(true), marked(false), mined(false), exploded(false) {}
+    Cell() : bits(HIDDEN) {}
 
     /**
      * @brief Benutzerdefinierter Konstruktor für die Cell-Klasse.
@@ -52,32 +63,44 @@ public:
 
     /// @name Getter-Methoden
     /// Diese Methoden liefern die aktuellen Werte der Attribute zurück.
+    /// Sie sind inline, weil sie in jeder Nachbarschaftsschleife des Spielfelds aufgerufen werden.
+    /// Die Flags werden an ihre Bitposition verschoben statt maskiert; so summiert der Compiler
+    /// z.B. die Minen der Nachbarn ohne einen Vergleich pro Zelle.
     /// @author Daniel Schukin
     /// @{
-    int get_mines_around();
-    bool is_hidden();
-    bool is_marked();
-    bool is_mined();
-    bool is_exploded();
+    int get_mines_around() const { return bits & MINES_AROUND; }
+    bool is_hidden() const { return (bits >> 4) & 1; }
+    bool is_marked() const { return (bits >> 5) & 1; }
+    bool is_mined() const { return (bits >> 6) & 1; }
+    bool is_exploded() const { return (bits >> 7) & 1; }
+    unsigned char get_bits() const { return bits; } ///< Gepackter Zustand, siehe HIDDEN usw.
     /// @}
 
     /// @name Setter-Methoden
     /// Diese Methoden setzen die Werte der Attribute.
+    /// Die Minenzahl wird modulo 16 gespeichert; Randzellen dürfen so beim Verschieben einer Mine
+    /// kurzzeitig unter 0 fallen, ihre Minenzahl wird nie gelesen.
     /// @author Daniel Schukin
     /// @{
-    void set_mines_around(int mines_around);
-    void set_hidden(bool hidden);
-    void set_marked(bool marked);
-    void set_mined(bool mined);
-    void set_exploded(bool exploded);
+    void set_mines_around(int mines_around) { bits = (bits & ~MINES_AROUND) | (mines_around & MINES_AROUND); }
+    void set_hidden(bool hidden) { setBit(HIDDEN, hidden); }
+    void set_marked(bool marked) { setBit(MARKED, marked); }
+    void set_mined(bool mined) { setBit(MINED, mined); }
+    void set_exploded(bool exploded) { setBit(EXPLODED, exploded); }
+    void set_bits(unsigned char bits) { this->bits = bits; } ///< Setzt den gepackten Zustand, siehe get_bits().
     /// @}
 
-private: // Attribute
-    int mines_around; ///< Anzahl der Minen um die Zelle herum.
-    bool hidden;      ///< Zeigt an, ob die Zelle versteckt ist.
-    bool marked;      ///< Zeigt an, ob die Zelle markiert wurde.
-    bool mined;       ///< Zeigt an, ob die Zelle eine Mine enthält.
-    bool exploded;    ///< Zeigt an, ob die Zelle explodiert ist.
+private:
+    /**
+     * @brief Setzt oder löscht ein Zustandsbit.
+     * @param bit Eines der Bits HIDDEN bis EXPLODED.
+     * @param value Neuer Wert.
+     *
+     * @author Daniel Schukin
+     */
+    void setBit(unsigned char bit, bool value) { bits = value ? bits | bit : bits & ~bit; }
+
+    unsigned char bits; ///< Minenzahl und Zustände, siehe MINES_AROUND bis EXPLODED.
 };
 
 #endif // CELL_H
@@ -0,0 +1,312 @@
+#ifndef DELTAFORMAT_H
+#define DELTAFORMAT_H
+
+#include "replayformat.h"
+#include <QVector>
+#include <QtGlobal>
+#include <cstring>
+
+/**
+ * @file deltaformat.h
+ * @brief Gemeinsame Definitionen des Live-Mitschnitts der Spielfeldänderungen (siehe DeltaRecorder).
+ *
+ * Während eine Aufzeichnung (replayformat.h) nur die Klicks speichert und das Spiel beim
+ * Abspielen nachrechnen muss, enthält der Mitschnitt das sichtbare Ergebnis jedes Zugs. Ein
+ * Zuschauer kann das Spielfeld damit ohne Spiellogik nachbauen, auch während die Datei noch
+ * wächst. Aufbau:
+ * | Versatz | Größe       | Inhalt                                  |
+ * |---------|-------------|-----------------------------------------|
+ * | 0       | 4           | Kennung "U3DS"                          |
+ * | 4       | 2           | Formatversion (VERSION, Little-Endian)  |
+ * | 6       | 2           | Immer 0                                 |
+ * | 8       | ...         | Datensätze bis zum Dateiende            |
+ *
+ * Jeder Datensatz beginnt mit einem Varint mit der Länge des Rests und einem Varint
+ * (Zeit seit dem vorherigen Datensatz in ms << KIND_BITS | Kind). Es folgen ein Varint
+ * (Spielzeit in ms << STATE_BITS | STATE_*) und ein Varint mit der Anzahl der Markierungen,
+ * danach je nach Art:
+ * - DELTA (ein Zug): Anzahl der Läufe, dann pro Lauf aufeinanderfolgender Zellindizes ein Varint
+ *   (Zickzack-Abstand des ersten Index zum Ende des vorherigen Laufs, beginnend bei 0), ein
+ *   Varint (Länge - 1) und die Codes des Laufs.
+ * - BOARD (neues oder geladenes Spielfeld) und KEYFRAME (Stand nach dem vorherigen Zug): je ein
+ *   Varint mit Zeilen, Spalten, Minen und der Anzahl der Züge seit BOARD, dann die Codes aller
+ *   Zellen zeilenweise.
+ *
+ * Codes sind Anzeigecodes (siehe BoardPlane::cellCode()), verdeckte Zellen nur 0 oder 2 wie in
+ * BoardPlane::publicCode(). Sie werden lauflängenkodiert: ein Byte (Wiederholungen - 1) << CODE_BITS
+ * | Code für bis zu SHORT_REPEAT gleiche Codes; steht dort SHORT_REPEAT, folgt ein Varint mit
+ * Wiederholungen - SHORT_REPEAT - 1.
+ *
+ * Technische Entscheidung:
+ * Die Längenangabe vor jedem Datensatz erlaubt zweierlei: ein mitlesender Zuschauer erkennt einen
+ * halb geschriebenen Datensatz am Dateiende und wartet, und beim Springen werden Datensätze
+ * ohne Dekodieren übersprungen. Springen beginnt am letzten KEYFRAME vor dem Ziel; höchstens
+ * DeltaRecorder::KEYFRAME_MOVES Züge oder so viele Zellen, wie das Spielfeld hat, sind danach
+ * nachzuspielen. Eine Öffnung besteht aus wenigen Zeilenstücken mit meist gleichen Codes, ein
+ * Zug belegt so oft weniger als ein Byte pro Zelle.
+ *
+ * @author Daniel Schukin
+ */
+namespace DeltaFormat {
+
+constexpr char MAGIC[4] = {'U', '3', 'D', 'S'}; ///< Kennung am Dateianfang.
+constexpr quint16 VERSION = 1; ///< Aktuelle Formatversion.
+constexpr int HEADER_SIZE = 8; ///< Größe des Kopfs in Bytes.
+constexpr int MAX_RECORD = 64 << 20; ///< Größter Datensatz, den ein Leser annimmt.
+constexpr qint64 MAX_CELLS = 1 << 26; ///< Größtes Spielfeld, das ein Leser nachbaut.
+
+/// @brief Art eines Datensatzes.
+enum Kind : quint8 {
+    DELTA = 0,    ///< Geänderte Zellen eines Zugs.
+    KEYFRAME = 1, ///< Vollständiger Stand zum schnellen Springen.
+    BOARD = 2     ///< Vollständiger Stand eines neuen oder geladenen Spielfelds.
+};
+
+constexpr int KIND_BITS = 2; ///< Anzahl der Bits für die Art im Zeit-Varint.
+
+constexpr quint8 STATE_IN_GAME = 0x01; ///< Das Spiel läuft.
+constexpr quint8 STATE_WON = 0x02;     ///< Das Spiel wurde gewonnen.
+constexpr int STATE_BITS = 2;          ///< Anzahl der Bits für den Zustand im Spielzeit-Varint.
+
+constexpr int CODE_BITS = 5; ///< Bits für den Code im Lauflängenbyte; alle Anzeigecodes sind kleiner als 32.
+constexpr int SHORT_REPEAT = 7; ///< Wiederholungsfeld, ab dem ein Varint mit den weiteren Wiederholungen folgt.
+
+/**
+ * @brief Schreibt einen Lauf gleicher Codes.
+ * @param out Zielpuffer mit Platz für mindestens 11 Bytes.
+ * @param code Anzeigecode.
+ * @param repeat Anzahl der Zellen (mindestens 1).
+ * @return Anzahl der geschriebenen Bytes.
+ *
+ * @author Daniel Schukin
+ */
+inline int putRun(uchar *out, quint8 code, quint64 repeat) {
+    if (repeat <= quint64(SHORT_REPEAT)) {
+        out[0] = uchar((repeat - 1) << CODE_BITS | code);
+        return 1;
+    }
+    out[0] = uchar(SHORT_REPEAT << CODE_BITS | code);
+    return 1 + ReplayFormat::putVarint(out + 1, repeat - SHORT_REPEAT - 1);
+}
+
+/**
+ * @brief Schreibt eine Folge von Codes lauflängenkodiert.
+ * @param out Zielpuffer mit Platz für mindestens count + 10 Bytes.
+ * @param codes Codes.
+ * @param count Anzahl der Codes (mindestens 1).
+ * @return Anzahl der geschriebenen Bytes.
+ *
+ * @author Daniel Schukin
+ */
+inline int putCodes(uchar *out, const quint8 *codes, int count) {
+    int n = 0;
+    for (int i = 0; i < count;) {
+        int j = i + 1;
+        while (j < count && codes[j] == codes[i]) {
+            j++;
+        }
+        n += putRun(out + n, codes[i], quint64(j - i));
+        i = j;
+    }
+    return n;
+}
+
+/**
+ * @brief Liest lauflängenkodierte Codes.
+ * @param pos Leseposition, wird hinter die Codes verschoben.
+ * @param end Ende des Puffers.
+ * @param out Ziel für genau count Codes.
+ * @param count Anzahl der Codes.
+ * @return False, wenn der Puffer vorher aufhört oder ein Lauf über count hinausgeht.
+ *
+ * @author Daniel Schukin
+ */
+inline bool getCodes(const uchar *&pos, const uchar *end, quint8 *out, qint64 count) {
+    while (count > 0) {
+        if (pos >= end) {
+            return false;
+        }
+        const uchar byte = *pos++;
+        quint64 repeat = (byte >> CODE_BITS) + 1;
+        if (repeat > quint64(SHORT_REPEAT)) {
+            quint64 more;
+            if (!ReplayFormat::getVarint(pos, end, more) || more >= quint64(count)) {
+                return false;
+            }
+            repeat += more;
+        }
+        if (repeat > quint64(count)) {
+            return false;
+        }
+        std::memset(out, byte & ((1 << CODE_BITS) - 1), size_t(repeat));
+        out += repeat;
+        count -= qint64(repeat);
+    }
+    return true;
+}
+
+/**
+ * @brief Kopf eines Datensatzes; der Inhalt wird erst von Board::apply() dekodiert.
+ *
+ * @author Daniel Schukin
+ */
+struct Record
+{
+    Kind kind = DELTA;              ///< Art des Datensatzes.
+    quint64 timeDelta = 0;          ///< Zeit seit dem vorherigen Datensatz in ms.
+    const uchar *payload = nullptr; ///< Inhalt nach dem Zeit-Varint.
+    const uchar *end = nullptr;     ///< Ende des Datensatzes.
+};
+
+/**
+ * @brief Liest den Kopf des nächsten Datensatzes.
+ * @param pos Anfang des Datensatzes.
+ * @param end Ende der bisher gelesenen Bytes.
+ * @param record Gibt den Kopf zurück.
+ * @return Länge des Datensatzes in Bytes; 0, wenn er noch nicht vollständig ist; -1, wenn er ungültig ist.
+ *
+ * @author Daniel Schukin
+ */
+inline qint64 parseRecord(const uchar *pos, const uchar *end, Record &record) {
+    const uchar *start = pos;
+    quint64 size;
+    if (!ReplayFormat::getVarint(pos, end, size)) {
+        return end - start >= 10 ? -1 : 0;
+    }
+    if (size == 0 || size > quint64(MAX_RECORD)) {
+        return -1;
+    }
+    if (quint64(end - pos) < size) {
+        return 0;
+    }
+    record.end = pos + size;
+    quint64 time;
+    if (!ReplayFormat::getVarint(pos, record.end, time) || (time & ((1 << KIND_BITS) - 1)) > BOARD) {
+        return -1;
+    }
+    record.kind = Kind(time & ((1 << KIND_BITS) - 1));
+    record.timeDelta = time >> KIND_BITS;
+    record.payload = pos;
+    return record.end - start;
+}
+
+/**
+ * @brief Aus einem Mitschnitt nachgebautes Spielfeld.
+ *
+ * Header-only, damit Zuschauer-Werkzeuge nur diese Datei brauchen.
+ *
+ * @author Daniel Schukin
+ */
+struct Board
+{
+    int length = 0;             ///< Anzahl der Zeilen.
+    int width = 0;              ///< Anzahl der Spalten.
+    int minesNumber = 0;        ///< Anzahl der Minen.
+    int markedCells = 0;        ///< Anzahl der markierten Zellen.
+    qint64 elapsedTime = 0;     ///< Spielzeit in ms.
+    bool inGame = false;        ///< True, wenn das Spiel läuft.
+    bool won = false;           ///< True, wenn das Spiel gewonnen wurde.
+    quint64 boards = 0;         ///< Anzahl der gelesenen BOARD-Datensätze.
+    quint64 moves = 0;          ///< Züge seit Beginn des Spielfelds.
+    quint64 time = 0;           ///< Zeit seit Beginn des Mitschnitts in ms.
+    QVector<quint8> codes;      ///< Anzeigecodes, zeilenweise.
+
+    /**
+     * @brief Wendet einen Datensatz an.
+     * @param record Kopf des Datensatzes (siehe parseRecord()).
+     * @param changed Wenn nicht nullptr, werden die Indizes der geänderten Zellen angehängt (nur bei DELTA).
+     * @return False, wenn der Datensatz ungültig ist oder vor dem ersten vollständigen Stand ein Zug kommt.
+     *
+     * @author Daniel Schukin
+     */
+    bool apply(const Record &record, QVector<qint32> *changed = nullptr) {
+        const uchar *pos = record.payload;
+        quint64 state, marked;
+        if (!ReplayFormat::getVarint(pos, record.end, state) || !ReplayFormat::getVarint(pos, record.end, marked)) {
+            return false;
+        }
+        if (record.kind == DELTA) {
+            if (!applyDelta(pos, record.end, changed)) {
+                return false;
+            }
+            moves++;
+        } else if (!applyKeyframe(pos, record.end, record.kind)) {
+            return false;
+        }
+        time += record.timeDelta;
+        elapsedTime = qint64(state >> STATE_BITS);
+        inGame = state & STATE_IN_GAME;
+        won = state & STATE_WON;
+        markedCells = int(marked);
+        return pos == record.end;
+    }
+
+private:
+    /**
+     * @brief Übernimmt die Läufe eines Zugs.
+     * @param pos Leseposition.
+     * @param end Ende des Datensatzes.
+     * @param changed Optionales Ziel für die geänderten Indizes.
+     * @return False bei ungültigen Läufen.
+     *
+     * @author Daniel Schukin
+     */
+    bool applyDelta(const uchar *&pos, const uchar *end, QVector<qint32> *changed) {
+        const qint64 cells = codes.size();
+        quint64 runs;
+        if (codes.isEmpty() || !ReplayFormat::getVarint(pos, end, runs)) {
+            return false;
+        }
+        qint64 next = 0;
+        for (quint64 run = 0; run < runs; run++) {
+            quint64 gap, count;
+            if (!ReplayFormat::getVarint(pos, end, gap) || !ReplayFormat::getVarint(pos, end, count)) {
+                return false;
+            }
+            const qint64 first = next + (qint64(gap >> 1) ^ -qint64(gap & 1)); ///< Zickzack wie BotProtocol::unzigzag()
+            if (first < 0 || count >= quint64(cells) || first + qint64(count) >= cells
+                || !getCodes(pos, end, codes.data() + first, qint64(count) + 1)) {
+                return false;
+            }
+            next = first + qint64(count) + 1;
+            if (changed != nullptr) {
+                for (qint64 index = first; index < next; index++) {
+                    changed->append(qint32(index));
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Übernimmt einen vollständigen Stand.
+     * @param pos Leseposition.
+     * @param end Ende des Datensatzes.
+     * @param kind BOARD oder KEYFRAME.
+     * @return False bei ungültigen Maßen oder Codes.
+     *
+     * @author Daniel Schukin
+     */
+    bool applyKeyframe(const uchar *&pos, const uchar *end, Kind kind) {
+        quint64 rows, cols, mines, moveCount;
+        if (!ReplayFormat::getVarint(pos, end, rows) || !ReplayFormat::getVarint(pos, end, cols)
+            || !ReplayFormat::getVarint(pos, end, mines) || !ReplayFormat::getVarint(pos, end, moveCount)
+            || rows == 0 || cols == 0 || rows > quint64(MAX_CELLS) || cols > quint64(MAX_CELLS)
+            || rows * cols > quint64(MAX_CELLS)) {
+            return false;
+        }
+        length = int(rows);
+        width = int(cols);
+        minesNumber = int(mines);
+        moves = moveCount;
+        codes.resize(length * width);
+        if (kind == BOARD) {
+            boards++;
+        }
+        return getCodes(pos, end, codes.data(), codes.size());
+    }
+};
+
+}
+
+#endif // DELTAFORMAT_H
@@ -0,0 +1,364 @@
+#include "deltarecorder.h"
+#include "tracing.h"
+#include <QThread>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Fasst Spielzeit und Zustand eines Ereignisses zu einem Varint-Wert zusammen.
+ * @param event Ereignis.
+ * @return Spielzeit << STATE_BITS | STATE_*.
+ */
+static quint64 stateOf(const EngineEvent &event) {
+    return quint64(event.elapsedTime) << DeltaFormat::STATE_BITS | (event.inGame ? DeltaFormat::STATE_IN_GAME : 0)
+           | (event.won ? DeltaFormat::STATE_WON : 0);
+}
+
+/**
+ * @brief Destruktor für DeltaRecorder.
+ *
+ * Schreibt den Rest, damit auch beim Beenden kein Zug verloren geht.
+ */
+DeltaRecorder::~DeltaRecorder() {
+    finish();
+}
+
+/**
+ * @brief Beginnt einen Mitschnitt.
+ * @param filePath Pfad der Datei; eine vorhandene wird überschrieben.
+ * @return False, wenn die Datei nicht angelegt werden konnte.
+ *
+ * Der Kopf wird sofort geschrieben, damit ein Zuschauer die Datei schon vor dem ersten Zug
+ * erkennt. Der erste Datensatz muss ein BOARD sein (siehe recordBoard()).
+ */
+bool DeltaRecorder::start(const QString &filePath) {
+    finish();
+    file.setFileName(filePath);
+    uchar header[DeltaFormat::HEADER_SIZE];
+    std::memcpy(header, DeltaFormat::MAGIC, sizeof(DeltaFormat::MAGIC));
+    qToLittleEndian<quint16>(DeltaFormat::VERSION, header + 4);
+    qToLittleEndian<quint16>(0, header + 6);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || file.write(reinterpret_cast<const char *>(header), DeltaFormat::HEADER_SIZE) != DeltaFormat::HEADER_SIZE
+        || !file.flush()) {
+        file.close();
+        return false;
+    }
+    cells = 0;
+    catchUp = DeltaFormat::DELTA;
+    overflow = Pending();
+    dropped = 0;
+    lastTime = 0;
+    clock.start();
+    thread = QThread::create([this]() { run(); });
+    thread->start(QThread::LowPriority);
+    return true;
+}
+
+/**
+ * @brief Schließt den Mitschnitt ab und wartet, bis alles geschrieben ist.
+ *
+ * Läuft im Engine-Thread nach seinem letzten Datensatz; der Schreib-Thread leert die Schlange
+ * nach dem Freigeben noch einmal ganz. Ein liegengebliebener vollständiger Stand wird vorher
+ * nachgereicht, damit der Mitschnitt mit dem letzten Stand endet.
+ */
+void DeltaRecorder::finish() {
+    if (thread == nullptr) {
+        return;
+    }
+    if (catchUp != DeltaFormat::DELTA) {
+        while (!queue.tryPush(std::move(overflow))) {
+            QThread::msleep(1); ///< der Schreib-Thread leert die Schlange spätestens nach FLUSH_INTERVAL ms
+        }
+        catchUp = DeltaFormat::DELTA;
+    }
+    stop.release();
+    thread->wait();
+    delete thread;
+    thread = nullptr;
+    file.close();
+    if (dropped > 0) {
+        qCWarning(lcEngine) << "Mitschnitt: Datensätze verworfen und durch vollständige Stände ersetzt:" << dropped;
+    }
+}
+
+/**
+ * @brief Schneidet ein neues oder geladenes Spielfeld als BOARD mit.
+ * @param event BOARD-Ereignis mit Anzeigeebene und Zählern.
+ *
+ * Spielfelder, die ein Leser nicht nachbauen würde (DeltaFormat::MAX_CELLS), werden samt ihren
+ * Zügen ausgelassen.
+ */
+void DeltaRecorder::recordBoard(const EngineEvent &event) {
+    if (!is_recording()) {
+        return;
+    }
+    cells = qint64(event.plane.getLength()) * event.plane.getWidth();
+    moves = 0;
+    if (event.plane.isEmpty() || cells > DeltaFormat::MAX_CELLS) {
+        cells = 0;
+        return;
+    }
+    pushKeyframe(DeltaFormat::BOARD, event);
+}
+
+/**
+ * @brief Schneidet einen Zug als DELTA mit, bei Bedarf gefolgt von einem KEYFRAME.
+ * @param event MOVE-Ereignis.
+ *
+ * Kostet unabhängig von der Anzahl der Zellen nur das Anhängen an die Warteschlange. Ein
+ * KEYFRAME folgt nach KEYFRAME_MOVES Zügen oder sobald seit dem letzten vollständigen Stand
+ * KEYFRAME_BOARDS-mal so viele Zellen geändert wurden, wie das Spielfeld hat; beim Springen ist
+ * dann nie viel mehr nachzuspielen als einige vollständige Stände. Passt ein Datensatz nicht
+ * in die Schlange, werden die folgenden Züge als vollständige Stände geschrieben, bis wieder
+ * einer passt.
+ */
+void DeltaRecorder::recordMove(const EngineEvent &event) {
+    if (!is_recording() || cells == 0) {
+        return;
+    }
+    moves++;
+    if (catchUp != DeltaFormat::DELTA) {
+        pushKeyframe(catchUp, event);
+        return;
+    }
+    Pending pending;
+    pending.timeDelta = takeTimeDelta();
+    pending.state = stateOf(event);
+    pending.markedCells = event.markedCells;
+    pending.cells = event.cells; ///< nur eine Referenz
+    movesSinceKeyframe++;
+    changesSinceKeyframe += event.cells.size();
+    if (!push(pending)) {
+        catchUp = DeltaFormat::KEYFRAME;
+        overflow = makeKeyframe(DeltaFormat::KEYFRAME, event);
+        return;
+    }
+    if (movesSinceKeyframe >= KEYFRAME_MOVES || changesSinceKeyframe >= KEYFRAME_BOARDS * cells) {
+        pushKeyframe(DeltaFormat::KEYFRAME, event);
+    }
+}
+
+/**
+ * @brief Reiht einen vollständigen Stand ein.
+ * @param kind BOARD oder KEYFRAME.
+ * @param event Ereignis mit Anzeigeebene und Zählern.
+ *
+ * Passt er nicht mehr in die Schlange, bleibt er als overflow liegen, bis ihn der nächste
+ * Stand ersetzt oder finish() ihn nachreicht.
+ */
+void DeltaRecorder::pushKeyframe(DeltaFormat::Kind kind, const EngineEvent &event) {
+    Pending pending = makeKeyframe(kind, event);
+    if (push(pending)) {
+        catchUp = DeltaFormat::DELTA;
+        overflow = Pending();
+    } else {
+        catchUp = kind;
+        overflow = std::move(pending);
+    }
+}
+
+/**
+ * @brief Erzeugt einen vollständigen Stand.
+ * @param kind BOARD oder KEYFRAME.
+ * @param event Ereignis mit Anzeigeebene und Zählern.
+ * @return Datensatz.
+ *
+ * Solange der Schreib-Thread die Kopie der Ebene hält, kopiert der Engine-Thread jeden Block,
+ * in den er schreibt, einmal (siehe BoardPlane); das kostet höchstens so viel wie die Ebene
+ * einmal zu kopieren und ist billiger, als den Schreib-Thread für jeden Stand sofort zu wecken.
+ */
+DeltaRecorder::Pending DeltaRecorder::makeKeyframe(DeltaFormat::Kind kind, const EngineEvent &event) {
+    Pending pending;
+    pending.kind = kind;
+    pending.timeDelta = takeTimeDelta();
+    pending.state = stateOf(event);
+    pending.markedCells = event.markedCells;
+    pending.minesNumber = event.setup.minesNumber;
+    pending.moves = moves;
+    pending.plane = event.plane; ///< nur Referenzen, siehe BoardPlane
+    movesSinceKeyframe = 0;
+    changesSinceKeyframe = 0;
+    return pending;
+}
+
+/**
+ * @brief Hängt einen Datensatz an die Warteschlange an.
+ * @param pending Datensatz; wird nur bei Erfolg verschoben.
+ * @return False, wenn die Schlange voll ist.
+ *
+ * Weder Sperre noch Systemaufruf. Die Zeit eines Datensatzes, der nicht passt, geht auf den
+ * vollständigen Stand über, der ihn ersetzt.
+ */
+bool DeltaRecorder::push(Pending &pending) {
+    if (queue.tryPush(std::move(pending))) {
+        return true;
+    }
+    lastTime -= qint64(pending.timeDelta);
+    dropped++;
+    return false;
+}
+
+/**
+ * @brief Gibt die Zeit seit dem vorherigen Datensatz zurück und merkt sich den Zeitpunkt.
+ * @return Zeit in ms.
+ */
+quint64 DeltaRecorder::takeTimeDelta() {
+    const qint64 now = clock.elapsed();
+    const qint64 delta = now - lastTime;
+    lastTime = now;
+    return quint64(delta);
+}
+
+/**
+ * @brief Schleife des Schreib-Threads.
+ *
+ * Wartet FLUSH_INTERVAL ms oder bis finish(), holt dann alle Datensätze aus der Schlange und
+ * kodiert und schreibt sie. Ein Fehler beim Schreiben wird einmal gemeldet; der Mitschnitt ist
+ * dann unvollständig, das Spiel läuft weiter.
+ */
+void DeltaRecorder::run() {
+    Pending record;
+    QVector<quint64> sorted;
+    QByteArray body;
+    QByteArray out;
+    int width = 0;
+    bool failed = false;
+    bool done = false;
+    while (!done) {
+        done = stop.tryAcquire(1, FLUSH_INTERVAL);
+
+        TRACE_SPAN("delta.write");
+        out.clear();
+        while (queue.tryPop(record)) {
+            if (record.kind == DeltaFormat::DELTA) {
+                encodeDelta(record, width, sorted, body, out);
+            } else {
+                width = record.plane.getWidth();
+                encodeKeyframe(record, body, out);
+            }
+        }
+        record = Pending(); ///< gibt Zellen und Ebene des letzten Datensatzes frei
+        if (!out.isEmpty() && !failed && (file.write(out) != out.size() || !file.flush())) {
+            qCWarning(lcEngine) << "Mitschnitt konnte nicht geschrieben werden:" << file.errorString();
+            failed = true;
+        }
+    }
+}
+
+/**
+ * @brief Kodiert einen Zug als Datensatz.
+ * @param pending Zug.
+ * @param width Breite des Spielfelds für den Zellindex.
+ * @param sorted Zwischenspeicher für Zellindex << 8 | Code.
+ * @param body Zwischenspeicher für den Datensatz ohne Längenangabe.
+ * @param out Ausgabepuffer.
+ *
+ * Läuft im Schreib-Thread. Zellen in Zeilenreihenfolge (der Normalfall, siehe
+ * Game::getChangedCells()) werden nicht sortiert.
+ */
+void DeltaRecorder::encodeDelta(const Pending &pending, int width, QVector<quint64> &sorted, QByteArray &body,
+                                QByteArray &out) {
+    const int count = pending.cells.size();
+    sorted.resize(count);
+    bool ordered = true;
+    quint64 previous = 0;
+    for (int i = 0; i < count; i++) {
+        const CellUpdate &cell = pending.cells.at(i);
+        const quint64 key = quint64(qint64(cell.row) * width + cell.col) << 8
+                            | BoardPlane::publicCode(BoardPlane::cellCode(cell.status, cell.minesAround));
+        ordered = ordered && key >= previous;
+        previous = key;
+        sorted[i] = key;
+    }
+    if (!ordered) {
+        std::sort(sorted.begin(), sorted.end());
+    }
+    const quint64 *keys = sorted.constData();
+    int runs = 0;
+    for (int i = 0; i < count; i++) {
+        runs += i == 0 || (keys[i] >> 8) != (keys[i - 1] >> 8) + 1;
+    }
+
+    body.resize(64 + count * 16); ///< je Zelle höchstens ein Laufkopf (2 Varints) und ein Codebyte
+    uchar *begin = reinterpret_cast<uchar *>(body.data());
+    uchar *pos = begin;
+    pos += ReplayFormat::putVarint(pos, pending.timeDelta << DeltaFormat::KIND_BITS | DeltaFormat::DELTA);
+    pos += ReplayFormat::putVarint(pos, pending.state);
+    pos += ReplayFormat::putVarint(pos, quint64(pending.markedCells));
+    pos += ReplayFormat::putVarint(pos, quint64(runs));
+    qint64 next = 0;
+    for (int i = 0; i < count;) {
+        int end = i + 1;
+        while (end < count && (keys[end] >> 8) == (keys[end - 1] >> 8) + 1) {
+            end++;
+        }
+        const qint64 gap = qint64(keys[i] >> 8) - next;
+        pos += ReplayFormat::putVarint(pos, (quint64(gap) << 1) ^ quint64(gap >> 63)); ///< Zickzack wie BotProtocol::zigzag()
+        pos += ReplayFormat::putVarint(pos, quint64(end - i - 1));
+        next = qint64(keys[end - 1] >> 8) + 1;
+        while (i < end) {
+            const quint8 code = quint8(keys[i]);
+            int same = i + 1;
+            while (same < end && quint8(keys[same]) == code) {
+                same++;
+            }
+            pos += DeltaFormat::putRun(pos, code, quint64(same - i));
+            i = same;
+        }
+    }
+
+    uchar size[10];
+    out.append(reinterpret_cast<const char *>(size), ReplayFormat::putVarint(size, quint64(pos - begin)));
+    out.append(body.constData(), int(pos - begin));
+}
+
+/**
+ * @brief Kodiert einen vollständigen Stand als Datensatz.
+ * @param pending BOARD oder KEYFRAME.
+ * @param body Zwischenspeicher für den Datensatz ohne Längenangabe.
+ * @param out Ausgabepuffer.
+ *
+ * Läuft im Schreib-Thread. Die Codes werden zeilenstückweise aus der Ebene gelesen; ein Lauf
+ * darf über Zeilen- und Blockgrenzen hinausgehen.
+ */
+void DeltaRecorder::encodeKeyframe(const Pending &pending, QByteArray &body, QByteArray &out) {
+    TRACE_SPAN("delta.keyframe");
+    const BoardPlane &plane = pending.plane;
+    const int length = plane.getLength();
+    const int width = plane.getWidth();
+    body.resize(int(qint64(length) * width + 80)); ///< höchstens ein Byte pro Zelle
+    uchar *begin = reinterpret_cast<uchar *>(body.data());
+    uchar *pos = begin;
+    pos += ReplayFormat::putVarint(pos, pending.timeDelta << DeltaFormat::KIND_BITS | pending.kind);
+    pos += ReplayFormat::putVarint(pos, pending.state);
+    pos += ReplayFormat::putVarint(pos, quint64(pending.markedCells));
+    pos += ReplayFormat::putVarint(pos, quint64(length));
+    pos += ReplayFormat::putVarint(pos, quint64(width));
+    pos += ReplayFormat::putVarint(pos, quint64(pending.minesNumber));
+    pos += ReplayFormat::putVarint(pos, pending.moves);
+    quint8 code = BoardPlane::publicCode(plane.code(0, 0));
+    quint64 repeat = 0;
+    for (int row = 0; row < length; row++) {
+        for (int col = 0; col < width;) {
+            int count;
+            const quint8 *span = plane.rowSpan(row, col, count);
+            for (int i = 0; i < count; i++) {
+                const quint8 next = BoardPlane::publicCode(span[i]);
+                if (next != code) {
+                    pos += DeltaFormat::putRun(pos, code, repeat);
+                    code = next;
+                    repeat = 0;
+                }
+                repeat++;
+            }
+            col += count;
+        }
+    }
+    pos += DeltaFormat::putRun(pos, code, repeat);
+
+    uchar size[10];
+    out.append(reinterpret_cast<const char *>(size), ReplayFormat::putVarint(size, quint64(pos - begin)));
+    out.append(body.constData(), int(pos - begin));
+}
@@ -0,0 +1,207 @@
+#ifndef DELTARECORDER_H
+#define DELTARECORDER_H
+
+#include "boardplane.h"
+#include "deltaformat.h"
+#include "gameengine.h"
+#include "spscqueue.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSemaphore>
+#include <QString>
+#include <QVector>
+
+class QThread;
+
+/**
+ * @file deltarecorder.h
+ * @class DeltaRecorder
+ * @brief Schreibt einen Live-Mitschnitt der Spielfeldänderungen in eine Datei.
+ *
+ * Pro Zug wird ein Datensatz mit den geänderten Zellen des Ereignisses (also aus
+ * Game::getChangedCells()) geschrieben, dazu vollständige Stände bei jedem neuen Spielfeld und
+ * regelmäßig zwischendurch. Format siehe deltaformat.h; ein Zuschauer kann die Datei mitlesen,
+ * z.B. mit tools/u3-delta.
+ *
+ * Technische Entscheidung:
+ * Der Engine-Thread kodiert nichts: ein Zug kostet ihn nur einen Zeitstempel und einen Platz in
+ * einer sperrfreien Warteschlange (SpscQueue), unabhängig von der Anzahl der Zellen (die Zellen
+ * sind implizit geteilt und werden nicht kopiert, wie die Ebene bei einem KEYFRAME, siehe
+ * BoardPlane). Er nimmt keine Sperre und weckt niemanden: der Schreib-Thread mit niedriger
+ * Priorität schaut alle FLUSH_INTERVAL ms nach, damit ein Zuschauer jeden Zug kurz danach sieht,
+ * und sortiert, kodiert und schreibt alles, was in dieser Zeit anfällt, mit einem Systemaufruf.
+ * Die Läufe eines Zugs werden nach Zellindex sortiert, damit auch eine ab dem Klick sortierte
+ * Öffnung (GameEngine::setRevealOrdered()) in wenige Läufe zerfällt.
+ *
+ * Fallen in einem Intervall mehr als QUEUE_CAPACITY Datensätze an (nur bei Bots), werden die
+ * überzähligen verworfen und die folgenden Züge als vollständige Stände geschrieben, bis wieder
+ * Platz ist; der Mitschnitt bleibt so nachspielbar und endet mit dem letzten Stand, ihm fehlen
+ * nur Zwischenstände.
+ *
+ * Abhängigkeit: schreibt nur der Engine-Thread (siehe GameEngine::publish()); Einschalten über
+ * EngineCommand::RECORD_DELTAS.
+ *
+ * @author Daniel Schukin
+ */
+class DeltaRecorder
+{
+public:
+    static constexpr int QUEUE_CAPACITY = 4096; ///< Datensätze, die zwischen zwei Schreibvorgängen warten können.
+    static constexpr int FLUSH_INTERVAL = 50; ///< Längste Verzögerung eines Zugs in der Warteschlange in ms.
+    static constexpr int KEYFRAME_MOVES = 1024; ///< Züge, nach denen spätestens ein KEYFRAME folgt.
+    static constexpr int KEYFRAME_BOARDS = 4; ///< Geänderte Zellen in Spielfeldgrößen, nach denen spätestens ein KEYFRAME folgt.
+
+    /**
+     * @brief Destruktor für DeltaRecorder. Schreibt den Rest und beendet den Schreib-Thread.
+     *
+     * @author Daniel Schukin
+     */
+    ~DeltaRecorder();
+
+    /**
+     * @brief Beginnt einen Mitschnitt; ein laufender wird abgeschlossen.
+     * @param filePath Pfad der Datei; eine vorhandene wird überschrieben.
+     * @return False, wenn die Datei nicht angelegt werden konnte.
+     *
+     * @author Daniel Schukin
+     */
+    bool start(const QString &filePath);
+
+    /**
+     * @brief Schließt den Mitschnitt ab und wartet, bis alles geschrieben ist.
+     *
+     * @author Daniel Schukin
+     */
+    void finish();
+
+    /**
+     * @brief Gibt an, ob gerade mitgeschnitten wird.
+     * @return True zwischen start() und finish().
+     *
+     * @author Daniel Schukin
+     */
+    bool is_recording() const { return thread != nullptr; }
+
+    /**
+     * @brief Gibt die Fehlermeldung des letzten start() zurück.
+     * @return Beschreibung des Fehlers.
+     *
+     * @author Daniel Schukin
+     */
+    QString errorString() const { return file.errorString(); }
+
+    /**
+     * @brief Schneidet ein neues oder geladenes Spielfeld als BOARD mit.
+     * @param event BOARD-Ereignis mit Anzeigeebene und Zählern.
+     *
+     * @author Daniel Schukin
+     */
+    void recordBoard(const EngineEvent &event);
+
+    /**
+     * @brief Schneidet einen Zug als DELTA mit, bei Bedarf gefolgt von einem KEYFRAME.
+     * @param event MOVE-Ereignis.
+     *
+     * @author Daniel Schukin
+     */
+    void recordMove(const EngineEvent &event);
+
+private:
+    /// @brief Vom Schreib-Thread noch zu kodierender Datensatz.
+    struct Pending
+    {
+        DeltaFormat::Kind kind = DeltaFormat::DELTA; ///< Art des Datensatzes.
+        quint64 timeDelta = 0;   ///< Zeit seit dem vorherigen Datensatz in ms.
+        quint64 state = 0;       ///< Spielzeit << STATE_BITS | STATE_*.
+        int markedCells = 0;     ///< Anzahl der markierten Zellen.
+        QVector<CellUpdate> cells; ///< Geänderte Zellen (bei DELTA; implizit geteilt).
+        int minesNumber = 0;     ///< Anzahl der Minen (bei BOARD und KEYFRAME).
+        quint64 moves = 0;       ///< Züge seit BOARD (bei BOARD und KEYFRAME).
+        BoardPlane plane;        ///< Anzeigeebene (bei BOARD und KEYFRAME; Copy-on-Write-Kopie).
+    };
+
+    /**
+     * @brief Reiht einen vollständigen Stand ein.
+     * @param kind BOARD oder KEYFRAME.
+     * @param event Ereignis mit Anzeigeebene und Zählern.
+     *
+     * @author Daniel Schukin
+     */
+    void pushKeyframe(DeltaFormat::Kind kind, const EngineEvent &event);
+
+    /**
+     * @brief Erzeugt einen vollständigen Stand.
+     * @param kind BOARD oder KEYFRAME.
+     * @param event Ereignis mit Anzeigeebene und Zählern.
+     * @return Datensatz.
+     *
+     * @author Daniel Schukin
+     */
+    Pending makeKeyframe(DeltaFormat::Kind kind, const EngineEvent &event);
+
+    /**
+     * @brief Hängt einen Datensatz an die Warteschlange an.
+     * @param pending Datensatz; wird nur bei Erfolg verschoben.
+     * @return False, wenn die Schlange voll ist.
+     *
+     * @author Daniel Schukin
+     */
+    bool push(Pending &pending);
+
+    /**
+     * @brief Gibt die Zeit seit dem vorherigen Datensatz zurück und merkt sich den Zeitpunkt.
+     * @return Zeit in ms.
+     *
+     * @author Daniel Schukin
+     */
+    quint64 takeTimeDelta();
+
+    /**
+     * @brief Schleife des Schreib-Threads.
+     *
+     * @author Daniel Schukin
+     */
+    void run();
+
+    /**
+     * @brief Kodiert einen Zug als Datensatz.
+     * @param pending Zug.
+     * @param width Breite des Spielfelds für den Zellindex.
+     * @param sorted Zwischenspeicher für Zellindex << 8 | Code.
+     * @param body Zwischenspeicher für den Datensatz ohne Längenangabe.
+     * @param out Ausgabepuffer.
+     *
+     * @author Daniel Schukin
+     */
+    static void encodeDelta(const Pending &pending, int width, QVector<quint64> &sorted, QByteArray &body,
+                            QByteArray &out);
+
+    /**
+     * @brief Kodiert einen vollständigen Stand als Datensatz.
+     * @param pending BOARD oder KEYFRAME.
+     * @param body Zwischenspeicher für den Datensatz ohne Längenangabe.
+     * @param out Ausgabepuffer.
+     *
+     * @author Daniel Schukin
+     */
+    static void encodeKeyframe(const Pending &pending, QByteArray &body, QByteArray &out);
+
+    QThread *thread = nullptr; ///< Schreib-Thread; nullptr, wenn nicht mitgeschnitten wird.
+    QFile file; ///< Datei des Mitschnitts; gehört nach start() dem Schreib-Thread.
+    QElapsedTimer clock; ///< Zeit seit Beginn des Mitschnitts.
+    qint64 lastTime = 0; ///< Zeitpunkt des vorherigen Datensatzes in ms.
+    qint64 cells = 0; ///< Anzahl der Zellen des Spielfelds; 0, wenn es nicht mitgeschnitten wird.
+    quint64 moves = 0; ///< Züge seit BOARD.
+    int movesSinceKeyframe = 0; ///< Züge seit dem letzten vollständigen Stand.
+    qint64 changesSinceKeyframe = 0; ///< Geänderte Zellen seit dem letzten vollständigen Stand.
+
+    DeltaFormat::Kind catchUp = DeltaFormat::DELTA; ///< Art des vollständigen Stands, der verworfene Datensätze ersetzt; DELTA, wenn keiner fehlt.
+    Pending overflow; ///< Letzter vollständiger Stand, der nicht in die Schlange passte (bei catchUp != DELTA).
+    int dropped = 0; ///< Seit start() verworfene Datensätze.
+
+    SpscQueue<Pending> queue{QUEUE_CAPACITY}; ///< Noch nicht geschriebene Datensätze; Erzeuger ist der Engine-Thread.
+    QSemaphore stop; ///< Von finish() freigegeben; beendet das Warten des Schreib-Threads.
+};
+
+#endif // DELTARECORDER_H
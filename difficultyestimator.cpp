@@ -0,0 +1,177 @@
+#include "difficultyestimator.h"
+#include "batchenvironment.h"
+#include "gamesolver.h"
+#include "tracing.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QThread>
+
+/**
+ * @brief Konstruktor für DifficultyEstimator. Startet den Schätz-Thread.
+ * @param parent Übergeordnetes Objekt.
+ */
+DifficultyEstimator::DifficultyEstimator(QObject *parent)
+    : QObject(parent)
+{
+    thread = QThread::create([this]() { run(); });
+    thread->start(QThread::LowPriority);
+}
+
+/**
+ * @brief Destruktor für DifficultyEstimator. Bricht eine laufende Schätzung ab und beendet den Thread.
+ *
+ * Eine laufende Serie bemerkt das nach dem aktuellen Zug, der Destruktor wartet also nicht auf
+ * ihr Ende.
+ */
+DifficultyEstimator::~DifficultyEstimator() {
+    {
+        QMutexLocker locker(&mutex);
+        quitting = true;
+        wake.wakeOne();
+    }
+    thread->wait();
+    delete thread;
+}
+
+/**
+ * @brief Fordert eine Schätzung an; wartet nie auf den Schätz-Thread.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @param minesNumber Anzahl der Minen.
+ * @param estimate Gibt das zwischengespeicherte Ergebnis zurück, falls vorhanden.
+ * @return True, wenn das Ergebnis schon vorlag.
+ *
+ * Eine neue Anforderung ersetzt eine noch nicht abgeholte und bricht eine laufende Serie ab,
+ * auch wenn die neue Konfiguration schon zwischengespeichert ist.
+ */
+bool DifficultyEstimator::request(int length, int width, int minesNumber, Estimate &estimate) {
+    QMutexLocker locker(&mutex);
+    requestedGeneration++;
+    const auto it = cache.constFind(generateKey(length, width, minesNumber));
+    if (it != cache.constEnd()) {
+        estimate = it.value();
+        pending = false;
+        return true;
+    }
+    requestedLength = length;
+    requestedWidth = width;
+    requestedMines = minesNumber;
+    pending = true;
+    wake.wakeOne();
+    return false;
+}
+
+/**
+ * @brief Gibt ein zwischengespeichertes Ergebnis zurück.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @param minesNumber Anzahl der Minen.
+ * @param estimate Gibt das Ergebnis zurück, falls vorhanden.
+ * @return True, wenn für die Konfiguration ein Ergebnis vorliegt.
+ */
+bool DifficultyEstimator::cached(int length, int width, int minesNumber, Estimate &estimate) {
+    QMutexLocker locker(&mutex);
+    const auto it = cache.constFind(generateKey(length, width, minesNumber));
+    if (it == cache.constEnd()) {
+        return false;
+    }
+    estimate = it.value();
+    return true;
+}
+
+/**
+ * @brief Schleife des Schätz-Threads.
+ *
+ * Holt die neueste Anforderung und spielt ihre Serie ohne Sperre. Nur vollständige Serien
+ * kommen in den Zwischenspeicher.
+ */
+void DifficultyEstimator::run() {
+    while (true) {
+        int length, width, minesNumber;
+        quint64 generation;
+        {
+            QMutexLocker locker(&mutex);
+            while (!pending && !quitting) {
+                wake.wait(&mutex);
+            }
+            if (quitting) {
+                return;
+            }
+            length = requestedLength;
+            width = requestedWidth;
+            minesNumber = requestedMines;
+            generation = requestedGeneration;
+            pending = false;
+        }
+
+        Estimate result;
+        if (!estimate(length, width, minesNumber, generation, result)) {
+            continue; ///< überholt, die neue Anforderung liegt schon bereit
+        }
+        {
+            QMutexLocker locker(&mutex);
+            cache.insert(generateKey(length, width, minesNumber), result);
+        }
+        emit estimateReady(length, width, minesNumber);
+    }
+}
+
+/**
+ * @brief Spielt die Serie für eine Konfiguration.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @param minesNumber Anzahl der Minen.
+ * @param generation Nummer der Anforderung.
+ * @param estimate Gibt das Ergebnis zurück.
+ * @return False, wenn die Serie abgebrochen wurde.
+ *
+ * Spiel i hat immer den Seed BatchEnvironment::episodeSeed(ESTIMATE_SEED, 0, i); bricht das
+ * Zeitbudget ab, ist das Ergebnis also der Anfang derselben Serie.
+ */
+bool DifficultyEstimator::estimate(int length, int width, int minesNumber, quint64 generation, Estimate &estimate) {
+    TRACE_SPAN("estimator.estimate");
+    if (length < 1 || width < 1 || minesNumber < 1 || minesNumber >= length * width) {
+        return true; ///< ungültige Konfiguration: leeres Ergebnis, damit sie nicht erneut angefordert wird
+    }
+    QElapsedTimer clock;
+    clock.start();
+    BatchEnvironment env(1, length, width, minesNumber, ESTIMATE_SEED);
+    GameSolver solver(length, width, minesNumber);
+    qint64 bbbvTotal = 0;
+    for (int game = 0; game < ESTIMATE_GAMES && (game == 0 || clock.elapsed() < ESTIMATE_BUDGET); game++) {
+        env.startEpisode(0, quint32(game));
+        solver.reset();
+        for (;;) {
+            if (quitting || requestedGeneration.load(std::memory_order_relaxed) != generation) {
+                return false;
+            }
+            const qint32 action = solver.next(env.observations()).cell;
+            if (action < 0) {
+                break;
+            }
+            env.step(&action, false);
+            if (env.dones()[0]) {
+                estimate.wins += env.wins()[0];
+                break;
+            }
+        }
+        estimate.games++;
+        bbbvTotal += env.getBbbv(0);
+    }
+    estimate.bbbv = double(bbbvTotal) / estimate.games;
+    return true;
+}
+
+/**
+ * @brief Erzeugt den Schlüssel einer Konfiguration für den Zwischenspeicher.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @param minesNumber Anzahl der Minen.
+ * @return Schlüssel aus Zeilen, Spalten und Minen.
+ *
+ * Eine Zahl statt des Textschlüssels von GameStatistics, weil bei jedem Schritt eines
+ * Schiebereglers nachgeschlagen wird.
+ */
+quint64 DifficultyEstimator::generateKey(int length, int width, int minesNumber) {
+    return quint64(quint16(length)) << 48 | quint64(quint16(width)) << 32 | quint32(minesNumber);
+}
@@ -0,0 +1,155 @@
+#ifndef DIFFICULTYESTIMATOR_H
+#define DIFFICULTYESTIMATOR_H
+
+#include <QObject>
+#include <QMap>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+
+class QThread;
+
+/**
+ * @file difficultyestimator.h
+ * @class DifficultyEstimator
+ * @brief Schätzt in einem eigenen Thread, wie schwer eine Spielfeldkonfiguration ist.
+ *
+ * Für eine Konfiguration spielt GameSolver eine kurze Serie von Spielen mit festen Seeds auf
+ * einer BatchEnvironment und liefert die Gewinnrate und das mittlere 3BV. Ergebnisse werden
+ * pro Konfiguration zwischengespeichert; eine schon geschätzte Konfiguration kostet nichts mehr.
+ *
+ * Technische Entscheidung:
+ * Wie bei BoardRenderer gilt nur die neueste Anforderung. request() legt sie unter einer kurzen
+ * Sperre ab und kehrt sofort zurück, ein Schieberegler kann also beliebig schnell bewegt werden.
+ * Der Schätz-Thread prüft nach jedem Zug, ob inzwischen etwas anderes angefordert wurde, und
+ * verwirft dann die angefangene Serie, statt sie zu Ende zu spielen. Der Thread läuft mit
+ * niedriger Priorität, damit die Oberfläche auch auf einem Kern flüssig bleibt.
+ *
+ * Eine Serie endet nach ESTIMATE_GAMES Spielen oder nach ESTIMATE_BUDGET ms, je nachdem, was
+ * zuerst eintritt; große Spielfelder werden so mit weniger Spielen, aber rechtzeitig geschätzt.
+ *
+ * Abhängigkeit: GameSolver und BatchEnvironment; gehört dem MainWindow und wird dem
+ * SettingsDialog übergeben.
+ *
+ * @author Daniel Schukin
+ */
+class DifficultyEstimator : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int ESTIMATE_GAMES = 1000; ///< Höchstens so viele Spiele pro Schätzung.
+    static constexpr int ESTIMATE_BUDGET = 400; ///< Höchstens so viele ms pro Schätzung.
+    static constexpr quint64 ESTIMATE_SEED = 0x5533; ///< Grundseed; gleiche Konfigurationen ergeben gleiche Spiele.
+
+    /// @brief Ergebnis einer Schätzung.
+    struct Estimate
+    {
+        int games = 0;      ///< Gespielte Spiele.
+        int wins = 0;       ///< Davon gewonnen.
+        double bbbv = 0.0;  ///< Mittleres 3BV der Spielfelder.
+
+        /**
+         * @brief Gibt die geschätzte Gewinnwahrscheinlichkeit zurück.
+         * @return Anteil gewonnener Spiele zwischen 0 und 1.
+         *
+         * @author Daniel Schukin
+         */
+        double winRate() const { return games > 0 ? double(wins) / games : 0.0; }
+    };
+
+    /**
+     * @brief Konstruktor für DifficultyEstimator. Startet den Schätz-Thread.
+     * @param parent Übergeordnetes Objekt.
+     *
+     * @author Daniel Schukin
+     */
+    explicit DifficultyEstimator(QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor für DifficultyEstimator. Bricht eine laufende Schätzung ab und beendet den Thread.
+     *
+     * @author Daniel Schukin
+     */
+    ~DifficultyEstimator();
+
+    /**
+     * @brief Fordert eine Schätzung an; wartet nie auf den Schätz-Thread.
+     * @param length Anzahl der Zeilen.
+     * @param width Anzahl der Spalten.
+     * @param minesNumber Anzahl der Minen.
+     * @param estimate Gibt das zwischengespeicherte Ergebnis zurück, falls vorhanden.
+     * @return True, wenn das Ergebnis schon vorlag; sonst folgt später estimateReady().
+     *
+     * @author Daniel Schukin
+     */
+    bool request(int length, int width, int minesNumber, Estimate &estimate);
+
+    /**
+     * @brief Gibt ein zwischengespeichertes Ergebnis zurück.
+     * @param length Anzahl der Zeilen.
+     * @param width Anzahl der Spalten.
+     * @param minesNumber Anzahl der Minen.
+     * @param estimate Gibt das Ergebnis zurück, falls vorhanden.
+     * @return True, wenn für die Konfiguration ein Ergebnis vorliegt.
+     *
+     * @author Daniel Schukin
+     */
+    bool cached(int length, int width, int minesNumber, Estimate &estimate);
+
+signals:
+    /**
+     * @brief Wird aus dem Schätz-Thread gesendet, wenn eine Schätzung fertig ist.
+     * @param length Anzahl der Zeilen.
+     * @param width Anzahl der Spalten.
+     * @param minesNumber Anzahl der Minen.
+     *
+     * @author Daniel Schukin
+     */
+    void estimateReady(int length, int width, int minesNumber);
+
+private:
+    /**
+     * @brief Schleife des Schätz-Threads.
+     *
+     * @author Daniel Schukin
+     */
+    void run();
+
+    /**
+     * @brief Spielt die Serie für eine Konfiguration.
+     * @param length Anzahl der Zeilen.
+     * @param width Anzahl der Spalten.
+     * @param minesNumber Anzahl der Minen.
+     * @param generation Nummer der Anforderung; ändert sich requestedGeneration, wird abgebrochen.
+     * @param estimate Gibt das Ergebnis zurück.
+     * @return False, wenn die Serie abgebrochen wurde.
+     *
+     * @author Daniel Schukin
+     */
+    bool estimate(int length, int width, int minesNumber, quint64 generation, Estimate &estimate);
+
+    /**
+     * @brief Erzeugt den Schlüssel einer Konfiguration für den Zwischenspeicher.
+     * @param length Anzahl der Zeilen.
+     * @param width Anzahl der Spalten.
+     * @param minesNumber Anzahl der Minen.
+     * @return Schlüssel aus Zeilen, Spalten und Minen.
+     *
+     * @author Daniel Schukin
+     */
+    static quint64 generateKey(int length, int width, int minesNumber);
+
+    QThread *thread; ///< Schätz-Thread.
+    QMutex mutex; ///< Schützt Anforderung und Zwischenspeicher.
+    QWaitCondition wake; ///< Weckt den Schätz-Thread bei einer neuen Anforderung.
+    QMap<quint64, Estimate> cache; ///< Fertige Schätzungen. Key: siehe generateKey().
+    int requestedLength = 0; ///< Zeilen der neuesten Anforderung.
+    int requestedWidth = 0; ///< Spalten der neuesten Anforderung.
+    int requestedMines = 0; ///< Minen der neuesten Anforderung.
+    std::atomic<quint64> requestedGeneration{0}; ///< Nummer der neuesten Anforderung, ohne Sperre lesbar.
+    bool pending = false; ///< True, solange die neueste Anforderung nicht abgeholt wurde.
+    std::atomic<bool> quitting{false}; ///< True, sobald der Schätz-Thread enden soll.
+};
+
+#endif // DIFFICULTYESTIMATOR_H
@@ -0,0 +1,98 @@
+#include "framemonitor.h"
+#include <QFile>
+
+/**
+ * @brief Konstruktor, startet die Uhr.
+ */
+FrameMonitor::FrameMonitor() {
+    clock.start();
+}
+
+/**
+ * @brief Merkt den Zeitpunkt einer Eingabe.
+ *
+ * Folgt ein zweiter Klick, bevor das Bild zum ersten fertig ist, zählt der frühere Zeitpunkt;
+ * die Wartezeit des ersten Klicks ginge sonst verloren.
+ */
+void FrameMonitor::inputStarted() {
+    if (inputTime < 0) {
+        inputTime = now();
+    }
+}
+
+/**
+ * @brief Meldet, dass die Antwort auf einen Klick angezeigt wird.
+ * @param changed True, wenn dabei Zellen geändert wurden.
+ *
+ * Ohne Änderung (z.B. Rechtsklick auf eine aufgedeckte Zelle) zeichnet Qt kein neues Bild; der
+ * Klick wird verworfen, es sei denn, ein früherer Klick wartet schon auf sein Bild.
+ */
+void FrameMonitor::inputApplied(bool changed) {
+    if (changed) {
+        inputAnswered = inputTime >= 0;
+    } else if (!inputAnswered) {
+        inputTime = -1;
+    }
+}
+
+/**
+ * @brief Beendet die Latenz eines beantworteten Klicks, sobald sein Zug gezeichnet ist.
+ *
+ * Ruft BoardView::paintEvent() über BoardView::movePainted() auf, also noch während des
+ * Zeichnens des Fensters; gemessen wird wie bei endFrame() bis ins Backing Store.
+ */
+void FrameMonitor::inputPainted() {
+    if (inputAnswered) {
+        latency.record(now() - inputTime);
+        inputTime = -1;
+        inputAnswered = false;
+    }
+}
+
+/**
+ * @brief Merkt den Beginn des Zeichnens.
+ */
+void FrameMonitor::beginFrame() {
+    frameStart = now();
+}
+
+/**
+ * @brief Zählt das fertige Bild.
+ */
+void FrameMonitor::endFrame() {
+    frameTime.record(now() - frameStart);
+    framesSinceHud++;
+}
+
+/**
+ * @brief Erstellt den Text für die Leistungsanzeige.
+ * @return p50/p99 der Latenz und der Bildzeit sowie die Bilder pro Sekunde seit dem letzten Aufruf.
+ */
+QString FrameMonitor::hudText() {
+    const qint64 time = now();
+    const double fps = time > lastHudTime ? framesSinceHud * 1e6 / (time - lastHudTime) : 0.0;
+    framesSinceHud = 0;
+    lastHudTime = time;
+    return QString("Klick→Bild p50 %1 ms  p99 %2 ms\nBild p50 %3 ms  p99 %4 ms\n%5 FPS")
+        .arg(latency.valueAtPercentile(50) / 1000.0, 0, 'f', 1)
+        .arg(latency.valueAtPercentile(99) / 1000.0, 0, 'f', 1)
+        .arg(frameTime.valueAtPercentile(50) / 1000.0, 0, 'f', 1)
+        .arg(frameTime.valueAtPercentile(99) / 1000.0, 0, 'f', 1)
+        .arg(fps, 0, 'f', 1);
+}
+
+/**
+ * @brief Schreibt beide Histogramme in eine Textdatei.
+ * @param filePath Pfad der Datei.
+ * @return True bei Erfolg.
+ */
+bool FrameMonitor::writeToFile(const QString &filePath) const {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+    latency.write(out, "Klick bis fertiges Bild (ms)");
+    frameTime.write(out, "Zeichnen pro Bild (ms)");
+    return true;
+}
@@ -0,0 +1,122 @@
+#ifndef FRAMEMONITOR_H
+#define FRAMEMONITOR_H
+
+#include "latencyhistogram.h"
+#include <QElapsedTimer>
+#include <QString>
+
+/**
+ * @file framemonitor.h
+ * @class FrameMonitor
+ * @brief Misst die Zeit vom Klick bis zum fertig gezeichneten Bild und die Dauer jedes Bildes.
+ *
+ * Ablauf:
+ * - inputStarted() beim Mausdruck auf eine Zelle (BoardView::mousePressEvent),
+ * - inputApplied(), sobald das Ereignis der Engine zu dem Klick angezeigt wird oder feststeht,
+ *   dass der Klick keinen Befehl auslöst,
+ * - inputPainted(), sobald BoardView ein Bild gezeichnet hat, das den Zug enthält
+ *   (BoardView::movePainted()),
+ * - beginFrame()/endFrame() um das Zeichnen des Fensters (QEvent::UpdateRequest in MainWindow).
+ * Erst das Bild mit dem Zug beendet die Latenz des Klicks; Bilder aus anderem Anlass (z.B. die
+ * Zeitanzeige), die noch das alte Bild des Renderers zeigen, lassen sie offen. Ein Klick ohne
+ * geänderte Zellen braucht kein neues Bild und wird verworfen. Beide Messungen landen in je
+ * einem LatencyHistogram.
+ *
+ * Technische Entscheidung:
+ * Qt zeichnet alle geänderten Widgets eines Fensters gesammelt bei einem UpdateRequest; erst
+ * danach ist das Bild im Backing Store und damit beim Fenstersystem. Gemessen wird also bis
+ * einschließlich Zeichnen, ohne das Warten auf den Bildschirm-Refresh.
+ *
+ * Abhängigkeit: wird nur vom MainWindow verwendet.
+ *
+ * @author Daniel Schukin
+ */
+class FrameMonitor
+{
+public:
+    /**
+     * @brief Konstruktor, startet die Uhr.
+     *
+     * @author Daniel Schukin
+     */
+    FrameMonitor();
+
+    /**
+     * @brief Merkt den Zeitpunkt einer Eingabe; ein noch offener Klick bleibt bestehen.
+     *
+     * @author Daniel Schukin
+     */
+    void inputStarted();
+
+    /**
+     * @brief Meldet, dass die Antwort auf einen Klick angezeigt wird.
+     * @param changed True, wenn dabei Zellen geändert wurden; sonst wird ein offener Klick verworfen.
+     *
+     * @author Daniel Schukin
+     */
+    void inputApplied(bool changed);
+
+    /**
+     * @brief Beendet die Latenz eines beantworteten Klicks, sobald sein Zug gezeichnet ist.
+     *
+     * @author Daniel Schukin
+     */
+    void inputPainted();
+
+    /**
+     * @brief Merkt den Beginn des Zeichnens.
+     *
+     * @author Daniel Schukin
+     */
+    void beginFrame();
+
+    /**
+     * @brief Zählt das fertige Bild.
+     *
+     * @author Daniel Schukin
+     */
+    void endFrame();
+
+    /**
+     * @brief Erstellt den Text für die Leistungsanzeige.
+     * @return p50/p99 der Latenz und der Bildzeit sowie die Bilder pro Sekunde seit dem letzten Aufruf.
+     *
+     * @author Daniel Schukin
+     */
+    QString hudText();
+
+    /**
+     * @brief Schreibt beide Histogramme in eine Textdatei.
+     * @param filePath Pfad der Datei.
+     * @return True bei Erfolg.
+     *
+     * @author Daniel Schukin
+     */
+    bool writeToFile(const QString &filePath) const;
+
+    /// @name Getter
+    /// @{
+    const LatencyHistogram &getLatency() const { return latency; }
+    const LatencyHistogram &getFrameTime() const { return frameTime; }
+    /// @}
+
+private:
+    /**
+     * @brief Gibt die Zeit seit dem Start zurück.
+     * @return Zeit in µs.
+     *
+     * @author Daniel Schukin
+     */
+    qint64 now() const { return clock.nsecsElapsed() / 1000; }
+
+    QElapsedTimer clock; ///< Gemeinsame Uhr aller Messungen.
+    LatencyHistogram latency; ///< Zeit vom Klick bis zum fertigen Bild.
+    LatencyHistogram frameTime; ///< Dauer des Zeichnens pro Bild.
+    qint64 inputTime = -1; ///< Zeitpunkt des offenen Klicks, -1 wenn keiner offen ist.
+    bool inputAnswered = false; ///< True, sobald geänderte Zellen zum offenen Klick angezeigt werden.
+    qint64 frameStart = 0; ///< Beginn des aktuellen Bildes.
+    qint64 framesSinceHud = 0; ///< Bilder seit dem letzten hudText().
+    qint64 lastHudTime = 0; ///< Zeitpunkt des letzten hudText().
+};
+
+#endif // FRAMEMONITOR_H
@@ -1,16 +1,21 @@
 #include "game.h"
 #include "gamestatistics.h"
 #include "cell.h"
+#include "boardlayout.h"
+#include "boardkernels.h"
+#include "boardplane.h"
 #include <QRandomGenerator>
 #include <algorithm>
+#include <array>
 #include <QDebug>
+#include "tracing.h"
 
 /**
  * @brief Standardkonstruktor der Game-Klasse.
  *
- * Initialisiert das Statistik-Objekt.
+ * Initialisiert das Statistik-Objekt, ohne gespeicherte Statistiken zu laden.
  */
-Game::Game() {
+Game::Game() : gridLength(10), gridWidth(10), minesNumber(10) {
     gameStatistics = new GameStatistics();
 }
 
@@ -43,14 +48,53 @@ Game::~Game() {
  * @param width Anzahl der Spalten.
  */
 void Game::createMatrix(int length, int width) {
-    this->gameMatrix.clear(); ///< die Matrix löschen, falls schon gespielt wurde
-    ///< die Matrix mit neuen Zellen einfüllen
+    TRACE_SPAN("game.createMatrix");
+    ///< die Schleifen für diese Spielfeldgröße werden einmal pro Spielfeld gewählt
+    this->kernels = &BoardKernels::select(length, width);
+    this->stride = BoardLayout::stride(width);
+    this->cellsNumber = BoardLayout::paddedSize(length, width);
+
+    ///< kleine Spielfelder (alle Schwierigkeitsgrade) liegen im festen Speicher des Game-Objekts
+    if (cellsNumber <= PRESET_CELLS) {
+        this->gameMatrix.clear();
+        this->gameMatrix.squeeze();
+        this->cells = presetMatrix.data();
+    } else {
+        this->gameMatrix.resize(cellsNumber);
+        this->cells = gameMatrix.data();
+    }
+
+    ///< die Matrix mit neuen Zellen einfüllen, der Rand besteht aus aufgedeckten Sentinel-Zellen;
+    ///< jede Zelle wird nur einmal geschrieben, das Innere einer Zeile als ein Block
+    const Cell sentinel(0, false, false, false, false);
+    std::fill(cells, cells + stride, sentinel);
     for (int i = 0; i < length; i++) {
-        this->gameMatrix.append(QVector<Cell>());
-        for (int j = 0; j < width; j++) {
-            this->gameMatrix[i].append(Cell());
-        }
+        Cell *row = cells + cellIndex(i, 0);
+        row[-1] = sentinel;
+        std::fill(row, row + width, Cell());
+        row[width] = sentinel;
     }
+    std::fill(cells + cellsNumber - stride, cells + cellsNumber, sentinel);
+    this->firstClick = true; ///< der erste Klick auf dem neuen Spielfeld ist wieder geschützt
+    this->openingsLabeled = false;
+    resetArena();
+}
+
+/**
+ * @brief Leert alle Puffer des letzten Spiels und setzt die Arena zurück.
+ *
+ * Die Puffer werden durch leere Vektoren ohne Kapazität ersetzt, bevor die Arena ihren
+ * Speicher auf einmal freigibt.
+ */
+void Game::resetArena() {
+    journal.clear();
+    ArenaVector<int>(&arena).swap(openingOf);
+    ArenaVector<int>(&arena).swap(openingStart);
+    ArenaVector<int>(&arena).swap(openingCells);
+    ArenaVector<QPoint>(&arena).swap(changed_cells);
+    ArenaVector<QPoint>(&arena).swap(floodPending);
+    arena.reset();
+    openingStart.assign(1, 0);
 }
 
 /**
@@ -78,51 +122,326 @@ void Game::changeMinesNumber(int minesNumber) {
 }
 
 /**
- * @brief Setzt die Anzahl der markierten und geöffneten Zellen bei neuem Spiel zurück.
+ * @brief Setzt die Zähler der geöffneten und markierten Zellen bei neuem Spiel zurück.
  */
 void Game::resetMarkedCells() {
-    this->openedCells = 0;
-    this->markedCells = 0;
+    this->safeRevealed = 0;
+    this->correctFlags = 0;
+    this->wrongFlags = 0;
+    this->undone = false;
+    this->assisted = false;
     this->inGame = true;
 }
 
 /**
  * @brief Platziert zufällig Minen auf dem Spielfeld.
  *
- * Stellt sicher, dass jede Mine an einer anderen Zelle platziert wird.
+ * Wählt einen neuen zufälligen Seed, siehe place_mines(quint64).
  */
 void Game::place_mines() {
+    place_mines(QRandomGenerator::global()->generate64());
+}
+
+/**
+ * @brief Platziert die Minen reproduzierbar aus einem Seed.
+ * @param seed Seed für den Zufallsgenerator des Spiels.
+ *
+ * Stellt sicher, dass jede Mine an einer anderen Zelle platziert wird. Derselbe Seed ergibt
+ * bei gleichen Einstellungen dasselbe Spielfeld, auch nach dem Verschieben der Minen beim
+ * ersten Klick.
+ */
+void Game::place_mines(quint64 seed) {
+    TRACE_SPAN("game.place_mines");
+    seed_random(seed);
+
     int counter = 0; ///< counter für schon platzierte Minen
     int rand_row, rand_col; ///< Zeile, Spalte für die Minen
 
     ///< platziert die Minen in den zufälligen, nicht gleichen Zellen und inkrementiert den counter
     while (counter < getMinesNumber()) {
-        rand_row = QRandomGenerator::global()->bounded(getLength());
-        rand_col = QRandomGenerator::global()->bounded(getWidth());
-        if (!gameMatrix[rand_row][rand_col].is_mined()) {
-            gameMatrix[rand_row][rand_col].set_mined(true);
+        rand_row = rng.bounded(getLength());
+        rand_col = rng.bounded(getWidth());
+        if (!cells[cellIndex(rand_row, rand_col)].is_mined()) {
+            cells[cellIndex(rand_row, rand_col)].set_mined(true);
             counter++;
         }
     }
 }
 
+/**
+ * @brief Startet den Zufallsgenerator des Spiels mit einem Seed.
+ * @param seed Neuer Seed, alle 64 Bit werden verwendet.
+ */
+void Game::seed_random(quint64 seed) {
+    this->seed = seed;
+    const quint32 seedWords[2] = {quint32(seed), quint32(seed >> 32)};
+    this->rng = QRandomGenerator(seedWords, seedWords + 2);
+}
+
 /**
  * @brief Zählt die Anzahl der Minen um jede Zelle und speichert die Werte.
  */
 void Game::count_mines_around() {
-    ///< geht durch die Matrix
-    for (int i = 0; i < getLength(); i++) {
-        for (int j = 0; j < getWidth(); j++) {
-            int mines_counter = 0; ///< counter für die Minen rund um die Zelle
-            ///< geht durch die Zellen herum
-            for (int row = std::max(0, i - 1); row < std::min(getLength(), i + 2); row++) {
-                for (int col = std::max(0, j - 1); col < std::min(getWidth(), j + 2); col++) {
-                    if (gameMatrix[row][col].is_mined()) {
-                        mines_counter++;
-                    }
-                }
+    TRACE_SPAN("game.count_mines_around");
+    kernels->countMinesAround(cells, getLength(), getWidth());
+}
+
+/**
+ * @brief Sorgt dafür, dass der erste Klick keine Mine trifft.
+ * @param row Zeilenindex der zuerst geklickten Zelle.
+ * @param col Spaltenindex der zuerst geklickten Zelle.
+ *
+ * Statt das Spielfeld neu zu generieren, werden nur die Minen aus der geschützten Zone
+ * verschoben. Ist das Spielfeld zu voll für eine freie 3x3-Umgebung, wird nur die
+ * geklickte Zelle geschützt.
+ */
+void Game::protect_first_click(int row, int col) {
+    int top = row, bottom = row + 1, left = col, right = col + 1; ///< Grenzen der geschützten Zone
+    if (is_safeOpening()) {
+        int zoneRows = std::min(getLength(), row + 2) - std::max(0, row - 1);
+        int zoneCols = std::min(getWidth(), col + 2) - std::max(0, col - 1);
+        ///< nur wenn außerhalb der 3x3-Umgebung genug Platz für alle Minen ist
+        if (getLength() * getWidth() - zoneRows * zoneCols >= getMinesNumber()) {
+            top = std::max(0, row - 1);
+            bottom = std::min(getLength(), row + 2);
+            left = std::max(0, col - 1);
+            right = std::min(getWidth(), col + 2);
+        }
+    }
+    ///< bei einem komplett verminten Spielfeld gibt es keinen freien Platz
+    if (getLength() * getWidth() - (bottom - top) * (right - left) < getMinesNumber()) {
+        return;
+    }
+
+    ///< verschiebt jede Mine der Zone an eine zufällige freie Zelle außerhalb der Zone
+    for (int i = top; i < bottom; i++) {
+        for (int j = left; j < right; j++) {
+            if (!cells[cellIndex(i, j)].is_mined()) {
+                continue;
+            }
+            int rand_row, rand_col; ///< Zeile, Spalte für die neue Mine
+            do {
+                rand_row = rng.bounded(getLength());
+                rand_col = rng.bounded(getWidth());
+            } while (cells[cellIndex(rand_row, rand_col)].is_mined()
+                     || (rand_row >= top && rand_row < bottom && rand_col >= left && rand_col < right));
+            move_mine(i, j, rand_row, rand_col);
+        }
+    }
+}
+
+/**
+ * @brief Verschiebt eine Mine und repariert die Minenzahlen der beiden Nachbarschaften.
+ * @param fromRow Zeile der Mine.
+ * @param fromCol Spalte der Mine.
+ * @param toRow Zeile der neuen Zelle.
+ * @param toCol Spalte der neuen Zelle.
+ */
+void Game::move_mine(int fromRow, int fromCol, int toRow, int toCol) {
+    count_flag(cells[cellIndex(fromRow, fromCol)], -1); ///< eine Markierung wechselt dabei zwischen richtig und falsch
+    cells[cellIndex(fromRow, fromCol)].set_mined(false);
+    count_flag(cells[cellIndex(fromRow, fromCol)], +1);
+    adjust_mines_around(fromRow, fromCol, -1);
+    count_flag(cells[cellIndex(toRow, toCol)], -1);
+    cells[cellIndex(toRow, toCol)].set_mined(true);
+    count_flag(cells[cellIndex(toRow, toCol)], +1);
+    adjust_mines_around(toRow, toCol, +1);
+}
+
+/**
+ * @brief Zählt eine Zelle zu den Zählern der aufgedeckten und markierten Zellen.
+ * @param cell Betroffene Zelle.
+ * @param delta +1 zum Hinzuzählen, -1 zum Abziehen.
+ *
+ * Vor einer Änderung mit -1 und danach mit +1 aufgerufen, hält das alle Zähler aktuell.
+ */
+void Game::count_cell(const Cell &cell, int delta) {
+    if (!cell.is_hidden() && !cell.is_mined()) {
+        safeRevealed += delta;
+    }
+    count_flag(cell, delta);
+}
+
+/**
+ * @brief Schaltet die im Protokoll gespeicherten Bits eines Zugs um.
+ * @param move Nummer des Zugs im Protokoll.
+ *
+ * Da jedes Bit nur umgeschaltet wird, macht derselbe Aufruf einen Zug rückgängig oder wiederholt ihn.
+ */
+void Game::apply_move(int move) {
+    for (const GameJournal::Run *run = journal.runsBegin(move); run != journal.runsEnd(move); run++) {
+        for (int index = run->start; index < run->start + run->length; index++) {
+            Cell &cell = cells[index];
+            count_cell(cell, -1);
+            if (run->mask & GameJournal::HIDDEN) {
+                cell.set_hidden(!cell.is_hidden());
+            }
+            if (run->mask & GameJournal::MARKED) {
+                cell.set_marked(!cell.is_marked());
+            }
+            if (run->mask & GameJournal::EXPLODED) {
+                cell.set_exploded(!cell.is_exploded());
+            }
+            count_cell(cell, +1);
+            cellChanged(index);
+        }
+    }
+}
+
+/**
+ * @brief Macht den letzten Zug rückgängig.
+ * @return True, wenn ein Zug rückgängig gemacht wurde.
+ *
+ * Ein gewonnenes oder abgebrochenes Spiel bleibt beendet. Hat der Zug das Spiel verloren, wird das Ergebnis aus
+ * der Statistik genommen und das Spiel läuft weiter. Ab jetzt zählt das Spiel nicht mehr für
+ * die Bestzeit.
+ */
+bool Game::undo() {
+    TRACE_SPAN("game.undo");
+    if (!journal.canUndo()) {
+        return false;
+    }
+    ///< nur ein durch einen Zug verlorenes Spiel läuft weiter, kein gewonnenes oder abgebrochenes
+    if (!inGame && (won || !journal.lastMove().endedGame)) {
+        return false;
+    }
+    int move = journal.undoMove();
+    apply_move(move);
+    if (journal.moveAt(move).endedGame) {
+        if (statisticsEnabled) {
+            gameStatistics->revokeStats(getLength(), getWidth(), getMinesNumber(), won,
+                                        getBbbv(), getOpeningsNumber(), undone, assisted);
+            gameStatistics->saveToFile("statistics.json");
+        }
+        won = false;
+        inGame = true;
+    }
+    undone = true;
+    return true;
+}
+
+/**
+ * @brief Wiederholt den zuletzt rückgängig gemachten Zug.
+ * @return True, wenn ein Zug wiederholt wurde.
+ *
+ * Hat der Zug das Spiel beendet, wird das Spiel erneut beendet und in der Statistik gezählt.
+ */
+bool Game::redo() {
+    TRACE_SPAN("game.redo");
+    if (!journal.canRedo() || !inGame) {
+        return false;
+    }
+    int move = journal.redoMove();
+    apply_move(move);
+    if (journal.moveAt(move).endedGame) {
+        won = journal.moveAt(move).won;
+        gameEnd();
+    }
+    return true;
+}
+
+/**
+ * @brief Zählt die Markierung einer Zelle zu den richtigen oder falschen Markierungen.
+ * @param cell Betroffene Zelle.
+ * @param delta +1 beim Setzen, -1 beim Entfernen der Markierung.
+ *
+ * Nicht markierte Zellen werden ignoriert.
+ */
+void Game::count_flag(const Cell &cell, int delta) {
+    if (cell.is_marked()) {
+        (cell.is_mined() ? correctFlags : wrongFlags) += delta;
+    }
+}
+
+/**
+ * @brief Ändert die Minenzahl aller Zellen in der 3x3-Umgebung um delta.
+ * @param row Zeilenindex der Mitte.
+ * @param col Spaltenindex der Mitte.
+ * @param delta Änderung der Minenzahl.
+ *
+ * Die Mitte wird wie in count_mines_around() mitgezählt.
+ */
+void Game::adjust_mines_around(int row, int col, int delta) {
+    kernels->adjustMinesAround(cells, getLength(), getWidth(), row, col, delta);
+}
+
+/**
+ * @brief Beschriftet alle Öffnungen des Spielfelds und berechnet 3BV.
+ *
+ * Erster Durchlauf: Union-Find über die Nullzellen, wobei jede Zelle nur mit den schon
+ * besuchten Nachbarn (links, oben links, oben, oben rechts) vereinigt wird.
+ * Zweiter Durchlauf: Größe jeder Zellliste zählen, danach die Listen füllen.
+ * Randzellen, die an mehrere Öffnungen grenzen, stehen in jeder dieser Listen.
+ */
+void Game::label_openings() {
+    TRACE_SPAN("game.label_openings");
+    bbbv = kernels->labelOpenings(cells, getLength(), getWidth(), openingOf, openingStart, openingCells);
+    openingsLabeled = true;
+}
+
+/**
+ * @brief Deckt eine Öffnung samt Rand in einem Durchlauf über ihre Zellliste auf.
+ * @param opening Nummer der Öffnung.
+ * @param row Zeilenindex der geklickten Zelle.
+ * @param col Spaltenindex der geklickten Zelle.
+ *
+ * Enthält die Öffnung eine markierte Zelle, wird wie bei der früheren Rekursion nur der Teil
+ * aufgedeckt, der vom Klick aus ohne die markierten Zellen erreichbar ist: eine markierte
+ * Nullzelle hält die Ausbreitung auf.
+ */
+void Game::reveal_opening(int opening, int row, int col) {
+    const int first = openingStart[opening];
+    const int last = openingStart[opening + 1];
+    bool marked = false;
+    for (int k = first; k < last && !marked; k++) {
+        marked = cells[openingCells[k]].is_marked();
+    }
+    if (marked) {
+        flood_opening(row, col);
+        return;
+    }
+    for (int k = first; k < last; k++) {
+        const int index = openingCells[k];
+        Cell &cell = cells[index];
+        if (cell.is_hidden()) {
+            cell.set_hidden(false);
+            safeRevealed++; ///< Öffnungen und ihr Rand sind nie vermint
+            journal.record(index, GameJournal::HIDDEN);
+            cellChanged(index);
+        }
+    }
+}
+
+/**
+ * @brief Deckt eine Öffnung von einer Zelle aus auf und hält an markierten Zellen an.
+ * @param row Zeilenindex der geklickten Nullzelle.
+ * @param col Spaltenindex der geklickten Nullzelle.
+ *
+ * Ausweg von reveal_opening() für Öffnungen mit Markierungen; arbeitet mit einem eigenen Stapel
+ * statt Rekursion. Randzellen sind aufgedeckt und werden deshalb nie betreten. Der Stapel liegt
+ * in der Arena und behält seine Kapazität von Zug zu Zug.
+ */
+void Game::flood_opening(int row, int col) {
+    ArenaVector<QPoint> &pending = floodPending;
+    pending.clear();
+    pending.push_back(QPoint(row, col));
+    while (!pending.empty()) {
+        const QPoint position = pending.back();
+        pending.pop_back();
+        const int index = cellIndex(position.x(), position.y());
+        Cell &cell = cells[index];
+        if (!cell.is_hidden() || cell.is_marked()) {
+            continue;
+        }
+        cell.set_hidden(false);
+        safeRevealed++; ///< Öffnungen und ihr Rand sind nie vermint
+        journal.record(index, GameJournal::HIDDEN);
+        cellChanged(index);
+        if (cell.get_mines_around() == 0) {
+            for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+                pending.push_back(QPoint(position.x() + BoardLayout::NEIGHBOUR_ROWS[k],
+                                         position.y() + BoardLayout::NEIGHBOUR_COLS[k]));
             }
-            gameMatrix[i][j].set_mines_around(mines_counter);
         }
     }
 }
@@ -132,38 +451,54 @@ void Game::count_mines_around() {
  * @param row Zeilenindex der zu öffnenden Zelle.
  * @param col Spaltenindex der zu öffnenden Zelle.
  *
- * Falls die Zelle keine umliegenden Minen hat, werden benachbarte Zellen rekursiv geöffnet.
- * Bei einer Mine endet das Spiel.
+ * Falls die Zelle keine umliegenden Minen hat, wird ihre ganze vorberechnete Öffnung
+ * aufgedeckt. Bei einer Mine endet das Spiel. Der erste Klick eines Spiels trifft nie eine Mine.
  */
 void Game::open_cell(int row, int col) {
+    TRACE_SPAN("game.open_cell");
     ///< falls die Zelle aufgedeckt oder markiert ist - öffnet die Zelle nicht
-    if (!gameMatrix[row][col].is_hidden() || gameMatrix[row][col].is_marked()) {
+    if (!cells[cellIndex(row, col)].is_hidden() || cells[cellIndex(row, col)].is_marked()) {
         return;
     }
 
-    ///< ändert den Status und merkt die Koordinaten der veränderten Zellen
-    gameMatrix[row][col].set_hidden(false);
-    openedCells++;
-    this->changed_cells.append(QPoint(row, col));
+    journal.beginMove();
 
-    ///< falls die Zelle vermint ist
-    if (gameMatrix[row][col].is_mined()) {
-        gameMatrix[row][col].set_exploded(true);
-        gameLost();
+    ///< beim ersten Klick werden Minen aus der Umgebung verschoben
+    if (firstClick) {
+        firstClick = false;
+        protect_first_click(row, col);
+        label_openings(); ///< das Spielfeld steht jetzt endgültig fest
+    } else if (!openingsLabeled) {
+        label_openings(); ///< nach dem Laden eines Spielstands erst beim ersten Öffnen beschriften
     }
-    ///< falls die Zelle unvermint ist und an keine verminte Zelle grenzt, öffnet sie auch rekursiv
-    else if (gameMatrix[row][col].get_mines_around() == 0) {
-        for (int i = std::max(0, row - 1); i < std::min(getLength(), row + 2); i++) {
-            for (int j = std::max(0, col - 1); j < std::min(getWidth(), col + 2); j++) {
-                open_cell(i, j);
-            }
+
+    ///< falls die Zelle an keine verminte Zelle grenzt, wird die ganze Öffnung aufgedeckt
+    int opening = openingOf[cellIndex(row, col)];
+    if (opening >= 0) {
+        reveal_opening(opening, row, col);
+    } else {
+        ///< ändert den Status und merkt die Koordinaten der veränderten Zellen
+        cells[cellIndex(row, col)].set_hidden(false);
+
+        ///< falls die Zelle vermint ist
+        if (cells[cellIndex(row, col)].is_mined()) {
+            cells[cellIndex(row, col)].set_exploded(true);
+            cellChanged(cellIndex(row, col));
+            journal.record(cellIndex(row, col), GameJournal::HIDDEN | GameJournal::EXPLODED);
+            gameLost();
+            journal.endMove(true, false);
+            return;
         }
+        cellChanged(cellIndex(row, col));
+        safeRevealed++;
+        journal.record(cellIndex(row, col), GameJournal::HIDDEN);
     }
     // prüft, ob alle Zelle schon aufgedeckt sind und beendet das Spiel
-    if (openedCells == getLength() * getWidth()) {
+    if (is_boardComplete()) {
         won = checkIfWon();
         gameEnd();
     }
+    journal.endMove(!inGame, won);
 }
 
 /**
@@ -186,11 +521,11 @@ void Game::open_cell(int row, int col) {
  * Die Flags werden addiert, wenn mehrere Bedingungen zutreffen.
  * Zum Beispiel: Eine markierte, versteckte Zelle ohne Mine hätte nur das `0x0002`-Flag.
  */
-int Game::getCellStatus(int row, int col) {
-    return !gameMatrix[row][col].is_hidden() * 0x0001
-           + gameMatrix[row][col].is_marked() * 0x0002
-           + gameMatrix[row][col].is_mined() * 0x0004
-           + gameMatrix[row][col].is_exploded() * 0x0008;
+int Game::getCellStatus(int row, int col) const {
+    return !cells[cellIndex(row, col)].is_hidden() * 0x0001
+           + cells[cellIndex(row, col)].is_marked() * 0x0002
+           + cells[cellIndex(row, col)].is_mined() * 0x0004
+           + cells[cellIndex(row, col)].is_exploded() * 0x0008;
 }
 
 /**
@@ -199,8 +534,42 @@ int Game::getCellStatus(int row, int col) {
  * @param col Spaltenindex.
  * @return Anzahl der umliegenden Minen.
  */
-int Game::getCellMinesNumber(int row, int col) {
-    return gameMatrix[row][col].get_mines_around();
+int Game::getCellMinesNumber(int row, int col) const {
+    return cells[cellIndex(row, col)].get_mines_around();
+}
+
+/**
+ * @brief Berechnet den Anzeigecode für jeden möglichen gepackten Zellzustand.
+ * @return Tabelle, indiziert mit Cell::get_bits().
+ */
+static std::array<quint8, 256> makeCellCodes() {
+    std::array<quint8, 256> codes{};
+    for (int bits = 0; bits < int(codes.size()); bits++) {
+        Cell cell;
+        cell.set_bits(quint8(bits));
+        const int status = !cell.is_hidden() + cell.is_marked() * 2 + cell.is_mined() * 4 + cell.is_exploded() * 8;
+        codes[bits] = BoardPlane::cellCode(status, cell.get_mines_around());
+    }
+    return codes;
+}
+
+/**
+ * @brief Schreibt die Anzeigecodes mehrerer Zellen einer Zeile.
+ * @param row Zeilenindex.
+ * @param col Erste Spalte.
+ * @param count Anzahl der Zellen.
+ * @param codes Ziel für count Codes.
+ *
+ * Da eine Zelle nur ein Byte belegt, ist ihr Code ein Nachschlagen in einer Tabelle mit 256
+ * Einträgen; damit füllt die Engine nach dem Laden eines Spielstands ihre BoardPlane in einem
+ * Durchlauf.
+ */
+void Game::getCellCodes(int row, int col, int count, quint8 *codes) const {
+    static const std::array<quint8, 256> CELL_CODES = makeCellCodes();
+    const Cell *cell = cells + cellIndex(row, col);
+    for (int i = 0; i < count; i++) {
+        codes[i] = CELL_CODES[cell[i].get_bits()];
+    }
 }
 
 /**
@@ -209,19 +578,28 @@ int Game::getCellMinesNumber(int row, int col) {
  * @param col Spaltenindex.
  */
 void Game::mark_cell(int row, int col) {
-    ///< markiert die Zelle, falls die demarkiert ist und umgekehrt
-    if (gameMatrix[row][col].is_hidden()) {
-        gameMatrix[row][col].set_marked(!gameMatrix[row][col].is_marked());
-        ///< merkt die Koordinaten der veränderten Zelle und ändert die counters
-        this->changed_cells.append(QPoint(row, col));
-        markedCells += gameMatrix[row][col].is_marked() ? 1 : -1;
-        openedCells += gameMatrix[row][col].is_marked() ? 1 : -1;
+    TRACE_SPAN("game.mark_cell");
+    ///< aufgedeckte Zellen lassen sich nicht markieren; ohne Änderung wird auch kein Zug begonnen,
+    ///< der die wiederholbaren Züge verwerfen würde
+    if (!cells[cellIndex(row, col)].is_hidden()) {
+        return;
     }
+    ///< markiert die Zelle, falls die demarkiert ist und umgekehrt
+    journal.beginMove();
+    count_flag(cells[cellIndex(row, col)], -1);
+    cells[cellIndex(row, col)].set_marked(!cells[cellIndex(row, col)].is_marked());
+    count_flag(cells[cellIndex(row, col)], +1);
+    journal.record(cellIndex(row, col), GameJournal::MARKED);
+    ///< merkt die Koordinaten der veränderten Zelle und ändert die counters
+    cellChanged(cellIndex(row, col));
     ///< prüft, ob alle Zelle schon aufgedeckt sind und beendet das Spiel
-    if (openedCells == getLength() * getWidth()) {
+    if (inGame && is_boardComplete()) {
         won = checkIfWon();
         gameEnd();
+        journal.endMove(true, won);
+        return;
     }
+    journal.endMove(false, false);
 }
 
 /**
@@ -231,12 +609,14 @@ void Game::mark_cell(int row, int col) {
  */
 void Game::unmark_cell(int row, int col) {
     ///< demarkiert die Zelle, falls die markiert ist
-    if(gameMatrix[row][col].is_marked()) {
-        gameMatrix[row][col].set_marked(false);
+    if(cells[cellIndex(row, col)].is_marked()) {
+        journal.beginMove();
+        count_flag(cells[cellIndex(row, col)], -1);
+        cells[cellIndex(row, col)].set_marked(false);
+        journal.record(cellIndex(row, col), GameJournal::MARKED);
+        journal.endMove(false, false);
         ///< merkt die Koordinaten der veränderten Zelle und ändert die counters
-        this->changed_cells.append(QPoint(row, col));
-        markedCells--;
-        openedCells--;
+        cellChanged(cellIndex(row, col));
     }
 }
 
@@ -244,25 +624,51 @@ void Game::unmark_cell(int row, int col) {
  * @brief Beendet das Spiel und speichert die Statistiken.
  */
 void Game::gameEnd() {
-    gameStatistics->updateStats(getLength(), getWidth(), getMinesNumber(), won, getElapsedSeconds());
-    gameStatistics->saveToFile("statistics.json");
+    TRACE_SPAN("game.gameEnd");
+    ///< falls noch nicht geklickt wurde, ist das Spielfeld noch nicht beschriftet
+    if (!openingsLabeled && cells != nullptr) {
+        label_openings();
+    }
+    stopClock(); ///< die Zeit endet mit dem letzten Zug, nicht erst mit der Anzeige
+    if (statisticsEnabled) {
+        gameStatistics->updateStats(getLength(), getWidth(), getMinesNumber(), won, getElapsedTime(),
+                                    getBbbv(), getOpeningsNumber(), undone, assisted);
+        gameStatistics->saveToFile("statistics.json");
+    }
     this->inGame = false;
 }
 
+/**
+ * @brief Setzt die Spielzeit; eine laufende Uhr zählt von diesem Wert aus weiter.
+ * @param value Neue Spielzeit in ms.
+ */
+void Game::setElapsedTime(qint64 value) {
+    clock.setElapsedTime(value);
+}
+
+/**
+ * @brief Startet die Spielzeit bzw. setzt sie nach einer Pause fort.
+ */
+void Game::startClock() {
+    clock.start();
+}
+
+/**
+ * @brief Hält die Spielzeit an und rechnet den laufenden Abschnitt auf die Spielzeit an.
+ */
+void Game::stopClock() {
+    clock.stop();
+}
+
 /**
  * @brief Überprüft, ob der Spieler gewonnen hat.
  * @return True, wenn alle Minen korrekt markiert wurden; sonst false.
+ *
+ * Die richtigen Markierungen werden bei jedem Zug mitgezählt, ein Durchlauf über das
+ * Spielfeld ist nicht nötig.
  */
-bool Game::checkIfWon() {
-    int markedRight = 0; ///< counter für die richtig markierte Zellen
-    for (int row = 0; row < getLength(); row++) {
-        for (int col = 0; col < getWidth(); col++) {
-            if (gameMatrix[row][col].is_marked() && gameMatrix[row][col].is_mined()) {
-                markedRight++;
-            }
-        }
-    }
-    return markedRight == getMinesNumber();
+bool Game::checkIfWon() const {
+    return correctFlags == getMinesNumber();
 }
 
 /**
@@ -272,9 +678,12 @@ void Game::openAllCells() {
     ///< geht durch die Matrix und deckt die Zellen auf
     for (int row = 0; row < getLength(); row++) {
         for (int col = 0; col < getWidth(); col++) {
-            if (gameMatrix[row][col].is_hidden()) {
-                gameMatrix[row][col].set_hidden(false);
-                this->changed_cells.append(QPoint(row, col));
+            if (cells[cellIndex(row, col)].is_hidden()) {
+                count_cell(cells[cellIndex(row, col)], -1);
+                cells[cellIndex(row, col)].set_hidden(false);
+                count_cell(cells[cellIndex(row, col)], +1);
+                journal.record(cellIndex(row, col), GameJournal::HIDDEN);
+                cellChanged(cellIndex(row, col));
             }
         }
     }
@@ -296,9 +705,9 @@ void Game::debug_checkGridGeneretion() {
     for (int i = 0; i < getLength(); i++) {
         QString tmp;
         for (int j = 0; j < getWidth(); j++) {
-            tmp.append(gameMatrix[i][j].is_mined() ? "m " : QString::number(gameMatrix[i][j].get_mines_around()) + " ");
+            tmp.append(cells[cellIndex(i, j)].is_mined() ? "m " : QString::number(cells[cellIndex(i, j)].get_mines_around()) + " ");
         }
-        qDebug() << tmp;
+        qCDebug(lcEngine) << tmp;
     }
 }
 
@@ -309,8 +718,8 @@ void Game::debug_statuses() {
     for (int i = 0; i < getLength(); i++) {
         QString tmp;
         for (int j = 0; j < getWidth(); j++) {
-            tmp.append(gameMatrix[i][j].is_hidden() ? "X " : "O ");
+            tmp.append(cells[cellIndex(i, j)].is_hidden() ? "X " : "O ");
         }
-        qDebug() << tmp;
+        qCDebug(lcEngine) << tmp;
     }
 }
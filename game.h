@@ -3,10 +3,16 @@
 
 #include <cell.h>
 #include <gamestatistics.h>
+#include <boardlayout.h>
+#include <boardkernels.h>
+#include <gamearena.h>
+#include <gamejournal.h>
+#include <gameclock.h>
 #include <QVector>
 #include <QPoint>
 #include <QIcon>
 #include <QTimer>
+#include <QRandomGenerator>
 
 /**
  * @file game.h
@@ -28,7 +34,8 @@ class Game
 public:
     /**
      * @brief Standardkonstruktor für die Game-Klasse.
-     * Initialisiert das Spiel mit Standardwerten.
+     * Initialisiert das Spiel mit Standardwerten (10x10, 10 Minen), ohne gespeicherte
+     * Statistiken zu laden, z.B. zum Nachspielen von Aufzeichnungen.
      *
      * @author Daniel Schukin
      */
@@ -44,7 +51,7 @@ public:
      *
      * @author Daniel Schukin
      */
-    Game(int gridLength = 10, int gridWidth = 10, int minesNumber = 10);
+    Game(int gridLength, int gridWidth, int minesNumber);
 
     /**
      * @brief Destruktor für die Game-Klasse.
@@ -97,7 +104,7 @@ public:
     void changeMinesNumber(int minesNumber);
 
     /**
-     * @brief Setzt die Anzahl der markierten Zellen zurück.
+     * @brief Setzt die Zähler der geöffneten und markierten Zellen zurück.
      *
      * @author Daniel Schukin
      */
@@ -112,28 +119,36 @@ public:
      *
      * @author Daniel Schukin
      */
-    int getLength() { return gridLength; }
+    int getLength() const { return gridLength; }
     /**
      * @brief Gibt die Anzahl der Spalten zurück.
      * @return Anzahl der Spalten im Spielfeld.
      *
      * @author Daniel Schukin
      */
-    int getWidth() { return gridWidth; }
+    int getWidth() const { return gridWidth; }
     /**
      * @brief Gibt die Anzahl der Minen zurück.
      * @return Anzahl der Minen im Spielfeld.
      *
      * @author Daniel Schukin
      */
-    int getMinesNumber() { return minesNumber; }
+    int getMinesNumber() const { return minesNumber; }
     /**
-     * @brief Gibt die vergangene Zeit seit Spielbeginn zurück.
-     * @return Anzahl der Sekunden.
+     * @brief Gibt die Spielzeit zurück, bei laufender Uhr einschließlich des aktuellen Abschnitts.
+     * @return Spielzeit in ms.
      *
      * @author Daniel Schukin
      */
-    int getElapsedSeconds() { return elapsedSeconds; }
+    qint64 getElapsedTime() const { return clock.getElapsedTime(); }
+
+    /**
+     * @brief Gibt an, ob die Spielzeit gerade läuft.
+     * @return True zwischen startClock() und stopClock().
+     *
+     * @author Daniel Schukin
+     */
+    bool is_clockRunning() const { return clock.is_running(); }
 
     /**
      * @brief Gibt die Anzahl der markierten Zellen zurück.
@@ -141,15 +156,66 @@ public:
      *
      * @author Daniel Schukin
      */
-    int getMarkedCells() { return markedCells; }
+    int getMarkedCells() const { return correctFlags + wrongFlags; }
+
+    /**
+     * @brief Gibt die Anzahl der aufgedeckten Zellen ohne Mine zurück.
+     * @return Anzahl der sicher aufgedeckten Zellen.
+     *
+     * @author Daniel Schukin
+     */
+    int getSafeRevealed() const { return safeRevealed; }
+
+    /**
+     * @brief Gibt die Anzahl der richtig markierten Zellen (mit Mine) zurück.
+     * @return Anzahl der richtigen Markierungen.
+     *
+     * @author Daniel Schukin
+     */
+    int getCorrectFlags() const { return correctFlags; }
+
+    /**
+     * @brief Gibt die Anzahl der falsch markierten Zellen (ohne Mine) zurück.
+     * @return Anzahl der falschen Markierungen.
+     *
+     * @author Daniel Schukin
+     */
+    int getWrongFlags() const { return wrongFlags; }
+
+    /**
+     * @brief Gibt den 3BV-Wert des Spielfelds zurück.
+     * @return Mindestanzahl der Klicks, um das Spielfeld ohne Markierungen zu lösen.
+     *
+     * @author Daniel Schukin
+     */
+    int getBbbv() const { return bbbv; }
+
+    /**
+     * @brief Gibt die Anzahl der Öffnungen (zusammenhängende Nullbereiche) zurück.
+     * @return Anzahl der Öffnungen im Spielfeld.
+     *
+     * @author Daniel Schukin
+     */
+    int getOpeningsNumber() const { return int(openingStart.size()) - 1; }
 
     /**
      * @brief Gibt eine Liste der zuletzt geänderten Zellen zurück.
      * @return Zeiger auf die Liste der geänderten Zellen.
      *
+     * Die Liste liegt in der Arena des Spiels; nach dem Leeren bleibt ihre Kapazität erhalten,
+     * sodass weitere Züge keinen Heap-Speicher anfordern.
+     *
+     * @author Daniel Schukin
+     */
+    ArenaVector<QPoint>* getChangedCells() { return &changed_cells; }
+
+    /**
+     * @brief Gibt die Arena für die kurzlebigen Daten des Spiels zurück.
+     * @return Zeiger auf die Arena, z.B. um einen Zähl-Callback für Heap-Anforderungen zu setzen.
+     *
      * @author Daniel Schukin
      */
-    QVector<QPoint>* getChangedCells() { return &changed_cells; }
+    GameArena* getArena() { return &arena; }
 
     /**
      * @brief Überprüft, ob das Spiel noch läuft.
@@ -157,18 +223,42 @@ public:
      *
      * @author Daniel Schukin
      */
-    bool is_inGame() { return inGame; }
+    bool is_inGame() const { return inGame; }
+
+    /**
+     * @brief Gibt an, ob das beendete Spiel gewonnen wurde.
+     * @return True, wenn das Spiel gewonnen wurde; sonst false.
+     *
+     * @author Daniel Schukin
+     */
+    bool is_won() const { return won; }
+
+    /**
+     * @brief Gibt an, ob beim ersten Klick die ganze 3x3-Umgebung minenfrei gemacht wird.
+     * @return True, wenn die Umgebung freigeräumt wird; sonst nur die geklickte Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    bool is_safeOpening() const { return safeOpening; }
+
+    /**
+     * @brief Gibt den Seed zurück, aus dem das Spielfeld erzeugt wurde.
+     * @return Seed des aktuellen Spielfelds.
+     *
+     * @author Daniel Schukin
+     */
+    quint64 getSeed() const { return seed; }
     /// @}
 
     /// @name Setter-Methoden
     /// @{
     /**
-     * @brief Setzt die vergangene Spielzeit.
-     * @param value Neue Zeit in Sekunden.
+     * @brief Setzt die Spielzeit; eine laufende Uhr zählt von diesem Wert aus weiter.
+     * @param value Neue Spielzeit in ms.
      *
      * @author Daniel Schukin
      */
-    void setElapsedSeconds(int value) { this->elapsedSeconds = value; };
+    void setElapsedTime(qint64 value);
 
     /**
      * @brief Setzt den Siegstatus des Spiels.
@@ -177,6 +267,22 @@ public:
      * @author Daniel Schukin
      */
     void setWon(bool value) { this->won = value; }
+
+    /**
+     * @brief Legt fest, ob der erste Klick eine ganze minenfreie 3x3-Öffnung garantiert.
+     * @param value True für eine freie 3x3-Umgebung, false nur für eine freie Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    void setSafeOpening(bool value) { this->safeOpening = value; }
+
+    /**
+     * @brief Legt fest, ob beendete Spiele in die Statistik eingehen.
+     * @param value False z.B. beim Abspielen einer Aufzeichnung.
+     *
+     * @author Daniel Schukin
+     */
+    void setStatisticsEnabled(bool value) { this->statisticsEnabled = value; }
     /// @}
 
     /// @name Zellstatus und Minenzählung
@@ -189,7 +295,7 @@ public:
      *
      * @author Daniel Schukin
      */
-    int getCellStatus(int row, int col);
+    int getCellStatus(int row, int col) const;
 
     /**
      * @brief Gibt die Anzahl der Minen um eine bestimmte Zelle zurück.
@@ -199,7 +305,18 @@ public:
      *
      * @author Daniel Schukin
      */
-    int getCellMinesNumber(int row, int col);
+    int getCellMinesNumber(int row, int col) const;
+
+    /**
+     * @brief Schreibt die Anzeigecodes mehrerer Zellen einer Zeile.
+     * @param row Zeilenindex.
+     * @param col Erste Spalte.
+     * @param count Anzahl der Zellen.
+     * @param codes Ziel für count Codes wie BoardPlane::cellCode() aus getCellStatus() und getCellMinesNumber().
+     *
+     * @author Daniel Schukin
+     */
+    void getCellCodes(int row, int col, int count, quint8 *codes) const;
     /// @}
 
     /// @name Spiellogik
@@ -211,6 +328,14 @@ public:
      */
     void place_mines();
 
+    /**
+     * @brief Platziert die Minen reproduzierbar aus einem Seed.
+     * @param seed Seed für den Zufallsgenerator des Spiels.
+     *
+     * @author Daniel Schukin
+     */
+    void place_mines(quint64 seed);
+
     /**
      * @brief Zählt die Anzahl der Minen um jede Zelle.
      *
@@ -218,6 +343,31 @@ public:
      */
     void count_mines_around();
 
+    /**
+     * @brief Sorgt dafür, dass der erste Klick keine Mine trifft.
+     * @param row Zeilenindex der zuerst geklickten Zelle.
+     * @param col Spaltenindex der zuerst geklickten Zelle.
+     *
+     * Minen in der geschützten Zone (die Zelle bzw. ihre 3x3-Umgebung) werden an zufällige
+     * freie Zellen außerhalb verschoben. Die Minenzahlen werden nur in den betroffenen
+     * Nachbarschaften angepasst, sodass pro verschobener Mine O(1) Aufwand entsteht.
+     *
+     * @author Daniel Schukin
+     */
+    void protect_first_click(int row, int col);
+
+    /**
+     * @brief Beschriftet alle Öffnungen des fertig generierten Spielfelds.
+     *
+     * Jede zusammenhängende Region von Zellen ohne Nachbarminen bekommt eine Nummer
+     * (Union-Find in einem zeilenweisen Durchlauf). Pro Öffnung wird eine kompakte Liste
+     * ihrer Zellen samt nummeriertem Rand gespeichert. Nebenbei werden 3BV und die Anzahl
+     * der Öffnungen bestimmt.
+     *
+     * @author Daniel Schukin
+     */
+    void label_openings();
+
     /**
      * @brief Öffnet eine bestimmte Zelle.
      * @param row Zeilenindex der zu öffnenden Zelle.
@@ -252,13 +402,69 @@ public:
      */
     void gameEnd();
 
+    /**
+     * @brief Macht den letzten Zug rückgängig.
+     * @return True, wenn ein Zug rückgängig gemacht wurde.
+     *
+     * @author Daniel Schukin
+     */
+    bool undo();
+
+    /**
+     * @brief Wiederholt den zuletzt rückgängig gemachten Zug.
+     * @return True, wenn ein Zug wiederholt wurde.
+     *
+     * @author Daniel Schukin
+     */
+    bool redo();
+
+    /**
+     * @brief Prüft, ob im aktuellen Spiel ein Zug rückgängig gemacht wurde.
+     * @return True, wenn das Spiel nicht für die Bestzeit zählt.
+     *
+     * @author Daniel Schukin
+     */
+    bool is_undone() const { return undone; }
+
+    /**
+     * @brief Hält fest, dass im aktuellen Spiel ein Tipp angezeigt wurde.
+     *
+     * Das Spiel zählt dann nicht mehr für die Bestzeit und wird in der Statistik
+     * eigens gezählt (GameStats::gamesAssisted).
+     *
+     * @author Daniel Schukin
+     */
+    void markAssisted() { assisted = true; }
+
+    /**
+     * @brief Prüft, ob im aktuellen Spiel ein Tipp angezeigt wurde.
+     * @return True, wenn das Spiel nicht für die Bestzeit zählt.
+     *
+     * @author Daniel Schukin
+     */
+    bool is_assisted() const { return assisted; }
+
     /**
      * @brief Überprüft, ob das Spiel gewonnen wurde.
      * @return True, wenn alle Minen korrekt markiert sind; sonst false.
      *
      * @author Daniel Schukin
      */
-    bool checkIfWon();
+    bool checkIfWon() const;
+
+    /**
+     * @brief Startet die Spielzeit bzw. setzt sie nach einer Pause fort.
+     *
+     * @author Daniel Schukin
+     */
+    void startClock();
+
+    /**
+     * @brief Hält die Spielzeit an und rechnet den laufenden Abschnitt auf die Spielzeit an.
+     *
+     * @author Daniel Schukin
+     */
+    void stopClock();
 
     /**
      * @brief Öffnet alle Zellen des Spielfelds.
@@ -300,17 +506,163 @@ public:
     /// @}
 
 private:
+    friend class GameSnapshot; ///< liest und schreibt den Zellspeicher direkt.
+
+    /**
+     * @brief Startet den Zufallsgenerator des Spiels mit einem Seed.
+     * @param seed Neuer Seed.
+     *
+     * @author Daniel Schukin
+     */
+    void seed_random(quint64 seed);
+
+    /**
+     * @brief Verschiebt eine Mine und repariert die Minenzahlen der beiden Nachbarschaften.
+     * @param fromRow Zeile der Mine.
+     * @param fromCol Spalte der Mine.
+     * @param toRow Zeile der neuen, bisher freien Zelle.
+     * @param toCol Spalte der neuen, bisher freien Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    void move_mine(int fromRow, int fromCol, int toRow, int toCol);
+
+    /**
+     * @brief Ändert die Minenzahl aller Zellen in der 3x3-Umgebung um delta.
+     * @param row Zeilenindex der Mitte.
+     * @param col Spaltenindex der Mitte.
+     * @param delta +1, wenn eine Mine hinzukommt; -1, wenn sie entfernt wird.
+     *
+     * @author Daniel Schukin
+     */
+    void adjust_mines_around(int row, int col, int delta);
+
+    /**
+     * @brief Deckt eine ganze Öffnung in einem Durchlauf über ihre Zellliste auf.
+     * @param opening Nummer der Öffnung.
+     * @param row Zeilenindex der geklickten Zelle.
+     * @param col Spaltenindex der geklickten Zelle.
+     *
+     * Markierte Zellen bleiben verdeckt und halten die Ausbreitung auf (siehe flood_opening()).
+     *
+     * @author Daniel Schukin
+     */
+    void reveal_opening(int opening, int row, int col);
+
+    /**
+     * @brief Deckt eine Öffnung von einer Zelle aus auf und hält an markierten Zellen an.
+     * @param row Zeilenindex der geklickten Nullzelle.
+     * @param col Spaltenindex der geklickten Nullzelle.
+     *
+     * @author Daniel Schukin
+     */
+    void flood_opening(int row, int col);
+
+    /**
+     * @brief Zählt eine Zelle zu den Zählern der aufgedeckten und markierten Zellen.
+     * @param cell Betroffene Zelle.
+     * @param delta +1 zum Hinzuzählen, -1 zum Abziehen.
+     *
+     * @author Daniel Schukin
+     */
+    void count_cell(const Cell &cell, int delta);
+
+    /**
+     * @brief Schaltet die im Protokoll gespeicherten Bits eines Zugs um.
+     * @param move Nummer des Zugs im Protokoll.
+     *
+     * @author Daniel Schukin
+     */
+    void apply_move(int move);
+
+    /**
+     * @brief Zählt die Markierung einer Zelle zu den richtigen oder falschen Markierungen.
+     * @param cell Betroffene Zelle.
+     * @param delta +1 beim Setzen, -1 beim Entfernen der Markierung.
+     *
+     * @author Daniel Schukin
+     */
+    void count_flag(const Cell &cell, int delta);
+
+    /**
+     * @brief Prüft, ob jede Zelle aufgedeckt oder markiert ist.
+     * @return True, wenn keine verdeckte, unmarkierte Zelle mehr übrig ist.
+     *
+     * @author Daniel Schukin
+     */
+    bool is_boardComplete() const {
+        return safeRevealed + correctFlags + wrongFlags == getLength() * getWidth();
+    }
+
+    /**
+     * @brief Leert alle Puffer des letzten Spiels und setzt die Arena zurück.
+     *
+     * @author Daniel Schukin
+     */
+    void resetArena();
+
+    /**
+     * @brief Rechnet Zeile und Spalte in den Index des gepolsterten Zellvektors um.
+     * @param row Zeilenindex.
+     * @param col Spaltenindex.
+     * @return Linearer Index in cells.
+     *
+     * @author Daniel Schukin
+     */
+    int cellIndex(int row, int col) const { return BoardLayout::index(row, col, stride); }
+
+    /**
+     * @brief Merkt eine geänderte Zelle vor.
+     * @param index Index der Zelle im Zellvektor.
+     *
+     * Wird nach jeder Änderung an einer Zelle aufgerufen, nachdem alle ihre Flags gesetzt sind.
+     *
+     * @author Daniel Schukin
+     */
+    void cellChanged(int index) { changed_cells.push_back(cellPosition(index)); }
+
+    /**
+     * @brief Rechnet einen Index des Zellvektors in Zeile und Spalte um.
+     * @param index Linearer Index in cells.
+     * @return Zeile (x) und Spalte (y) der Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    QPoint cellPosition(int index) const { return QPoint(index / stride - 1, index % stride - 1); }
+
     int gridLength; ///< Anzahl der Zeilen im Spielfeld.
     int gridWidth; ///< Anzahl der Spalten im Spielfeld.
     int minesNumber; ///< Anzahl der Minen im Spielfeld.
-    bool won; ///< True, wenn das Spiel gewonnen wurde.
+    bool won = false; ///< True, wenn das Spiel gewonnen wurde.
     bool inGame = false; ///< True, wenn das Spiel noch läuft.
-    int elapsedSeconds = 0; ///< Spielzeit in Sekunden.
-    int markedCells; ///< Anzahl der markierten Zellen.
-    int openedCells; ///< Anzahl der geöffneten Zellen.
-
-    QVector<QPoint> changed_cells; ///< Liste der kürzlich veränderten Zellen.
-    QVector<QVector<Cell>> gameMatrix; ///< Matrix, die alle Zellen des Spielfelds enthält.
+    GameClock clock; ///< Spielzeit des aktuellen Spiels.
+    int safeRevealed = 0; ///< Anzahl der aufgedeckten Zellen ohne Mine.
+    int correctFlags = 0; ///< Anzahl der markierten Zellen mit Mine.
+    int wrongFlags = 0; ///< Anzahl der markierten Zellen ohne Mine.
+    bool undone = false; ///< True, sobald im aktuellen Spiel ein Zug rückgängig gemacht wurde.
+    bool assisted = false; ///< True, sobald im aktuellen Spiel ein Tipp angezeigt wurde.
+    bool statisticsEnabled = true; ///< True, wenn beendete Spiele in die Statistik eingehen.
+    quint64 seed = 0; ///< Seed des aktuellen Spielfelds.
+    QRandomGenerator rng; ///< Zufallsgenerator des Spiels, aus seed initialisiert.
+    bool firstClick = true; ///< True, solange noch keine Zelle geöffnet wurde.
+    bool safeOpening = true; ///< True, wenn der erste Klick eine freie 3x3-Umgebung garantiert.
+    bool openingsLabeled = false; ///< True, wenn die Öffnungen des aktuellen Spielfelds beschriftet sind.
+    int bbbv = 0; ///< 3BV des aktuellen Spielfelds.
+
+    GameArena arena; ///< Speicher für alle kurzlebigen Puffer eines Spiels, muss vor ihnen deklariert sein.
+    ArenaVector<int> openingOf{&arena}; ///< Nummer der Öffnung pro Zelle (Index wie cells), -1 für Rand und Zellen mit Nachbarminen.
+    ArenaVector<int> openingStart{1, 0, &arena}; ///< Beginn der Zellliste jeder Öffnung in openingCells (plus Endmarke).
+    ArenaVector<int> openingCells{&arena}; ///< Zellindizes aller Öffnungen inklusive Rand, hintereinander abgelegt.
+    GameJournal journal{&arena}; ///< Protokoll der Züge für Rückgängig und Wiederholen.
+
+    ArenaVector<QPoint> changed_cells{&arena}; ///< Liste der kürzlich veränderten Zellen.
+    ArenaVector<QPoint> floodPending{&arena}; ///< Stapel von flood_opening(), wird über die Züge hinweg wiederverwendet.
+    std::array<Cell, PRESET_CELLS> presetMatrix; ///< Fester Zellspeicher für alle Spielfelder bis zur Größe von "Schwer".
+    QVector<Cell> gameMatrix; ///< Zellspeicher für größere benutzerdefinierte Spielfelder.
+    Cell *cells = nullptr; ///< Aktiver Zellvektor, zeilenweise mit Sentinel-Rand, siehe boardlayout.h.
+    int cellsNumber = 0; ///< Anzahl der gespeicherten Zellen inklusive Rand.
+    int stride = 0; ///< Anzahl der gespeicherten Zellen pro Zeile (Breite + 2).
+    const BoardKernels *kernels = nullptr; ///< Für die Spielfeldgröße gewählte Schleifen, siehe boardkernels.h.
     GameStatistics *gameStatistics; ///< Zeiger auf das Statistik-Objekt.
 };
 
@@ -0,0 +1,107 @@
+#include "gamearena.h"
+#include <new>
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @brief Konstruktor für GameArena.
+ *
+ * Holt den ersten Block, damit kleine Spiele den Heap nach dem Start nie brauchen.
+ *
+ * @param initialSize Größe des ersten Blocks in Bytes.
+ */
+GameArena::GameArena(std::size_t initialSize) {
+    addChunk(initialSize);
+    allocationsThisGame = 0; ///< der erste Block gehört zu keinem Spiel
+}
+
+/**
+ * @brief Destruktor für GameArena.
+ *
+ * Gibt alle Blöcke an den Heap zurück.
+ */
+GameArena::~GameArena() {
+    for (const Chunk &chunk : chunks) {
+        ::operator delete(chunk.data);
+    }
+}
+
+/**
+ * @brief Gibt den gesamten Speicher der Arena frei.
+ *
+ * Bei nur einem Block reicht es, den Zeiger zurückzusetzen. Mussten im letzten Spiel
+ * weitere Blöcke geholt werden, werden alle durch einen Block der Gesamtgröße ersetzt, höchstens
+ * aber durch einen von MAX_RETAINED_SIZE; ein noch größeres Spiel holt sich den Rest wieder
+ * blockweise.
+ */
+void GameArena::reset() {
+    if (chunks.size() > 1) {
+        std::size_t capacity = std::min(getCapacity(), MAX_RETAINED_SIZE);
+        for (const Chunk &chunk : chunks) {
+            ::operator delete(chunk.data);
+        }
+        chunks.clear();
+        addChunk(capacity);
+    }
+    offset = 0;
+    bytesUsed = 0;
+    allocationsThisGame = 0;
+}
+
+/**
+ * @brief Gibt die Größe aller Blöcke zusammen zurück.
+ * @return Kapazität der Arena in Bytes.
+ */
+std::size_t GameArena::getCapacity() const {
+    std::size_t capacity = 0;
+    for (const Chunk &chunk : chunks) {
+        capacity += chunk.size;
+    }
+    return capacity;
+}
+
+/**
+ * @brief Vergibt Speicher per Bump-Pointer aus dem aktuellen Block.
+ * @param bytes Angeforderte Größe.
+ * @param alignment Geforderte Ausrichtung (Zweierpotenz).
+ * @return Zeiger auf den Speicher.
+ *
+ * Ausgerichtet wird die Adresse selbst, nicht der Versatz im Block; so gilt auch eine
+ * Ausrichtung über der des Heaps (16 Bytes).
+ */
+void *GameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    std::size_t start = alignedOffset(alignment);
+    if (start + bytes > chunks.back().size) {
+        addChunk(bytes + alignment); ///< genug für den Versatz bis zur nächsten ausgerichteten Adresse
+        start = alignedOffset(alignment);
+    }
+    offset = start + bytes;
+    bytesUsed += bytes;
+    return chunks.back().data + start;
+}
+
+/**
+ * @brief Gibt den ersten ausgerichteten Versatz im aktuellen Block ab offset zurück.
+ * @param alignment Geforderte Ausrichtung (Zweierpotenz).
+ * @return Versatz im aktuellen Block.
+ */
+std::size_t GameArena::alignedOffset(std::size_t alignment) const {
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(chunks.back().data) + offset;
+    return offset + ((alignment - address % alignment) & (alignment - 1));
+}
+
+/**
+ * @brief Holt einen neuen Block vom Heap.
+ * @param minimumSize Mindestgröße des Blocks in Bytes.
+ *
+ * Die Blockgröße verdoppelt sich, damit die Anzahl der Heap-Anforderungen logarithmisch bleibt.
+ */
+void GameArena::addChunk(std::size_t minimumSize) {
+    std::size_t size = std::max(minimumSize, chunks.empty() ? std::size_t(0) : chunks.back().size * 2);
+    chunks.push_back(Chunk{static_cast<std::byte *>(::operator new(size)), size});
+    offset = 0;
+    allocationsThisGame++;
+    if (hook) {
+        hook(size, allocationsThisGame);
+    }
+}
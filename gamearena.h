@@ -0,0 +1,149 @@
+#ifndef GAMEARENA_H
+#define GAMEARENA_H
+
+#include <memory_resource>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+/**
+ * @file gamearena.h
+ * @class GameArena
+ * @brief Monotoner Speicherbereich für die kurzlebigen Daten eines Spiels.
+ *
+ * Alle Puffer, die nur während eines Spiels leben (Liste der geänderten Zellen,
+ * Öffnungslisten, Hilfspuffer der Spielfeldschleifen), holen ihren Speicher per Bump-Pointer
+ * aus dieser Arena. Freigaben einzelner Blöcke sind wirkungslos; erst reset() gibt alles
+ * auf einmal frei, indem der Zeiger zurückgesetzt wird.
+ *
+ * Technische Entscheidung:
+ * Die Arena ist eine std::pmr::memory_resource, sodass die Standardcontainer aus
+ * std::pmr sie direkt verwenden können. Reicht der Speicher nicht, wird ein weiterer Block
+ * vom Heap geholt. Beim Zurücksetzen werden mehrere Blöcke zu einem großen zusammengelegt,
+ * damit das nächste Spiel gleicher Größe den Heap gar nicht mehr braucht. Behalten wird
+ * höchstens MAX_RETAINED_SIZE, damit ein einzelnes riesiges Spiel den Speicher nicht bis zum
+ * Programmende belegt.
+ *
+ * Abhängigkeit: ist unabhängig und wird nur vom Game-Modul eingebunden.
+ *
+ * @author Daniel Schukin
+ */
+class GameArena : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t MAX_RETAINED_SIZE = 64 << 20; ///< Größter Block, den reset() für das nächste Spiel behält.
+
+    /**
+     * @brief Callback, der bei jeder Heap-Anforderung der Arena aufgerufen wird.
+     *
+     * Parameter: Größe des neuen Blocks in Bytes und Anzahl der Heap-Anforderungen seit dem
+     * letzten reset().
+     */
+    using AllocationHook = std::function<void(std::size_t bytes, int allocationsThisGame)>;
+
+    /**
+     * @brief Konstruktor für GameArena.
+     * @param initialSize Größe des ersten Blocks in Bytes.
+     *
+     * @author Daniel Schukin
+     */
+    explicit GameArena(std::size_t initialSize = 64 * 1024);
+
+    /**
+     * @brief Destruktor für GameArena. Gibt alle Blöcke frei.
+     *
+     * @author Daniel Schukin
+     */
+    ~GameArena() override;
+
+    GameArena(const GameArena &) = delete;
+    GameArena &operator=(const GameArena &) = delete;
+
+    /**
+     * @brief Gibt den gesamten Speicher der Arena für das nächste Spiel frei.
+     *
+     * Alle Container, die Speicher aus der Arena halten, müssen vorher geleert sein.
+     *
+     * @author Daniel Schukin
+     */
+    void reset();
+
+    /**
+     * @brief Setzt den Callback für Heap-Anforderungen.
+     * @param hook Aufzurufende Funktion, leer zum Abschalten.
+     *
+     * @author Daniel Schukin
+     */
+    void setAllocationHook(AllocationHook hook) { this->hook = std::move(hook); }
+
+    /**
+     * @brief Gibt die Anzahl der Heap-Anforderungen seit dem letzten reset() zurück.
+     * @return Anzahl der Heap-Anforderungen im aktuellen Spiel.
+     *
+     * @author Daniel Schukin
+     */
+    int getAllocationsThisGame() const { return allocationsThisGame; }
+
+    /**
+     * @brief Gibt die Anzahl der seit dem letzten reset() vergebenen Bytes zurück.
+     * @return Belegte Bytes im aktuellen Spiel.
+     *
+     * @author Daniel Schukin
+     */
+    std::size_t getBytesUsed() const { return bytesUsed; }
+
+    /**
+     * @brief Gibt die Größe aller Blöcke zusammen zurück.
+     * @return Kapazität der Arena in Bytes.
+     *
+     * @author Daniel Schukin
+     */
+    std::size_t getCapacity() const;
+
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void *, std::size_t, std::size_t) override {} ///< Einzelne Freigaben sind wirkungslos.
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+    /// @brief Ein vom Heap geholter Speicherblock.
+    struct Chunk
+    {
+        std::byte *data;  ///< Beginn des Blocks.
+        std::size_t size; ///< Größe des Blocks in Bytes.
+    };
+
+    /**
+     * @brief Holt einen neuen Block vom Heap und macht ihn zum aktuellen.
+     * @param minimumSize Mindestgröße des Blocks in Bytes.
+     *
+     * @author Daniel Schukin
+     */
+    void addChunk(std::size_t minimumSize);
+
+    /**
+     * @brief Gibt den ersten ausgerichteten Versatz im aktuellen Block ab offset zurück.
+     * @param alignment Geforderte Ausrichtung (Zweierpotenz).
+     * @return Versatz im aktuellen Block.
+     *
+     * @author Daniel Schukin
+     */
+    std::size_t alignedOffset(std::size_t alignment) const;
+
+    std::vector<Chunk> chunks; ///< Alle Blöcke, der letzte ist der aktuelle.
+    std::size_t offset = 0; ///< Belegte Bytes im aktuellen Block.
+    std::size_t bytesUsed = 0; ///< Vergebene Bytes seit dem letzten reset().
+    int allocationsThisGame = 0; ///< Heap-Anforderungen seit dem letzten reset().
+    AllocationHook hook; ///< Callback für Heap-Anforderungen.
+};
+
+/**
+ * @brief Vektor, dessen Speicher aus einer GameArena stammt.
+ *
+ * Beim Kopieren muss die Arena explizit übergeben werden, sonst fällt std::pmr auf den
+ * Standard-Heap zurück.
+ */
+template <class T>
+using ArenaVector = std::pmr::vector<T>;
+
+#endif // GAMEARENA_H
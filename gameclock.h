@@ -0,0 +1,83 @@
+#ifndef GAMECLOCK_H
+#define GAMECLOCK_H
+
+#include <QElapsedTimer>
+
+/**
+ * @file gameclock.h
+ * @class GameClock
+ * @brief Misst die Spielzeit mit Pausen.
+ *
+ * Die Zeit kommt aus einer monotonen Uhr, Pausen werden also exakt herausgerechnet und
+ * Verzögerungen der Anzeige haben keinen Einfluss auf die Spielzeit.
+ *
+ * Technische Entscheidung:
+ * Die Uhr ist eine eigene Klasse, weil sie an zwei Stellen gebraucht wird: im Game-Modul ohne
+ * Oberfläche und in MainWindow, seit das Spiel im Engine-Thread läuft. Dort misst die
+ * Oberfläche die Zeit und gibt sie mit jedem Befehl an das Spiel weiter.
+ *
+ * @author Daniel Schukin
+ */
+class GameClock
+{
+public:
+    /**
+     * @brief Gibt die Spielzeit zurück, bei laufender Uhr einschließlich des aktuellen Abschnitts.
+     * @return Spielzeit in ms.
+     *
+     * @author Daniel Schukin
+     */
+    qint64 getElapsedTime() const {
+        return (elapsedNsecs + (timer.isValid() ? timer.nsecsElapsed() : 0)) / 1000000;
+    }
+
+    /**
+     * @brief Gibt an, ob die Uhr gerade läuft.
+     * @return True zwischen start() und stop().
+     *
+     * @author Daniel Schukin
+     */
+    bool is_running() const { return timer.isValid(); }
+
+    /**
+     * @brief Setzt die Spielzeit; eine laufende Uhr zählt von diesem Wert aus weiter.
+     * @param value Neue Spielzeit in ms.
+     *
+     * @author Daniel Schukin
+     */
+    void setElapsedTime(qint64 value) {
+        elapsedNsecs = value * 1000000;
+        if (timer.isValid()) {
+            timer.restart();
+        }
+    }
+
+    /**
+     * @brief Startet die Uhr bzw. setzt sie nach einer Pause fort.
+     *
+     * @author Daniel Schukin
+     */
+    void start() {
+        if (!timer.isValid()) {
+            timer.start();
+        }
+    }
+
+    /**
+     * @brief Hält die Uhr an und rechnet den laufenden Abschnitt auf die Spielzeit an.
+     *
+     * @author Daniel Schukin
+     */
+    void stop() {
+        if (timer.isValid()) {
+            elapsedNsecs += timer.nsecsElapsed();
+            timer.invalidate();
+        }
+    }
+
+private:
+    qint64 elapsedNsecs = 0; ///< Spielzeit der abgeschlossenen Abschnitte in ns.
+    QElapsedTimer timer; ///< Misst den laufenden Abschnitt; ungültig, solange die Uhr steht.
+};
+
+#endif // GAMECLOCK_H
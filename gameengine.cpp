@@ -0,0 +1,353 @@
+#include "gameengine.h"
+#include "deltarecorder.h"
+#include "game.h"
+#include "gamesnapshot.h"
+#include "tracing.h"
+#include <QThread>
+#include <QFile>
+
+/**
+ * @brief Konstruktor für GameEngine.
+ * @param game Spiel, das der Engine-Thread ab start() verwendet.
+ * @param parent Übergeordnetes Objekt.
+ */
+GameEngine::GameEngine(Game *game, QObject *parent)
+    : QObject(parent)
+    , game(game)
+    , deltaRecorder(new DeltaRecorder)
+    , commands(COMMAND_CAPACITY)
+    , events(EVENT_CAPACITY)
+{
+}
+
+/**
+ * @brief Destruktor für GameEngine. Beendet den Thread und schließt einen laufenden Mitschnitt ab.
+ */
+GameEngine::~GameEngine() {
+    stop();
+    delete deltaRecorder;
+}
+
+/**
+ * @brief Startet den Engine-Thread.
+ */
+void GameEngine::start() {
+    if (thread != nullptr) {
+        return;
+    }
+    stopping = false;
+    thread = QThread::create([this]() { run(); });
+    thread->start();
+}
+
+/**
+ * @brief Arbeitet die restlichen Befehle ab und beendet den Thread.
+ *
+ * Der einzige Fall, in dem die Oberfläche auf die Engine wartet; er tritt nur beim Beenden ein.
+ */
+void GameEngine::stop() {
+    if (thread == nullptr) {
+        return;
+    }
+    stopping = true;
+    EngineCommand quit;
+    quit.type = EngineCommand::QUIT;
+    while (!commands.tryPush(quit)) {
+        QThread::msleep(1);
+    }
+    commandsAvailable.release();
+    thread->wait();
+    delete thread;
+    thread = nullptr;
+}
+
+/**
+ * @brief Schickt einen Befehl an den Engine-Thread; wartet nie.
+ * @param command Befehl.
+ * @return False, wenn die Befehlsschlange voll ist.
+ */
+bool GameEngine::post(const EngineCommand &command) {
+    if (!commands.tryPush(command)) {
+        qCWarning(lcEngine) << "Befehlsschlange voll, Befehl verworfen";
+        return false;
+    }
+    commandsAvailable.release();
+    return true;
+}
+
+/**
+ * @brief Holt das älteste Ereignis ab.
+ * @param event Abgeholtes Ereignis.
+ * @return False, wenn keins bereitliegt.
+ *
+ * Ist die Schlange leer, darf der Engine-Thread für das nächste Ereignis wieder
+ * eventsAvailable() senden. Das Zurücksetzen geschieht vor dem letzten Leseversuch, damit kein
+ * Ereignis ohne Signal liegen bleibt.
+ */
+bool GameEngine::takeEvent(EngineEvent &event) {
+    if (events.tryPop(event)) {
+        return true;
+    }
+    notifyPending.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst); ///< Gegenstück zum Zaun in publish()
+    return events.tryPop(event);
+}
+
+/**
+ * @brief Schleife des Engine-Threads.
+ */
+void GameEngine::run() {
+    EngineCommand command;
+    while (true) {
+        commandsAvailable.acquire();
+        if (!commands.tryPop(command)) {
+            continue;
+        }
+        if (command.type == EngineCommand::QUIT) {
+            return;
+        }
+        execute(command);
+    }
+}
+
+/**
+ * @brief Führt einen Befehl aus und legt sein Ereignis ab.
+ * @param command Befehl.
+ *
+ * Die Spielzeit des Befehls wird vor dem Zug übernommen; endet das Spiel, geht sie so in die
+ * Statistik ein.
+ */
+void GameEngine::execute(const EngineCommand &command) {
+    TRACE_SPAN("engine.execute");
+    switch (command.type) {
+    case EngineCommand::NEW_GAME: {
+        const GameSetup &setup = command.setup;
+        game->setStatisticsEnabled(setup.statisticsEnabled);
+        game->changeLength(setup.length);
+        game->changeWidth(setup.width);
+        game->changeMinesNumber(setup.minesNumber);
+        game->setSafeOpening(setup.safeOpening);
+        game->createMatrix(setup.length, setup.width);
+        game->place_mines(setup.seed);
+        game->count_mines_around();
+        game->resetMarkedCells();
+        game->setWon(false);
+        game->setElapsedTime(0);
+        game->getChangedCells()->clear();
+        plane.reset(setup.length, setup.width);
+        publish(makeEvent(EngineEvent::BOARD));
+        return;
+    }
+    case EngineCommand::LOAD_SNAPSHOT: {
+        game->setStatisticsEnabled(true);
+        if (!QFile::exists(command.filePath) || !GameSnapshot::load(*game, command.filePath)) {
+            return; ///< kein Spielstand: die Oberfläche bleibt beim normalen Start
+        }
+        game->getChangedCells()->clear();
+        plane.reset(game->getLength(), game->getWidth());
+        for (int row = 0; row < game->getLength(); row++) {
+            for (int col = 0, count = 0; col < game->getWidth(); col += count) {
+                quint8 *codes = plane.rowData(row, col, count);
+                game->getCellCodes(row, col, count, codes);
+            }
+        }
+        EngineEvent event = makeEvent(EngineEvent::BOARD); ///< wie bei NEW_GAME nur die Ebene, cells bleibt leer
+        event.loaded = true;
+        publish(std::move(event));
+        return;
+    }
+    case EngineCommand::SAVE_SNAPSHOT:
+        if (game->is_inGame()) {
+            game->setElapsedTime(command.elapsedTime);
+            GameSnapshot::write(GameSnapshot::serialize(*game), command.filePath);
+        } else {
+            QFile::remove(command.filePath); ///< ein beendetes Spiel wird nicht fortgesetzt
+        }
+        return; ///< ändert nichts am Spielfeld, also kein Ereignis
+    case EngineCommand::EXPORT_BOARD:
+        if (command.filePath.isEmpty()) {
+            boardExport.close();
+        } else if (boardExport.open(command.filePath)) {
+            boardExport.writeBoard(makeEvent(EngineEvent::BOARD)); ///< Leser sehen sofort das laufende Spiel
+        } else {
+            qCWarning(lcEngine) << "Spielfeld konnte nicht veröffentlicht werden:" << boardExport.errorString();
+        }
+        return; ///< ändert nichts am Spielfeld, also kein Ereignis
+    case EngineCommand::RECORD_DELTAS:
+        if (command.filePath.isEmpty()) {
+            deltaRecorder->finish();
+        } else if (deltaRecorder->start(command.filePath)) {
+            deltaRecorder->recordBoard(makeEvent(EngineEvent::BOARD)); ///< Zuschauer sehen sofort das laufende Spiel
+        } else {
+            qCWarning(lcEngine) << "Mitschnitt konnte nicht begonnen werden:" << deltaRecorder->errorString();
+        }
+        return; ///< ändert nichts am Spielfeld, also kein Ereignis
+    case EngineCommand::HINT:
+        if (game->is_inGame()) {
+            game->markAssisted();
+        }
+        return; ///< ändert nichts am Spielfeld, also kein Ereignis
+    case EngineCommand::QUIT:
+        return;
+    default:
+        break;
+    }
+
+    game->setElapsedTime(command.elapsedTime);
+    switch (command.type) {
+    case EngineCommand::OPEN:
+        game->open_cell(command.row, command.col);
+        break;
+    case EngineCommand::UNMARK:
+        game->unmark_cell(command.row, command.col);
+        break;
+    case EngineCommand::MARK:
+        game->mark_cell(command.row, command.col);
+        break;
+    case EngineCommand::UNDO:
+        game->undo();
+        break;
+    case EngineCommand::REDO:
+        game->redo();
+        break;
+    case EngineCommand::RESIGN:
+        game->gameLost();
+        break;
+    case EngineCommand::ABANDON:
+        if (game->is_inGame()) {
+            game->setWon(false);
+            game->gameEnd();
+        }
+        break;
+    default:
+        break;
+    }
+
+    ArenaVector<QPoint> *changed = game->getChangedCells();
+    if (command.type == EngineCommand::OPEN && revealOrdered) {
+        orderFromClick(*changed, command.row, command.col);
+    }
+    QVector<CellUpdate> cells;
+    cells.reserve(int(changed->size()));
+    for (const QPoint &coord : *changed) {
+        const int status = game->getCellStatus(coord.x(), coord.y());
+        const int minesAround = game->getCellMinesNumber(coord.x(), coord.y());
+        cells.append({coord.x(), coord.y(), qint8(status), qint8(minesAround)});
+        plane.set(coord.x(), coord.y(), BoardPlane::cellCode(status, minesAround));
+    }
+    changed->clear();
+    EngineEvent event = makeEvent(EngineEvent::MOVE);
+    event.cells = std::move(cells);
+    publish(std::move(event));
+}
+
+/**
+ * @brief Sortiert die geänderten Zellen eines Zugs in Breitensuche-Reihenfolge ab der angeklickten Zelle.
+ * @param changed Geänderte Zellen; werden in-place umsortiert.
+ * @param row Zeilenindex der angeklickten Zelle.
+ * @param col Spaltenindex der angeklickten Zelle.
+ *
+ * Das Spiel liefert eine Öffnung zeilenweise. Für das schrittweise Aufdecken in BoardView soll
+ * sie sich aber wie eine Welle vom Klick aus ausbreiten. Gesucht wird über die 8 Nachbarn,
+ * aber nur innerhalb der geänderten Zellen; nicht erreichbare Zellen (z.B. die Minen bei einer
+ * Niederlage) folgen in ihrer ursprünglichen Reihenfolge.
+ */
+void GameEngine::orderFromClick(ArenaVector<QPoint> &changed, int row, int col) {
+    TRACE_SPAN("engine.orderFromClick");
+    const int length = game->getLength();
+    const int width = game->getWidth();
+    if (changed.size() < 2 || row < 0 || col < 0 || row >= length || col >= width) {
+        return;
+    }
+    if (revealMarks.size() != length * width) {
+        revealMarks.fill(0, length * width);
+    }
+    for (const QPoint &coord : changed) {
+        revealMarks[coord.x() * width + coord.y()] = 1; ///< geändert, noch nicht einsortiert
+    }
+
+    QVector<QPoint> order;
+    order.reserve(int(changed.size()));
+    if (revealMarks[row * width + col] == 1) {
+        revealMarks[row * width + col] = 2;
+        order.append(QPoint(row, col));
+    }
+    for (int next = 0; next < order.size(); next++) {
+        const QPoint cell = order.at(next);
+        for (int r = qMax(0, cell.x() - 1); r <= qMin(length - 1, cell.x() + 1); r++) {
+            for (int c = qMax(0, cell.y() - 1); c <= qMin(width - 1, cell.y() + 1); c++) {
+                quint8 &mark = revealMarks[r * width + c];
+                if (mark == 1) {
+                    mark = 2;
+                    order.append(QPoint(r, c));
+                }
+            }
+        }
+    }
+    for (const QPoint &coord : changed) {
+        quint8 &mark = revealMarks[coord.x() * width + coord.y()];
+        if (mark == 1) {
+            order.append(coord);
+        }
+        mark = 0; ///< für den nächsten Zug wieder leer
+    }
+    std::copy(order.cbegin(), order.cend(), changed.begin());
+}
+
+/**
+ * @brief Erzeugt ein Ereignis mit den Zählern und der Anzeigeebene des Spiels.
+ * @param type Art des Ereignisses.
+ * @return Ereignis ohne Zellen.
+ */
+EngineEvent GameEngine::makeEvent(EngineEvent::Type type) const {
+    EngineEvent event;
+    event.type = type;
+    event.setup.length = game->getLength();
+    event.setup.width = game->getWidth();
+    event.setup.minesNumber = game->getMinesNumber();
+    event.setup.seed = game->getSeed();
+    event.setup.safeOpening = game->is_safeOpening();
+    event.markedCells = game->getMarkedCells();
+    event.inGame = game->is_inGame();
+    event.won = game->is_won();
+    event.elapsedTime = game->getElapsedTime();
+    event.plane = plane; ///< nur Referenzen, siehe BoardPlane
+    return event;
+}
+
+/**
+ * @brief Legt ein Ereignis ab und meldet es der Oberfläche.
+ * @param event Ereignis.
+ *
+ * Ist die Ereignisschlange voll, wartet die Engine (nicht die Oberfläche), bis wieder Platz
+ * ist; beim Beenden wird das Ereignis verworfen. Das Signal geht nur raus, wenn seit der
+ * letzten Leerung noch keins gesendet wurde. Ist das Spielfeld freigegeben oder läuft ein
+ * Mitschnitt, bekommen Segment und DeltaRecorder das Ereignis vorher, unabhängig davon, wann
+ * die Oberfläche es abholt.
+ */
+void GameEngine::publish(EngineEvent &&event) {
+    if (boardExport.isOpen()) {
+        if (event.type == EngineEvent::BOARD) {
+            boardExport.writeBoard(event);
+        } else {
+            boardExport.writeMove(event);
+        }
+    }
+    if (deltaRecorder->is_recording()) {
+        if (event.type == EngineEvent::BOARD) {
+            deltaRecorder->recordBoard(event);
+        } else {
+            deltaRecorder->recordMove(event);
+        }
+    }
+    while (!events.tryPush(std::move(event))) {
+        if (stopping) {
+            return;
+        }
+        QThread::msleep(1);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst); ///< Ereignis sichtbar, bevor das Flag gelesen wird
+    if (!notifyPending.exchange(true)) {
+        emit eventsAvailable();
+    }
+}
@@ -0,0 +1,267 @@
+#ifndef GAMEENGINE_H
+#define GAMEENGINE_H
+
+#include "spscqueue.h"
+#include "boardexport.h"
+#include "boardplane.h"
+#include "gamearena.h"
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QPoint>
+#include <QSemaphore>
+#include <atomic>
+
+class DeltaRecorder;
+class Game;
+class QThread;
+
+/**
+ * @brief Einstellungen, aus denen ein Spielfeld erzeugt wird.
+ *
+ * Zusammen mit dem Seed beschreiben sie ein Spielfeld vollständig (wie der Kopf einer
+ * Aufzeichnung).
+ *
+ * @author Daniel Schukin
+ */
+struct GameSetup
+{
+    int length = 10;                ///< Anzahl der Zeilen.
+    int width = 10;                 ///< Anzahl der Spalten.
+    int minesNumber = 10;           ///< Anzahl der Minen.
+    quint64 seed = 0;               ///< Seed des Spielfelds.
+    bool safeOpening = true;        ///< Erster Klick öffnet immer eine Öffnung.
+    bool statisticsEnabled = true;  ///< Beendete Spiele gehen in die Statistik ein.
+};
+
+/**
+ * @brief Befehl der Oberfläche an den Engine-Thread.
+ *
+ * @author Daniel Schukin
+ */
+struct EngineCommand
+{
+    /// @brief Art des Befehls.
+    enum Type {
+        NEW_GAME,      ///< Neues Spielfeld aus setup erzeugen.
+        OPEN,          ///< Zelle öffnen.
+        UNMARK,        ///< Markierung entfernen.
+        MARK,          ///< Zelle markieren.
+        UNDO,          ///< Letzten Zug rückgängig machen.
+        REDO,          ///< Rückgängig gemachten Zug wiederholen.
+        RESIGN,        ///< Spiel aufgeben (verloren).
+        ABANDON,       ///< Laufendes Spiel als verloren in die Statistik übernehmen, z.B. vor neuen Einstellungen.
+        HINT,          ///< Ein Tipp wurde angezeigt; das laufende Spiel zählt als mit Tipp gespielt.
+        SAVE_SNAPSHOT, ///< Laufendes Spiel nach filePath speichern, sonst die Datei löschen.
+        LOAD_SNAPSHOT, ///< Spiel aus filePath laden.
+        EXPORT_BOARD,  ///< Spielfeld im Shared-Memory-Segment filePath veröffentlichen; leer beendet das.
+        RECORD_DELTAS, ///< Live-Mitschnitt der Änderungen nach filePath schreiben; leer beendet ihn.
+        QUIT           ///< Engine-Thread beenden.
+    };
+
+    Type type = OPEN;        ///< Art des Befehls.
+    int row = 0;             ///< Zeilenindex der Zelle (bei Zellbefehlen).
+    int col = 0;             ///< Spaltenindex der Zelle (bei Zellbefehlen).
+    qint64 elapsedTime = 0;  ///< Spielzeit in ms zum Zeitpunkt des Befehls.
+    GameSetup setup;         ///< Einstellungen (bei NEW_GAME).
+    QString filePath;        ///< Datei (bei SAVE_SNAPSHOT/LOAD_SNAPSHOT/RECORD_DELTAS) oder Segment (bei EXPORT_BOARD).
+};
+
+/**
+ * @brief Geänderte Zelle in einem EngineEvent.
+ *
+ * @author Daniel Schukin
+ */
+struct CellUpdate
+{
+    int row;            ///< Zeilenindex der Zelle.
+    int col;            ///< Spaltenindex der Zelle.
+    qint8 status;       ///< Status der Zelle, siehe Game::getCellStatus().
+    qint8 minesAround;  ///< Anzahl benachbarter Minen (nur bei aufgedeckten Zellen gültig).
+};
+
+/**
+ * @brief Ergebnis eines Befehls vom Engine-Thread an die Oberfläche.
+ *
+ * @author Daniel Schukin
+ */
+struct EngineEvent
+{
+    /// @brief Art des Ereignisses.
+    enum Type {
+        BOARD, ///< Neues oder geladenes Spielfeld; nur plane ist gefüllt, cells bleibt leer.
+        MOVE   ///< Zug; cells enthält alle geänderten Zellen.
+    };
+
+    Type type = MOVE;            ///< Art des Ereignisses.
+    bool loaded = false;         ///< True, wenn das Spielfeld aus einem Spielstand stammt (bei BOARD).
+    GameSetup setup;             ///< Einstellungen des Spielfelds (bei BOARD).
+    QVector<CellUpdate> cells;   ///< Geänderte Zellen; bei OPEN ggf. ab der angeklickten Zelle sortiert, siehe GameEngine::setRevealOrdered().
+    BoardPlane plane;            ///< Anzeigecodes aller Zellen nach dem Befehl (Copy-on-Write-Kopie).
+    int markedCells = 0;         ///< Anzahl der markierten Zellen danach.
+    bool inGame = false;         ///< True, wenn das Spiel danach noch läuft.
+    bool won = false;            ///< True, wenn das Spiel gewonnen wurde.
+    qint64 elapsedTime = 0;      ///< Spielzeit in ms nach dem Befehl.
+};
+
+/**
+ * @file gameengine.h
+ * @class GameEngine
+ * @brief Führt die Spiellogik in einem eigenen Thread aus.
+ *
+ * Die Oberfläche schickt Befehle mit post(), der Engine-Thread führt sie der Reihe nach auf dem
+ * Game-Objekt aus und legt für jeden Befehl ein Ereignis mit den geänderten Zellen, den Zählern
+ * und einer Kopie der Anzeigeebene (BoardPlane) ab. Liegen neue Ereignisse bereit, wird
+ * eventsAvailable() gesendet; die Oberfläche holt sie mit takeEvent() ab. Die Reihenfolge der
+ * Züge bleibt in beiden Richtungen erhalten.
+ *
+ * Technische Entscheidung:
+ * Befehle und Ereignisse laufen über je eine sperrfreie SPSC-Warteschlange. post() kostet
+ * damit nur das Kopieren des Befehls und wartet nie auf die Engine, auch nicht während eines
+ * Zugs, der Millionen Zellen aufdeckt. Der Engine-Thread schläft auf einem Semaphor, solange
+ * keine Befehle anliegen. eventsAvailable() wird zusammengefasst: ein Signal pro Leerung der
+ * Schlange statt eines pro Zug, damit die Ereignisschleife der Oberfläche nicht überläuft.
+ *
+ * Die Spielzeit misst die Oberfläche (siehe GameClock) und gibt sie mit jedem Befehl mit. Die
+ * Zeit eines Zugs ist damit der Zeitpunkt des Klicks, nicht das Ende seiner Berechnung.
+ *
+ * Abhängigkeit: besitzt das Game-Objekt, solange der Thread läuft; niemand sonst darf es dann
+ * verwenden.
+ *
+ * @author Daniel Schukin
+ */
+class GameEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int COMMAND_CAPACITY = 4096; ///< Plätze der Befehlsschlange.
+    static constexpr int EVENT_CAPACITY = 4096; ///< Plätze der Ereignisschlange.
+
+    /**
+     * @brief Konstruktor für GameEngine.
+     * @param game Spiel, das der Engine-Thread ab start() verwendet.
+     * @param parent Übergeordnetes Objekt.
+     *
+     * @author Daniel Schukin
+     */
+    explicit GameEngine(Game *game, QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor für GameEngine. Beendet den Thread, siehe stop().
+     *
+     * @author Daniel Schukin
+     */
+    ~GameEngine();
+
+    /**
+     * @brief Startet den Engine-Thread.
+     *
+     * @author Daniel Schukin
+     */
+    void start();
+
+    /**
+     * @brief Arbeitet die restlichen Befehle ab und beendet den Thread.
+     *
+     * Wartet, bis der Thread fertig ist, z.B. damit ein Spielstand vor dem Beenden geschrieben
+     * ist. Nicht abgeholte Ereignisse werden verworfen.
+     *
+     * @author Daniel Schukin
+     */
+    void stop();
+
+    /**
+     * @brief Schickt einen Befehl an den Engine-Thread; wartet nie.
+     * @param command Befehl.
+     * @return False, wenn die Befehlsschlange voll ist; der Befehl wird dann verworfen.
+     *
+     * @author Daniel Schukin
+     */
+    bool post(const EngineCommand &command);
+
+    /**
+     * @brief Legt fest, ob die Zellen eines OPEN-Ereignisses ab dem Klick sortiert werden.
+     * @param enabled True für Breitensuche-Reihenfolge (für das schrittweise Aufdecken), sonst zeilenweise.
+     *
+     * Darf aus jedem Thread aufgerufen werden; gilt ab dem nächsten ausgeführten Befehl.
+     *
+     * @author Daniel Schukin
+     */
+    void setRevealOrdered(bool enabled) { revealOrdered = enabled; }
+
+    /**
+     * @brief Holt das älteste Ereignis ab.
+     * @param event Abgeholtes Ereignis.
+     * @return False, wenn keins bereitliegt.
+     *
+     * @author Daniel Schukin
+     */
+    bool takeEvent(EngineEvent &event);
+
+signals:
+    /**
+     * @brief Wird aus dem Engine-Thread gesendet, wenn nach einer Leerung wieder Ereignisse bereitliegen.
+     *
+     * @author Daniel Schukin
+     */
+    void eventsAvailable();
+
+private:
+    /**
+     * @brief Schleife des Engine-Threads.
+     *
+     * @author Daniel Schukin
+     */
+    void run();
+
+    /**
+     * @brief Führt einen Befehl aus und legt sein Ereignis ab.
+     * @param command Befehl.
+     *
+     * @author Daniel Schukin
+     */
+    void execute(const EngineCommand &command);
+
+    /**
+     * @brief Sortiert die geänderten Zellen eines Zugs in Breitensuche-Reihenfolge ab der angeklickten Zelle.
+     * @param changed Geänderte Zellen; werden in-place umsortiert.
+     * @param row Zeilenindex der angeklickten Zelle.
+     * @param col Spaltenindex der angeklickten Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    void orderFromClick(ArenaVector<QPoint> &changed, int row, int col);
+
+    /**
+     * @brief Erzeugt ein Ereignis mit den Zählern und der Anzeigeebene des Spiels.
+     * @param type Art des Ereignisses.
+     * @return Ereignis ohne Zellen.
+     *
+     * @author Daniel Schukin
+     */
+    EngineEvent makeEvent(EngineEvent::Type type) const;
+
+    /**
+     * @brief Legt ein Ereignis ab und meldet es der Oberfläche.
+     * @param event Ereignis.
+     *
+     * @author Daniel Schukin
+     */
+    void publish(EngineEvent &&event);
+
+    Game *game; ///< Spiel; gehört ab start() dem Engine-Thread.
+    BoardPlane plane; ///< Anzeigecodes aller Zellen; schreibt nur der Engine-Thread.
+    BoardExport boardExport; ///< Veröffentlichtes Spielfeld für andere Prozesse, siehe EXPORT_BOARD.
+    DeltaRecorder *deltaRecorder; ///< Live-Mitschnitt der Änderungen, siehe RECORD_DELTAS.
+    QVector<quint8> revealMarks; ///< Markierungen für orderFromClick(), zwischen den Zügen alle 0.
+    QThread *thread = nullptr; ///< Engine-Thread.
+    SpscQueue<EngineCommand> commands; ///< Befehle von der Oberfläche.
+    SpscQueue<EngineEvent> events; ///< Ereignisse an die Oberfläche.
+    QSemaphore commandsAvailable; ///< Anzahl der anliegenden Befehle.
+    std::atomic<bool> notifyPending{false}; ///< True, solange ein gesendetes eventsAvailable() nicht abgeholt wurde.
+    std::atomic<bool> revealOrdered{false}; ///< True, wenn OPEN-Ereignisse ab dem Klick sortiert werden.
+    std::atomic<bool> stopping{false}; ///< True während stop(); volle Ereignisschlange wird dann nicht mehr abgewartet.
+};
+
+#endif // GAMEENGINE_H
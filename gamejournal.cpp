@@ -0,0 +1,73 @@
+#include "gamejournal.h"
+
+/**
+ * @brief Konstruktor für GameJournal.
+ * @param arena Arena, aus der alle Läufe ihren Speicher holen.
+ */
+GameJournal::GameJournal(GameArena *arena) : arena(arena), runs(arena), moves(arena) {}
+
+/**
+ * @brief Leert das Protokoll für ein neues Spiel.
+ *
+ * Die Vektoren werden durch leere ersetzt, damit sie keinen Speicher der Arena mehr halten.
+ */
+void GameJournal::clear() {
+    ArenaVector<Run>(arena).swap(runs);
+    ArenaVector<Move>(arena).swap(moves);
+    applied = 0;
+    recording = false;
+}
+
+/**
+ * @brief Beginnt einen neuen Zug.
+ *
+ * Liegen noch rückgängig gemachte Züge hinter dem aktuellen, werden sie verworfen.
+ */
+void GameJournal::beginMove() {
+    if (canRedo()) {
+        runs.resize(moves[applied].firstRun);
+        moves.resize(applied);
+    }
+    moves.push_back(Move{std::int32_t(runs.size()), false, false});
+    applied++;
+    recording = true;
+}
+
+/**
+ * @brief Merkt sich die umgeschalteten Bits einer Zelle im aktuellen Zug.
+ * @param index Zellindex im Zellspeicher des Spiels.
+ * @param mask Umgeschaltete Bits.
+ *
+ * Schließt die Zelle direkt an den letzten Lauf des Zugs mit denselben Bits an, wird
+ * dieser verlängert, sonst beginnt ein neuer Lauf.
+ */
+void GameJournal::record(int index, std::uint8_t mask) {
+    if (!recording) {
+        return;
+    }
+    if (int(runs.size()) > moves.back().firstRun) {
+        Run &last = runs.back();
+        if (last.mask == mask && last.start + last.length == index && last.length < UINT16_MAX) {
+            last.length++;
+            return;
+        }
+    }
+    runs.push_back(Run{index, 1, mask});
+}
+
+/**
+ * @brief Schließt den aktuellen Zug ab.
+ * @param endedGame True, wenn der Zug das Spiel beendet hat.
+ * @param won Ergebnis des Spiels, falls endedGame.
+ */
+void GameJournal::endMove(bool endedGame, bool won) {
+    recording = false;
+    ///< ein Zug ohne veränderte Zelle (z.B. Klick auf eine aufgedeckte Zelle) wird nicht gespeichert
+    if (int(runs.size()) == moves.back().firstRun) {
+        moves.pop_back();
+        applied--;
+        return;
+    }
+    moves.back().endedGame = endedGame;
+    moves.back().won = won;
+}
@@ -0,0 +1,181 @@
+#ifndef GAMEJOURNAL_H
+#define GAMEJOURNAL_H
+
+#include "gamearena.h"
+#include <cstdint>
+
+/**
+ * @file gamejournal.h
+ * @class GameJournal
+ * @brief Protokoll aller Zellveränderungen eines Spiels für Rückgängig und Wiederholen.
+ *
+ * Jeder Zug (Öffnen, Markieren, Entmarkieren) wird als Liste der umgeschalteten Zellbits
+ * gespeichert. Aufeinanderfolgende Zellen mit denselben umgeschalteten Bits werden zu einem
+ * Lauf (Run) zusammengefasst, eine aufgedeckte Öffnung braucht so nur wenige Einträge.
+ *
+ * Technische Entscheidung:
+ * Da jeder Eintrag nur Bits umschaltet (XOR), ist derselbe Eintrag sowohl für Rückgängig als
+ * auch für Wiederholen gültig, beides kostet O(Anzahl der geänderten Zellen). Der Speicher
+ * wächst nur mit den tatsächlich veränderten Zellen, nie mit der Spielfeldgröße. Die Läufe
+ * liegen in der Arena des Spiels und werden mit ihr bei neuem Spiel freigegeben.
+ *
+ * Abhängigkeit: wird vom Game-Modul verwendet, die Bits beziehen sich auf die Zustände der Cell-Klasse.
+ *
+ * @author Daniel Schukin
+ */
+class GameJournal
+{
+public:
+    /// @name Umschaltbare Zellbits
+    /// @{
+    static constexpr std::uint8_t HIDDEN = 0x01;   ///< Zelle verdeckt/aufgedeckt.
+    static constexpr std::uint8_t MARKED = 0x02;   ///< Markierung gesetzt/entfernt.
+    static constexpr std::uint8_t EXPLODED = 0x04; ///< Mine explodiert.
+    /// @}
+
+    /// @brief Folge benachbarter Zellindizes, bei denen dieselben Bits umgeschaltet wurden.
+    struct Run
+    {
+        std::int32_t start;   ///< Erster Zellindex (Index wie im Zellspeicher des Spiels).
+        std::uint16_t length; ///< Anzahl der Zellen.
+        std::uint8_t mask;    ///< Umgeschaltete Bits.
+    };
+
+    /// @brief Ein Zug im Protokoll.
+    struct Move
+    {
+        std::int32_t firstRun; ///< Index des ersten Laufs in runs.
+        bool endedGame;        ///< True, wenn der Zug das Spiel beendet hat.
+        bool won;              ///< Ergebnis des Spiels, falls endedGame.
+    };
+
+    /**
+     * @brief Konstruktor für GameJournal.
+     * @param arena Arena, aus der alle Läufe ihren Speicher holen.
+     *
+     * @author Daniel Schukin
+     */
+    explicit GameJournal(GameArena *arena);
+
+    /**
+     * @brief Leert das Protokoll für ein neues Spiel.
+     *
+     * Muss vor dem Zurücksetzen der Arena aufgerufen werden.
+     *
+     * @author Daniel Schukin
+     */
+    void clear();
+
+    /**
+     * @brief Beginnt einen neuen Zug; rückgängig gemachte Züge können danach nicht mehr wiederholt werden.
+     *
+     * @author Daniel Schukin
+     */
+    void beginMove();
+
+    /**
+     * @brief Merkt sich die umgeschalteten Bits einer Zelle im aktuellen Zug.
+     * @param index Zellindex im Zellspeicher des Spiels.
+     * @param mask Umgeschaltete Bits.
+     *
+     * Außerhalb eines Zugs (z.B. beim Abbrechen des Spiels) wird nichts gespeichert.
+     *
+     * @author Daniel Schukin
+     */
+    void record(int index, std::uint8_t mask);
+
+    /**
+     * @brief Schließt den aktuellen Zug ab. Züge ohne Veränderung werden verworfen.
+     * @param endedGame True, wenn der Zug das Spiel beendet hat.
+     * @param won Ergebnis des Spiels, falls endedGame.
+     *
+     * @author Daniel Schukin
+     */
+    void endMove(bool endedGame, bool won);
+
+    /**
+     * @brief Prüft, ob ein Zug rückgängig gemacht werden kann.
+     * @return True, wenn mindestens ein ausgeführter Zug vorhanden ist.
+     *
+     * @author Daniel Schukin
+     */
+    bool canUndo() const { return applied > 0; }
+
+    /**
+     * @brief Prüft, ob ein rückgängig gemachter Zug wiederholt werden kann.
+     * @return True, wenn ein rückgängig gemachter Zug vorhanden ist.
+     *
+     * @author Daniel Schukin
+     */
+    bool canRedo() const { return applied < int(moves.size()); }
+
+    /**
+     * @brief Gibt den zuletzt ausgeführten Zug zurück und nimmt ihn aus den ausgeführten Zügen.
+     * @return Nummer des Zugs für moveAt(), runsBegin() und runsEnd().
+     *
+     * @author Daniel Schukin
+     */
+    int undoMove() { return --applied; }
+
+    /**
+     * @brief Gibt den nächsten rückgängig gemachten Zug zurück und zählt ihn wieder als ausgeführt.
+     * @return Nummer des Zugs für moveAt(), runsBegin() und runsEnd().
+     *
+     * @author Daniel Schukin
+     */
+    int redoMove() { return applied++; }
+
+    /**
+     * @brief Gibt einen Zug zurück.
+     * @param move Nummer des Zugs.
+     * @return Der Zug.
+     *
+     * @author Daniel Schukin
+     */
+    const Move &moveAt(int move) const { return moves[move]; }
+
+    /**
+     * @brief Gibt den zuletzt ausgeführten Zug zurück.
+     * @return Der Zug; nur gültig, wenn canUndo() true ist.
+     *
+     * @author Daniel Schukin
+     */
+    const Move &lastMove() const { return moves[applied - 1]; }
+
+    /**
+     * @brief Gibt den ersten Lauf eines Zugs zurück.
+     * @param move Nummer des Zugs.
+     * @return Zeiger auf den ersten Lauf.
+     *
+     * @author Daniel Schukin
+     */
+    const Run *runsBegin(int move) const { return runs.data() + moves[move].firstRun; }
+
+    /**
+     * @brief Gibt das Ende der Läufe eines Zugs zurück.
+     * @param move Nummer des Zugs.
+     * @return Zeiger hinter den letzten Lauf.
+     *
+     * @author Daniel Schukin
+     */
+    const Run *runsEnd(int move) const {
+        return runs.data() + (move + 1 < int(moves.size()) ? moves[move + 1].firstRun : int(runs.size()));
+    }
+
+    /**
+     * @brief Gibt die Anzahl der gespeicherten Läufe zurück.
+     * @return Anzahl der Läufe aller Züge.
+     *
+     * @author Daniel Schukin
+     */
+    int getRunsNumber() const { return int(runs.size()); }
+
+private:
+    GameArena *arena; ///< Arena für alle Läufe und Züge.
+    ArenaVector<Run> runs; ///< Läufe aller Züge, hintereinander abgelegt.
+    ArenaVector<Move> moves; ///< Alle Züge, auch die rückgängig gemachten.
+    int applied = 0; ///< Anzahl der ausgeführten Züge; dahinter liegen die wiederholbaren.
+    bool recording = false; ///< True zwischen beginMove() und endMove().
+};
+
+#endif // GAMEJOURNAL_H
@@ -0,0 +1,285 @@
+#include "gamesnapshot.h"
+#include "game.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+#include <QDebug>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <type_traits>
+#include "tracing.h"
+
+static constexpr char MAGIC[4] = {'U', '3', 'S', 'G'}; ///< Kennung am Dateianfang.
+static constexpr int CHECKSUM_OFFSET = 32; ///< Lage der Prüfsumme im Kopf.
+static constexpr int PLANES = 4; ///< Anzahl der Bitebenen bis Version 2: verdeckt, markiert, vermint, explodiert.
+
+static_assert(sizeof(Cell) == 1 && std::is_trivially_copyable<Cell>::value,
+              "Zellen werden byteweise gespeichert und geladen");
+
+/**
+ * @brief Wandelt den Zustand eines laufenden Spiels in das Binärformat um.
+ * @param game Zu speicherndes Spiel.
+ * @return Inhalt der Datei.
+ *
+ * Jede Zelle wird mit ihrem gepackten Byte (Cell::get_bits()) übernommen, eine Zeile mit einem memcpy.
+ */
+QByteArray GameSnapshot::serialize(const Game &game) {
+    TRACE_SPAN("snapshot.serialize");
+    const int length = game.getLength(), width = game.getWidth();
+    QByteArray data(HEADER_SIZE + qint64(length) * width, '\0');
+    uchar *out = reinterpret_cast<uchar *>(data.data());
+
+    ///< Kopf
+    std::memcpy(out, MAGIC, sizeof(MAGIC));
+    quint16 flags = (game.firstClick ? FLAG_FIRST_CLICK : 0)
+                    | (game.is_safeOpening() ? FLAG_SAFE_OPENING : 0) | (game.is_undone() ? FLAG_UNDONE : 0)
+                    | (game.is_assisted() ? FLAG_ASSISTED : 0);
+    qToLittleEndian<quint16>(VERSION, out + 4);
+    qToLittleEndian<quint16>(flags, out + 6);
+    qToLittleEndian<qint32>(length, out + 8);
+    qToLittleEndian<qint32>(width, out + 12);
+    qToLittleEndian<qint32>(game.getMinesNumber(), out + 16);
+    qToLittleEndian<qint32>(qint32(std::min<qint64>(game.getElapsedTime(), INT_MAX)), out + 20);
+    qToLittleEndian<quint64>(game.getSeed(), out + 24);
+
+    ///< Zellen, zeilenweise ohne den Rand
+    uchar *cells = out + HEADER_SIZE;
+    for (int row = 0; row < length; row++) {
+        std::memcpy(cells + qint64(row) * width, game.cells + game.cellIndex(row, 0), width);
+    }
+
+    qToLittleEndian<quint64>(checksum(out, data.size()), out + CHECKSUM_OFFSET);
+    return data;
+}
+
+/**
+ * @brief Stellt ein Spiel aus dem Binärformat wieder her.
+ * @param game Zielspiel; wird nur bei Erfolg verändert.
+ * @param data Inhalt der Datei.
+ * @param size Größe der Datei in Bytes.
+ * @return True bei Erfolg; false bei falscher Kennung, Version, Größe oder Prüfsumme.
+ *
+ * Zuerst werden Kopf, Größe und Prüfsumme geprüft, erst dann wird das Spiel verändert.
+ * Ab Version 3 enthält die Datei die fertigen Zellbytes samt Minenzahlen, das Spielfeld
+ * entsteht also in einem Durchlauf über die Abbildung; ältere Dateien mit Bitebenen werden
+ * weiter gelesen und ihre Minenzahlen neu berechnet. Die Öffnungen werden erst beim nächsten
+ * Öffnen einer Zelle beschriftet.
+ */
+bool GameSnapshot::deserialize(Game &game, const uchar *data, qint64 size) {
+    if (data == nullptr || size < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    const quint16 version = qFromLittleEndian<quint16>(data + 4);
+    if (version < 1 || version > VERSION) {
+        return false; ///< unbekannte Versionen werden nicht geraten, sondern abgelehnt
+    }
+    const quint16 flags = qFromLittleEndian<quint16>(data + 6);
+    const int length = qFromLittleEndian<qint32>(data + 8);
+    const int width = qFromLittleEndian<qint32>(data + 12);
+    const int mines = qFromLittleEndian<qint32>(data + 16);
+    const qint64 elapsedTime = qFromLittleEndian<qint32>(data + 20) * (version == 1 ? qint64(1000) : qint64(1));
+    if (length <= 0 || width <= 0 || mines < 0 || qint64(mines) > qint64(length) * width || elapsedTime < 0) {
+        return false;
+    }
+    const qint64 cells = qint64(length) * width;
+    const qint64 body = version >= 3 ? cells : PLANES * planeSize(cells);
+    if (size != HEADER_SIZE + body) {
+        return false; ///< abgeschnitten oder mit angehängten Daten
+    }
+
+    ///< die Prüfsumme wurde mit 0 an ihrer eigenen Stelle berechnet
+    uchar header[HEADER_SIZE];
+    std::memcpy(header, data, HEADER_SIZE);
+    std::memset(header + CHECKSUM_OFFSET, 0, 8);
+    quint64 hash = checksum(header, HEADER_SIZE);
+    hash = checksum(data + HEADER_SIZE, size - HEADER_SIZE, hash);
+    if (hash != qFromLittleEndian<quint64>(data + CHECKSUM_OFFSET)) {
+        return false;
+    }
+
+    game.changeLength(length);
+    game.changeWidth(width);
+    game.changeMinesNumber(mines);
+    game.setSafeOpening(flags & FLAG_SAFE_OPENING);
+    game.createMatrix(length, width);
+    game.resetMarkedCells();
+    if (version >= 3) {
+        unpackCells(game, data + HEADER_SIZE);
+    } else {
+        unpackPlanes(game, data + HEADER_SIZE);
+        game.count_mines_around();
+    }
+    ///< der Zufallsgenerator wird für die Verschiebung beim ersten Klick neu aus dem Seed gestartet
+    game.seed_random(qFromLittleEndian<quint64>(data + 24));
+    game.undone = flags & FLAG_UNDONE;
+    game.assisted = flags & FLAG_ASSISTED;
+    game.firstClick = flags & FLAG_FIRST_CLICK; ///< Öffnungen werden erst beim nächsten Öffnen beschriftet
+    game.setElapsedTime(elapsedTime);
+    return true;
+}
+
+/**
+ * @brief Summiert die 8 Bytes eines Worts.
+ * @param lanes Wort mit 8 Zählern zu je einem Byte.
+ * @return Summe der 8 Zähler.
+ */
+static int sumLanes(quint64 lanes) {
+    constexpr quint64 LOW_BYTES = 0x00FF00FF00FF00FFULL;
+    lanes = (lanes & LOW_BYTES) + ((lanes >> 8) & LOW_BYTES); ///< 4 Zähler zu je 16 Bit
+    return int((lanes * 0x0001000100010001ULL) >> 48);
+}
+
+/**
+ * @brief Übernimmt die Zellbytes einer Datei ab Version 3 und zählt dabei die Zellen.
+ * @param game Zielspiel mit frisch erstelltem Spielfeld.
+ * @param in Erstes Zellbyte in der Abbildung.
+ *
+ * Jede Zeile wird mit einem memcpy in den gepolsterten Zellspeicher kopiert. Die Zähler laufen
+ * je 8 Zellen auf einmal: nach dem Verschieben steht das gesuchte Bit jeder Zelle an der
+ * untersten Stelle ihres Bytes, und jedes Byte eines Worts zählt für sich. Bevor ein Byte
+ * überlaufen kann, werden die Zähler mit sumLanes() aufsummiert.
+ */
+void GameSnapshot::unpackCells(Game &game, const uchar *in) {
+    const int length = game.getLength(), width = game.getWidth();
+    for (int row = 0; row < length; row++) {
+        std::memcpy(game.cells + game.cellIndex(row, 0), in + qint64(row) * width, width);
+    }
+
+    constexpr quint64 LOW_BITS = 0x0101010101010101ULL; ///< unterstes Bit jedes Bytes
+    constexpr int HIDDEN_SHIFT = 4, MARKED_SHIFT = 5, MINED_SHIFT = 6;
+    constexpr int FLUSH_WORDS = 255; ///< höchstens so viele Einsen passen in ein Byte
+    static_assert(Cell::HIDDEN == 1 << HIDDEN_SHIFT && Cell::MARKED == 1 << MARKED_SHIFT
+                      && Cell::MINED == 1 << MINED_SHIFT,
+                  "Verschiebungen passen nicht zu den Zellbits");
+    const qint64 cells = qint64(length) * width;
+    qint64 safeRevealed = 0, correctFlags = 0, wrongFlags = 0;
+    qint64 i = 0;
+    while (i + 8 <= cells) {
+        quint64 safeLanes = 0, correctLanes = 0, wrongLanes = 0;
+        for (int word = 0; word < FLUSH_WORDS && i + 8 <= cells; word++, i += 8) {
+            const quint64 bytes = qFromLittleEndian<quint64>(in + i);
+            const quint64 hidden = bytes >> HIDDEN_SHIFT, marked = bytes >> MARKED_SHIFT, mined = bytes >> MINED_SHIFT;
+            safeLanes += ~(hidden | mined) & LOW_BITS;
+            correctLanes += marked & mined & LOW_BITS;
+            wrongLanes += marked & ~mined & LOW_BITS;
+        }
+        safeRevealed += sumLanes(safeLanes);
+        correctFlags += sumLanes(correctLanes);
+        wrongFlags += sumLanes(wrongLanes);
+    }
+    for (; i < cells; i++) {
+        const Cell cell = reinterpret_cast<const Cell &>(in[i]);
+        safeRevealed += !cell.is_hidden() && !cell.is_mined();
+        correctFlags += cell.is_marked() && cell.is_mined();
+        wrongFlags += cell.is_marked() && !cell.is_mined();
+    }
+    game.safeRevealed = int(safeRevealed);
+    game.correctFlags = int(correctFlags);
+    game.wrongFlags = int(wrongFlags);
+}
+
+/**
+ * @brief Entpackt die Bitebenen einer Datei bis Version 2.
+ * @param game Zielspiel mit frisch erstelltem Spielfeld.
+ * @param planes Beginn der ersten Bitebene in der Abbildung.
+ *
+ * Die Minenzahlen fehlen in diesen Dateien und müssen danach berechnet werden.
+ */
+void GameSnapshot::unpackPlanes(Game &game, const uchar *planes) {
+    const int width = game.getWidth();
+    const qint64 cells = qint64(game.getLength()) * width;
+    const qint64 plane = planeSize(cells);
+    int row = 0, col = 0;
+    for (qint64 word = 0; word * 64 < cells; word++) {
+        const quint64 hidden = qFromLittleEndian<quint64>(planes + word * 8);
+        const quint64 marked = qFromLittleEndian<quint64>(planes + plane + word * 8);
+        const quint64 mined = qFromLittleEndian<quint64>(planes + 2 * plane + word * 8);
+        const quint64 exploded = qFromLittleEndian<quint64>(planes + 3 * plane + word * 8);
+        const int count = int(std::min<qint64>(64, cells - word * 64));
+        const quint64 valid = count == 64 ? ~quint64(0) : (quint64(1) << count) - 1;
+        game.safeRevealed += qPopulationCount(~hidden & ~mined & valid);
+        game.correctFlags += qPopulationCount(marked & mined & valid);
+        game.wrongFlags += qPopulationCount(marked & ~mined & valid);
+        for (int bit = 0; bit < count; bit++) {
+            Cell &c = game.cells[game.cellIndex(row, col)];
+            c.set_hidden(hidden >> bit & 1);
+            c.set_marked(marked >> bit & 1);
+            c.set_mined(mined >> bit & 1);
+            c.set_exploded(exploded >> bit & 1);
+            if (++col == width) {
+                col = 0;
+                row++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Schreibt einen mit serialize() erzeugten Inhalt atomar in eine Datei.
+ * @param data Inhalt der Datei.
+ * @param filePath Pfad der Datei.
+ * @return True bei Erfolg.
+ *
+ * QSaveFile ersetzt die alte Datei erst nach vollständigem Schreiben, ein Absturz während
+ * des Speicherns hinterlässt also keine halbe Datei.
+ */
+bool GameSnapshot::write(const QByteArray &data, const QString &filePath) {
+    TRACE_SPAN("snapshot.write");
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size()) {
+        qWarning() << "Failed to write snapshot: " << filePath;
+        return false;
+    }
+    return file.commit();
+}
+
+/**
+ * @brief Lädt ein Spiel aus einer Datei, die dazu in den Speicher eingeblendet wird.
+ * @param game Zielspiel; wird nur bei Erfolg verändert.
+ * @param filePath Pfad der Datei.
+ * @return True bei Erfolg.
+ */
+bool GameSnapshot::load(Game &game, const QString &filePath) {
+    TRACE_SPAN("snapshot.load");
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 size = file.size();
+    uchar *data = file.map(0, size);
+    if (data == nullptr) {
+        qWarning() << "Failed to map snapshot: " << filePath;
+        return false;
+    }
+    bool ok = deserialize(game, data, size);
+    file.unmap(data);
+    if (!ok) {
+        qWarning() << "Snapshot is damaged or has an unknown version: " << filePath;
+    }
+    return ok;
+}
+
+/**
+ * @brief Berechnet die Prüfsumme eines Speicherbereichs.
+ * @param data Beginn des Bereichs.
+ * @param size Größe in Bytes.
+ * @param hash Startwert, erlaubt die Fortsetzung über mehrere Bereiche.
+ * @return Neue Prüfsumme.
+ *
+ * FNV-1a über 8-Byte-Wörter mit zusätzlicher Durchmischung der oberen Bits. Jeder Schritt ist
+ * umkehrbar, ein einzelnes verändertes Wort ändert also immer das Ergebnis.
+ */
+quint64 GameSnapshot::checksum(const uchar *data, qint64 size, quint64 hash) {
+    constexpr quint64 PRIME = 0x100000001b3ULL;
+    qint64 i = 0;
+    for (; i + 8 <= size; i += 8) {
+        hash = (hash ^ qFromLittleEndian<quint64>(data + i)) * PRIME;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * PRIME;
+    }
+    return hash;
+}
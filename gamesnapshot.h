@@ -0,0 +1,142 @@
+#ifndef GAMESNAPSHOT_H
+#define GAMESNAPSHOT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+class Game;
+
+/**
+ * @file gamesnapshot.h
+ * @class GameSnapshot
+ * @brief Speichert ein laufendes Spiel in einem kompakten Binärformat und lädt es wieder.
+ *
+ * Aufbau einer Datei (alle Zahlen Little-Endian):
+ * | Versatz | Größe | Inhalt                                                       |
+ * |---------|-------|--------------------------------------------------------------|
+ * | 0       | 4     | Kennung "U3SG"                                               |
+ * | 4       | 2     | Formatversion (VERSION)                                      |
+ * | 6       | 2     | Flags (FLAG_*)                                               |
+ * | 8       | 4     | Anzahl der Zeilen                                            |
+ * | 12      | 4     | Anzahl der Spalten                                           |
+ * | 16      | 4     | Anzahl der Minen                                             |
+ * | 20      | 4     | Spielzeit in ms (Version 1: in Sekunden)                     |
+ * | 24      | 8     | Seed des Spielfelds                                          |
+ * | 32      | 8     | Prüfsumme über die ganze Datei (mit 0 an dieser Stelle)      |
+ * | 40      | n     | Ein Byte pro Zelle (Cell::get_bits()), zeilenweise ohne Rand |
+ *
+ * Bis Version 2 folgten dem Kopf statt der Zellbytes vier Bitebenen (verdeckt, markiert,
+ * vermint, explodiert) mit einem Bit pro Zelle, je auf ganze 8 Byte aufgerundet; solche
+ * Dateien werden weiter gelesen.
+ *
+ * Technische Entscheidung:
+ * Die Zellbytes enthalten Zustand und Minenzahl genau so, wie Cell sie im Speicher hält.
+ * Beim Laden wird die Datei in den Speicher eingeblendet (QFile::map) und jede Zeile mit einem
+ * memcpy in das Spielfeld kopiert; die Zähler entstehen im selben Durchlauf. Ein Spielfeld mit
+ * 10000x10000 Zellen belegt so 100 MB, lädt aber ohne Neuberechnung der Minenzahlen. Eine
+ * abgeschnittene Datei fällt über die erwartete Größe auf, eine beschädigte über die Prüfsumme.
+ * Die Zugliste für Rückgängig wird nicht gespeichert.
+ *
+ * Abhängigkeit: greift direkt auf den Zustand des Game-Moduls zu.
+ *
+ * @author Daniel Schukin
+ */
+class GameSnapshot
+{
+public:
+    static constexpr quint16 VERSION = 3; ///< Aktuelle Formatversion (1: Spielzeit in Sekunden, bis 2: Bitebenen).
+    static constexpr int HEADER_SIZE = 40; ///< Größe des Kopfs in Bytes.
+
+    /// @name Flags im Kopf
+    /// @{
+    ///< 0x0001 ist reserviert und wird beim Laden ignoriert.
+    static constexpr quint16 FLAG_FIRST_CLICK = 0x0002;  ///< Es wurde noch keine Zelle geöffnet.
+    static constexpr quint16 FLAG_SAFE_OPENING = 0x0004; ///< Erster Klick mit freier 3x3-Umgebung.
+    static constexpr quint16 FLAG_UNDONE = 0x0008;       ///< Im Spiel wurden Züge rückgängig gemacht.
+    static constexpr quint16 FLAG_ASSISTED = 0x0010;     ///< Im Spiel wurde ein Tipp angezeigt.
+    /// @}
+
+    /**
+     * @brief Wandelt den Zustand eines laufenden Spiels in das Binärformat um.
+     * @param game Zu speicherndes Spiel.
+     * @return Inhalt der Datei.
+     *
+     * @author Daniel Schukin
+     */
+    static QByteArray serialize(const Game &game);
+
+    /**
+     * @brief Stellt ein Spiel aus dem Binärformat wieder her.
+     * @param game Zielspiel; wird nur bei Erfolg verändert.
+     * @param data Inhalt der Datei.
+     * @param size Größe der Datei in Bytes.
+     * @return True bei Erfolg; false bei falscher Kennung, Version, Größe oder Prüfsumme.
+     *
+     * @author Daniel Schukin
+     */
+    static bool deserialize(Game &game, const uchar *data, qint64 size);
+
+    /**
+     * @brief Schreibt einen mit serialize() erzeugten Inhalt atomar in eine Datei.
+     * @param data Inhalt der Datei.
+     * @param filePath Pfad der Datei.
+     * @return True bei Erfolg.
+     *
+     * Kann in einem Hintergrund-Thread aufgerufen werden, da es nicht auf das Spiel zugreift.
+     *
+     * @author Daniel Schukin
+     */
+    static bool write(const QByteArray &data, const QString &filePath);
+
+    /**
+     * @brief Lädt ein Spiel aus einer Datei, die dazu in den Speicher eingeblendet wird.
+     * @param game Zielspiel; wird nur bei Erfolg verändert.
+     * @param filePath Pfad der Datei.
+     * @return True bei Erfolg.
+     *
+     * @author Daniel Schukin
+     */
+    static bool load(Game &game, const QString &filePath);
+
+    /**
+     * @brief Berechnet die Prüfsumme eines Speicherbereichs.
+     * @param data Beginn des Bereichs.
+     * @param size Größe in Bytes.
+     * @param hash Startwert, erlaubt die Fortsetzung über mehrere Bereiche.
+     * @return Neue Prüfsumme.
+     *
+     * @author Daniel Schukin
+     */
+    static quint64 checksum(const uchar *data, qint64 size, quint64 hash = 0xcbf29ce484222325ULL);
+
+private:
+    /**
+     * @brief Übernimmt die Zellbytes einer Datei ab Version 3 und zählt dabei die Zellen.
+     * @param game Zielspiel mit frisch erstelltem Spielfeld.
+     * @param in Erstes Zellbyte.
+     *
+     * @author Daniel Schukin
+     */
+    static void unpackCells(Game &game, const uchar *in);
+
+    /**
+     * @brief Entpackt die Bitebenen einer Datei bis Version 2.
+     * @param game Zielspiel mit frisch erstelltem Spielfeld.
+     * @param planes Beginn der ersten Bitebene.
+     *
+     * @author Daniel Schukin
+     */
+    static void unpackPlanes(Game &game, const uchar *planes);
+
+    /**
+     * @brief Gibt die Größe einer Bitebene in Bytes zurück.
+     * @param cells Anzahl der Zellen.
+     * @return Auf ganze 8 Byte aufgerundete Größe (Format bis Version 2).
+     *
+     * @author Daniel Schukin
+     */
+    static qint64 planeSize(qint64 cells) { return (cells + 63) / 64 * 8; }
+};
+
+#endif // GAMESNAPSHOT_H
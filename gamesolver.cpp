@@ -0,0 +1,391 @@
+#include "gamesolver.h"
+#include "boardlayout.h"
+#include "boardplane.h"
+
+/**
+ * @brief Gibt zurück, ob ein Code eine aufgedeckte Zelle bezeichnet.
+ * @param code Sichtbarer Code.
+ * @return True für BoardPlane::OPEN_CODE bis OPEN_CODE + 8.
+ */
+static inline bool isOpen(quint8 code) {
+    return code >= BoardPlane::OPEN_CODE && code < BoardPlane::CODE_COUNT;
+}
+
+/**
+ * @brief Konstruktor für GameSolver.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @param minesNumber Anzahl der Minen.
+ * @param safeOpening True, wenn der erste Klick keine Mine treffen kann.
+ */
+GameSolver::GameSolver(int length, int width, int minesNumber, bool safeOpening)
+    : length(length)
+    , width(width)
+    , minesNumber(minesNumber)
+    , safeOpening(safeOpening)
+{
+    const int cells = length * width;
+    neighbours.fill(-1, cells * BoardLayout::NEIGHBOURS);
+    for (int row = 0; row < length; row++) {
+        for (int col = 0; col < width; col++) {
+            for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+                const int r = row + BoardLayout::NEIGHBOUR_ROWS[k];
+                const int c = col + BoardLayout::NEIGHBOUR_COLS[k];
+                if (r >= 0 && r < length && c >= 0 && c < width) {
+                    neighbours[(row * width + col) * BoardLayout::NEIGHBOURS + k] = r * width + c;
+                }
+            }
+        }
+    }
+    seen.fill(0, cells);
+    knowledge.fill(UNKNOWN, cells);
+    queued.fill(0, cells);
+    risk.resize(cells);
+}
+
+/**
+ * @brief Vergisst alle Schlüsse.
+ */
+void GameSolver::reset() {
+    seen.fill(0);
+    knowledge.fill(UNKNOWN);
+    queued.fill(0);
+    safeCells.clear();
+    worklist.clear();
+    subsetList.clear();
+    openCells = 0;
+}
+
+/**
+ * @brief Wählt den nächsten Zug; die geänderten Zellen sucht der Solver selbst.
+ * @param visible Sichtbare Codes aller Zellen.
+ * @return Zu öffnende Zelle.
+ *
+ * Vergleicht die Codes mit dem zuletzt gesehenen Stand; das ist ein einfacher Durchlauf,
+ * die eigentliche Analyse bleibt auf die geänderten Zellen beschränkt.
+ */
+GameSolver::Move GameSolver::next(const quint8 *visible) {
+    const int cells = length * width;
+    for (int cell = 0; cell < cells; cell++) {
+        if (visible[cell] != seen.at(cell)) {
+            applyChange(cell, visible[cell]);
+        }
+    }
+    return next(visible, nullptr, 0);
+}
+
+/**
+ * @brief Wählt den nächsten Zug, wenn die seit dem letzten Aufruf geänderten Zellen bekannt sind.
+ * @param visible Sichtbare Codes aller Zellen.
+ * @param changed Indizes der geänderten Zellen.
+ * @param count Anzahl der geänderten Zellen.
+ * @return Zu öffnende Zelle.
+ *
+ * Ist noch nichts aufgedeckt, wird die Mitte geöffnet; bei sicherem ersten Klick gilt das
+ * nicht als Raten. Sonst zuerst eine schon erkannte oder neu erkennbare sichere Zelle, erst
+ * dann wird geraten.
+ */
+GameSolver::Move GameSolver::next(const quint8 *visible, const qint32 *changed, int count) {
+    for (int i = 0; i < count; i++) {
+        applyChange(changed[i], visible[changed[i]]);
+    }
+    Move move;
+    if (openCells == 0) {
+        const int cells = length * width;
+        move.cell = (length / 2) * width + width / 2;
+        move.safe = safeOpening;
+        move.risk = safeOpening ? 0.0 : double(minesNumber) / cells;
+        return move;
+    }
+    if (!propagate()) {
+        return move;
+    }
+    if (hasSafeCell()) {
+        move.cell = safeCells.last();
+        move.safe = true;
+        move.risk = 0.0;
+        return move;
+    }
+    return guess();
+}
+
+/**
+ * @brief Übernimmt den neuen Code einer Zelle und stellt betroffene Zahlen zur Prüfung an.
+ * @param cell Index der Zelle.
+ * @param code Neuer sichtbarer Code.
+ *
+ * Markieren und Entfernen einer Markierung ändern keine Zahl und werden nur übernommen. Wird
+ * eine Zelle (durch Rückgängig) wieder verdeckt, bleiben die Schlüsse gültig, denn sie gelten
+ * für die Minen, nicht für die Anzeige.
+ */
+void GameSolver::applyChange(int cell, quint8 code) {
+    const bool wasOpen = isOpen(seen.at(cell));
+    const bool open = isOpen(code);
+    seen[cell] = code;
+    if (wasOpen == open) {
+        return;
+    }
+    openCells += open ? 1 : -1;
+    if (open) {
+        enqueue(cell);
+    }
+    enqueueNeighbours(cell);
+}
+
+/**
+ * @brief Wendet die Regeln auf die angestellten Zahlen an, bis eine sichere Zelle feststeht.
+ * @return False, wenn die Analyse unterbrochen wurde; die Listen bleiben dann erhalten.
+ *
+ * Zuerst die einfachen Regeln für alle angestellten Zahlen; Zahlen, bei denen sie nichts
+ * ergeben, kommen in eine zweite Liste für die teurere Teilmengenregel. Diese wird erst
+ * geprüft, wenn die einfachen Regeln nichts mehr ergeben. Steht eine sichere Zelle fest,
+ * wird sofort aufgehört: der Rest der Listen bleibt für den nächsten Zug liegen.
+ * Jede Zelle wird höchstens einmal als sicher oder Mine erkannt und stellt dabei höchstens 8
+ * Zahlen an; der Aufwand hängt also von der Änderung ab, nicht von der Größe des Spielfelds.
+ */
+bool GameSolver::propagate() {
+    int unknown[BoardLayout::NEIGHBOURS];
+    int count;
+    int steps = 0;
+    for (;;) {
+        if (interrupt && (++steps & 63) == 0 && interrupt->load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (hasSafeCell()) {
+            return true;
+        }
+        if (!worklist.isEmpty()) {
+            const int cell = worklist.last();
+            worklist.removeLast();
+            queued[cell] &= ~IN_WORKLIST;
+            if (!isOpen(seen.at(cell))) {
+                continue;
+            }
+            const int mines = constraint(cell, unknown, count);
+            if (count == 0) {
+                continue;
+            }
+            if (mines == 0) {
+                mark(unknown, count, SAFE);
+            } else if (mines == count) {
+                mark(unknown, count, MINE);
+            } else if (!(queued.at(cell) & IN_SUBSETLIST)) {
+                queued[cell] |= IN_SUBSETLIST;
+                subsetList.append(cell);
+            }
+            continue;
+        }
+        if (subsetList.isEmpty()) {
+            return true;
+        }
+        const int cell = subsetList.last();
+        subsetList.removeLast();
+        queued[cell] &= ~IN_SUBSETLIST;
+        if (isOpen(seen.at(cell))) {
+            applySubsetRule(cell);
+        }
+    }
+}
+
+/**
+ * @brief Gibt zurück, ob eine erkannte sichere Zelle noch verdeckt ist.
+ * @return True, wenn safeCells.last() geöffnet werden kann.
+ *
+ * Inzwischen aufgedeckte Zellen werden dabei aus safeCells entfernt.
+ */
+bool GameSolver::hasSafeCell() {
+    while (!safeCells.isEmpty() && isOpen(seen.at(safeCells.last()))) {
+        safeCells.removeLast();
+    }
+    return !safeCells.isEmpty();
+}
+
+/**
+ * @brief Sammelt für eine Zahl ihre unbekannten Nachbarn und die noch fehlenden Minen.
+ * @param cell Index der aufgedeckten Zelle.
+ * @param unknown Gibt die unbekannten Nachbarn zurück.
+ * @param count Gibt die Anzahl der unbekannten Nachbarn zurück.
+ * @return Anzahl der noch nicht erkannten Minen um die Zelle.
+ */
+int GameSolver::constraint(int cell, int *unknown, int &count) const {
+    int mines = seen.at(cell) - BoardPlane::OPEN_CODE;
+    count = 0;
+    const qint32 *cellNeighbours = neighbours.constData() + cell * BoardLayout::NEIGHBOURS;
+    for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+        const int neighbour = cellNeighbours[k];
+        if (neighbour < 0 || isOpen(seen.at(neighbour))) {
+            continue;
+        }
+        const quint8 known = knowledge.at(neighbour);
+        if (known == MINE) {
+            mines--;
+        } else if (known == UNKNOWN) {
+            unknown[count++] = neighbour;
+        }
+    }
+    return mines;
+}
+
+/**
+ * @brief Prüft die Teilmengenregel für eine Zahl gegen alle Zahlen in ihrer Nähe.
+ * @param cell Index der aufgedeckten Zelle.
+ * @return True, wenn dabei etwas erkannt wurde.
+ *
+ * Geprüft wird in beide Richtungen, denn nur die geänderte Zahl steht in der Liste, nicht
+ * ihre Partnerin. Nach dem ersten Treffer wird abgebrochen; mark() stellt die Zahl
+ * dann ohnehin neu an.
+ */
+bool GameSolver::applySubsetRule(int cell) {
+    int unknownA[BoardLayout::NEIGHBOURS];
+    int countA;
+    const int minesA = constraint(cell, unknownA, countA);
+    int unknownB[BoardLayout::NEIGHBOURS];
+    int countB;
+    const int rowA = cell / width, colA = cell % width;
+    for (int r = qMax(0, rowA - 2); r <= qMin(length - 1, rowA + 2); r++) {
+        for (int c = qMax(0, colA - 2); c <= qMin(width - 1, colA + 2); c++) {
+            const int other = r * width + c;
+            if (other == cell || !isOpen(seen.at(other))) {
+                continue;
+            }
+            const int minesB = constraint(other, unknownB, countB);
+            if (countB == 0 || countB == countA) {
+                continue;
+            }
+            ///< kleine ⊆ große Menge  =>  der Rest der großen enthält mines(groß) - mines(klein) Minen
+            const bool aSmaller = countA < countB;
+            const int *small = aSmaller ? unknownA : unknownB;
+            const int *large = aSmaller ? unknownB : unknownA;
+            const int smallCount = aSmaller ? countA : countB;
+            const int largeCount = aSmaller ? countB : countA;
+            int rest[BoardLayout::NEIGHBOURS];
+            int restCount = 0;
+            for (int j = 0; j < largeCount; j++) {
+                bool shared = false;
+                for (int i = 0; i < smallCount && !shared; i++) {
+                    shared = small[i] == large[j];
+                }
+                if (!shared) {
+                    rest[restCount++] = large[j];
+                }
+            }
+            if (largeCount - restCount != smallCount) {
+                continue; ///< keine Teilmenge
+            }
+            const int restMines = aSmaller ? minesB - minesA : minesA - minesB;
+            if (restMines == 0) {
+                mark(rest, restCount, SAFE);
+                return true;
+            }
+            if (restMines == restCount) {
+                mark(rest, restCount, MINE);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Hält Zellen als sicher oder als Minen fest und stellt ihre Nachbarzahlen zur Prüfung an.
+ * @param cells Indizes der Zellen.
+ * @param count Anzahl der Zellen.
+ * @param value SAFE oder MINE.
+ */
+void GameSolver::mark(const int *cells, int count, quint8 value) {
+    for (int i = 0; i < count; i++) {
+        const int cell = cells[i];
+        if (knowledge.at(cell) != UNKNOWN) {
+            continue;
+        }
+        knowledge[cell] = value;
+        if (value == SAFE) {
+            safeCells.append(cell);
+        }
+        enqueueNeighbours(cell);
+    }
+}
+
+/**
+ * @brief Stellt die aufgedeckten Nachbarn einer Zelle zur Prüfung an.
+ * @param cell Index der Zelle.
+ */
+void GameSolver::enqueueNeighbours(int cell) {
+    const qint32 *cellNeighbours = neighbours.constData() + cell * BoardLayout::NEIGHBOURS;
+    for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+        const int neighbour = cellNeighbours[k];
+        if (neighbour >= 0 && isOpen(seen.at(neighbour))) {
+            enqueue(neighbour);
+        }
+    }
+}
+
+/**
+ * @brief Stellt eine aufgedeckte Zelle zur Prüfung an, falls sie es nicht schon ist.
+ * @param cell Index der Zelle.
+ */
+void GameSolver::enqueue(int cell) {
+    if (!(queued.at(cell) & IN_WORKLIST)) {
+        queued[cell] |= IN_WORKLIST;
+        worklist.append(cell);
+    }
+}
+
+/**
+ * @brief Schätzt für jede verdeckte Zelle das Risiko und wählt die kleinste.
+ * @return Geratener Zug.
+ *
+ * Bei gleichem Risiko gewinnt die Zelle mit den wenigsten unbekannten Nachbarn, weil sie
+ * eher eine Öffnung oder eine aussagekräftige Zahl ergibt.
+ */
+GameSolver::Move GameSolver::guess() {
+    const int cells = length * width;
+    int unknownCells = 0;
+    int foundMines = 0;
+    for (int cell = 0; cell < cells; cell++) {
+        risk[cell] = -1.0f; ///< noch keine Zahl daneben
+        if (!isOpen(seen.at(cell))) {
+            const quint8 known = knowledge.at(cell);
+            foundMines += known == MINE;
+            unknownCells += known == UNKNOWN;
+        }
+    }
+
+    int unknown[BoardLayout::NEIGHBOURS];
+    int count;
+    for (int cell = 0; cell < cells; cell++) {
+        if (!isOpen(seen.at(cell))) {
+            continue;
+        }
+        const int mines = constraint(cell, unknown, count);
+        if (count == 0) {
+            continue;
+        }
+        const float share = float(mines) / float(count);
+        for (int i = 0; i < count; i++) {
+            risk[unknown[i]] = qMax(risk[unknown[i]], share);
+        }
+    }
+
+    const float density = unknownCells > 0 ? float(minesNumber - foundMines) / float(unknownCells) : 1.0f;
+    Move move;
+    int bestUnknown = BoardLayout::NEIGHBOURS + 1;
+    for (int cell = 0; cell < cells; cell++) {
+        if (isOpen(seen.at(cell)) || knowledge.at(cell) != UNKNOWN) {
+            continue;
+        }
+        const float cellRisk = risk[cell] < 0.0f ? density : risk[cell];
+        int unknownAround = 0;
+        const qint32 *cellNeighbours = neighbours.constData() + cell * BoardLayout::NEIGHBOURS;
+        for (int k = 0; k < BoardLayout::NEIGHBOURS; k++) {
+            const int neighbour = cellNeighbours[k];
+            unknownAround += neighbour >= 0 && !isOpen(seen.at(neighbour)) && knowledge.at(neighbour) == UNKNOWN;
+        }
+        if (move.cell < 0 || cellRisk < move.risk || (cellRisk == move.risk && unknownAround < bestUnknown)) {
+            move.cell = cell;
+            move.risk = cellRisk;
+            bestUnknown = unknownAround;
+        }
+    }
+    return move;
+}
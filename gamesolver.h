@@ -0,0 +1,221 @@
+#ifndef GAMESOLVER_H
+#define GAMESOLVER_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @file gamesolver.h
+ * @class GameSolver
+ * @brief Wählt den nächsten Zug anhand des sichtbaren Spielfelds.
+ *
+ * Der Solver sieht nur, was auch der Spieler sieht: ein Byte pro Zelle mit den Codes von
+ * BoardPlane, z.B. aus HintService, BotSession oder BatchEnvironment::observations(). Markierungen
+ * des Spielers werden wie verdeckte Zellen behandelt; der Solver merkt sich seine eigenen,
+ * sicher erkannten Minen und sicheren Zellen.
+ *
+ * Vorgehen:
+ * 1. Einfache Regeln: Hat eine Zahl schon so viele bekannte Minen wie ihr Wert, sind ihre
+ *    übrigen verdeckten Nachbarn sicher; hat sie genau so viele verdeckte Nachbarn wie noch
+ *    Minen fehlen, sind das alles Minen.
+ * 2. Teilmengenregel für benachbarte Zahlen: Sind die offenen Nachbarn der einen in denen der
+ *    anderen enthalten, gilt die Differenz der fehlenden Minen für die restlichen Zellen.
+ * 3. Ohne sichere Zelle wird geraten: Für Zellen am Rand des aufgedeckten Bereichs gilt als
+ *    Risiko der höchste Anteil fehlender Minen unter ihren Zahlen, für alle übrigen die
+ *    durchschnittliche Dichte der noch nicht gefundenen Minen. Die Zelle mit dem kleinsten
+ *    Risiko wird gewählt.
+ *
+ * Technische Entscheidung:
+ * Inkrementell: Der Solver behält seine Schlüsse von Zug zu Zug, denn die Minen eines
+ * Spielfelds ändern sich nicht, auch nicht durch Rückgängig. Nach einem Zug werden nur die
+ * Zahlen an den geänderten Zellen neu geprüft; jede neu erkannte Zelle stellt wiederum nur ihre
+ * Nachbarzahlen zur Prüfung an (Arbeitsliste). Die Analyse endet, sobald eine sichere Zelle
+ * feststeht; erkannte sichere Zellen und die restliche Arbeitsliste werden in den folgenden
+ * Zügen weiterverwendet. Die Teilmengenregel vergleicht nur Zahlen im
+ * Abstand von höchstens 2, denn nur deren Nachbarschaften können sich überschneiden.
+ *
+ * Keine vollständige Wahrscheinlichkeitsrechnung über alle Randkonfigurationen: die beiden
+ * Regeln lösen den Großteil aller Stellungen und brauchen keinen Speicher pro Stellung; der
+ * Solver ist damit schnell genug für Millionen simulierter Spiele.
+ *
+ * @author Daniel Schukin
+ */
+class GameSolver
+{
+public:
+    /// @brief Gewählter Zug.
+    struct Move
+    {
+        int cell = -1;       ///< Index der Zelle (Zeile * Breite + Spalte), -1 wenn keine verdeckte Zelle übrig ist oder die Analyse unterbrochen wurde.
+        bool safe = false;   ///< True, wenn die Zelle sicher keine Mine ist.
+        double risk = 1.0;   ///< Geschätzte Wahrscheinlichkeit einer Mine (0 bei sicheren Zellen).
+    };
+
+    /**
+     * @brief Konstruktor für GameSolver.
+     * @param length Anzahl der Zeilen.
+     * @param width Anzahl der Spalten.
+     * @param minesNumber Anzahl der Minen.
+     * @param safeOpening True, wenn der erste Klick wie in Game keine Mine treffen kann.
+     *
+     * @author Daniel Schukin
+     */
+    GameSolver(int length, int width, int minesNumber, bool safeOpening = true);
+
+    /**
+     * @brief Vergisst alle Schlüsse, z.B. für ein neues Spielfeld.
+     *
+     * @author Daniel Schukin
+     */
+    void reset();
+
+    /**
+     * @brief Wählt den nächsten Zug; die geänderten Zellen sucht der Solver selbst.
+     * @param visible Sichtbare Codes aller Zellen (getLength() * getWidth()).
+     * @return Zu öffnende Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    Move next(const quint8 *visible);
+
+    /**
+     * @brief Wählt den nächsten Zug, wenn die seit dem letzten Aufruf geänderten Zellen bekannt sind.
+     * @param visible Sichtbare Codes aller Zellen.
+     * @param changed Indizes der geänderten Zellen, z.B. aus Game::getChangedCells().
+     * @param count Anzahl der geänderten Zellen.
+     * @return Zu öffnende Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    Move next(const quint8 *visible, const qint32 *changed, int count);
+
+    /**
+     * @brief Setzt ein Flag, bei dem die Analyse abbricht, z.B. weil schon der nächste Zug vorliegt.
+     * @param flag Wird regelmäßig gelesen; nullptr für keinen Abbruch.
+     *
+     * Eine unterbrochene Analyse geht nicht verloren: der nächste Aufruf von next() setzt sie fort.
+     *
+     * @author Daniel Schukin
+     */
+    void setInterruptFlag(const std::atomic<bool> *flag) { interrupt = flag; }
+
+    /**
+     * @brief Gibt zurück, ob der Solver eine Zelle als Mine erkannt hat.
+     * @param cell Index der Zelle.
+     * @return True bei einer sicher erkannten Mine.
+     *
+     * @author Daniel Schukin
+     */
+    bool isKnownMine(int cell) const { return knowledge.at(cell) == MINE; }
+
+    /// @name Getter
+    /// @{
+    int getLength() const { return length; }
+    int getWidth() const { return width; }
+    int getMinesNumber() const { return minesNumber; }
+    /// @}
+
+private:
+    static constexpr quint8 UNKNOWN = 0; ///< Über die Zelle ist nichts bekannt.
+    static constexpr quint8 SAFE = 1;    ///< Die Zelle ist sicher keine Mine.
+    static constexpr quint8 MINE = 2;    ///< Die Zelle ist sicher eine Mine.
+    static constexpr quint8 IN_WORKLIST = 1;   ///< Bit in queued: Zelle steht in worklist.
+    static constexpr quint8 IN_SUBSETLIST = 2; ///< Bit in queued: Zelle steht in subsetList.
+
+    /**
+     * @brief Übernimmt den neuen Code einer Zelle und stellt betroffene Zahlen zur Prüfung an.
+     * @param cell Index der Zelle.
+     * @param code Neuer sichtbarer Code.
+     *
+     * @author Daniel Schukin
+     */
+    void applyChange(int cell, quint8 code);
+
+    /**
+     * @brief Wendet die Regeln auf die angestellten Zahlen an, bis eine sichere Zelle feststeht oder nichts mehr folgt.
+     * @return False, wenn die Analyse unterbrochen wurde.
+     *
+     * @author Daniel Schukin
+     */
+    bool propagate();
+
+    /**
+     * @brief Gibt zurück, ob eine erkannte sichere Zelle noch verdeckt ist.
+     * @return True, wenn safeCells.last() geöffnet werden kann.
+     *
+     * @author Daniel Schukin
+     */
+    bool hasSafeCell();
+
+    /**
+     * @brief Sammelt für eine Zahl ihre unbekannten Nachbarn und die noch fehlenden Minen.
+     * @param cell Index der aufgedeckten Zelle.
+     * @param unknown Gibt die unbekannten Nachbarn zurück (höchstens 8).
+     * @param count Gibt die Anzahl der unbekannten Nachbarn zurück.
+     * @return Anzahl der noch nicht erkannten Minen um die Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    int constraint(int cell, int *unknown, int &count) const;
+
+    /**
+     * @brief Prüft die Teilmengenregel für eine Zahl gegen alle Zahlen in ihrer Nähe.
+     * @param cell Index der aufgedeckten Zelle.
+     * @return True, wenn dabei etwas erkannt wurde.
+     *
+     * @author Daniel Schukin
+     */
+    bool applySubsetRule(int cell);
+
+    /**
+     * @brief Hält Zellen als sicher oder als Minen fest und stellt ihre Nachbarzahlen zur Prüfung an.
+     * @param cells Indizes der Zellen.
+     * @param count Anzahl der Zellen.
+     * @param value SAFE oder MINE.
+     *
+     * @author Daniel Schukin
+     */
+    void mark(const int *cells, int count, quint8 value);
+
+    /**
+     * @brief Stellt die aufgedeckten Nachbarn einer Zelle zur Prüfung an.
+     * @param cell Index der Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    void enqueueNeighbours(int cell);
+
+    /**
+     * @brief Stellt eine aufgedeckte Zelle zur Prüfung an, falls sie es nicht schon ist.
+     * @param cell Index der Zelle.
+     *
+     * @author Daniel Schukin
+     */
+    void enqueue(int cell);
+
+    /**
+     * @brief Schätzt für jede verdeckte Zelle das Risiko und wählt die kleinste.
+     * @return Geratener Zug.
+     *
+     * @author Daniel Schukin
+     */
+    Move guess();
+
+    int length;        ///< Anzahl der Zeilen.
+    int width;         ///< Anzahl der Spalten.
+    int minesNumber;   ///< Anzahl der Minen.
+    bool safeOpening;  ///< True, wenn der erste Klick sicher ist.
+    int openCells = 0; ///< Anzahl aufgedeckter Zellen in seen.
+    QVector<qint32> neighbours; ///< 8 Nachbarn pro Zelle, -1 außerhalb des Spielfelds.
+    QVector<quint8> seen;       ///< Zuletzt gesehene Codes aller Zellen.
+    QVector<quint8> knowledge;  ///< UNKNOWN, SAFE oder MINE pro Zelle.
+    QVector<qint32> safeCells;  ///< Als sicher erkannte Zellen; aufgedeckte werden beim Abgeben übersprungen.
+    QVector<qint32> worklist;   ///< Zahlen, die neu geprüft werden müssen.
+    QVector<qint32> subsetList; ///< Zahlen, für die noch die Teilmengenregel aussteht.
+    QVector<quint8> queued;     ///< IN_WORKLIST und IN_SUBSETLIST pro Zelle.
+    QVector<float> risk;        ///< Risiko pro Zelle beim Raten (Hilfspuffer).
+    const std::atomic<bool> *interrupt = nullptr; ///< Abbruchflag, siehe setInterruptFlag().
+};
+
+#endif // GAMESOLVER_H
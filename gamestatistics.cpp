@@ -1,4 +1,5 @@
 #include "gamestatistics.h"
+#include "tracing.h"
 
 /**
  * @brief Konstruktor für die GameStatistics-Klasse.
@@ -28,9 +29,14 @@ GameStatistics::~GameStatistics() {
  * @param width Breite des Spielfelds (Anzahl der Spalten).
  * @param mines Anzahl der Minen im Spielfeld.
  * @param won Gibt an, ob das Spiel gewonnen wurde (true) oder verloren wurde (false).
- * @param time Die Zeit (in Sekunden), die für das Spiel benötigt wurde.
+ * @param time Die Zeit (in ms), die für das Spiel benötigt wurde.
+ * @param bbbv 3BV des gespielten Spielfelds.
+ * @param openings Anzahl der Öffnungen des gespielten Spielfelds.
+ * @param undone True, wenn im Spiel Züge rückgängig gemacht wurden; dann zählt die Zeit nicht als Bestzeit.
+ * @param assisted True, wenn im Spiel ein Tipp angezeigt wurde; dann zählt die Zeit ebenfalls nicht als Bestzeit.
  */
-void GameStatistics::updateStats(int length, int width, int mines, bool won, int time) {
+void GameStatistics::updateStats(int length, int width, int mines, bool won, qint64 time, int bbbv, int openings,
+                                 bool undone, bool assisted) {
     QString key = generateKey(length, width, mines); ///< Generiere einen Schlüssel für die aktuelle Konfiguration.
 
     ///< Prüfe, ob die Konfiguration bereits existiert. Wenn nicht, füge sie hinzu.
@@ -42,17 +48,89 @@ void GameStatistics::updateStats(int length, int width, int mines, bool won, int
     GameStats *stats = &(*statsMap)[key];
 
     stats->gamesPlayed++; ///< Erhöhe die Anzahl der gespielten Spiele.
+    stats->bbbvTotal += bbbv; ///< Summiere 3BV und Öffnungen für Durchschnittswerte.
+    stats->openingsTotal += openings;
+    if (undone) {
+        stats->gamesUndone++;
+    }
+    if (assisted) {
+        stats->gamesAssisted++;
+    }
 
     if (won) {
         stats->gamesWon++; ///< Erhöhe die Anzahl der gewonnenen Spiele.
-        if (time < stats->shortestTime) {
-            stats->shortestTime = time; ///< Aktualisiere die kürzeste benötigte Zeit.
+        if (!undone && !assisted && time < stats->shortestTime) {
+            stats->shortestTime = int(time); ///< Aktualisiere die kürzeste benötigte Zeit.
+            stats->shortestTimeBbbv = bbbv;
         }
     } else {
         stats->gamesLost++; ///< Erhöhe die Anzahl der verlorenen Spiele.
     }
 }
 
+/**
+ * @brief Nimmt ein gezähltes Spiel wieder aus den Statistiken.
+ *
+ * Wird verwendet, wenn ein verlorener Zug rückgängig gemacht wird und das Spiel weiterläuft.
+ *
+ * @param length Länge des Spielfelds (Anzahl der Zeilen).
+ * @param width Breite des Spielfelds (Anzahl der Spalten).
+ * @param mines Anzahl der Minen im Spielfeld.
+ * @param won Gibt an, ob das Spiel als gewonnen gezählt wurde.
+ * @param bbbv 3BV des gespielten Spielfelds.
+ * @param openings Anzahl der Öffnungen des gespielten Spielfelds.
+ * @param undone Gibt an, ob das Spiel als rückgängig gemacht gezählt wurde.
+ * @param assisted Gibt an, ob das Spiel als mit Tipp gespielt gezählt wurde.
+ */
+void GameStatistics::revokeStats(int length, int width, int mines, bool won, int bbbv, int openings, bool undone,
+                                 bool assisted) {
+    QString key = generateKey(length, width, mines);
+    if (!statsMap->contains(key)) {
+        return; ///< das Spiel wurde nie gezählt
+    }
+    GameStats *stats = &(*statsMap)[key];
+    stats->gamesPlayed--;
+    stats->bbbvTotal -= bbbv;
+    stats->openingsTotal -= openings;
+    if (undone) {
+        stats->gamesUndone--;
+    }
+    if (assisted) {
+        stats->gamesAssisted--;
+    }
+    if (won) {
+        stats->gamesWon--;
+    } else {
+        stats->gamesLost--;
+    }
+}
+
+/**
+ * @brief Addiert fertige Statistiken zu ihrer Konfiguration.
+ *
+ * Wird von u3-sim verwendet, das die Spiele pro Thread zählt und erst am Ende zusammenführt.
+ *
+ * @param stats Zu addierende Statistiken.
+ */
+void GameStatistics::mergeStats(const GameStats &stats) {
+    QString key = generateKey(stats.gridLength, stats.gridWidth, stats.minesNumber);
+    if (!statsMap->contains(key)) {
+        (*statsMap)[key] = GameStats(stats.gridLength, stats.gridWidth, stats.minesNumber);
+    }
+    GameStats *total = &(*statsMap)[key];
+    total->gamesPlayed += stats.gamesPlayed;
+    total->gamesWon += stats.gamesWon;
+    total->gamesLost += stats.gamesLost;
+    total->bbbvTotal += stats.bbbvTotal;
+    total->openingsTotal += stats.openingsTotal;
+    total->gamesUndone += stats.gamesUndone;
+    total->gamesAssisted += stats.gamesAssisted;
+    if (stats.shortestTime < total->shortestTime) {
+        total->shortestTime = stats.shortestTime;
+        total->shortestTimeBbbv = stats.shortestTimeBbbv;
+    }
+}
+
 /**
  * @brief Speichert die aktuellen Spielstatistiken in einer JSON-Datei.
  *
@@ -61,6 +139,7 @@ void GameStatistics::updateStats(int length, int width, int mines, bool won, int
  * @param filePath Der Pfad zur Datei, in die die Statistiken gespeichert werden sollen.
  */
 void GameStatistics::saveToFile(const QString &filePath) {
+    TRACE_SPAN("stats.saveToFile");
     QJsonArray statsArray; ///< JSON-Array zur Speicherung der Statistiken.
 
     ///< Iteriere durch die QMap und konvertiere jede Statistik in ein JSON-Objekt.
@@ -90,6 +169,7 @@ void GameStatistics::saveToFile(const QString &filePath) {
  * @param filePath Der Pfad zur Datei, aus der die Statistiken geladen werden sollen.
  */
 void GameStatistics::loadFromFile(const QString &filePath) {
+    TRACE_SPAN("stats.loadFromFile");
     QFile file(filePath);
 
     ///< Öffne die Datei im Lesemodus und lese den Inhalt.
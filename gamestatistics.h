@@ -24,7 +24,12 @@ struct GameStats
     int gamesPlayed = 0; ///< Anzahl der gespielten Spiele.
     int gamesWon = 0;    ///< Anzahl der gewonnenen Spiele.
     int gamesLost = 0;   ///< Anzahl der verlorenen Spiele.
-    int shortestTime = INT_MAX; ///< Kürzeste benötigte Zeit für ein gewonnenes Spiel.
+    int shortestTime = INT_MAX; ///< Kürzeste benötigte Zeit für ein gewonnenes Spiel in ms.
+    int shortestTimeBbbv = 0; ///< 3BV des Spielfelds, auf dem die kürzeste Zeit erreicht wurde.
+    int bbbvTotal = 0;    ///< Summe der 3BV-Werte aller gespielten Spielfelder.
+    int openingsTotal = 0; ///< Summe der Öffnungen aller gespielten Spielfelder.
+    int gamesUndone = 0;  ///< Anzahl der Spiele mit rückgängig gemachten Zügen (zählen nicht für die Bestzeit).
+    int gamesAssisted = 0; ///< Anzahl der Spiele, in denen ein Tipp angezeigt wurde (zählen nicht für die Bestzeit).
 
     /**
      * @brief Konstruktor für GameStats.
@@ -51,7 +56,13 @@ struct GameStats
         obj["gamesPlayed"] = gamesPlayed;
         obj["gamesWon"] = gamesWon;
         obj["gamesLost"] = gamesLost;
-        obj["shortestTime"] = shortestTime == INT_MAX ? -1 : shortestTime; // -1, wenn kein Spiel gewonnen wurde.
+        obj["shortestTimeMs"] = shortestTime == INT_MAX ? -1 : shortestTime; // -1, wenn kein Spiel gewonnen wurde.
+        obj["shortestTime"] = shortestTime == INT_MAX ? -1 : shortestTime / 1000; // in Sekunden für ältere Versionen
+        obj["shortestTimeBbbv"] = shortestTimeBbbv;
+        obj["bbbvTotal"] = bbbvTotal;
+        obj["openingsTotal"] = openingsTotal;
+        obj["gamesUndone"] = gamesUndone;
+        obj["gamesAssisted"] = gamesAssisted;
         return obj;
     }
 
@@ -68,10 +79,22 @@ struct GameStats
         gamesPlayed = obj["gamesPlayed"].toInt();
         gamesWon = obj["gamesWon"].toInt();
         gamesLost = obj["gamesLost"].toInt();
-        shortestTime = obj["shortestTime"].toInt();
+        ///< ältere Dateien enthalten die Bestzeit nur in ganzen Sekunden
+        if (obj.contains("shortestTimeMs")) {
+            shortestTime = obj["shortestTimeMs"].toInt();
+        } else {
+            shortestTime = obj["shortestTime"].toInt();
+            shortestTime = shortestTime == -1 ? -1 : shortestTime * 1000;
+        }
         if (shortestTime == -1) {
             shortestTime = INT_MAX; ///< Falls kein Spiel gewonnen wurde, zurücksetzen.
         }
+        ///< ältere Dateien enthalten noch keine 3BV-Werte, dann bleibt es bei 0
+        shortestTimeBbbv = obj["shortestTimeBbbv"].toInt();
+        bbbvTotal = obj["bbbvTotal"].toInt();
+        openingsTotal = obj["openingsTotal"].toInt();
+        gamesUndone = obj["gamesUndone"].toInt();
+        gamesAssisted = obj["gamesAssisted"].toInt();
     }
 };
 
@@ -110,11 +133,47 @@ public:
      * @param width Spielfeldbreite.
      * @param mines Anzahl der Minen.
      * @param won Gibt an, ob das Spiel gewonnen wurde.
-     * @param time Die benötigte Zeit für das Spiel.
+     * @param time Die benötigte Zeit für das Spiel in ms.
+     * @param bbbv 3BV des gespielten Spielfelds.
+     * @param openings Anzahl der Öffnungen des gespielten Spielfelds.
+     * @param undone True, wenn im Spiel Züge rückgängig gemacht wurden.
+     * @param assisted True, wenn im Spiel ein Tipp angezeigt wurde.
+     *
+     * @author Daniel Schukin
+     */
+    void updateStats(int length, int width, int mines, bool won, qint64 time, int bbbv = 0, int openings = 0,
+                     bool undone = false, bool assisted = false);
+
+    /**
+     * @brief Nimmt ein mit updateStats() gezähltes Spiel wieder aus den Statistiken.
+     *
+     * Die Bestzeit wird nicht zurückgesetzt; nur Spiele, die sie nicht verändert haben
+     * (verlorene, rückgängig gemachte oder mit Tipp gespielte), dürfen zurückgenommen werden.
+     *
+     * @param length Spielfeldlänge.
+     * @param width Spielfeldbreite.
+     * @param mines Anzahl der Minen.
+     * @param won Gibt an, ob das Spiel als gewonnen gezählt wurde.
+     * @param bbbv 3BV des gespielten Spielfelds.
+     * @param openings Anzahl der Öffnungen des gespielten Spielfelds.
+     * @param undone Gibt an, ob das Spiel als rückgängig gemacht gezählt wurde.
+     * @param assisted Gibt an, ob das Spiel als mit Tipp gespielt gezählt wurde.
+     *
+     * @author Daniel Schukin
+     */
+    void revokeStats(int length, int width, int mines, bool won, int bbbv, int openings, bool undone,
+                     bool assisted = false);
+
+    /**
+     * @brief Addiert die Zähler fertiger Statistiken, z.B. aus einer Simulation, zu ihrer Konfiguration.
+     *
+     * Die kürzere Bestzeit bleibt erhalten.
+     *
+     * @param stats Zu addierende Statistiken; die Konfiguration steht in stats selbst.
      *
      * @author Daniel Schukin
      */
-    void updateStats(int length, int width, int mines, bool won, int time);
+    void mergeStats(const GameStats &stats);
 
     /**
      * @brief Speichert die Statistiken in einer JSON-Datei.
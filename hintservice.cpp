@@ -0,0 +1,166 @@
+#include "hintservice.h"
+#include "gamesolver.h"
+#include "tracing.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+
+/**
+ * @brief Konstruktor für HintService. Startet den Analyse-Thread.
+ * @param parent Übergeordnetes Objekt.
+ */
+HintService::HintService(QObject *parent)
+    : QObject(parent)
+{
+    thread = QThread::create([this]() { run(); });
+    thread->start(QThread::LowPriority);
+}
+
+/**
+ * @brief Destruktor für HintService. Bricht eine laufende Analyse ab und beendet den Thread.
+ */
+HintService::~HintService() {
+    {
+        QMutexLocker locker(&mutex);
+        quitting = true;
+        interrupted = true;
+        wake.wakeOne();
+    }
+    thread->wait();
+    delete thread;
+}
+
+/**
+ * @brief Beginnt die Analyse eines neuen oder geladenen Spielfelds.
+ * @param setup Einstellungen des Spielfelds.
+ * @param plane Anzeigeebene des Spielfelds.
+ *
+ * Noch nicht abgeholte Züge des alten Spielfelds werden verworfen.
+ */
+void HintService::showBoard(const GameSetup &setup, const BoardPlane &plane) {
+    QMutexLocker locker(&mutex);
+    requestedSetup = setup;
+    requestedPlane = plane; ///< nur Referenzen, siehe BoardPlane
+    requestedChanges.clear();
+    requestedReset = true;
+    pending = true;
+    requestedVersion++;
+    interrupted = true;
+    wake.wakeOne();
+}
+
+/**
+ * @brief Gibt einen Zug weiter.
+ * @param plane Anzeigeebene nach dem Zug.
+ * @param cells Geänderte Zellen.
+ *
+ * Kostet im GUI-Thread nur das Anhängen der Indizes; die Codes liest der Analyse-Thread selbst
+ * aus der Ebene. Folgt noch ein neues Spielfeld, das nicht abgeholt wurde, genügt die Ebene.
+ */
+void HintService::showMove(const BoardPlane &plane, const QVector<CellUpdate> &cells) {
+    QMutexLocker locker(&mutex);
+    requestedPlane = plane;
+    const int width = requestedSetup.width;
+    if (!requestedReset && qint64(requestedSetup.length) * width <= MAX_CELLS) {
+        requestedChanges.reserve(requestedChanges.size() + cells.size());
+        for (const CellUpdate &cell : cells) {
+            requestedChanges.append(cell.row * width + cell.col);
+        }
+    }
+    pending = true;
+    requestedVersion++;
+    interrupted = true;
+    wake.wakeOne();
+}
+
+/**
+ * @brief Gibt den Tipp zum neuesten Stand zurück, falls er schon berechnet ist.
+ * @param hint Gibt den Tipp zurück.
+ * @return True, wenn ein Tipp zum neuesten Stand vorliegt.
+ */
+bool HintService::take(Hint &hint) {
+    QMutexLocker locker(&mutex);
+    if (this->hint.version != requestedVersion || this->hint.row < 0) {
+        return false;
+    }
+    hint = this->hint;
+    return true;
+}
+
+/**
+ * @brief Schleife des Analyse-Threads.
+ *
+ * Holt unter der Sperre alle seit dem letzten Mal geänderten Zellen auf einmal ab und
+ * analysiert ohne Sperre. Wurde der Solver unterbrochen, liegt schon ein neuerer Stand bereit;
+ * die bis dahin übernommenen Zellen und Schlüsse bleiben im Solver.
+ */
+void HintService::run() {
+    GameSolver solver(0, 0, 0);
+    QVector<quint8> visible; ///< Codes aller Zellen, wie sie der Solver liest
+    bool analysable = false; ///< False bei zu großen Spielfeldern
+    while (true) {
+        GameSetup setup;
+        BoardPlane plane;
+        QVector<qint32> changes;
+        bool reset;
+        quint64 version;
+        {
+            QMutexLocker locker(&mutex);
+            while (!pending && !quitting) {
+                wake.wait(&mutex);
+            }
+            if (quitting) {
+                return;
+            }
+            setup = requestedSetup;
+            plane = requestedPlane;
+            changes.swap(requestedChanges);
+            reset = requestedReset;
+            version = requestedVersion;
+            requestedReset = false;
+            pending = false;
+            interrupted = false;
+        }
+
+        TRACE_SPAN("hint.analyse");
+        const qint64 cells = qint64(setup.length) * setup.width;
+        if (reset) {
+            analysable = cells > 0 && cells <= MAX_CELLS;
+            if (!analysable) {
+                continue;
+            }
+            solver = GameSolver(setup.length, setup.width, setup.minesNumber, setup.safeOpening);
+            solver.setInterruptFlag(&interrupted);
+            visible.resize(int(cells));
+            for (int row = 0; row < setup.length; row++) {
+                for (int col = 0; col < setup.width;) {
+                    int count;
+                    const quint8 *codes = plane.rowSpan(row, col, count);
+                    std::copy(codes, codes + count, visible.begin() + (row * setup.width + col));
+                    col += count;
+                }
+            }
+        } else if (!analysable) {
+            continue;
+        } else {
+            for (const qint32 cell : changes) {
+                visible[cell] = plane.code(cell / setup.width, cell % setup.width);
+            }
+        }
+
+        const GameSolver::Move move = reset ? solver.next(visible.constData())
+                                            : solver.next(visible.constData(), changes.constData(), changes.size());
+        if (move.cell < 0) {
+            continue; ///< unterbrochen (der neue Stand liegt schon bereit) oder keine verdeckte Zelle mehr
+        }
+        {
+            QMutexLocker locker(&mutex);
+            hint.row = move.cell / setup.width;
+            hint.col = move.cell % setup.width;
+            hint.safe = move.safe;
+            hint.risk = move.risk;
+            hint.version = version;
+        }
+        emit hintReady();
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef HINTSERVICE_H
+#define HINTSERVICE_H
+
+#include "boardplane.h"
+#include "gameengine.h"
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+
+class QThread;
+
+/**
+ * @file hintservice.h
+ * @class HintService
+ * @brief Berechnet nach jedem Zug im Hintergrund einen Tipp für den nächsten Zug.
+ *
+ * Der Tipp ist eine sichere Zelle oder, wenn es keine gibt, die verdeckte Zelle mit dem
+ * kleinsten geschätzten Risiko (siehe GameSolver). Die Oberfläche gibt jedes Ereignis der
+ * Engine weiter; die Analyse beginnt sofort, nicht erst beim Drücken der Tipp-Taste, und ist
+ * bis dahin meist längst fertig.
+ *
+ * Technische Entscheidung:
+ * Ein GameSolver bleibt über das ganze Spiel erhalten und bekommt nach jedem Zug nur die
+ * geänderten Zellen aus dem Ereignis (also aus Game::getChangedCells()); bereits gefundene
+ * sichere Zellen und Minen werden weiterverwendet. Wie bei BoardRenderer gilt nur der neueste
+ * Stand: Kommt ein Zug, während noch analysiert wird, setzt showMove() ein Abbruchflag, das
+ * der Solver regelmäßig liest. Die angefangene Arbeit bleibt dabei im Solver und wird mit den
+ * neuen Zellen fortgesetzt, statt verworfen zu werden.
+ *
+ * Jeder Tipp trägt die Nummer des Stands, zu dem er gehört; take() gibt nur einen Tipp zum
+ * neuesten Stand heraus. Spielfelder mit mehr als MAX_CELLS Zellen werden nicht analysiert.
+ *
+ * Abhängigkeit: GameSolver; bekommt die Ereignisse der GameEngine von MainWindow.
+ *
+ * @author Daniel Schukin
+ */
+class HintService : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_CELLS = 1 << 20; ///< Größere Spielfelder bekommen keine Tipps (der Solver braucht ~40 Byte pro Zelle).
+
+    /// @brief Berechneter Tipp.
+    struct Hint
+    {
+        int row = -1;          ///< Zeilenindex der Zelle, -1 wenn es keinen Tipp gibt.
+        int col = -1;          ///< Spaltenindex der Zelle.
+        bool safe = false;     ///< True, wenn die Zelle sicher keine Mine ist.
+        double risk = 1.0;     ///< Geschätzte Wahrscheinlichkeit einer Mine.
+        quint64 version = 0;   ///< Nummer des Stands, zu dem der Tipp gehört.
+    };
+
+    /**
+     * @brief Konstruktor für HintService. Startet den Analyse-Thread.
+     * @param parent Übergeordnetes Objekt.
+     *
+     * @author Daniel Schukin
+     */
+    explicit HintService(QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor für HintService. Bricht eine laufende Analyse ab und beendet den Thread.
+     *
+     * @author Daniel Schukin
+     */
+    ~HintService();
+
+    /**
+     * @brief Beginnt die Analyse eines neuen oder geladenen Spielfelds.
+     * @param setup Einstellungen des Spielfelds.
+     * @param plane Anzeigeebene des Spielfelds.
+     *
+     * @author Daniel Schukin
+     */
+    void showBoard(const GameSetup &setup, const BoardPlane &plane);
+
+    /**
+     * @brief Gibt einen Zug weiter; eine laufende Analyse wird abgebrochen und mit ihm fortgesetzt.
+     * @param plane Anzeigeebene nach dem Zug.
+     * @param cells Geänderte Zellen.
+     *
+     * @author Daniel Schukin
+     */
+    void showMove(const BoardPlane &plane, const QVector<CellUpdate> &cells);
+
+    /**
+     * @brief Gibt den Tipp zum neuesten Stand zurück, falls er schon berechnet ist; wartet nie.
+     * @param hint Gibt den Tipp zurück.
+     * @return True, wenn ein Tipp zum neuesten Stand vorliegt; sonst folgt später hintReady().
+     *
+     * @author Daniel Schukin
+     */
+    bool take(Hint &hint);
+
+signals:
+    /**
+     * @brief Wird aus dem Analyse-Thread gesendet, wenn ein Tipp fertig ist.
+     *
+     * @author Daniel Schukin
+     */
+    void hintReady();
+
+private:
+    /**
+     * @brief Schleife des Analyse-Threads.
+     *
+     * @author Daniel Schukin
+     */
+    void run();
+
+    QThread *thread; ///< Analyse-Thread.
+    QMutex mutex; ///< Schützt die angeforderten Daten und den fertigen Tipp.
+    QWaitCondition wake; ///< Weckt den Analyse-Thread bei einem neuen Stand.
+    GameSetup requestedSetup; ///< Einstellungen des neuesten Spielfelds.
+    BoardPlane requestedPlane; ///< Neuester Stand (Copy-on-Write-Kopie).
+    QVector<qint32> requestedChanges; ///< Seit der letzten Abholung geänderte Zellen (Index Zeile * Breite + Spalte).
+    bool requestedReset = false; ///< True, wenn seit der letzten Abholung ein neues Spielfeld kam.
+    bool pending = false; ///< True, solange der neueste Stand nicht abgeholt wurde.
+    quint64 requestedVersion = 0; ///< Nummer des neuesten Stands.
+    Hint hint; ///< Zuletzt berechneter Tipp.
+    std::atomic<bool> interrupted{false}; ///< True, sobald ein neuerer Stand vorliegt; bricht den Solver ab.
+    std::atomic<bool> quitting{false}; ///< True, sobald der Analyse-Thread enden soll.
+};
+
+#endif // HINTSERVICE_H
@@ -0,0 +1,101 @@
+#include "latencyhistogram.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Zählt eine Messung.
+ * @param value Gemessene Zeit in µs.
+ */
+void LatencyHistogram::record(qint64 value) {
+    value = std::clamp<qint64>(value, 0, (qint64(1) << MAX_BITS) - 1);
+    counts[bucketOf(value)]++;
+    count++;
+    sum += value;
+    max = std::max(max, value);
+}
+
+/**
+ * @brief Berechnet das Fach eines Werts.
+ * @param value Wert in µs.
+ * @return Index in counts.
+ *
+ * Ab SUB_BUCKETS wird der Wert so weit nach rechts geschoben, dass die obersten
+ * SUB_BUCKET_BITS Bits übrig bleiben; sie wählen das Fach innerhalb der Zweierpotenz.
+ */
+int LatencyHistogram::bucketOf(qint64 value) {
+    if (value < SUB_BUCKETS) {
+        return int(value);
+    }
+    const int shift = 63 - int(qCountLeadingZeroBits(quint64(value))) - (SUB_BUCKET_BITS - 1);
+    return SUB_BUCKETS + (shift - 1) * (SUB_BUCKETS / 2) + int(value >> shift) - SUB_BUCKETS / 2;
+}
+
+/**
+ * @brief Berechnet den größten Wert eines Fachs.
+ * @param bucket Index in counts.
+ * @return Obere Grenze in µs.
+ */
+qint64 LatencyHistogram::highestValueOf(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    const int shift = (bucket - SUB_BUCKETS) / (SUB_BUCKETS / 2) + 1;
+    const qint64 top = (bucket - SUB_BUCKETS) % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+    return ((top + 1) << shift) - 1;
+}
+
+/**
+ * @brief Gibt den Wert zurück, unter dem ein Anteil der Messungen liegt.
+ * @param percentile Perzentil zwischen 0 und 100.
+ * @return Obere Grenze des Fachs in µs (höchstens die größte Messung), 0 ohne Messungen.
+ */
+qint64 LatencyHistogram::valueAtPercentile(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    const qint64 target = std::max<qint64>(1, qint64(std::ceil(percentile / 100.0 * count)));
+    qint64 seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += counts[bucket];
+        if (seen >= target) {
+            return std::min(highestValueOf(bucket), max);
+        }
+    }
+    return max;
+}
+
+/**
+ * @brief Löscht alle Messungen.
+ */
+void LatencyHistogram::reset() {
+    counts.fill(0);
+    count = 0;
+    sum = 0;
+    max = 0;
+}
+
+/**
+ * @brief Schreibt die Verteilung als Perzentil-Tabelle im Textformat von HdrHistogram.
+ * @param out Ziel der Ausgabe.
+ * @param title Überschrift der Tabelle.
+ */
+void LatencyHistogram::write(QTextStream &out, const QString &title) const {
+    out << "# " << title << "\n";
+    out << "       Value     Percentile TotalCount 1/(1-Percentile)\n\n";
+    qint64 seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        if (counts[bucket] == 0) {
+            continue;
+        }
+        seen += counts[bucket];
+        const double fraction = double(seen) / count;
+        out << QString("%1 %2 %3 %4\n")
+                   .arg(std::min(highestValueOf(bucket), max) / 1000.0, 12, 'f', 3)
+                   .arg(fraction, 14, 'f', 12)
+                   .arg(seen, 10)
+                   .arg(fraction < 1.0 ? QString::number(1.0 / (1.0 - fraction), 'f', 2) : QString("inf"), 14);
+    }
+    out << QString("#[Mean    = %1, Max     = %2]\n").arg(getMean() / 1000.0, 12, 'f', 3).arg(max / 1000.0, 12, 'f', 3);
+    out << QString("#[Total count    = %1]\n\n").arg(count, 12);
+}
@@ -0,0 +1,103 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QString>
+#include <QTextStream>
+#include <array>
+
+/**
+ * @file latencyhistogram.h
+ * @class LatencyHistogram
+ * @brief Histogramm für Zeitmessungen in Mikrosekunden mit fester relativer Genauigkeit (HDR).
+ *
+ * Werte unter SUB_BUCKETS µs werden exakt gezählt. Darüber wird jede Zweierpotenz in
+ * SUB_BUCKETS / 2 gleich breite Fächer geteilt, die relative Abweichung eines Perzentils
+ * liegt damit unter 1/64 (1,6 %). Der Bereich reicht bis 2^MAX_BITS µs (ca. 12 Tage),
+ * größere Werte landen im obersten Fach.
+ *
+ * Technische Entscheidung:
+ * Ein Wert wird mit einem Bit-Scan in ein Fach umgerechnet und gezählt, ohne Speicher zu
+ * belegen; record() kann so bei jedem Klick und jedem Bild aufgerufen werden. Der Speicher ist
+ * fest (ca. 18 KB) und unabhängig von der Anzahl der Messungen.
+ *
+ * Abhängigkeit: ist unabhängig und wird vom FrameMonitor verwendet.
+ *
+ * @author Daniel Schukin
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 7; ///< Bits für die Fächer pro Zweierpotenz.
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS; ///< Anzahl der exakten Fächer.
+    static constexpr int MAX_BITS = 40; ///< Größter erfasster Wert ist 2^MAX_BITS - 1 µs.
+    static constexpr int BUCKETS = SUB_BUCKETS + (MAX_BITS - SUB_BUCKET_BITS) * SUB_BUCKETS / 2; ///< Anzahl aller Fächer.
+
+    /**
+     * @brief Zählt eine Messung.
+     * @param value Gemessene Zeit in µs.
+     *
+     * @author Daniel Schukin
+     */
+    void record(qint64 value);
+
+    /**
+     * @brief Gibt den Wert zurück, unter dem ein Anteil der Messungen liegt.
+     * @param percentile Perzentil zwischen 0 und 100.
+     * @return Obere Grenze des Fachs in µs, 0 ohne Messungen.
+     *
+     * @author Daniel Schukin
+     */
+    qint64 valueAtPercentile(double percentile) const;
+
+    /**
+     * @brief Löscht alle Messungen.
+     *
+     * @author Daniel Schukin
+     */
+    void reset();
+
+    /**
+     * @brief Schreibt die Verteilung als Perzentil-Tabelle im Textformat von HdrHistogram.
+     * @param out Ziel der Ausgabe.
+     * @param title Überschrift der Tabelle.
+     *
+     * Die Werte werden in ms ausgegeben; die Tabelle kann direkt mit dem HdrHistogram-Plotter
+     * dargestellt werden.
+     *
+     * @author Daniel Schukin
+     */
+    void write(QTextStream &out, const QString &title) const;
+
+    /// @name Getter
+    /// @{
+    qint64 getCount() const { return count; }
+    qint64 getMax() const { return max; }
+    double getMean() const { return count ? double(sum) / count : 0.0; }
+    /// @}
+
+private:
+    /**
+     * @brief Berechnet das Fach eines Werts.
+     * @param value Wert in µs.
+     * @return Index in counts.
+     *
+     * @author Daniel Schukin
+     */
+    static int bucketOf(qint64 value);
+
+    /**
+     * @brief Berechnet den größten Wert eines Fachs.
+     * @param bucket Index in counts.
+     * @return Obere Grenze in µs.
+     *
+     * @author Daniel Schukin
+     */
+    static qint64 highestValueOf(int bucket);
+
+    std::array<qint64, BUCKETS> counts{}; ///< Anzahl der Messungen pro Fach.
+    qint64 count = 0; ///< Anzahl aller Messungen.
+    qint64 sum = 0; ///< Summe aller Messungen in µs.
+    qint64 max = 0; ///< Größte Messung in µs.
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -3,14 +3,18 @@
  * @brief Einstiegspunkt für die Anwendung.
  *
  * Initialisiert die Qt-Anwendung, erstellt das Spiel und das Hauptfenster
- * und startet die Ereignisschleife.
+ * und startet die Ereignisschleife. Mit `--serve [Name]` oder `--stdio` läuft
+ * stattdessen nur der Server für Bots, ohne Fenster (siehe BotServer).
  *
  * @author Daniel Schukin
  */
 
 #include "mainwindow.h"
+#include "botprotocol.h"
+#include "botserver.h"
 #include "game.h"
 #include <QApplication>
+#include <QDebug>
 #include <QFile>
 
 /**
@@ -27,6 +31,31 @@
  * @author Daniel Schukin
  */
 int main(int argc, char *argv[]) {
+    /**
+     * @brief Startet ohne Fenster nur den Server für Bots.
+     *
+     * @details Wird vor QApplication geprüft, damit der Server auch ohne Display läuft.
+     *
+     * @author Daniel Schukin
+     */
+    for (int i = 1; i < argc; i++) {
+        if (qstrcmp(argv[i], "--stdio") == 0) {
+            QCoreApplication app(argc, argv);
+            return BotServer::serveStdio();
+        }
+        if (qstrcmp(argv[i], "--serve") == 0) {
+            QCoreApplication app(argc, argv);
+            const QString name = i + 1 < argc ? QString::fromLocal8Bit(argv[i + 1])
+                                              : QString(BotProtocol::DEFAULT_SERVER);
+            BotServer server;
+            if (!server.listen(name)) {
+                qWarning() << "Bot-Server konnte nicht starten:" << server.errorString();
+                return 1;
+            }
+            return app.exec();
+        }
+    }
+
     QApplication a(argc, argv);
 
     /**
@@ -3,18 +3,37 @@
 #include "settingsdialog.h"
 #include "statisticsdialog.h"
 #include "helpdialog.h"
-#include "qminerpushbutton.h"
+#include "boardview.h"
 #include "game.h"
+#include "gameengine.h"
 #include <QMenu>
 #include <QMessageBox>
 #include <QDebug>
 #include <QFile>
 #include <QTimer>
+#include <QCloseEvent>
+#include <QDir>
+#include <QDateTime>
+#include <QFileDialog>
+#include <QEvent>
+#include <QScrollArea>
+#include <QScreen>
+#include <QStyle>
+#include <QRandomGenerator>
+#include <algorithm>
+#include "tracing.h"
+
+static const char *SAVEGAME_PATH = "savegame.u3s"; ///< Datei für das beim Beenden gespeicherte Spiel.
+static const char *REPLAY_DIR = "replays"; ///< Ordner für die Aufzeichnungen aller Spiele.
+static const char *DELTA_DIR = "deltas"; ///< Ordner für die Live-Mitschnitte (siehe tools/u3-delta).
+static const char *LATENCY_PATH = "latency.hgrm"; ///< Datei für die Latenz-Histogramme beim Beenden.
+static constexpr int HUD_INTERVAL = 500; ///< Aktualisierungsintervall der Leistungsanzeige in ms.
+static constexpr qint64 MAX_REPLAY_DELAY = 1000; ///< Längste Pause beim Abspielen einer Aufzeichnung in ms.
 
 /**
  * @brief Konstruktor der MainWindow-Klasse.
  * @param parent Zeiger auf das übergeordnete Widget.
- * @param game Zeiger auf das Game-Objekt zur Spiellogikverwaltung.
+ * @param game Zeiger auf das Game-Objekt zur Spiellogikverwaltung; es gehört ab hier dem Engine-Thread.
  */
 MainWindow::MainWindow(QWidget *parent, Game *game)
     : QMainWindow(parent)
@@ -26,10 +45,32 @@ MainWindow::MainWindow(QWidget *parent, Game *game)
     ///< Spielfeld-Einstellungen
     ui->gameGridWidget->setMinimumSize(BUTTONSIZE * 10, BUTTONSIZE * 10);
     ui->gameGrid->setSpacing(0);
-    this->game = game;
+    boardView = new BoardView(BUTTONSIZE);
+    boardScrollArea = new QScrollArea(this);
+    boardScrollArea->setFrameShape(QFrame::NoFrame);
+    boardScrollArea->setWidget(boardView); ///< große Spielfelder werden gescrollt
+    ui->gameGrid->addWidget(boardScrollArea, 0, 0);
+    connect(boardView, &BoardView::inputReceived, this, [this]() {
+        frameMonitor.inputStarted();
+    });
+    connect(boardView, &BoardView::movePainted, this, [this]() {
+        frameMonitor.inputPainted();
+    });
+    connect(boardView, &BoardView::leftClicked, this, &MainWindow::LMC_on_gameCell);
+    connect(boardView, &BoardView::middleClicked, this, &MainWindow::MMC_on_gameCell);
+    connect(boardView, &BoardView::rightClicked, this, &MainWindow::RMC_on_gameCell);
+    setup.length = game->getLength();
+    setup.width = game->getWidth();
+    setup.minesNumber = game->getMinesNumber();
+    board = setup;
+
+    ///< Spiellogik im eigenen Thread, ab hier nur noch über Befehle
+    engine = new GameEngine(game, this);
+    connect(engine, &GameEngine::eventsAvailable, this, &MainWindow::drainEngineEvents);
+    engine->start();
 
     ///< LCD-Anzeigen für Minen und Flags initialisieren
-    ui->minesLCDNumber->display(game->getMinesNumber());
+    ui->minesLCDNumber->display(setup.minesNumber);
     ui->flagsLCDNumber->setStyleSheet("QLCDNumber { color: blue; }");
 
     ///< Timer-Einstellungen
@@ -37,12 +78,68 @@ MainWindow::MainWindow(QWidget *parent, Game *game)
     ui->timeLCDNumber->display("00:00:00");
     timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, &MainWindow::updateTime);
+    replayTimer = new QTimer(this);
+    replayTimer->setSingleShot(true);
+    connect(replayTimer, &QTimer::timeout, this, &MainWindow::stepReplay);
+
+    ///< Leistungsanzeige oben links, standardmäßig ausgeblendet
+    hudLabel = new QLabel(this);
+    hudLabel->setStyleSheet("QLabel { background: rgba(0, 0, 0, 160); color: white; padding: 4px; }");
+    hudLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+    hudLabel->move(4, 4);
+    hudLabel->hide();
+    hudTimer = new QTimer(this);
+    connect(hudTimer, &QTimer::timeout, this, &MainWindow::updateHud);
 
     ///< Menü erstellen
     QMenu *menu = new QMenu(this);
     QAction *settingsAction = menu->addAction("Einstellungen");
     QAction *helpAction = menu->addAction("Hilfe");
     QAction *statsAction = menu->addAction("Statistik");
+    QAction *replayAction = menu->addAction("Aufzeichnung abspielen");
+    menu->addSeparator();
+    QAction *undoAction = menu->addAction("Rückgängig");
+    QAction *redoAction = menu->addAction("Wiederholen");
+    undoAction->setShortcut(QKeySequence::Undo);
+    redoAction->setShortcut(QKeySequence::Redo);
+    addAction(undoAction); ///< Tastenkürzel sollen auch bei geschlossenem Menü funktionieren
+    addAction(redoAction);
+    QAction *hudAction = menu->addAction("Leistungsanzeige");
+    hudAction->setCheckable(true);
+    hudAction->setShortcut(QKeySequence(Qt::Key_F3));
+    addAction(hudAction);
+    connect(hudAction, &QAction::toggled, this, &MainWindow::on_hudAction_toggled);
+    QAction *hintAction = menu->addAction("Tipp");
+    hintAction->setShortcut(QKeySequence(Qt::Key_H));
+    addAction(hintAction);
+    connect(hintAction, &QAction::triggered, this, &MainWindow::on_hintAction_clicked);
+    connect(&hintService, &HintService::hintReady, this, &MainWindow::showHint);
+    QAction *revealAction = menu->addAction("Schrittweise aufdecken");
+    revealAction->setCheckable(true);
+    connect(revealAction, &QAction::toggled, this, [this](bool enabled) {
+        engine->setRevealOrdered(enabled);
+        boardView->setAnimatedReveal(enabled);
+    });
+    QAction *exportAction = menu->addAction("Spielfeld freigeben");
+    exportAction->setCheckable(true);
+    connect(exportAction, &QAction::toggled, this, [this](bool enabled) {
+        EngineCommand command;
+        command.type = EngineCommand::EXPORT_BOARD;
+        command.filePath = enabled ? QString(BoardExport::DEFAULT_KEY) : QString(); ///< für Overlays, siehe BoardExportReader
+        engine->post(command);
+    });
+    QAction *deltaAction = menu->addAction("Live-Mitschnitt");
+    deltaAction->setCheckable(true);
+    connect(deltaAction, &QAction::toggled, this, [this](bool enabled) {
+        EngineCommand command;
+        command.type = EngineCommand::RECORD_DELTAS;
+        if (enabled) {
+            QDir().mkpath(DELTA_DIR);
+            const QString fileName = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz") + ".u3d";
+            command.filePath = QDir(DELTA_DIR).filePath(fileName);
+        }
+        engine->post(command);
+    });
 
     ///< Menü mit Button verbinden
     ui->menuButton->setMenu(menu);
@@ -51,12 +148,20 @@ MainWindow::MainWindow(QWidget *parent, Game *game)
     connect(settingsAction, &QAction::triggered, this, &MainWindow::on_settingsAction_clicked);
     connect(helpAction, &QAction::triggered, this, &MainWindow::on_helpAction_clicked);
     connect(statsAction, &QAction::triggered, this, &MainWindow::on_statsAction_clicked);
+    connect(replayAction, &QAction::triggered, this, &MainWindow::on_replayAction_clicked);
+#ifdef U3_TRACING
+    QAction *traceAction = menu->addAction("Trace speichern");
+    connect(traceAction, &QAction::triggered, this, &MainWindow::on_traceAction_clicked);
+#endif
+    connect(undoAction, &QAction::triggered, this, &MainWindow::on_undoAction_clicked);
+    connect(redoAction, &QAction::triggered, this, &MainWindow::on_redoAction_clicked);
 
     ///< Buttons für Spielsteuerung verbinden
     connect(ui->newGameButton, &QPushButton::clicked, this, &MainWindow::on_newGameBtn_clicked);
     connect(ui->pauseGameButton, &QPushButton::clicked, this, &MainWindow::on_pauseGameBtn_clicked);
     connect(ui->endGameButton, &QPushButton::clicked, this, &MainWindow::on_endGameBtn_clicked);
 
+    resumeSavedGame();
     resizeMainWindow();
 }
 
@@ -74,16 +179,10 @@ MainWindow::~MainWindow()
  * Setzt das Spielfeld zurück und beginnt ein neues Spiel.
  */
 void MainWindow::on_newGameBtn_clicked() {
-    clear_grid();
-    create_grid();
-    updateGameGrid();
-    restartTime();
-
-    ///< Flags-Zähler zurücksetzen
-    game->resetMarkedCells();
-    ui->flagsLCDNumber->display(game->getMarkedCells());
-    ui->flagsLCDNumber->setStyleSheet("QLCDNumber { color: blue; }");
-    resizeMainWindow();
+    TRACE_SPAN("ui.newGame");
+    replayTimer->stop();
+    replaying = false;
+    newGame();
 }
 
 /**
@@ -95,14 +194,15 @@ void MainWindow::on_pauseGameBtn_clicked() {
         hideGameGrid();
         ui->newGameButton->setVisible(false);
         ui->endGameButton->setVisible(false);
-        timer->stop();
+        pauseClock();
         isRunning = false;
         ui->pauseGameButton->setText("Resume");
+        saveGameInBackground();
     } else {
         showGameGrid();
         ui->newGameButton->setVisible(true);
         ui->endGameButton->setVisible(true);
-        timer->start(1000);
+        resumeClock();
         isRunning = true;
         ui->pauseGameButton->setText("Pause");
     }
@@ -113,9 +213,11 @@ void MainWindow::on_pauseGameBtn_clicked() {
  * Setzt das Spielfeld und den Timer zurück.
  */
 void MainWindow::on_endGameBtn_clicked() {
-    game->gameLost();
-    updateGameGrid();
-    resetTime();
+    if (pendingBoards > 0 || !postCommand(EngineCommand::RESIGN)) {
+        return;
+    }
+    recorder.record(ReplayFormat::RESIGN);
+    isRunning = false; ///< die Endzeit zeigt updateGameGrid(), sobald die Engine das Spiel beendet hat
 }
 
 /**
@@ -124,42 +226,37 @@ void MainWindow::on_endGameBtn_clicked() {
  */
 void MainWindow::on_settingsAction_clicked() {
     this->hide();
-    if (isRunning)
-        timer->stop();
+    const bool wasPaused = clockPaused;
+    pauseClock(); ///< die Spielzeit steht, solange der Dialog offen ist
 
-    SettingsDialog dialog(this);
+    SettingsDialog dialog(&estimator, this);
     if (dialog.exec() == QDialog::Accepted) {
-        game->setWon(false);
-        game->gameEnd();
-        clear_grid();
+        postCommand(EngineCommand::ABANDON);
 
         ///< Spielfeld basierend auf Schwierigkeitsgrad erstellen
         if (dialog.get_difficulty().isEmpty()) { ///< wenn nichts gewählt wurde
-            game->changeLength(dialog.get_boardLength());
-            game->changeWidth(dialog.get_boardWidth());
-            game->changeMinesNumber(dialog.get_minesNumber());
+            setup.length = dialog.get_boardLength();
+            setup.width = dialog.get_boardWidth();
+            setup.minesNumber = dialog.get_minesNumber();
         } else if (dialog.get_difficulty().contains("Leicht")) { ///< wenn leichte Schwirigkeit gewählt wurde
-            game->changeLength(10);
-            game->changeWidth(10);
-            game->changeMinesNumber(10);
+            setup.length = PRESET_EASY.length;
+            setup.width = PRESET_EASY.width;
+            setup.minesNumber = PRESET_EASY.minesNumber;
         } else if (dialog.get_difficulty().contains("Mittel")) { ///< wenn mittlere Schwirigkeit gewählt wurde
-            game->changeLength(14);
-            game->changeWidth(18);
-            game->changeMinesNumber(40);
+            setup.length = PRESET_MEDIUM.length;
+            setup.width = PRESET_MEDIUM.width;
+            setup.minesNumber = PRESET_MEDIUM.minesNumber;
         } else if (dialog.get_difficulty().contains("Schwer")) { ///< wenn schwere Schwirigkeit gewählt wurde
-            game->changeLength(20);
-            game->changeWidth(24);
-            game->changeMinesNumber(99);
+            setup.length = PRESET_HARD.length;
+            setup.width = PRESET_HARD.width;
+            setup.minesNumber = PRESET_HARD.minesNumber;
         }
         ///< das Spielfeld mit neuen Parametern starten
-        game->resetMarkedCells();
-        ui->minesLCDNumber->display(game->getMinesNumber());
-        create_grid();
-        updateGameGrid();
-        resizeMainWindow();
-        restartTime();
-    } else if (!firstGame && game->is_inGame()) { ///< falls die Einstellungen nicht bestätigt wurden, zurückgehen
-        timer->start(1000);
+        replayTimer->stop();
+        replaying = false;
+        newGame();
+    } else if (!wasPaused) { ///< falls die Einstellungen nicht bestätigt wurden, zurückgehen
+        resumeClock();
     }
     this->show(); ///< mainwindow wieder anzeigen
 }
@@ -169,11 +266,12 @@ void MainWindow::on_settingsAction_clicked() {
  */
 void MainWindow::on_statsAction_clicked() {
     this->hide();
-    timer->stop();
+    const bool wasPaused = clockPaused;
+    pauseClock();
     StatisticsDialog dialog(this);
     dialog.exec();
-    if (firstGame && game->is_inGame()) {
-        timer->start(1000);
+    if (!wasPaused) {
+        resumeClock();
     }
     this->show();
 }
@@ -183,55 +281,125 @@ void MainWindow::on_statsAction_clicked() {
  */
 void MainWindow::on_helpAction_clicked() {
     this->hide();
-    timer->stop();
+    const bool wasPaused = clockPaused;
+    pauseClock();
     HelpDialog dialog(this);
     dialog.exec();
-    if (!firstGame && game->is_inGame()) {
-        timer->start(1000);
+    if (!wasPaused) {
+        resumeClock();
     }
     this->show();
 }
 
 /**
- * @brief Linksklick-Signal auf einem Spielfeldbutton.
+ * @brief Slot: Macht den letzten Zug rückgängig.
+ * Läuft ein verlorenes Spiel dadurch weiter, startet updateGameGrid() den Timer mit der bisherigen Zeit.
+ */
+void MainWindow::on_undoAction_clicked() {
+    if (!isRunning || replaying || pendingBoards > 0 || !postCommand(EngineCommand::UNDO)) {
+        return;
+    }
+    recorder.record(ReplayFormat::UNDO);
+}
+
+/**
+ * @brief Slot: Wiederholt den zuletzt rückgängig gemachten Zug.
+ */
+void MainWindow::on_redoAction_clicked() {
+    if (!isRunning || replaying || pendingBoards > 0 || !postCommand(EngineCommand::REDO)) {
+        return;
+    }
+    recorder.record(ReplayFormat::REDO);
+}
+
+/**
+ * @brief Slot: Fordert einen Tipp für den aktuellen Stand an.
+ *
+ * Der Tipp ist meist schon im Hintergrund berechnet und erscheint sofort; sonst zeigt ihn
+ * showHint(), sobald er fertig ist.
+ */
+void MainWindow::on_hintAction_clicked() {
+    if (!isRunning || !inGame || replaying || pendingBoards > 0) {
+        return;
+    }
+    hintWanted = true;
+    showHint();
+}
+
+/**
+ * @brief Slot: Zeigt einen angeforderten Tipp an, sobald er zum neuesten Stand vorliegt.
+ *
+ * Angezeigt wird nur, wenn die Engine den Befehl HINT annimmt; das Spiel zählt dann in
+ * der Statistik als mit Tipp gespielt (siehe Game::markAssisted()).
+ */
+void MainWindow::showHint() {
+    HintService::Hint hint;
+    if (!hintWanted || !hintService.take(hint)) {
+        return;
+    }
+    hintWanted = false;
+    if (!inGame || !postCommand(EngineCommand::HINT)) {
+        return;
+    }
+    boardView->setHighlight(hint.row, hint.col, hint.safe);
+    boardScrollArea->ensureVisible(hint.col * BUTTONSIZE + BUTTONSIZE / 2, hint.row * BUTTONSIZE + BUTTONSIZE / 2,
+                                   BUTTONSIZE, BUTTONSIZE);
+}
+
+/**
+ * @brief Linksklick-Signal auf einem Spielfeldzelle.
  * @param row Zeilenindex der Zelle.
  * @param col Spaltenindex der Zelle.
  */
 void MainWindow::LMC_on_gameCell(int row, int col) {
-    qDebug() << "Linksklick auf Zelle";
-    game->open_cell(row, col);
-    updateGameGrid();
+    TRACE_SPAN("ui.leftClick");
+    qCDebug(lcUi) << "Linksklick auf Zelle";
+    if (replaying || pendingBoards > 0 || !postCommand(EngineCommand::OPEN, row, col)) {
+        frameMonitor.inputApplied(false); ///< ohne Befehl gibt es kein Bild zu messen
+        return;
+    }
+    recorder.record(ReplayFormat::OPEN, row, col);
 }
 
 /**
- * @brief Mittelklick-Signal auf einem Spielfeldbutton.
+ * @brief Mittelklick-Signal auf einem Spielfeldzelle.
  * Entfernt eine Markierung auf der Zelle.
  * @param row Zeilenindex der Zelle.
  * @param col Spaltenindex der Zelle.
  */
 void MainWindow::MMC_on_gameCell(int row, int col) {
-    qDebug() << "Mittelklick auf Zelle";
-    game->unmark_cell(row, col);
-    updateGameGrid();
-    ui->flagsLCDNumber->display(game->getMarkedCells());
-    if (game->getMarkedCells() <= game->getMinesNumber()) {
-        ui->flagsLCDNumber->setStyleSheet("QLCDNumber { color: blue; }");
+    TRACE_SPAN("ui.middleClick");
+    qCDebug(lcUi) << "Mittelklick auf Zelle";
+    if (replaying || pendingBoards > 0 || !postCommand(EngineCommand::UNMARK, row, col)) {
+        frameMonitor.inputApplied(false); ///< ohne Befehl gibt es kein Bild zu messen
+        return;
     }
+    recorder.record(ReplayFormat::UNMARK, row, col);
 }
 
 /**
- * @brief Rechtsklick-Signal auf einem Spielfeldbutton.
+ * @brief Rechtsklick-Signal auf einem Spielfeldzelle.
  * Markiert eine Zelle als potenzielle Mine.
  * @param row Zeilenindex der Zelle.
  * @param col Spaltenindex der Zelle.
  */
 void MainWindow::RMC_on_gameCell(int row, int col) {
-    qDebug() << "Rechtsklick auf Zelle";
-    game->mark_cell(row, col);
-    updateGameGrid();
-    ui->flagsLCDNumber->display(game->getMarkedCells());
+    TRACE_SPAN("ui.rightClick");
+    qCDebug(lcUi) << "Rechtsklick auf Zelle";
+    if (replaying || pendingBoards > 0 || !postCommand(EngineCommand::MARK, row, col)) {
+        frameMonitor.inputApplied(false); ///< ohne Befehl gibt es kein Bild zu messen
+        return;
+    }
+    recorder.record(ReplayFormat::MARK, row, col);
+}
+
+/**
+ * @brief Aktualisiert die Anzeige der markierten Zellen (LCD).
+ */
+void MainWindow::updateFlagsLCD() {
+    ui->flagsLCDNumber->display(markedCells);
     ///< wenn es mehr Felder markiert sind, als es Minen gibt, wird der Text vom Flagezähler Rot, sonst blau.
-    if (game->getMarkedCells() > game->getMinesNumber()) {
+    if (markedCells > board.minesNumber) {
         ui->flagsLCDNumber->setStyleSheet("QLCDNumber { color: red; }");
     } else {
         ui->flagsLCDNumber->setStyleSheet("QLCDNumber { color: blue; }");
@@ -239,101 +407,322 @@ void MainWindow::RMC_on_gameCell(int row, int col) {
 }
 
 /**
- * @brief Fügt einen Button zum Spielfeld GridLayout hinzu.
- * Erstellt und verbindet einen Button für eine bestimmte Zelle.
- * @param row Zeilenindex der Zelle.
- * @param col Spaltenindex der Zelle.
+ * @brief Slot: Holt alle bereitliegenden Ereignisse der Engine ab und zeigt sie an.
  */
-void MainWindow::addButtonToGrid(int row, int col) {
-    QMinerPushButton *button = new QMinerPushButton(this, row, col); ///< Zeiger für den Button erstellen
-    button->setFixedSize(QSize(BUTTONSIZE, BUTTONSIZE));
-    button->setIcon(QIcon(iconpathByStatus.value(0)));  ///< Standardicon für geschlossene Zellen.
-    button->setIconSize(QSize(BUTTONSIZE, BUTTONSIZE));
+void MainWindow::drainEngineEvents() {
+    TRACE_SPAN("ui.drainEngineEvents");
+    EngineEvent event;
+    while (engine->takeEvent(event)) {
+        if (event.type == EngineEvent::BOARD) {
+            showBoard(event);
+        } else {
+            updateGameGrid(event);
+        }
+    }
+}
 
-    ui->gameGrid->addWidget(button, row, col);
+/**
+ * @brief Zeigt ein neu erzeugtes oder geladenes Spielfeld an.
+ * @param event BOARD-Ereignis der Engine.
+ *
+ * Erst hier beginnen Aufzeichnung und Spielzeit, also genau dann, wenn das Spielfeld klickbar ist.
+ */
+void MainWindow::showBoard(const EngineEvent &event) {
+    TRACE_SPAN("ui.showBoard");
+    firstGame = false;
+    board = event.setup;
+    boardView->setPlane(event.plane);
+    boardView->clearHighlight();
+    hintService.showBoard(event.setup, event.plane);
+    hintWanted = false;
+    markedCells = event.markedCells;
+    inGame = event.inGame;
+    ui->minesLCDNumber->display(board.minesNumber);
+    updateFlagsLCD();
+    resizeMainWindow();
 
-    ///< Verbindet die Klicksignale des Buttons mit den entsprechenden Slots.
-    connect(button, &QMinerPushButton::leftClicked, this, [this, button]() {
-        LMC_on_gameCell(button->get_row(), button->get_col());
-    });
-    connect(button, &QMinerPushButton::middleClicked, this, [this, button]() {
-        MMC_on_gameCell(button->get_row(), button->get_col());
-    });
-    connect(button, &QMinerPushButton::rightClicked, this, [this, button]() {
-        RMC_on_gameCell(button->get_row(), button->get_col());
-    });
+    if (event.loaded) {
+        clock.setElapsedTime(event.elapsedTime);
+        clockPaused = false;
+        clock.start();
+        updateLCD();
+        startDisplayTimer();
+        isRunning = true;
+        return;
+    }
+    pendingBoards--;
+    if (replaying) {
+        resetTime();
+        scheduleReplayStep();
+    } else {
+        startRecording(); ///< vor der Spielzeit, damit beide Uhren gleichzeitig beginnen
+        restartTime();
+    }
 }
 
 /**
- * @brief Erstellt das Spielfeld GridLayout.
- * Generiert die Zellen und platziert Minen sowie Zählwerte für benachbarte Minen.
+ * @brief Aktualisiert das Spielfeld GridLayout.
+ * @param event MOVE-Ereignis der Engine.
+ *
+ * Zeigt den neuen Stand der Zellen und die Zähler an. Endet das Spiel mit diesem Zug,
+ * wird die Spielzeit des Zugs angezeigt und aufgezeichnet; nimmt ein Rückgängig ein beendetes
+ * Spiel wieder auf, läuft die Spielzeit weiter.
  */
-void MainWindow::create_grid() {
-    game->createMatrix(game->getLength(), game->getWidth());
-    for (int i = 0; i < game->getLength(); i++) {
-        for (int j = 0; j < game->getWidth(); j++) {
-            addButtonToGrid(i, j);
+void MainWindow::updateGameGrid(const EngineEvent &event) {
+    TRACE_SPAN("ui.updateGameGrid");
+    qCDebug(lcUi) << "Aktualisiere Spielfeld";
+    boardView->showMove(event.plane, event.cells); ///< gezeichnet wird im Render-Thread
+    frameMonitor.inputApplied(!event.cells.isEmpty());
+    hintService.showMove(event.plane, event.cells); ///< der nächste Tipp wird gleich im Hintergrund berechnet
+    markedCells = event.markedCells;
+    updateFlagsLCD();
+
+    const bool wasInGame = inGame;
+    inGame = event.inGame;
+    ///< Ereignisse des alten Spiels vor einem angeforderten neuen Spielfeld betreffen weder Zeit noch Aufzeichnung
+    if (pendingBoards > 0) {
+        return;
+    }
+    if (!inGame) {
+        if (wasInGame) { ///< das Spiel wurde gerade beendet
+            clock.stop();
+            clock.setElapsedTime(event.elapsedTime); ///< Zeit des letzten Klicks, nicht der Anzeige
+            recorder.recordResult(event.won, event.elapsedTime);
         }
+        timer->stop();
+        updateLCD(); ///< die genaue Endzeit anzeigen
+        recorder.flush(); ///< am Spielende liegt die ganze Aufzeichnung in der Datei
+    } else if (!wasInGame && !clockPaused && !replaying) { ///< Rückgängig nach dem Spielende
+        clock.start();
+        startDisplayTimer();
     }
-    ui->gameGrid->setSpacing(0);
-    game->place_mines();
-    game->count_mines_around();
 }
 
 /**
- * @brief Löscht das Spielfeld GridLayout.
- * Entfernt alle Buttons aus dem Spielfeld GridLayout.
+ * @brief Schickt einen Befehl mit der aktuellen Spielzeit an die Engine.
+ * @param type Art des Befehls.
+ * @param row Zeilenindex der Zelle (bei Zellbefehlen).
+ * @param col Spaltenindex der Zelle (bei Zellbefehlen).
+ * @return False, wenn die Engine den Befehl nicht annehmen konnte.
  */
-void MainWindow::clear_grid() {
-    if (!firstGame) {
-        for (int i = 0; i < game->getLength(); i++) {
-            for (int j = 0; j < game->getWidth(); j++) {
-                QLayoutItem *item = ui->gameGrid->itemAtPosition(i, j);
-                QMinerPushButton *button = qobject_cast<QMinerPushButton *>(item->widget());
-                ui->gameGrid->removeWidget(button);
-                delete button;
-            }
-        }
+bool MainWindow::postCommand(EngineCommand::Type type, int row, int col) {
+    EngineCommand command;
+    command.type = type;
+    command.row = row;
+    command.col = col;
+    command.elapsedTime = clock.getElapsedTime();
+    return engine->post(command);
+}
+
+/**
+ * @brief Fordert ein neues Spielfeld an.
+ * @param gameSetup Einstellungen des Spielfelds.
+ *
+ * Bis das Spielfeld angezeigt wird, nimmt das alte Spielfeld keine Klicks mehr an; sie würden
+ * sonst auf dem neuen Spielfeld ausgeführt.
+ */
+void MainWindow::newGame(const GameSetup &gameSetup) {
+    EngineCommand command;
+    command.type = EngineCommand::NEW_GAME;
+    command.setup = gameSetup;
+    if (engine->post(command)) {
+        pendingBoards++;
+    }
+}
+
+/**
+ * @brief Fordert ein neues Spielfeld mit den aktuellen Einstellungen und einem zufälligen Seed an.
+ */
+void MainWindow::newGame() {
+    GameSetup gameSetup = setup;
+    gameSetup.seed = QRandomGenerator::global()->generate64();
+    newGame(gameSetup);
+}
+
+/**
+ * @brief Speichert das laufende Spiel im Hintergrund.
+ *
+ * Packen und Schreiben übernimmt der Engine-Thread; ein beendetes Spiel löscht den Spielstand.
+ */
+void MainWindow::saveGameInBackground() {
+    if (firstGame) {
+        QFile::remove(SAVEGAME_PATH); ///< ohne Spielfeld gibt es nichts fortzusetzen
+        return;
+    }
+    EngineCommand command;
+    command.type = EngineCommand::SAVE_SNAPSHOT;
+    command.elapsedTime = clock.getElapsedTime();
+    command.filePath = SAVEGAME_PATH;
+    engine->post(command);
+}
+
+/**
+ * @brief Setzt ein beim letzten Beenden gespeichertes Spiel fort.
+ *
+ * Die Engine lädt den Spielstand und schickt ihn als Spielfeld zurück (siehe showBoard()). Ist
+ * kein Spielstand vorhanden oder ist er beschädigt, bleibt alles wie beim normalen Start.
+ */
+void MainWindow::resumeSavedGame() {
+    EngineCommand command;
+    command.type = EngineCommand::LOAD_SNAPSHOT;
+    command.filePath = SAVEGAME_PATH;
+    engine->post(command);
+}
+
+/**
+ * @brief Speichert ein laufendes Spiel beim Schließen des Fensters.
+ * @param event Schließereignis.
+ */
+void MainWindow::closeEvent(QCloseEvent *event) {
+    recorder.finish();
+    frameMonitor.writeToFile(LATENCY_PATH);
+    saveGameInBackground();
+    engine->stop(); ///< die Anwendung darf erst nach dem Schreiben enden
+    QMainWindow::closeEvent(event);
+}
+
+/**
+ * @brief Misst die Dauer jedes Bildes.
+ * @param event Ereignis des Fensters.
+ * @return Ergebnis der Basisklasse.
+ *
+ * Bei einem UpdateRequest zeichnet Qt alle geänderten Widgets des Fensters; die Zeit dafür ist
+ * die Bildzeit. Die Latenz eines Klicks schließt BoardView::movePainted() ab.
+ */
+bool MainWindow::event(QEvent *event) {
+    if (event->type() != QEvent::UpdateRequest) {
+        return QMainWindow::event(event);
+    }
+    frameMonitor.beginFrame();
+    const bool result = QMainWindow::event(event);
+    frameMonitor.endFrame();
+    return result;
+}
+
+/**
+ * @brief Slot: Blendet die Leistungsanzeige ein oder aus.
+ * @param visible True zum Einblenden.
+ */
+void MainWindow::on_hudAction_toggled(bool visible) {
+    hudLabel->setVisible(visible);
+    if (visible) {
+        updateHud();
+        hudTimer->start(HUD_INTERVAL); ///< nicht bei jedem Bild, sonst erzeugt die Anzeige selbst Bilder
     } else {
-        firstGame = false;
+        hudTimer->stop();
     }
 }
 
 /**
- * @brief Aktualisiert das Spielfeld GridLayout.
- * Passt die Icons der Zellen basierend auf ihrem aktuellen Status an.
- */
-void MainWindow::updateGameGrid() {
-    qDebug() << "Aktualisiere Spielfeld";
-    ///< für jeden Button der veränderten Zellen setzt das entsprechende Icon.
-    for (const QPoint &coord : *game->getChangedCells()) {
-        QLayoutItem *item = ui->gameGrid->itemAtPosition(coord.x(), coord.y());
-        QMinerPushButton *button = qobject_cast<QMinerPushButton *>(item->widget());
-        int status = game->getCellStatus(coord.x(), coord.y());
-
-        if (status == 1) {
-            button->setIcon(QIcon(iconpathByNumber.value(game->getCellMinesNumber(coord.x(), coord.y()))));
-        } else {
-            button->setIcon(QIcon(iconpathByStatus.value(status)));
-        }
-        ///< Icon anpassen und anzeigen
-        button->setIconSize(QSize(BUTTONSIZE, BUTTONSIZE));
-        button->update();
+ * @brief Aktualisiert den Text der Leistungsanzeige.
+ */
+void MainWindow::updateHud() {
+    hudLabel->setText(frameMonitor.hudText());
+    hudLabel->adjustSize();
+    hudLabel->raise();
+}
+
+/**
+ * @brief Beginnt die Aufzeichnung des gerade erzeugten Spiels.
+ *
+ * Eine laufende Wiedergabe wird dabei beendet.
+ */
+void MainWindow::startRecording() {
+    QDir().mkpath(REPLAY_DIR);
+    QString fileName = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz") + ".u3r";
+    const quint16 flags = board.safeOpening ? ReplayFormat::FLAG_SAFE_OPENING : 0;
+    recorder.start(board.length, board.width, board.minesNumber, board.seed, flags,
+                   QDir(REPLAY_DIR).filePath(fileName));
+}
+
+/**
+ * @brief Slot: Spielt eine Aufzeichnung schrittweise auf dem Spielfeld ab.
+ * Die Pausen zwischen den Aktionen entsprechen der Aufzeichnung, höchstens aber MAX_REPLAY_DELAY.
+ */
+void MainWindow::on_replayAction_clicked() {
+    QString filePath = QFileDialog::getOpenFileName(this, "Aufzeichnung abspielen", REPLAY_DIR,
+                                                    "Aufzeichnungen (*.u3r)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+    if (!player.load(filePath)) {
+        QMessageBox::warning(this, "Aufzeichnung", "Die Aufzeichnung ist beschädigt oder hat ein unbekanntes Format.");
+        return;
+    }
+    recorder.finish();
+    replayTimer->stop();
+    replaying = true;
+    GameSetup gameSetup;
+    gameSetup.length = player.getLength();
+    gameSetup.width = player.getWidth();
+    gameSetup.minesNumber = player.getMinesNumber();
+    gameSetup.seed = player.getSeed();
+    gameSetup.safeOpening = player.is_safeOpening();
+    gameSetup.statisticsEnabled = false;
+    newGame(gameSetup); ///< die erste Aktion plant showBoard()
+}
+
+#ifdef U3_TRACING
+/**
+ * @brief Slot: Schreibt die bisher gesammelten Spans als Chrome-Trace-JSON.
+ */
+void MainWindow::on_traceAction_clicked() {
+    QString filePath = QFileDialog::getSaveFileName(this, "Trace speichern", "u3-trace.json", "Chrome-Trace (*.json)");
+    if (!filePath.isEmpty() && !Tracing::writeChromeTrace(filePath)) {
+        QMessageBox::warning(this, "Trace", "Der Trace konnte nicht geschrieben werden.");
     }
-    game->getChangedCells()->clear();
+}
+#endif
 
-    if (!game->is_inGame()) {
-        timer->stop();
+/**
+ * @brief Liest die nächste Aktion der Wiedergabe und startet den Timer bis zu ihrer Ausführung.
+ */
+void MainWindow::scheduleReplayStep() {
+    if (!player.next(replayRecord)) {
+        replaying = false; ///< Ende der Aufzeichnung
+        return;
+    }
+    replayTimer->start(int(std::min(replayRecord.timeDelta, MAX_REPLAY_DELAY)));
+}
+
+/**
+ * @brief Slot: Führt die nächste Aktion der Wiedergabe aus.
+ */
+void MainWindow::stepReplay() {
+    switch (replayRecord.action) {
+    case ReplayFormat::OPEN:
+        postCommand(EngineCommand::OPEN, replayRecord.row, replayRecord.col);
+        break;
+    case ReplayFormat::UNMARK:
+        postCommand(EngineCommand::UNMARK, replayRecord.row, replayRecord.col);
+        break;
+    case ReplayFormat::MARK:
+        postCommand(EngineCommand::MARK, replayRecord.row, replayRecord.col);
+        break;
+    case ReplayFormat::UNDO:
+        postCommand(EngineCommand::UNDO);
+        break;
+    case ReplayFormat::REDO:
+        postCommand(EngineCommand::REDO);
+        break;
+    case ReplayFormat::RESIGN:
+        postCommand(EngineCommand::RESIGN);
+        break;
+    case ReplayFormat::PAUSE:
+    case ReplayFormat::RESULT:
+        break; ///< betrifft nur die Spielzeit bzw. die Prüfung
     }
+    scheduleReplayStep();
 }
 
 /**
  * @brief Aktualisiert die Zeit-Anzeige (LCD).
  */
 void MainWindow::updateLCD() {
-    int hours = game->getElapsedSeconds() / 3600;
-    int minutes = (game->getElapsedSeconds() % 3600) / 60;
-    int seconds = game->getElapsedSeconds() % 60;
+    const qint64 elapsedSeconds = clock.getElapsedTime() / 1000;
+    int hours = int(elapsedSeconds / 3600);
+    int minutes = int(elapsedSeconds % 3600) / 60;
+    int seconds = int(elapsedSeconds % 60);
 
     QString timeText = QString("%1:%2:%3") ///< QString Text, das angezeigt wird.
                            .arg(hours, 2, 10, QChar('0'))
@@ -343,12 +732,50 @@ void MainWindow::updateLCD() {
 }
 
 /**
- * @brief Aktualisiert die verstrichene Spielzeit.
- * Wird jede Sekunde vom Timer aufgerufen.
+ * @brief Aktualisiert die Zeit-Anzeige beim Wechsel der Sekunde.
+ * Die Spielzeit selbst misst clock, der Timer sorgt nur für das Neuzeichnen.
  */
 void MainWindow::updateTime() {
-    game->setElapsedSeconds(game->getElapsedSeconds() + 1);
     updateLCD();
+    startDisplayTimer();
+}
+
+/**
+ * @brief Startet den Anzeige-Timer so, dass er beim nächsten Sekundenwechsel der Spielzeit auslöst.
+ */
+void MainWindow::startDisplayTimer() {
+    timer->start(int(1000 - clock.getElapsedTime() % 1000));
+}
+
+/**
+ * @brief Hält Spielzeit und Anzeige an und zeichnet die Pause auf.
+ *
+ * Pause und Fortsetzen werden immer paarweise aufgezeichnet, auch bei beendetem Spiel; der
+ * ReplayVerifier bildet den Timer nach denselben Regeln nach.
+ */
+void MainWindow::pauseClock() {
+    if (clockPaused) {
+        return;
+    }
+    clockPaused = true;
+    timer->stop();
+    clock.stop();
+    recorder.record(ReplayFormat::PAUSE);
+}
+
+/**
+ * @brief Setzt eine Pause fort und zeichnet das Fortsetzen auf; die Spielzeit läuft nur bei laufendem Spiel weiter.
+ */
+void MainWindow::resumeClock() {
+    if (!clockPaused) {
+        return;
+    }
+    clockPaused = false;
+    recorder.record(ReplayFormat::PAUSE);
+    if (inGame && !replaying && pendingBoards == 0) {
+        clock.start();
+        startDisplayTimer();
+    }
 }
 
 /**
@@ -356,7 +783,9 @@ void MainWindow::updateTime() {
  */
 void MainWindow::resetTime() {
     timer->stop();
-    game->setElapsedSeconds(0);
+    clock.stop();
+    clock.setElapsedTime(0);
+    clockPaused = false;
     updateLCD();
     isRunning = false;
 }
@@ -365,8 +794,10 @@ void MainWindow::resetTime() {
  * @brief Startet den Timer neu.
  */
 void MainWindow::restartTime() {
-    timer->start(1000);
-    game->setElapsedSeconds(0);
+    clock.setElapsedTime(0);
+    clock.start();
+    clockPaused = false;
+    startDisplayTimer();
     updateLCD();
     isRunning = true;
 }
@@ -375,12 +806,25 @@ void MainWindow::restartTime() {
  * @brief Passt die Fenstergröße basierend auf der Spielfeldgröße an.
  */
 void MainWindow::resizeMainWindow() {
-    if (BUTTONSIZE * game->getWidth() < ui->gameGridWidget->width()) {
+    ///< höchstens so groß wie der Bildschirm, der Rest des Spielfelds wird gescrollt
+    const QRect screen = this->screen()->availableGeometry();
+    const int scrollBar = style()->pixelMetric(QStyle::PM_ScrollBarExtent);
+    int viewWidth = qMin(BUTTONSIZE * board.width, screen.width() - 20 - scrollBar);
+    int viewHeight = qMin(BUTTONSIZE * board.length, screen.height() - 115 - scrollBar);
+    if (viewWidth < BUTTONSIZE * board.width) {
+        viewHeight += scrollBar;
+    }
+    if (viewHeight < BUTTONSIZE * board.length) {
+        viewWidth += scrollBar;
+    }
+    boardScrollArea->setFixedSize(viewWidth, viewHeight);
+
+    if (viewWidth < ui->gameGridWidget->width()) {
         ui->gameGrid->setContentsMargins(120, 10, 120, 10);
-        setFixedSize(BUTTONSIZE * game->getWidth() + 270, BUTTONSIZE * game->getLength() + 115);
+        setFixedSize(viewWidth + 270, viewHeight + 115);
     } else {
         ui->gameGrid->setContentsMargins(0, 10, 0, 10);
-        setFixedSize(BUTTONSIZE * game->getWidth() + 20, BUTTONSIZE * game->getLength() + 115);
+        setFixedSize(viewWidth + 20, viewHeight + 115);
     }
 }
 
@@ -388,24 +832,12 @@ void MainWindow::resizeMainWindow() {
  * @brief Blendet das Spielfeld aus.
  */
 void MainWindow::hideGameGrid() {
-    for (int row = 0; row < game->getLength(); row++) {
-        for (int col = 0; col < game->getWidth(); col++) {
-            QLayoutItem *item = ui->gameGrid->itemAtPosition(row, col);
-            QMinerPushButton *button = qobject_cast<QMinerPushButton *>(item->widget());
-            button->hide();
-        }
-    }
+    boardView->hide();
 }
 
 /**
  * @brief Blendet das Spielfeld ein.
  */
 void MainWindow::showGameGrid() {
-    for (int row = 0; row < game->getLength(); row++) {
-        for (int col = 0; col < game->getWidth(); col++) {
-            QLayoutItem *item = ui->gameGrid->itemAtPosition(row, col);
-            QMinerPushButton *button = qobject_cast<QMinerPushButton *>(item->widget());
-            button->show();
-        }
-    }
+    boardView->show();
 }
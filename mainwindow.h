@@ -4,6 +4,17 @@
 #include <QMainWindow>
 #include <QVector>
 #include "game.h"
+#include "gameclock.h"
+#include "gameengine.h"
+#include "replayrecorder.h"
+#include "replayplayer.h"
+#include "framemonitor.h"
+#include "hintservice.h"
+#include "difficultyestimator.h"
+#include <QLabel>
+
+class BoardView;
+class QScrollArea;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -19,6 +30,10 @@ QT_END_NAMESPACE
  * Die MainWindow-Klasse verwaltet grafische Oberfläche und die visuelle Logik des Spiels,
  * einschließlich der Spielfläche, der Timersteuerung, der Benutzerinteraktionen und der Menüaktionen.
  *
+ * Die Spiellogik läuft in einem eigenen Thread (siehe GameEngine). Klicks werden als Befehle
+ * verschickt, das Spielfeld wird aus den zurückkommenden Ereignissen aktualisiert; das Fenster
+ * wartet dabei nie auf die Engine. Die Spielzeit misst das Fenster selbst.
+ *
  * @author Daniel Schukin
  */
 class MainWindow : public QMainWindow
@@ -29,7 +44,7 @@ public:
     /**
      * @brief Konstruktor für das Hauptfenster.
      * @param parent Pointer auf das übergeordnete Widget.
-     * @param game Pointer auf das Game-Objekt.
+     * @param game Pointer auf das Game-Objekt; gehört ab hier dem Engine-Thread.
      *
      * @author Daniel Schukin
      */
@@ -43,55 +58,134 @@ public:
     ~MainWindow();
 
     /**
-     * @brief Erstellt ein neues Spielfeld (Grid).
+     * @brief Aktualisiert den Zustand des Spielfelds nach einem Zug.
+     * @param event MOVE-Ereignis der Engine.
      *
      * @author Daniel Schukin
      */
-    void create_grid();
+    void updateGameGrid(const EngineEvent &event);
 
     /**
-     * @brief Löscht das aktuelle Spielfeld.
+     * @brief Zeigt ein neu erzeugtes oder geladenes Spielfeld an.
+     * @param event BOARD-Ereignis der Engine.
      *
      * @author Daniel Schukin
      */
-    void clear_grid();
+    void showBoard(const EngineEvent &event);
 
     /**
-     * @brief Fügt einen Button zur Spielfläche hinzu.
-     * @param row Zeilenindex des Buttons.
-     * @param col Spaltenindex des Buttons.
+     * @brief Versteckt das Spielfeld.
      *
      * @author Daniel Schukin
      */
-    void addButtonToGrid(int row, int col);
+    void hideGameGrid();
 
     /**
-     * @brief Aktualisiert den Zustand des Spielfelds.
+     * @brief Zeigt das Spielfeld.
      *
      * @author Daniel Schukin
      */
-    void updateGameGrid();
+    void showGameGrid();
 
     /**
-     * @brief Versteckt das Spielfeld.
+     * @brief Passt die Größe des Hauptfensters basierend auf dem Spielfeld an.
      *
      * @author Daniel Schukin
      */
-    void hideGameGrid();
+    void resizeMainWindow();
 
     /**
-     * @brief Zeigt das Spielfeld.
+     * @brief Schickt einen Befehl mit der aktuellen Spielzeit an die Engine.
+     * @param type Art des Befehls.
+     * @param row Zeilenindex der Zelle (bei Zellbefehlen).
+     * @param col Spaltenindex der Zelle (bei Zellbefehlen).
+     * @return False, wenn die Engine den Befehl nicht annehmen konnte.
      *
      * @author Daniel Schukin
      */
-    void showGameGrid();
+    bool postCommand(EngineCommand::Type type, int row = 0, int col = 0);
 
     /**
-     * @brief Passt die Größe des Hauptfensters basierend auf dem Spielfeld an.
+     * @brief Fordert ein neues Spielfeld an.
+     * @param gameSetup Einstellungen des Spielfelds.
      *
      * @author Daniel Schukin
      */
-    void resizeMainWindow();
+    void newGame(const GameSetup &gameSetup);
+
+    /**
+     * @brief Fordert ein neues Spielfeld mit den aktuellen Einstellungen und einem zufälligen Seed an.
+     *
+     * @author Daniel Schukin
+     */
+    void newGame();
+
+    /**
+     * @brief Speichert das laufende Spiel im Hintergrund, z.B. beim Pausieren.
+     *
+     * @author Daniel Schukin
+     */
+    void saveGameInBackground();
+
+    /**
+     * @brief Setzt ein beim letzten Beenden gespeichertes Spiel fort.
+     *
+     * @author Daniel Schukin
+     */
+    void resumeSavedGame();
+
+    /**
+     * @brief Beginnt die Aufzeichnung des gerade erzeugten Spiels.
+     *
+     * @author Daniel Schukin
+     */
+    void startRecording();
+
+    /**
+     * @brief Liest die nächste Aktion der Wiedergabe und plant ihre Ausführung.
+     *
+     * @author Daniel Schukin
+     */
+    void scheduleReplayStep();
+
+    /**
+     * @brief Startet den Anzeige-Timer bis zum nächsten Sekundenwechsel der Spielzeit.
+     *
+     * @author Daniel Schukin
+     */
+    void startDisplayTimer();
+
+    /**
+     * @brief Hält Spielzeit und Anzeige an, falls sie nicht schon pausiert sind.
+     *
+     * @author Daniel Schukin
+     */
+    void pauseClock();
+
+    /**
+     * @brief Beendet die Pause; Spielzeit und Anzeige laufen nur bei laufendem Spiel weiter.
+     *
+     * @author Daniel Schukin
+     */
+    void resumeClock();
+
+protected:
+    /**
+     * @brief Speichert ein laufendes Spiel, bevor das Fenster geschlossen wird.
+     * @param event Schließereignis.
+     *
+     * @author Daniel Schukin
+     */
+    void closeEvent(QCloseEvent *event) override;
+
+    /**
+     * @brief Misst beim Zeichnen des Fensters die Bildzeit und die Latenz seit dem letzten Klick.
+     * @param event Ereignis des Fensters.
+     * @return Ergebnis der Basisklasse.
+     *
+     * @author Daniel Schukin
+     */
+    bool event(QEvent *event) override;
 
 private slots:
     /// @name Slots für Spielaktionen
@@ -108,6 +202,14 @@ private slots:
     void on_settingsAction_clicked(); ///< Öffnet die Einstellungen.
     void on_statsAction_clicked(); ///< Zeigt die Spielstatistiken.
     void on_helpAction_clicked(); ///< Zeigt die Hilfsinformationen.
+    void on_undoAction_clicked(); ///< Macht den letzten Zug rückgängig.
+    void on_redoAction_clicked(); ///< Wiederholt den zuletzt rückgängig gemachten Zug.
+    void on_replayAction_clicked(); ///< Spielt eine Aufzeichnung ab.
+    void on_hudAction_toggled(bool visible); ///< Blendet die Leistungsanzeige ein oder aus.
+    void on_hintAction_clicked(); ///< Hebt eine sichere oder möglichst ungefährliche Zelle hervor.
+#ifdef U3_TRACING
+    void on_traceAction_clicked(); ///< Schreibt die gesammelten Spans als Chrome-Trace.
+#endif
     /// @}
 
     /// @name Slots für Interaktionen mit Spielfeldzellen
@@ -121,43 +223,42 @@ private slots:
     /// @name Slots für Timer-Steuerung
     /// @author Daniel Schukin
     /// @{
-    void updateTime(); ///< Aktualisiert die Zeit auf der Anzeige.
+    void updateTime(); ///< Aktualisiert die Zeit auf der Anzeige beim Sekundenwechsel.
     void resetTime(); ///< Setzt die Spielzeit zurück.
     void restartTime(); ///< Startet die Spielzeit neu.
+    void stepReplay(); ///< Führt die nächste Aktion der Wiedergabe aus.
+    void drainEngineEvents(); ///< Holt die Ereignisse der Engine ab und zeigt sie an.
+    void updateHud(); ///< Aktualisiert den Text der Leistungsanzeige.
+    void showHint(); ///< Zeigt einen angeforderten Tipp an, sobald er zum neuesten Stand vorliegt.
     /// @}
 
 private:
     Ui::MainWindow *ui; ///< Pointer auf die UI-Komponenten.
-    Game *game; ///< Pointer auf das Game-Objekt.
-
-    /// @brief Zuordnung von Spielstatus zu Icon-Pfaden.
-    QMap<int, QString> iconpathByStatus{
-        {0, ":/resources/icons/covered_cell.png"},
-        {4, ":/resources/icons/covered_cell.png"},
-        {2, ":/resources/icons/flag.png"},
-        {6, ":/resources/icons/flag.png"},
-        {3, ":/resources/icons/wrong_mark.png"},
-        {5, ":/resources/icons/mine.png"},
-        {7, ":/resources/icons/right_mark.png"},
-        {13, ":/resources/icons/exploded_mine.png"}
-    };
-
-    /// @brief Zuordnung von Zahlen zu Icon-Pfaden.
-    QMap<int, QString> iconpathByNumber{
-        {0, ":/resources/icons/opened_cell.png"},
-        {1, ":/resources/icons/number_1.png"},
-        {2, ":/resources/icons/number_2.png"},
-        {3, ":/resources/icons/number_3.png"},
-        {4, ":/resources/icons/number_4.png"},
-        {5, ":/resources/icons/number_5.png"},
-        {6, ":/resources/icons/number_6.png"},
-        {7, ":/resources/icons/number_7.png"},
-        {8, ":/resources/icons/number_8.png"}
-    };
+    GameEngine *engine; ///< Führt die Spiellogik im eigenen Thread aus.
+    BoardView *boardView; ///< Zeigt das Spielfeld; zeichnet im eigenen Thread.
+    QScrollArea *boardScrollArea; ///< Scrollt Spielfelder, die größer als der Bildschirm sind.
+    GameSetup setup; ///< Einstellungen für das nächste neue Spiel.
+    GameSetup board; ///< Einstellungen des angezeigten Spielfelds.
+    int markedCells = 0; ///< Anzahl der markierten Zellen laut letztem Ereignis.
+    bool inGame = false; ///< True, wenn das angezeigte Spiel laut letztem Ereignis noch läuft.
+    int pendingBoards = 0; ///< Angeforderte, noch nicht angezeigte neue Spielfelder.
+    GameClock clock; ///< Spielzeit des angezeigten Spiels.
+    bool clockPaused = false; ///< True zwischen pauseClock() und resumeClock().
 
     QTimer *timer; ///< Timer zur Zeitsteuerung.
     bool isRunning = false; ///< Gibt an, ob der Timer läuft.
     bool firstGame = true; ///< Gibt an, ob es das erste Spiel ist.
+    ReplayRecorder recorder; ///< Zeichnet das laufende Spiel auf.
+    ReplayPlayer player; ///< Aufzeichnung, die gerade abgespielt wird.
+    ReplayPlayer::Record replayRecord; ///< Nächste auszuführende Aktion der Wiedergabe.
+    QTimer *replayTimer; ///< Timer bis zur nächsten Aktion der Wiedergabe.
+    bool replaying = false; ///< True, solange eine Aufzeichnung abgespielt wird.
+    FrameMonitor frameMonitor; ///< Latenz vom Klick bis zum Bild und Bildzeiten.
+    QLabel *hudLabel; ///< Leistungsanzeige mit Latenz und FPS.
+    QTimer *hudTimer; ///< Timer für die Aktualisierung der Leistungsanzeige.
+    HintService hintService; ///< Berechnet nach jedem Zug im Hintergrund den nächsten Tipp.
+    DifficultyEstimator estimator; ///< Schätzt für den Einstellungsdialog; der Zwischenspeicher überdauert den Dialog.
+    bool hintWanted = false; ///< True, wenn ein Tipp angefordert, aber noch nicht angezeigt wurde.
     int BUTTONSIZE = 25; ///< Größe der Spielfeldzellen (in Pixeln).
 
     /**
@@ -166,6 +267,13 @@ private:
      * @author Daniel Schukin
      */
     void updateLCD();
+
+    /**
+     * @brief Aktualisiert die Anzeige der markierten Zellen und färbt sie rot, wenn es mehr Markierungen als Minen gibt.
+     *
+     * @author Daniel Schukin
+     */
+    void updateFlagsLCD();
 };
 
 #endif // MAINWINDOW_H
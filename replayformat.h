@@ -0,0 +1,117 @@
+#ifndef REPLAYFORMAT_H
+#define REPLAYFORMAT_H
+
+#include <QtGlobal>
+
+/**
+ * @file replayformat.h
+ * @brief Gemeinsame Definitionen des Aufzeichnungsformats für Spiele.
+ *
+ * Aufbau einer Aufzeichnung (alle Zahlen im Kopf Little-Endian):
+ * | Versatz | Größe | Inhalt                                      |
+ * |---------|-------|---------------------------------------------|
+ * | 0       | 4     | Kennung "U3RP"                              |
+ * | 4       | 2     | Formatversion (VERSION)                     |
+ * | 6       | 2     | Flags (FLAG_*)                              |
+ * | 8       | 4     | Anzahl der Zeilen                           |
+ * | 12      | 4     | Anzahl der Spalten                          |
+ * | 16      | 4     | Anzahl der Minen                            |
+ * | 20      | 8     | Seed des Spielfelds                         |
+ * | 28      | ...   | Aktionen bis zum Dateiende                  |
+ *
+ * Jede Aktion besteht aus einem Varint (Zeit seit der letzten Aktion in ms << 3 | Action),
+ * bei Zellaktionen gefolgt von einem Varint mit dem Zellindex row * Breite + col, bei RESULT
+ * gefolgt von einem Varint (angezeigte Spielzeit in ms << 1 | gewonnen).
+ * Varints speichern 7 Bit pro Byte, das oberste Bit markiert ein folgendes Byte.
+ *
+ * Technische Entscheidung:
+ * Zusammen mit dem Seed legt die Folge der Aktionen das ganze Spiel fest, es wird also kein
+ * Spielfeld gespeichert. Eine typische Aktion belegt 2-4 Bytes. Da es keine Längenangabe gibt,
+ * kann die Datei während des Spiels fortlaufend erweitert werden; eine beim Absturz
+ * abgeschnittene letzte Aktion wird beim Lesen verworfen.
+ *
+ * @author Daniel Schukin
+ */
+namespace ReplayFormat {
+
+constexpr char MAGIC[4] = {'U', '3', 'R', 'P'}; ///< Kennung am Dateianfang.
+constexpr quint16 VERSION = 2; ///< Aktuelle Formatversion (1: Spielzeit bei RESULT in ganzen Sekunden).
+constexpr int HEADER_SIZE = 28; ///< Größe des Kopfs in Bytes.
+
+constexpr quint16 FLAG_SAFE_OPENING = 0x0001; ///< Erster Klick mit freier 3x3-Umgebung.
+///< 0x0002 ist reserviert und wird beim Lesen ignoriert.
+
+/// @brief Art einer aufgezeichneten Aktion.
+enum Action : quint8 {
+    OPEN = 0,   ///< Linksklick: Zelle öffnen.
+    UNMARK = 1, ///< Mittelklick: Markierung entfernen.
+    MARK = 2,   ///< Rechtsklick: Markierung umschalten.
+    UNDO = 3,   ///< Letzten Zug rückgängig machen (ohne Zellindex).
+    REDO = 4,   ///< Rückgängig gemachten Zug wiederholen (ohne Zellindex).
+    PAUSE = 5,  ///< Spielzeit anhalten bzw. fortsetzen (ohne Zellindex).
+    RESIGN = 6, ///< Spiel über "Beenden" aufgeben (ohne Zellindex).
+    RESULT = 7  ///< Angezeigtes Ergebnis am Spielende, wird beim Prüfen nachgerechnet.
+};
+
+constexpr int ACTION_BITS = 3; ///< Anzahl der Bits für die Action im ersten Varint.
+
+/**
+ * @brief Prüft, ob zu einer Aktion ein Zellindex gehört.
+ * @param action Art der Aktion.
+ * @return True für Zellaktionen.
+ *
+ * @author Daniel Schukin
+ */
+constexpr bool hasCell(Action action) { return action <= MARK; }
+
+/**
+ * @brief Prüft, ob auf eine Aktion ein zweiter Varint folgt.
+ * @param action Art der Aktion.
+ * @return True für Zellaktionen und RESULT.
+ *
+ * @author Daniel Schukin
+ */
+constexpr bool hasArgument(Action action) { return hasCell(action) || action == RESULT; }
+
+/**
+ * @brief Schreibt einen Varint.
+ * @param out Zielpuffer mit Platz für mindestens 10 Bytes.
+ * @param value Zu schreibender Wert.
+ * @return Anzahl der geschriebenen Bytes.
+ *
+ * @author Daniel Schukin
+ */
+inline int putVarint(uchar *out, quint64 value) {
+    int n = 0;
+    while (value >= 0x80) {
+        out[n++] = uchar(value) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = uchar(value);
+    return n;
+}
+
+/**
+ * @brief Liest einen Varint.
+ * @param pos Leseposition, wird hinter den Varint verschoben.
+ * @param end Ende des Puffers.
+ * @param value Gelesener Wert.
+ * @return False, wenn der Puffer vor dem Ende des Varints aufhört oder er zu lang ist.
+ *
+ * @author Daniel Schukin
+ */
+inline bool getVarint(const uchar *&pos, const uchar *end, quint64 &value) {
+    value = 0;
+    for (int shift = 0; pos < end && shift < 64; shift += 7) {
+        const uchar byte = *pos++;
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+#endif // REPLAYFORMAT_H
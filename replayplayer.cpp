@@ -0,0 +1,143 @@
+#include "replayplayer.h"
+#include "game.h"
+#include <QFile>
+#include <QtEndian>
+#include <cstring>
+
+/**
+ * @brief Liest eine Aufzeichnung aus einer Datei.
+ * @param filePath Pfad der Datei.
+ * @return True, wenn der Kopf gültig ist.
+ */
+bool ReplayPlayer::load(const QString &filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return open(file.readAll());
+}
+
+/**
+ * @brief Übernimmt eine Aufzeichnung aus dem Speicher.
+ * @param data Inhalt der Aufzeichnung.
+ * @return True, wenn der Kopf gültig ist.
+ */
+bool ReplayPlayer::open(const QByteArray &data) {
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    if (data.size() < ReplayFormat::HEADER_SIZE
+        || std::memcmp(bytes, ReplayFormat::MAGIC, sizeof(ReplayFormat::MAGIC)) != 0
+        || qFromLittleEndian<quint16>(bytes + 4) < 1 || qFromLittleEndian<quint16>(bytes + 4) > ReplayFormat::VERSION) {
+        return false;
+    }
+    const int length = qFromLittleEndian<qint32>(bytes + 8);
+    const int width = qFromLittleEndian<qint32>(bytes + 12);
+    const int mines = qFromLittleEndian<qint32>(bytes + 16);
+    if (length <= 0 || width <= 0 || mines < 0 || qint64(mines) > qint64(length) * width) {
+        return false;
+    }
+    this->data = data;
+    this->version = qFromLittleEndian<quint16>(bytes + 4);
+    this->flags = qFromLittleEndian<quint16>(bytes + 6);
+    this->length = length;
+    this->width = width;
+    this->minesNumber = mines;
+    this->seed = qFromLittleEndian<quint64>(bytes + 20);
+    rewind();
+    return true;
+}
+
+/**
+ * @brief Erzeugt auf einem Game-Objekt das aufgezeichnete Spielfeld.
+ * @param game Zielspiel; Einstellungen und Spielfeld werden überschrieben.
+ */
+void ReplayPlayer::setupGame(Game &game) const {
+    game.setStatisticsEnabled(false);
+    game.changeLength(length);
+    game.changeWidth(width);
+    game.changeMinesNumber(minesNumber);
+    game.setSafeOpening(flags & ReplayFormat::FLAG_SAFE_OPENING);
+    game.createMatrix(length, width);
+    game.place_mines(seed);
+    game.count_mines_around();
+    game.resetMarkedCells();
+    game.setWon(false);
+    game.setElapsedTime(0);
+}
+
+/**
+ * @brief Dekodiert die nächste Aktion.
+ * @param record Gelesene Aktion.
+ * @return False am Ende der Aufzeichnung oder bei einer unvollständigen/ungültigen Aktion.
+ */
+bool ReplayPlayer::next(Record &record) {
+    const uchar *pos = reinterpret_cast<const uchar *>(data.constData()) + position;
+    const uchar *end = reinterpret_cast<const uchar *>(data.constData()) + data.size();
+    quint64 head, argument = 0;
+    if (!ReplayFormat::getVarint(pos, end, head)) {
+        return false;
+    }
+    record.action = ReplayFormat::Action(head & ((1 << ReplayFormat::ACTION_BITS) - 1));
+    record.timeDelta = qint64(head >> ReplayFormat::ACTION_BITS);
+    if (ReplayFormat::hasArgument(record.action) && !ReplayFormat::getVarint(pos, end, argument)) {
+        return false;
+    }
+    if (ReplayFormat::hasCell(record.action) && argument >= quint64(length) * width) {
+        return false;
+    }
+    const quint64 cell = ReplayFormat::hasCell(record.action) ? argument : 0;
+    record.row = int(cell / width);
+    record.col = int(cell % width);
+    record.won = record.action == ReplayFormat::RESULT && (argument & 1);
+    record.elapsedTime = record.action == ReplayFormat::RESULT ? qint64(argument >> 1) : 0;
+    position = pos - reinterpret_cast<const uchar *>(data.constData());
+    return true;
+}
+
+/**
+ * @brief Führt eine Aktion auf einem Spiel aus.
+ * @param game Spiel, auf dem die Aktion ausgeführt wird.
+ * @param record Auszuführende Aktion.
+ */
+void ReplayPlayer::apply(Game &game, const Record &record) {
+    switch (record.action) {
+    case ReplayFormat::OPEN:
+        game.open_cell(record.row, record.col);
+        break;
+    case ReplayFormat::UNMARK:
+        game.unmark_cell(record.row, record.col);
+        break;
+    case ReplayFormat::MARK:
+        game.mark_cell(record.row, record.col);
+        break;
+    case ReplayFormat::UNDO:
+        game.undo();
+        break;
+    case ReplayFormat::REDO:
+        game.redo();
+        break;
+    case ReplayFormat::RESIGN:
+        game.gameLost();
+        break;
+    case ReplayFormat::PAUSE:
+    case ReplayFormat::RESULT:
+        break; ///< betrifft nur die Spielzeit bzw. die Prüfung
+    }
+}
+
+/**
+ * @brief Spielt alle übrigen Aktionen ohne Oberfläche ab.
+ * @param game Mit setupGame() vorbereitetes Spiel.
+ * @return Anzahl der abgespielten Aktionen.
+ *
+ * Die Liste der geänderten Zellen wird nach jeder Aktion geleert, da keine Oberfläche sie abholt.
+ */
+int ReplayPlayer::playAll(Game &game) {
+    int actions = 0;
+    Record record;
+    while (next(record)) {
+        apply(game, record);
+        game.getChangedCells()->clear();
+        actions++;
+    }
+    return actions;
+}
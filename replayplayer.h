@@ -0,0 +1,132 @@
+#ifndef REPLAYPLAYER_H
+#define REPLAYPLAYER_H
+
+#include "replayformat.h"
+#include <QByteArray>
+#include <QString>
+
+class Game;
+
+/**
+ * @file replayplayer.h
+ * @class ReplayPlayer
+ * @brief Liest eine Aufzeichnung und spielt sie auf einem Game-Objekt ab.
+ *
+ * Format siehe replayformat.h. Die Aktionen können einzeln mit next() und apply() abgespielt
+ * werden (z.B. schrittweise in der Oberfläche) oder alle auf einmal mit playAll() ohne
+ * Oberfläche.
+ *
+ * Technische Entscheidung:
+ * Die Datei wird ganz in den Speicher geladen und direkt aus dem Puffer dekodiert; eine
+ * Aktion kostet nur das Lesen von ein bis zwei Varints und den eigentlichen Spielzug.
+ *
+ * Abhängigkeit: erzeugt das Spielfeld über das Game-Modul aus dem gespeicherten Seed.
+ *
+ * @author Daniel Schukin
+ */
+class ReplayPlayer
+{
+public:
+    /// @brief Eine dekodierte Aktion.
+    struct Record
+    {
+        qint64 timeDelta;             ///< Zeit seit der vorherigen Aktion in ms.
+        ReplayFormat::Action action;  ///< Art der Aktion.
+        int row;                      ///< Zeilenindex der Zelle (bei Zellaktionen).
+        int col;                      ///< Spaltenindex der Zelle (bei Zellaktionen).
+        bool won;                     ///< Angezeigtes Ergebnis (bei RESULT).
+        qint64 elapsedTime;           ///< Angezeigte Spielzeit in ms (bei RESULT).
+    };
+
+    /**
+     * @brief Liest eine Aufzeichnung aus einer Datei.
+     * @param filePath Pfad der Datei.
+     * @return True, wenn der Kopf gültig ist.
+     *
+     * @author Daniel Schukin
+     */
+    bool load(const QString &filePath);
+
+    /**
+     * @brief Übernimmt eine Aufzeichnung aus dem Speicher.
+     * @param data Inhalt der Aufzeichnung.
+     * @return True, wenn der Kopf gültig ist.
+     *
+     * @author Daniel Schukin
+     */
+    bool open(const QByteArray &data);
+
+    /**
+     * @brief Erzeugt auf einem Game-Objekt das aufgezeichnete Spielfeld.
+     * @param game Zielspiel; Einstellungen und Spielfeld werden überschrieben.
+     *
+     * Beendete Spiele gehen dabei nicht in die Statistik ein.
+     *
+     * @author Daniel Schukin
+     */
+    void setupGame(Game &game) const;
+
+    /**
+     * @brief Dekodiert die nächste Aktion.
+     * @param record Gelesene Aktion.
+     * @return False am Ende der Aufzeichnung oder bei einer unvollständigen/ungültigen Aktion.
+     *
+     * @author Daniel Schukin
+     */
+    bool next(Record &record);
+
+    /**
+     * @brief Führt eine Aktion auf einem Spiel aus.
+     * @param game Spiel, auf dem die Aktion ausgeführt wird.
+     * @param record Auszuführende Aktion.
+     *
+     * @author Daniel Schukin
+     */
+    static void apply(Game &game, const Record &record);
+
+    /**
+     * @brief Spielt alle übrigen Aktionen ohne Oberfläche ab.
+     * @param game Mit setupGame() vorbereitetes Spiel.
+     * @return Anzahl der abgespielten Aktionen.
+     *
+     * @author Daniel Schukin
+     */
+    int playAll(Game &game);
+
+    /**
+     * @brief Setzt die Leseposition auf die erste Aktion zurück.
+     *
+     * @author Daniel Schukin
+     */
+    void rewind() { position = ReplayFormat::HEADER_SIZE; }
+
+    /**
+     * @brief Gibt an, ob alle Aktionen gelesen wurden.
+     * @return True, wenn next() am Dateiende und nicht an einer ungültigen Aktion stehen blieb.
+     *
+     * @author Daniel Schukin
+     */
+    bool atEnd() const { return position == data.size(); }
+
+    /// @name Getter für den Kopf
+    /// @{
+    quint16 getVersion() const { return version; }
+    int getLength() const { return length; }
+    int getWidth() const { return width; }
+    int getMinesNumber() const { return minesNumber; }
+    quint64 getSeed() const { return seed; }
+    bool is_safeOpening() const { return flags & ReplayFormat::FLAG_SAFE_OPENING; }
+    /// @}
+
+private:
+    QByteArray data; ///< Inhalt der Aufzeichnung.
+    qint64 position = 0; ///< Leseposition der nächsten Aktion.
+    quint16 version = 0; ///< Formatversion aus dem Kopf.
+    quint16 flags = 0; ///< Flags aus dem Kopf.
+    int length = 0; ///< Anzahl der Zeilen.
+    int width = 0; ///< Anzahl der Spalten.
+    int minesNumber = 0; ///< Anzahl der Minen.
+    quint64 seed = 0; ///< Seed des Spielfelds.
+};
+
+#endif // REPLAYPLAYER_H
@@ -0,0 +1,132 @@
+#include "replayrecorder.h"
+#include <QFile>
+#include <QDebug>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <cstring>
+
+/**
+ * @brief Destruktor für ReplayRecorder.
+ *
+ * Schreibt den Rest des Puffers, damit auch beim Beenden keine Aktion verloren geht.
+ */
+ReplayRecorder::~ReplayRecorder() {
+    finish();
+}
+
+/**
+ * @brief Beginnt die Aufzeichnung eines Spielfelds, das aus diesen Einstellungen erzeugt wurde.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @param minesNumber Anzahl der Minen.
+ * @param seed Seed des Spielfelds.
+ * @param flags Flags für den Kopf (ReplayFormat::FLAG_*).
+ * @param filePath Pfad der neuen Datei.
+ *
+ * Der Kopf wird sofort geschrieben, damit auch ein nach wenigen Klicks abgebrochenes Spiel
+ * eine gültige Datei hinterlässt.
+ */
+void ReplayRecorder::start(int length, int width, int minesNumber, quint64 seed, quint16 flags,
+                           const QString &filePath) {
+    finish();
+    this->filePath = filePath;
+    this->width = width;
+
+    uchar header[ReplayFormat::HEADER_SIZE];
+    std::memcpy(header, ReplayFormat::MAGIC, sizeof(ReplayFormat::MAGIC));
+    qToLittleEndian<quint16>(ReplayFormat::VERSION, header + 4);
+    qToLittleEndian<quint16>(flags, header + 6);
+    qToLittleEndian<qint32>(length, header + 8);
+    qToLittleEndian<qint32>(width, header + 12);
+    qToLittleEndian<qint32>(minesNumber, header + 16);
+    qToLittleEndian<quint64>(seed, header + 20);
+    buffer.append(reinterpret_cast<const char *>(header), ReplayFormat::HEADER_SIZE);
+
+    recording = true;
+    lastTime = 0;
+    clock.start();
+    flush();
+}
+
+/**
+ * @brief Zeichnet eine Aktion auf.
+ * @param action Art der Aktion.
+ * @param row Zeilenindex der Zelle (bei Zellaktionen).
+ * @param col Spaltenindex der Zelle (bei Zellaktionen).
+ *
+ */
+void ReplayRecorder::record(ReplayFormat::Action action, int row, int col) {
+    append(action, quint64(row) * width + col);
+}
+
+/**
+ * @brief Zeichnet das angezeigte Ergebnis am Spielende auf.
+ * @param won True, wenn das Spiel gewonnen wurde.
+ * @param elapsedTime Angezeigte Spielzeit in ms.
+ */
+void ReplayRecorder::recordResult(bool won, qint64 elapsedTime) {
+    append(ReplayFormat::RESULT, quint64(elapsedTime) << 1 | won);
+}
+
+/**
+ * @brief Kodiert eine Aktion in den Puffer.
+ * @param action Art der Aktion.
+ * @param argument Zweiter Varint, falls die Aktion einen hat.
+ *
+ * Kodiert die Aktion nur in den Puffer; geschrieben wird erst ab FLUSH_SIZE Bytes.
+ */
+void ReplayRecorder::append(ReplayFormat::Action action, quint64 argument) {
+    if (!recording) {
+        return;
+    }
+    const qint64 now = clock.elapsed();
+    uchar bytes[20]; ///< zwei Varints mit je höchstens 10 Bytes
+    int n = ReplayFormat::putVarint(bytes, quint64(now - lastTime) << ReplayFormat::ACTION_BITS | action);
+    if (ReplayFormat::hasArgument(action)) {
+        n += ReplayFormat::putVarint(bytes + n, argument);
+    }
+    lastTime = now;
+    buffer.append(reinterpret_cast<const char *>(bytes), n);
+    if (buffer.size() >= FLUSH_SIZE) {
+        flush();
+    }
+}
+
+/**
+ * @brief Schreibt den Puffer im Hintergrund in die Datei.
+ *
+ * Ein noch laufender Schreibvorgang wird vorher abgewartet, damit die Teile in der richtigen
+ * Reihenfolge in der Datei landen. Bei FLUSH_SIZE ist er praktisch immer schon fertig.
+ */
+void ReplayRecorder::flush() {
+    if (buffer.isEmpty()) {
+        return;
+    }
+    pendingWrite.waitForFinished();
+    pendingWrite = QtConcurrent::run(&ReplayRecorder::appendToFile, filePath, buffer);
+    buffer.clear();
+}
+
+/**
+ * @brief Schließt die Aufzeichnung ab und wartet, bis alles geschrieben ist.
+ */
+void ReplayRecorder::finish() {
+    flush();
+    pendingWrite.waitForFinished();
+    recording = false;
+}
+
+/**
+ * @brief Hängt einen Teil der Aufzeichnung an die Datei an.
+ * @param filePath Pfad der Datei.
+ * @param chunk Anzuhängende Bytes.
+ * @return True bei Erfolg.
+ */
+bool ReplayRecorder::appendToFile(const QString &filePath, const QByteArray &chunk) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(chunk) != chunk.size()) {
+        qWarning() << "Failed to write replay: " << filePath;
+        return false;
+    }
+    return true;
+}
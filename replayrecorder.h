@@ -0,0 +1,124 @@
+#ifndef REPLAYRECORDER_H
+#define REPLAYRECORDER_H
+
+#include "replayformat.h"
+#include <QByteArray>
+#include <QString>
+#include <QElapsedTimer>
+#include <QFuture>
+
+/**
+ * @file replayrecorder.h
+ * @class ReplayRecorder
+ * @brief Zeichnet die Aktionen eines Spiels fortlaufend in eine Datei auf.
+ *
+ * Format siehe replayformat.h.
+ *
+ * Technische Entscheidung:
+ * Eine Aktion wird beim Klick nur in einen Puffer im Speicher kodiert (wenige Nanosekunden).
+ * Erst wenn der Puffer voll ist oder das Spiel endet, wird er in einem Hintergrund-Thread an
+ * die Datei angehängt. Das Schreiben auf die Festplatte liegt damit nie zwischen Klick und
+ * Bildaufbau. Schreibvorgänge laufen nacheinander, damit die Reihenfolge erhalten bleibt.
+ *
+ * Abhängigkeit: keine; Einstellungen und Seed übergibt die Oberfläche, siehe GameEngine.
+ *
+ * @author Daniel Schukin
+ */
+class ReplayRecorder
+{
+public:
+    static constexpr int FLUSH_SIZE = 4096; ///< Puffergröße in Bytes, ab der im Hintergrund geschrieben wird.
+
+    /**
+     * @brief Destruktor für ReplayRecorder. Schreibt den Rest des Puffers und wartet darauf.
+     *
+     * @author Daniel Schukin
+     */
+    ~ReplayRecorder();
+
+    /**
+     * @brief Beginnt die Aufzeichnung eines Spielfelds, das aus diesen Einstellungen erzeugt wurde.
+     * @param length Anzahl der Zeilen.
+     * @param width Anzahl der Spalten.
+     * @param minesNumber Anzahl der Minen.
+     * @param seed Seed des Spielfelds.
+     * @param flags Flags für den Kopf (ReplayFormat::FLAG_*).
+     * @param filePath Pfad der neuen Datei.
+     *
+     * Eine laufende Aufzeichnung wird abgeschlossen.
+     *
+     * @author Daniel Schukin
+     */
+    void start(int length, int width, int minesNumber, quint64 seed, quint16 flags, const QString &filePath);
+
+    /**
+     * @brief Zeichnet eine Aktion auf.
+     * @param action Art der Aktion.
+     * @param row Zeilenindex der Zelle (bei Zellaktionen).
+     * @param col Spaltenindex der Zelle (bei Zellaktionen).
+     *
+     * @author Daniel Schukin
+     */
+    void record(ReplayFormat::Action action, int row = 0, int col = 0);
+
+    /**
+     * @brief Zeichnet das angezeigte Ergebnis am Spielende auf.
+     * @param won True, wenn das Spiel gewonnen wurde.
+     * @param elapsedTime Angezeigte Spielzeit in ms.
+     *
+     * @author Daniel Schukin
+     */
+    void recordResult(bool won, qint64 elapsedTime);
+
+    /**
+     * @brief Schreibt den Puffer im Hintergrund in die Datei, z.B. am Spielende.
+     *
+     * @author Daniel Schukin
+     */
+    void flush();
+
+    /**
+     * @brief Schließt die Aufzeichnung ab und wartet, bis alles geschrieben ist.
+     *
+     * @author Daniel Schukin
+     */
+    void finish();
+
+    /**
+     * @brief Gibt an, ob gerade aufgezeichnet wird.
+     * @return True zwischen start() und finish().
+     *
+     * @author Daniel Schukin
+     */
+    bool is_recording() const { return recording; }
+
+private:
+    /**
+     * @brief Kodiert eine Aktion in den Puffer.
+     * @param action Art der Aktion.
+     * @param argument Zweiter Varint, falls die Aktion einen hat.
+     *
+     * @author Daniel Schukin
+     */
+    void append(ReplayFormat::Action action, quint64 argument);
+
+    /**
+     * @brief Hängt einen Teil der Aufzeichnung an die Datei an.
+     * @param filePath Pfad der Datei.
+     * @param chunk Anzuhängende Bytes.
+     * @return True bei Erfolg.
+     *
+     * @author Daniel Schukin
+     */
+    static bool appendToFile(const QString &filePath, const QByteArray &chunk);
+
+    QString filePath; ///< Datei der laufenden Aufzeichnung.
+    QByteArray buffer; ///< Noch nicht geschriebene Bytes.
+    QElapsedTimer clock; ///< Zeit seit Beginn der Aufzeichnung.
+    qint64 lastTime = 0; ///< Zeitpunkt der letzten Aktion in ms.
+    int width = 0; ///< Breite des Spielfelds für den Zellindex.
+    bool recording = false; ///< True zwischen start() und finish().
+    QFuture<bool> pendingWrite; ///< Laufender Schreibvorgang im Hintergrund.
+};
+
+#endif // REPLAYRECORDER_H
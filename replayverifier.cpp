@@ -0,0 +1,122 @@
+#include "replayverifier.h"
+#include "replayplayer.h"
+#include "game.h"
+#include <QtConcurrent>
+
+/**
+ * @brief Prüft eine Aufzeichnung aus einer Datei.
+ * @param filePath Pfad der Datei.
+ * @return Ergebnis der Prüfung.
+ */
+ReplayVerifier::Result ReplayVerifier::verifyFile(const QString &filePath) {
+    ReplayPlayer player;
+    Result result;
+    if (player.load(filePath)) {
+        result = verify(player);
+    }
+    result.filePath = filePath;
+    return result;
+}
+
+/**
+ * @brief Prüft eine geladene Aufzeichnung ab ihrer ersten Aktion.
+ * @param player Geladene Aufzeichnung.
+ * @return Ergebnis der Prüfung (ohne Dateipfad).
+ *
+ * Der Timer wird wie in MainWindow nachgebildet: er läuft ab Spielbeginn, hält am Spielende
+ * und bei Pause an, läuft nach dem Fortsetzen weiter und startet neu, wenn ein Rückgängig das
+ * beendete Spiel wieder aufnimmt. Ein Ergebnis gilt nur bis dahin; endet das Spiel danach nicht
+ * erneut, ist der Status NO_RESULT.
+ */
+ReplayVerifier::Result ReplayVerifier::verify(ReplayPlayer &player) {
+    Result result;
+    result.status = NO_RESULT;
+    Game game; ///< ohne Laden der Statistik
+    player.rewind();
+    player.setupGame(game);
+
+    const qint64 tolerance = player.getVersion() == 1 ? V1_TIME_TOLERANCE : TIME_TOLERANCE;
+    bool timerRunning = true;
+    bool paused = false;
+    int timerStarts = 1;
+    ReplayPlayer::Record record;
+    while (player.next(record)) {
+        if (timerRunning) {
+            result.playedTime += record.timeDelta;
+        }
+        result.actions++;
+        switch (record.action) {
+        case ReplayFormat::RESULT:
+            result.won = record.won;
+            result.claimedTime = record.elapsedTime;
+            if (game.is_inGame() || record.won != game.is_won()) {
+                result.status = RESULT_MISMATCH;
+                return result;
+            }
+            if (record.elapsedTime > result.playedTime + record.timeDelta + tolerance * timerStarts
+                || record.elapsedTime < result.playedTime - tolerance * timerStarts) {
+                result.status = TIME_MISMATCH;
+                return result;
+            }
+            result.status = VALID;
+            break;
+        case ReplayFormat::PAUSE:
+            paused = !paused;
+            timerRunning = !paused && game.is_inGame(); ///< ein beendetes Spiel läuft nach dem Fortsetzen nicht weiter
+            timerStarts += timerRunning;
+            break;
+        default:
+            ReplayPlayer::apply(game, record);
+            game.getChangedCells()->clear();
+            if (!game.is_inGame()) {
+                timerRunning = false;
+            } else if (!timerRunning && !paused) { ///< Rückgängig nach dem Spielende
+                timerRunning = true;
+                timerStarts++;
+            }
+            if (game.is_inGame() && result.status == VALID) { ///< das bisherige Ergebnis ist überholt
+                result.status = NO_RESULT;
+            }
+            break;
+        }
+    }
+    if (!player.atEnd()) {
+        result.status = CORRUPT;
+    }
+    return result;
+}
+
+/**
+ * @brief Prüft mehrere Dateien parallel auf allen Kernen.
+ * @param filePaths Pfade der Dateien.
+ * @return Ergebnisse in der Reihenfolge der Dateien.
+ *
+ * QtConcurrent verteilt die Dateien in kleinen Blöcken über den globalen Thread-Pool; ein
+ * Thread, der fertig ist, holt sich sofort den nächsten Block.
+ */
+QList<ReplayVerifier::Result> ReplayVerifier::verifyAll(const QStringList &filePaths) {
+    return QtConcurrent::blockingMapped<QList<Result>>(filePaths, &ReplayVerifier::verifyFile);
+}
+
+/**
+ * @brief Gibt einen lesbaren Namen für einen Status zurück.
+ * @param status Status der Prüfung.
+ * @return Name des Status.
+ */
+const char *ReplayVerifier::statusName(Status status) {
+    switch (status) {
+    case VALID:
+        return "valid";
+    case UNREADABLE:
+        return "unreadable";
+    case CORRUPT:
+        return "corrupt";
+    case NO_RESULT:
+        return "no result";
+    case RESULT_MISMATCH:
+        return "result mismatch";
+    case TIME_MISMATCH:
+        return "time mismatch";
+    }
+    return "unknown";
+}
@@ -0,0 +1,105 @@
+#ifndef REPLAYVERIFIER_H
+#define REPLAYVERIFIER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class ReplayPlayer;
+
+/**
+ * @file replayverifier.h
+ * @class ReplayVerifier
+ * @brief Prüft Aufzeichnungen, indem sie ohne Oberfläche nachgespielt werden.
+ *
+ * Jede Aufzeichnung wird auf ihrem aus dem Seed erzeugten Spielfeld abgespielt. Für jedes
+ * aufgezeichnete Ergebnis (RESULT) wird geprüft, ob das Spiel an dieser Stelle tatsächlich
+ * beendet ist, ob gewonnen/verloren stimmt und ob die angezeigte Zeit zur Spielzeit der
+ * Aufzeichnung passt. Die Spielzeit läuft wie in der Oberfläche nur, solange das Spiel läuft
+ * und nicht pausiert ist.
+ *
+ * Spielzeit und Aufzeichnung messen mit getrennten Uhren. Pro Start der Spielzeit (Spielbeginn,
+ * Fortsetzen, Rückgängig nach Spielende) dürfen sie um TIME_TOLERANCE auseinanderliegen. Die
+ * Spielzeit endet erst nach der Verarbeitung des letzten Zugs, darf also zusätzlich um die
+ * Zeit bis zum Eintrag des Ergebnisses über der Aufzeichnung liegen. Aufzeichnungen der
+ * Version 1 enthalten nur ganze Sekunden und werden mit V1_TIME_TOLERANCE geprüft.
+ *
+ * Geprüft wird nur, ob die Aufzeichnung in sich stimmig ist. Die Spielzeit wird aus den
+ * Zeitabständen derselben Datei nachgerechnet; eine Aufzeichnung, deren Abstände samt
+ * angezeigter Zeit gleichmäßig verkürzt wurden, gilt deshalb als VALID. Dass ein Spiel
+ * tatsächlich so lange gedauert hat, belegt die Prüfung nicht.
+ *
+ * Technische Entscheidung:
+ * Die Aufzeichnungen sind voneinander unabhängig und werden mit QtConcurrent auf alle Kerne
+ * verteilt. Jeder Thread holt sich die nächste Datei aus der gemeinsamen Liste, sobald er fertig
+ * ist; lange Aufzeichnungen blockieren damit keine anderen Threads.
+ *
+ * Abhängigkeit: spielt über ReplayPlayer auf einem eigenen Game-Objekt ohne Statistik.
+ *
+ * @author Daniel Schukin
+ */
+class ReplayVerifier
+{
+public:
+    static constexpr qint64 TIME_TOLERANCE = 5; ///< Erlaubte Abweichung in ms pro Start der Spielzeit.
+    static constexpr qint64 V1_TIME_TOLERANCE = 1000; ///< Dasselbe für Version 1 mit Sekundenanzeige.
+
+    /// @brief Ergebnis der Prüfung einer Aufzeichnung.
+    enum Status {
+        VALID,           ///< Alle Ergebnisse stimmen.
+        UNREADABLE,      ///< Datei fehlt oder der Kopf ist ungültig.
+        CORRUPT,         ///< Eine Aktion ist ungültig oder abgeschnitten.
+        NO_RESULT,       ///< Das Spiel wurde nicht beendet oder nach einem Rückgängig nicht erneut beendet.
+        RESULT_MISMATCH, ///< Das angezeigte Ergebnis passt nicht zum Spiel.
+        TIME_MISMATCH    ///< Die angezeigte Zeit passt nicht zur Spielzeit.
+    };
+
+    /// @brief Ergebnis der Prüfung einer Datei.
+    struct Result
+    {
+        QString filePath;         ///< Geprüfte Datei.
+        Status status = UNREADABLE; ///< Ergebnis der Prüfung.
+        int actions = 0;          ///< Anzahl der abgespielten Aktionen.
+        bool won = false;         ///< Letztes angezeigtes Ergebnis.
+        qint64 claimedTime = 0;   ///< Letzte angezeigte Spielzeit in ms.
+        qint64 playedTime = 0;    ///< Nachgerechnete Spielzeit in ms an dieser Stelle.
+    };
+
+    /**
+     * @brief Prüft eine Aufzeichnung aus einer Datei.
+     * @param filePath Pfad der Datei.
+     * @return Ergebnis der Prüfung.
+     *
+     * @author Daniel Schukin
+     */
+    static Result verifyFile(const QString &filePath);
+
+    /**
+     * @brief Prüft eine geladene Aufzeichnung ab ihrer ersten Aktion.
+     * @param player Geladene Aufzeichnung.
+     * @return Ergebnis der Prüfung (ohne Dateipfad).
+     *
+     * @author Daniel Schukin
+     */
+    static Result verify(ReplayPlayer &player);
+
+    /**
+     * @brief Prüft mehrere Dateien parallel auf allen Kernen.
+     * @param filePaths Pfade der Dateien.
+     * @return Ergebnisse in der Reihenfolge der Dateien.
+     *
+     * @author Daniel Schukin
+     */
+    static QList<Result> verifyAll(const QStringList &filePaths);
+
+    /**
+     * @brief Gibt einen lesbaren Namen für einen Status zurück.
+     * @param status Status der Prüfung.
+     * @return Name des Status.
+     *
+     * @author Daniel Schukin
+     */
+    static const char *statusName(Status status);
+};
+
+#endif // REPLAYVERIFIER_H
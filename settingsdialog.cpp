@@ -6,11 +6,13 @@
  *
  * Initialisiert die Benutzeroberfläche und stellt Verbindungen zu den Steuerelementen her.
  *
+ * @param estimator Schätzer für die Schwierigkeit; muss länger leben als der Dialog.
  * @param parent Das übergeordnete Widget (optional).
  */
-SettingsDialog::SettingsDialog(QWidget *parent)
+SettingsDialog::SettingsDialog(DifficultyEstimator *estimator, QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::SettingsDialog)
+    , estimator(estimator)
 {
     ui->setupUi(this);
     this->setWindowTitle("Settings");
@@ -24,12 +26,14 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     minesLineEdit = ui->minesLineEdit;
     lengthLineEdit = ui->lengthLineEdit;
     widthLineEdit = ui->widthLineEdit;
+    estimateLabel = ui->estimateLabel;
 
     ///< Verbindungen zu den Buttons
     connect(ui->cancelButton, &QPushButton::clicked, this, &SettingsDialog::on_cancelBtn_clicked);
     connect(ui->okButton, &QPushButton::clicked, this, &SettingsDialog::on_okBtn_clicked);
 
     setupConnections();
+    requestEstimate();
     adjustSize();
 }
 
@@ -87,6 +91,12 @@ void SettingsDialog::setupConnections()
     connect(widthLineEdit, &QLineEdit::textChanged, this, [=]() {
         updateSliderFromLineEdit(widthLineEdit, widthSlider);
     });
+
+    ///< Schwierigkeit bei jeder Änderung neu schätzen; das Ergebnis kommt aus dem Schätz-Thread
+    connect(minesSlider, &QSlider::valueChanged, this, &SettingsDialog::requestEstimate);
+    connect(lengthSlider, &QSlider::valueChanged, this, &SettingsDialog::requestEstimate);
+    connect(widthSlider, &QSlider::valueChanged, this, &SettingsDialog::requestEstimate);
+    connect(estimator, &DifficultyEstimator::estimateReady, this, &SettingsDialog::showEstimate);
 }
 
 /**
@@ -115,6 +125,46 @@ void SettingsDialog::updateLineEditFromSlider(QSlider *slider, QLineEdit *lineEd
     lineEdit->setText(QString::number(slider->value())); // Aktualisiert das LineEdit mit dem Slider-Wert
 }
 
+/**
+ * @brief Fordert die Schätzung für die aktuellen Werte der Schieberegler an.
+ * Kehrt sofort zurück; eine noch laufende Schätzung für alte Werte wird verworfen.
+ */
+void SettingsDialog::requestEstimate()
+{
+    DifficultyEstimator::Estimate estimate;
+    if (estimator->request(lengthSlider->value(), widthSlider->value(), minesSlider->value(), estimate)) {
+        showEstimate(lengthSlider->value(), widthSlider->value(), minesSlider->value());
+    } else {
+        estimateLabel->setText("Schwierigkeit wird geschätzt ...");
+    }
+}
+
+/**
+ * @brief Zeigt eine fertige Schätzung an, wenn sie noch zu den Schiebereglern passt.
+ *
+ * @param length Spielfeldlänge der Schätzung.
+ * @param width Spielfeldbreite der Schätzung.
+ * @param minesNumber Anzahl der Minen der Schätzung.
+ */
+void SettingsDialog::showEstimate(int length, int width, int minesNumber)
+{
+    if (length != lengthSlider->value() || width != widthSlider->value() || minesNumber != minesSlider->value()) {
+        return; ///< die Regler stehen schon woanders, die neue Schätzung folgt
+    }
+    DifficultyEstimator::Estimate estimate;
+    if (!estimator->cached(length, width, minesNumber, estimate)) {
+        return;
+    }
+    if (estimate.games == 0) {
+        estimateLabel->setText("Zu viele Minen für dieses Spielfeld");
+        return;
+    }
+    estimateLabel->setText(QString("Gewinnchance ca. %1 %, 3BV ca. %2 (%3 Testspiele)")
+                               .arg(qRound(100.0 * estimate.winRate()))
+                               .arg(qRound(estimate.bbbv))
+                               .arg(estimate.games));
+}
+
 /**
  * @brief Gibt die aktuell ausgewählte Schwierigkeit zurück.
  *
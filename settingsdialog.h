@@ -5,6 +5,8 @@
 #include <QSlider>
 #include <QLineEdit>
 #include <QComboBox>
+#include <QLabel>
+#include "difficultyestimator.h"
 
 namespace Ui {
 class SettingsDialog;
@@ -18,7 +20,12 @@ class SettingsDialog;
  * Dieses Dialogfenster ermöglicht es dem Benutzer, die Schwierigkeit, Spielfeldlängen,
  * Breiten und die Anzahl der Minen für das Spiel anzupassen.
  *
- * Abhängigkeit: ist unabhängig und wird nur von dem MainWindow eingebunden.
+ * Zu den Werten der Schieberegler zeigt der Dialog eine im Hintergrund berechnete Schätzung
+ * der Gewinnchance und des 3BV an, siehe DifficultyEstimator. Der Schätzer gehört dem
+ * MainWindow, damit schon geschätzte Konfigurationen beim nächsten Öffnen sofort dastehen und
+ * eine angefangene Schätzung beim Schließen weiterläuft, statt verworfen zu werden.
+ *
+ * Abhängigkeit: DifficultyEstimator; wird nur von dem MainWindow eingebunden.
  *
  * @author Daniel Schukin
  */
@@ -32,11 +39,12 @@ public:
      *
      * Initialisiert die Benutzeroberfläche und stellt Verbindungen zu den Steuerelementen her.
      *
+     * @param estimator Schätzer für die Schwierigkeit; muss länger leben als der Dialog.
      * @param parent Das übergeordnete Widget (optional).
      *
      * @author Daniel Schukin
      */
-    explicit SettingsDialog(QWidget *parent = nullptr);
+    explicit SettingsDialog(DifficultyEstimator *estimator, QWidget *parent = nullptr);
 
     /**
      * @brief Destruktor für SettingsDialog-Objekt.
@@ -110,6 +118,9 @@ private:
     QLineEdit *lengthLineEdit; ///< LineEdit für die Spielfeldlänge.
     QLineEdit *widthLineEdit; ///< LineEdit für die Spielfeldbreite.
 
+    QLabel *estimateLabel; ///< Label für die geschätzte Schwierigkeit.
+    DifficultyEstimator *estimator; ///< Schätzt die Schwierigkeit im Hintergrund; gehört dem MainWindow.
+
     /**
      * @brief Stellt die Verbindungen zwischen den Widgets her.
      * Synchronisiert die Slider und LineEdits, sodass Änderungen in einem Widget
@@ -138,6 +149,25 @@ private:
      * @author Daniel Schukin
      */
     void updateLineEditFromSlider(QSlider *slider, QLineEdit *lineEdit);
+
+    /**
+     * @brief Fordert die Schätzung für die aktuellen Werte der Schieberegler an.
+     * Liegt sie schon vor, wird sie sofort angezeigt.
+     *
+     * @author Daniel Schukin
+     */
+    void requestEstimate();
+
+    /**
+     * @brief Zeigt eine fertige Schätzung an, wenn sie noch zu den Schiebereglern passt.
+     *
+     * @param length Spielfeldlänge der Schätzung.
+     * @param width Spielfeldbreite der Schätzung.
+     * @param minesNumber Anzahl der Minen der Schätzung.
+     *
+     * @author Daniel Schukin
+     */
+    void showEstimate(int length, int width, int minesNumber);
 };
 
 #endif // SETTINGSDIALOG_H
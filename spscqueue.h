@@ -0,0 +1,120 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+/**
+ * @file spscqueue.h
+ * @class SpscQueue
+ * @brief Begrenzte, sperrfreie Warteschlange für genau einen Erzeuger und einen Verbraucher.
+ *
+ * Verbindet die Oberfläche mit dem Engine-Thread: ein Thread schreibt nur mit tryPush(), der
+ * andere liest nur mit tryPop(). Die Reihenfolge bleibt erhalten.
+ *
+ * Technische Entscheidung:
+ * Ein Ring fester Größe (Zweierpotenz) mit je einem atomaren Index für Kopf und Ende. Jeder
+ * Index wird nur von einer Seite geschrieben; Release beim Schreiben und Acquire beim Lesen
+ * des fremden Index reichen als Synchronisation. Keine Seite wartet je auf eine Sperre, eine
+ * volle oder leere Schlange meldet tryPush()/tryPop() mit false. Kopf und Ende liegen auf
+ * getrennten Cache-Zeilen, damit sich Erzeuger und Verbraucher nicht gegenseitig ausbremsen.
+ *
+ * @author Daniel Schukin
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    /**
+     * @brief Konstruktor für SpscQueue.
+     * @param capacity Anzahl der Plätze; wird auf die nächste Zweierpotenz aufgerundet.
+     *
+     * @author Daniel Schukin
+     */
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        ring.reset(new T[size]);
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * @brief Hängt ein Element an (nur vom Erzeuger-Thread).
+     * @param value Element; wird nur bei Erfolg verschoben.
+     * @return False, wenn die Schlange voll ist.
+     *
+     * @author Daniel Schukin
+     */
+    bool tryPush(T &&value) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) {
+                return false;
+            }
+        }
+        ring[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Hängt eine Kopie eines Elements an (nur vom Erzeuger-Thread).
+     * @param value Element.
+     * @return False, wenn die Schlange voll ist.
+     *
+     * @author Daniel Schukin
+     */
+    bool tryPush(const T &value) {
+        T copy(value);
+        return tryPush(std::move(copy));
+    }
+
+    /**
+     * @brief Entnimmt das älteste Element (nur vom Verbraucher-Thread).
+     * @param value Entnommenes Element.
+     * @return False, wenn die Schlange leer ist.
+     *
+     * @author Daniel Schukin
+     */
+    bool tryPop(T &value) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return false;
+            }
+        }
+        value = std::move(ring[h & mask]);
+        ring[h & mask] = T(); ///< gibt z.B. Puffer eines verschobenen Vektors sofort frei
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Gibt die Anzahl der Plätze zurück.
+     * @return Kapazität der Schlange.
+     *
+     * @author Daniel Schukin
+     */
+    size_t capacity() const { return mask + 1; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64; ///< Abstand zwischen den Indizes beider Seiten.
+
+    std::unique_ptr<T[]> ring; ///< Ring der Elemente.
+    size_t mask = 0; ///< Kapazität - 1.
+    alignas(CACHE_LINE) std::atomic<size_t> head{0}; ///< Nächster Leseplatz; schreibt nur der Verbraucher.
+    size_t cachedTail = 0; ///< Zuletzt gelesenes Ende (nur Verbraucher).
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0}; ///< Nächster Schreibplatz; schreibt nur der Erzeuger.
+    size_t cachedHead = 0; ///< Zuletzt gelesener Kopf (nur Erzeuger).
+};
+
+#endif // SPSCQUEUE_H
@@ -60,17 +60,19 @@ void StatisticsDialog::populateStatisticsTable() {
     ///< Durch alle Statistiken iterieren und die Werte in die Tabelle einfügen
     for (auto it = statisticManager.getAllStats()->begin(); it != statisticManager.getAllStats()->end(); ++it) {
         const GameStats &stats = it.value();
-        ///< Zeit in das Format "00:00:00" umwandeln
+        ///< Zeit in das Format "00:00:00.000" umwandeln
         QString time;
-        int hours, minutes, seconds;
+        int hours, minutes, seconds, milliseconds;
         if(stats.shortestTime == INT_MAX) {
             time = "-";
         }
         else {
-            hours = stats.shortestTime / 3600;
-            minutes = (stats.shortestTime % 3600) / 60;
-            seconds = stats.shortestTime % 60;
-            time = QString("%1:%2:%3").arg(hours, 2, 10, QChar('0')).arg(minutes, 2, 10, QChar('0')).arg(seconds, 2, 10, QChar('0'));
+            hours = stats.shortestTime / 3600000;
+            minutes = (stats.shortestTime % 3600000) / 60000;
+            seconds = (stats.shortestTime % 60000) / 1000;
+            milliseconds = stats.shortestTime % 1000;
+            time = QString("%1:%2:%3.%4").arg(hours, 2, 10, QChar('0')).arg(minutes, 2, 10, QChar('0'))
+                       .arg(seconds, 2, 10, QChar('0')).arg(milliseconds, 3, 10, QChar('0'));
         }
 
         ///< Werte für ein Spiel in die Tabelle einfügen
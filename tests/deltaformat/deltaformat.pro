@@ -0,0 +1,25 @@
+QT       += core testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_deltaformat
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../boardplane.cpp \
+    ../../deltarecorder.cpp \
+    ../../tracing.cpp \
+    tst_deltaformat.cpp
+
+# gameengine.h nur für EngineEvent, ohne moc, damit GameEngine nicht mitgebaut werden muss
+HEADERS += \
+    ../../boardexport.h \
+    ../../boardplane.h \
+    ../../deltaformat.h \
+    ../../deltarecorder.h \
+    ../../gamearena.h \
+    ../../replayformat.h \
+    ../../spscqueue.h \
+    ../../tracing.h
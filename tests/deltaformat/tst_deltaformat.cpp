@@ -0,0 +1,344 @@
+/**
+ * @file tst_deltaformat.cpp
+ * @brief Tests für den Live-Mitschnitt der Spielfeldänderungen (deltaformat.h).
+ *
+ * Schneidet Spielfelder und Züge mit DeltaRecorder mit und baut sie mit DeltaFormat::Board
+ * nach. Abgeschnittene und beschädigte Datensätze werden direkt im Speicher erzeugt.
+ *
+ * @author Daniel Schukin
+ */
+
+#include "deltaformat.h"
+#include "deltarecorder.h"
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest>
+#include <cstring>
+
+/**
+ * @brief Hängt einen Datensatz mit Längenangabe an.
+ * @param data Mitschnitt.
+ * @param body Datensatz ab dem Zeit-Varint.
+ */
+static void appendRecord(QByteArray &data, const QByteArray &body) {
+    uchar size[10];
+    data.append(reinterpret_cast<const char *>(size), ReplayFormat::putVarint(size, quint64(body.size())));
+    data.append(body);
+}
+
+/**
+ * @brief Hängt Varints an einen Datensatz an.
+ * @param body Datensatz.
+ * @param values Werte der Varints.
+ */
+static void appendVarints(QByteArray &body, std::initializer_list<quint64> values) {
+    for (quint64 value : values) {
+        uchar bytes[10];
+        body.append(reinterpret_cast<const char *>(bytes), ReplayFormat::putVarint(bytes, value));
+    }
+}
+
+/**
+ * @brief Erzeugt einen BOARD-Datensatz mit lauter verdeckten Zellen.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @return Datensatz ab dem Zeit-Varint.
+ */
+static QByteArray boardBody(int length, int width) {
+    QByteArray body;
+    appendVarints(body, {DeltaFormat::BOARD, DeltaFormat::STATE_IN_GAME, 0, quint64(length), quint64(width), 1, 0});
+    const QVector<quint8> codes(length * width, 0);
+    QByteArray runs(codes.size() + 10, '\0');
+    const int n = DeltaFormat::putCodes(reinterpret_cast<uchar *>(runs.data()), codes.constData(), codes.size());
+    body.append(runs.constData(), n);
+    return body;
+}
+
+/**
+ * @brief Liest alle vollständigen Datensätze eines Mitschnitts.
+ * @param data Mitschnitt samt Kopf.
+ * @param board Nachgebautes Spielfeld.
+ * @param changed Wenn nicht nullptr, die Indizes der geänderten Zellen aller Züge.
+ * @return Anzahl der angewendeten Datensätze; -1 bei einem ungültigen Datensatz.
+ */
+static int applyAll(const QByteArray &data, DeltaFormat::Board &board, QVector<qint32> *changed = nullptr) {
+    const uchar *pos = reinterpret_cast<const uchar *>(data.constData()) + DeltaFormat::HEADER_SIZE;
+    const uchar *end = reinterpret_cast<const uchar *>(data.constData()) + data.size();
+    int records = 0;
+    for (;;) {
+        DeltaFormat::Record record;
+        const qint64 size = DeltaFormat::parseRecord(pos, end, record);
+        if (size == 0) {
+            return records;
+        }
+        if (size < 0 || !board.apply(record, changed)) {
+            return -1;
+        }
+        pos += size;
+        records++;
+    }
+}
+
+/**
+ * @class TestDeltaFormat
+ * @brief Rundreise-, Abschneide- und Beschädigungstests für Mitschnitte.
+ *
+ * @author Daniel Schukin
+ */
+class TestDeltaFormat : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void codesRoundTrip();
+    void codesTruncated();
+    void codesOverrun();
+    void recorderRoundTrip();
+    void truncatedRecord();
+    void corruptRecord();
+    void corruptDelta();
+};
+
+/**
+ * @brief Läufe der Länge 1, SHORT_REPEAT und darüber lesen sich so zurück, wie sie geschrieben wurden.
+ */
+void TestDeltaFormat::codesRoundTrip() {
+    QVector<quint8> codes;
+    const int runs[][2] = {{0, 1}, {2, 1}, {16, DeltaFormat::SHORT_REPEAT}, {17, DeltaFormat::SHORT_REPEAT + 1},
+                           {0, 300}, {24, 1}, {13, 1}, {2, 20000}};
+    for (const auto &run : runs) {
+        codes.append(QVector<quint8>(run[1], quint8(run[0])));
+    }
+    QByteArray encoded(codes.size() + 10, '\0');
+    const int n = DeltaFormat::putCodes(reinterpret_cast<uchar *>(encoded.data()), codes.constData(), codes.size());
+    QVERIFY(n < 20);
+
+    QVector<quint8> decoded(codes.size(), 0xff);
+    const uchar *pos = reinterpret_cast<const uchar *>(encoded.constData());
+    QVERIFY(DeltaFormat::getCodes(pos, pos + n, decoded.data(), decoded.size()));
+    QCOMPARE(int(pos - reinterpret_cast<const uchar *>(encoded.constData())), n);
+    QVERIFY(decoded == codes);
+}
+
+/**
+ * @brief Fehlt das Ende der Läufe, werden die Codes abgelehnt.
+ */
+void TestDeltaFormat::codesTruncated() {
+    QVector<quint8> codes(500, 16);
+    codes[0] = 2;
+    codes[499] = 0;
+    uchar encoded[520];
+    const int n = DeltaFormat::putCodes(encoded, codes.constData(), codes.size());
+    QVector<quint8> decoded(codes.size());
+    for (int size = 0; size < n; size++) {
+        const uchar *pos = encoded;
+        QVERIFY(!DeltaFormat::getCodes(pos, encoded + size, decoded.data(), decoded.size()));
+    }
+}
+
+/**
+ * @brief Ein Lauf über die erwartete Anzahl hinaus wird abgelehnt, ohne über das Ziel zu schreiben.
+ */
+void TestDeltaFormat::codesOverrun() {
+    const QVector<quint8> codes(100, 16);
+    uchar encoded[100 + 10];
+    const int n = DeltaFormat::putCodes(encoded, codes.constData(), codes.size());
+    QVector<quint8> decoded(99 + 1, 0xff);
+    const uchar *pos = encoded;
+    QVERIFY(!DeltaFormat::getCodes(pos, encoded + n, decoded.data(), 99));
+    QCOMPARE(decoded.at(99), quint8(0xff));
+
+    const uchar shortRun[] = {uchar(3 << DeltaFormat::CODE_BITS | 16)};
+    pos = shortRun;
+    QVERIFY(!DeltaFormat::getCodes(pos, shortRun + 1, decoded.data(), 3));
+}
+
+/**
+ * @brief Ein mit DeltaRecorder geschriebener Mitschnitt ergibt nach jedem Datensatz die öffentlichen Codes der Ebene.
+ *
+ * Die Zellen des ersten Zugs sind nicht nach Index sortiert und bilden zwei Läufe; verdeckte
+ * Minen dürfen im Mitschnitt nicht von verdeckten Zellen zu unterscheiden sein.
+ */
+void TestDeltaFormat::recorderRoundTrip() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filePath = dir.filePath("round-trip.u3d");
+    constexpr int LENGTH = 5;
+    constexpr int WIDTH = 7;
+
+    EngineEvent board;
+    board.type = EngineEvent::BOARD;
+    board.setup.length = LENGTH;
+    board.setup.width = WIDTH;
+    board.setup.minesNumber = 3;
+    board.plane.reset(LENGTH, WIDTH);
+    board.plane.set(0, 0, BoardPlane::cellCode(0x4, 0));
+    board.plane.set(2, 6, BoardPlane::cellCode(0x4, 0));
+    board.plane.set(4, 6, BoardPlane::cellCode(0x4, 0));
+    board.inGame = true;
+
+    EngineEvent open = board;
+    open.type = EngineEvent::MOVE;
+    open.elapsedTime = 1500;
+    const CellUpdate opened[] = {{3, 1, 1, 0}, {1, 2, 1, 1}, {3, 0, 1, 0}, {1, 4, 1, 2}, {1, 3, 1, 1}};
+    for (const CellUpdate &cell : opened) {
+        open.cells.append(cell);
+        open.plane.set(cell.row, cell.col, BoardPlane::cellCode(cell.status, cell.minesAround));
+    }
+
+    EngineEvent mark = open;
+    mark.elapsedTime = 2750;
+    mark.markedCells = 1;
+    mark.cells = {{4, 6, 0x2 | 0x4, 0}};
+    mark.plane.set(4, 6, BoardPlane::cellCode(0x2 | 0x4, 0));
+
+    EngineEvent lose = mark;
+    lose.elapsedTime = 4000;
+    lose.inGame = false;
+    lose.cells = {{0, 0, 0x1 | 0x4 | 0x8, 0}};
+    lose.plane.set(0, 0, BoardPlane::cellCode(0x1 | 0x4 | 0x8, 0));
+
+    DeltaRecorder recorder;
+    QVERIFY(recorder.start(filePath));
+    recorder.recordBoard(board);
+    recorder.recordMove(open);
+    recorder.recordMove(mark);
+    recorder.recordMove(lose);
+    recorder.finish();
+    QVERIFY(!recorder.is_recording());
+
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+    QVERIFY(data.size() > DeltaFormat::HEADER_SIZE);
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    QVERIFY(std::memcmp(bytes, DeltaFormat::MAGIC, sizeof(DeltaFormat::MAGIC)) == 0);
+    QCOMPARE(qFromLittleEndian<quint16>(bytes + 4), DeltaFormat::VERSION);
+
+    const EngineEvent *events[] = {&board, &open, &mark, &lose};
+    const uchar *pos = bytes + DeltaFormat::HEADER_SIZE;
+    const uchar *end = bytes + data.size();
+    DeltaFormat::Board replayed;
+    for (const EngineEvent *event : events) {
+        DeltaFormat::Record record;
+        const qint64 size = DeltaFormat::parseRecord(pos, end, record);
+        QVERIFY(size > 0);
+        QCOMPARE(record.kind, event->type == EngineEvent::BOARD ? DeltaFormat::BOARD : DeltaFormat::DELTA);
+        QVector<qint32> changed;
+        QVERIFY(replayed.apply(record, &changed));
+        pos += size;
+
+        QCOMPARE(replayed.length, LENGTH);
+        QCOMPARE(replayed.width, WIDTH);
+        QCOMPARE(replayed.minesNumber, 3);
+        QCOMPARE(replayed.markedCells, event->markedCells);
+        QCOMPARE(replayed.elapsedTime, event->elapsedTime);
+        QCOMPARE(replayed.inGame, event->inGame);
+        QVERIFY(!replayed.won);
+        QCOMPARE(changed.size(), event->cells.size());
+        for (int row = 0; row < LENGTH; row++) {
+            for (int col = 0; col < WIDTH; col++) {
+                QCOMPARE(replayed.codes.at(row * WIDTH + col), BoardPlane::publicCode(event->plane.code(row, col)));
+            }
+        }
+    }
+    QCOMPARE(pos, end);
+    QCOMPARE(replayed.boards, quint64(1));
+    QCOMPARE(replayed.moves, quint64(3));
+    QCOMPARE(replayed.codes.at(0), quint8(0x1 | 0x4 | 0x8));
+    QCOMPARE(replayed.codes.at(2 * WIDTH + 6), quint8(0));
+}
+
+/**
+ * @brief Ein halb geschriebener letzter Datensatz gilt als unvollständig, nicht als ungültig.
+ */
+void TestDeltaFormat::truncatedRecord() {
+    QByteArray data(DeltaFormat::HEADER_SIZE, '\0');
+    appendRecord(data, boardBody(3, 4));
+    const int complete = data.size();
+    QByteArray move;
+    appendVarints(move, {DeltaFormat::DELTA, DeltaFormat::STATE_IN_GAME, 0, 1, 20, 1}); ///< Zickzack 10: Zellen 10 und 11
+    move.append(char(1 << DeltaFormat::CODE_BITS | (BoardPlane::OPEN_CODE + 1)));
+    appendRecord(data, move);
+
+    DeltaFormat::Board board;
+    QCOMPARE(applyAll(data, board), 2);
+    QCOMPARE(board.codes.at(10), quint8(BoardPlane::OPEN_CODE + 1));
+    QCOMPARE(board.codes.at(11), quint8(BoardPlane::OPEN_CODE + 1));
+    for (int size = complete; size < data.size(); size++) {
+        DeltaFormat::Board partial;
+        QCOMPARE(applyAll(QByteArray(data.constData(), size), partial), 1);
+        QCOMPARE(partial.moves, quint64(0));
+    }
+}
+
+/**
+ * @brief Datensätze mit ungültiger Länge, Art oder überzähligen Bytes werden abgelehnt.
+ */
+void TestDeltaFormat::corruptRecord() {
+    DeltaFormat::Record record;
+    const uchar empty[] = {0x00, 0x00};
+    QCOMPARE(DeltaFormat::parseRecord(empty, empty + sizeof(empty), record), qint64(-1));
+
+    uchar huge[10];
+    const int hugeSize = ReplayFormat::putVarint(huge, quint64(DeltaFormat::MAX_RECORD) + 1);
+    QCOMPARE(DeltaFormat::parseRecord(huge, huge + hugeSize, record), qint64(-1));
+
+    const uchar badKind[] = {0x01, 0x03};
+    QCOMPARE(DeltaFormat::parseRecord(badKind, badKind + sizeof(badKind), record), qint64(-1));
+
+    uchar overlong[11];
+    std::memset(overlong, 0xff, sizeof(overlong));
+    QCOMPARE(DeltaFormat::parseRecord(overlong, overlong + sizeof(overlong), record), qint64(-1));
+    QCOMPARE(DeltaFormat::parseRecord(overlong, overlong + 9, record), qint64(0));
+
+    QByteArray data(DeltaFormat::HEADER_SIZE, '\0');
+    QByteArray body = boardBody(3, 4);
+    body.append(char(0));
+    appendRecord(data, body);
+    DeltaFormat::Board board;
+    QCOMPARE(applyAll(data, board), -1);
+
+    data = QByteArray(DeltaFormat::HEADER_SIZE, '\0');
+    body.clear();
+    appendVarints(body, {DeltaFormat::BOARD, 0, 0, 0, 4, 1, 0});
+    appendRecord(data, body);
+    QCOMPARE(applyAll(data, board), -1);
+}
+
+/**
+ * @brief Züge vor dem ersten Spielfeld und Läufe außerhalb des Spielfelds werden abgelehnt.
+ */
+void TestDeltaFormat::corruptDelta() {
+    QByteArray move;
+    appendVarints(move, {DeltaFormat::DELTA, DeltaFormat::STATE_IN_GAME, 0, 1, 0, 0});
+    move.append(char(BoardPlane::OPEN_CODE));
+
+    QByteArray data(DeltaFormat::HEADER_SIZE, '\0');
+    appendRecord(data, move);
+    DeltaFormat::Board board;
+    QCOMPARE(applyAll(data, board), -1);
+
+    const struct { quint64 gap; quint64 count; } runs[] = {
+        {1, 0},      ///< Zickzack -1: vor der ersten Zelle
+        {24, 0},     ///< Index 12 bei 12 Zellen
+        {22, 1},     ///< Index 11 und 12
+        {0, 12},     ///< 13 Zellen bei 12 Zellen
+    };
+    for (const auto &run : runs) {
+        data = QByteArray(DeltaFormat::HEADER_SIZE, '\0');
+        appendRecord(data, boardBody(3, 4));
+        move.clear();
+        appendVarints(move, {DeltaFormat::DELTA, DeltaFormat::STATE_IN_GAME, 0, 1, run.gap, run.count});
+        move.append(char(qMin<quint64>(run.count, 6) << DeltaFormat::CODE_BITS | BoardPlane::OPEN_CODE));
+        appendRecord(data, move);
+        DeltaFormat::Board replayed;
+        QCOMPARE(applyAll(data, replayed), -1);
+        QCOMPARE(replayed.moves, quint64(0));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestDeltaFormat)
+
+#include "tst_deltaformat.moc"
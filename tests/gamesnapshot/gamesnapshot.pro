@@ -0,0 +1,32 @@
+QT       += core gui testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_gamesnapshot
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../boardkernels.cpp \
+    ../../cell.cpp \
+    ../../game.cpp \
+    ../../gamearena.cpp \
+    ../../gamejournal.cpp \
+    ../../gamesnapshot.cpp \
+    ../../gamestatistics.cpp \
+    ../../tracing.cpp \
+    tst_gamesnapshot.cpp
+
+HEADERS += \
+    ../../boardkernels.h \
+    ../../boardlayout.h \
+    ../../boardplane.h \
+    ../../cell.h \
+    ../../game.h \
+    ../../gamearena.h \
+    ../../gameclock.h \
+    ../../gamejournal.h \
+    ../../gamesnapshot.h \
+    ../../gamestatistics.h \
+    ../../tracing.h
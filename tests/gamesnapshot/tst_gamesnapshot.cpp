@@ -0,0 +1,272 @@
+/**
+ * @file tst_gamesnapshot.cpp
+ * @brief Tests für das Spielstandsformat (gamesnapshot.h).
+ *
+ * Speichert laufende Spiele mit GameSnapshot::serialize() und lädt sie mit deserialize() in ein
+ * neues Game-Objekt. Dateien der Versionen 1 und 2 sowie beschädigte Dateien werden direkt im
+ * Speicher nach der Formatbeschreibung erzeugt.
+ *
+ * @author Daniel Schukin
+ */
+
+#include "game.h"
+#include "gamesnapshot.h"
+#include <QtEndian>
+#include <QtTest>
+#include <cstring>
+
+static constexpr int CHECKSUM_OFFSET = 32; ///< Lage der Prüfsumme im Kopf, siehe gamesnapshot.h.
+
+/**
+ * @brief Erzeugt ein laufendes Spiel mit aufgedeckten, markierten und falsch markierten Zellen.
+ * @param game Zielspiel.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @param minesNumber Anzahl der Minen.
+ * @param seed Seed des Spielfelds.
+ * @param open True, wenn die mittlere Zelle geöffnet werden soll.
+ */
+static void setupGame(Game &game, int length, int width, int minesNumber, quint64 seed, bool open) {
+    game.setStatisticsEnabled(false);
+    game.changeLength(length);
+    game.changeWidth(width);
+    game.changeMinesNumber(minesNumber);
+    game.setSafeOpening(true);
+    game.createMatrix(length, width);
+    game.place_mines(seed);
+    game.count_mines_around();
+    game.resetMarkedCells();
+    if (open) {
+        game.open_cell(length / 2, width / 2);
+    }
+    for (int row = 0; row < length; row += 3) {
+        for (int col = row % 5; col < width; col += 5) {
+            game.mark_cell(row, col);
+        }
+    }
+    game.setElapsedTime(12345);
+}
+
+/**
+ * @brief Vergleicht Spielfeld und Zähler zweier Spiele.
+ * @param actual Geladenes Spiel.
+ * @param expected Gespeichertes Spiel.
+ * @return True, wenn alle Zellen und Zähler übereinstimmen.
+ */
+static bool sameGame(const Game &actual, const Game &expected) {
+    if (actual.getLength() != expected.getLength() || actual.getWidth() != expected.getWidth()
+        || actual.getMinesNumber() != expected.getMinesNumber() || actual.getSafeRevealed() != expected.getSafeRevealed()
+        || actual.getCorrectFlags() != expected.getCorrectFlags() || actual.getWrongFlags() != expected.getWrongFlags()
+        || actual.is_safeOpening() != expected.is_safeOpening() || actual.getElapsedTime() != expected.getElapsedTime()) {
+        return false;
+    }
+    for (int row = 0; row < expected.getLength(); row++) {
+        for (int col = 0; col < expected.getWidth(); col++) {
+            if (actual.getCellStatus(row, col) != expected.getCellStatus(row, col)
+                || actual.getCellMinesNumber(row, col) != expected.getCellMinesNumber(row, col)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Trägt die Prüfsumme in einen Spielstand ein.
+ * @param data Spielstand; die Prüfsumme wird mit 0 an ihrer Stelle berechnet.
+ */
+static void seal(QByteArray &data) {
+    uchar *bytes = reinterpret_cast<uchar *>(data.data());
+    std::memset(bytes + CHECKSUM_OFFSET, 0, 8);
+    qToLittleEndian<quint64>(GameSnapshot::checksum(bytes, data.size()), bytes + CHECKSUM_OFFSET);
+}
+
+/**
+ * @brief Erzeugt einen Spielstand im Bitebenenformat bis Version 2.
+ * @param game Zu speicherndes Spiel.
+ * @param version 1 (Spielzeit in Sekunden) oder 2.
+ * @return Inhalt der Datei.
+ */
+static QByteArray serializePlanes(const Game &game, quint16 version) {
+    const qint64 cells = qint64(game.getLength()) * game.getWidth();
+    const qint64 plane = (cells + 63) / 64 * 8;
+    QByteArray data = GameSnapshot::serialize(game).left(GameSnapshot::HEADER_SIZE);
+    data.append(QByteArray(int(4 * plane), '\0'));
+    uchar *bytes = reinterpret_cast<uchar *>(data.data());
+    qToLittleEndian<quint16>(version, bytes + 4);
+    if (version == 1) {
+        qToLittleEndian<qint32>(qint32(game.getElapsedTime() / 1000), bytes + 20);
+    }
+    uchar *planes = bytes + GameSnapshot::HEADER_SIZE;
+    for (qint64 i = 0; i < cells; i++) {
+        const int status = game.getCellStatus(int(i / game.getWidth()), int(i % game.getWidth()));
+        const bool bits[4] = {!(status & 0x1), bool(status & 0x2), bool(status & 0x4), bool(status & 0x8)};
+        for (int p = 0; p < 4; p++) {
+            planes[p * plane + i / 8] |= uchar(bits[p]) << (i % 8); ///< Little-Endian-Wörter: Bit i liegt in Byte i / 8
+        }
+    }
+    seal(data);
+    return data;
+}
+
+/**
+ * @class TestGameSnapshot
+ * @brief Rundreise-, Abschneide- und Beschädigungstests für Spielstände.
+ *
+ * @author Daniel Schukin
+ */
+class TestGameSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void firstClickRoundTrip();
+    void planeVersions();
+    void truncated();
+    void corruptBytes();
+    void corruptHeader();
+};
+
+/**
+ * @brief Spielfeldgrößen für roundTrip(): Rest unter 8 Zellen und mehr als 255 Wörter.
+ */
+void TestGameSnapshot::roundTrip_data() {
+    QTest::addColumn<int>("length");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("minesNumber");
+    QTest::newRow("1x1") << 1 << 1 << 0;
+    QTest::newRow("7x9") << 7 << 9 << 10;
+    QTest::newRow("50x61") << 50 << 61 << 400;
+    QTest::newRow("300x301") << 300 << 301 << 12000;
+}
+
+/**
+ * @brief Ein gespeichertes Spiel lädt mit denselben Zellen und Zählern und speichert sich gleich.
+ */
+void TestGameSnapshot::roundTrip() {
+    QFETCH(int, length);
+    QFETCH(int, width);
+    QFETCH(int, minesNumber);
+    Game saved;
+    setupGame(saved, length, width, minesNumber, 7, true);
+    const QByteArray data = GameSnapshot::serialize(saved);
+    QCOMPARE(data.size(), GameSnapshot::HEADER_SIZE + length * width);
+
+    Game loaded;
+    loaded.setStatisticsEnabled(false);
+    QVERIFY(GameSnapshot::deserialize(loaded, reinterpret_cast<const uchar *>(data.constData()), data.size()));
+    QVERIFY(sameGame(loaded, saved));
+    QVERIFY(GameSnapshot::serialize(loaded) == data);
+}
+
+/**
+ * @brief Vor dem ersten Klick bleibt dieser nach dem Laden geschützt.
+ */
+void TestGameSnapshot::firstClickRoundTrip() {
+    Game saved;
+    setupGame(saved, 16, 16, 40, 3, false);
+    const QByteArray data = GameSnapshot::serialize(saved);
+    QVERIFY(qFromLittleEndian<quint16>(reinterpret_cast<const uchar *>(data.constData()) + 6)
+            & GameSnapshot::FLAG_FIRST_CLICK);
+
+    Game loaded;
+    loaded.setStatisticsEnabled(false);
+    QVERIFY(GameSnapshot::deserialize(loaded, reinterpret_cast<const uchar *>(data.constData()), data.size()));
+    QVERIFY(GameSnapshot::serialize(loaded) == data);
+    loaded.open_cell(8, 8);
+    QVERIFY(loaded.getCellStatus(8, 8) & 0x1);
+    QVERIFY(!(loaded.getCellStatus(8, 8) & 0x4));
+}
+
+/**
+ * @brief Dateien mit Bitebenen (Version 1 und 2) laden weiter; die Minenzahlen werden berechnet.
+ */
+void TestGameSnapshot::planeVersions() {
+    Game saved;
+    setupGame(saved, 37, 41, 200, 11, true);
+    saved.setElapsedTime(9000); ///< ganze Sekunden, damit auch Version 1 sie genau speichert
+    for (quint16 version = 1; version <= 2; version++) {
+        const QByteArray data = serializePlanes(saved, version);
+        Game loaded;
+        loaded.setStatisticsEnabled(false);
+        QVERIFY(GameSnapshot::deserialize(loaded, reinterpret_cast<const uchar *>(data.constData()), data.size()));
+        QVERIFY(sameGame(loaded, saved));
+    }
+}
+
+/**
+ * @brief Jede abgeschnittene oder verlängerte Datei wird abgelehnt, ohne das Spiel zu verändern.
+ */
+void TestGameSnapshot::truncated() {
+    Game saved;
+    setupGame(saved, 9, 13, 20, 5, true);
+    QByteArray data = GameSnapshot::serialize(saved);
+    Game loaded;
+    setupGame(loaded, 4, 4, 3, 1, false);
+    for (int size = 0; size < data.size(); size++) {
+        QVERIFY(!GameSnapshot::deserialize(loaded, reinterpret_cast<const uchar *>(data.constData()), size));
+        QCOMPARE(loaded.getLength(), 4);
+    }
+    data.append('\0');
+    QVERIFY(!GameSnapshot::deserialize(loaded, reinterpret_cast<const uchar *>(data.constData()), data.size()));
+    QVERIFY(!GameSnapshot::deserialize(loaded, nullptr, 0));
+    QCOMPARE(loaded.getLength(), 4);
+}
+
+/**
+ * @brief Jedes geänderte Byte fällt über Kopf, Größe oder Prüfsumme auf.
+ */
+void TestGameSnapshot::corruptBytes() {
+    Game saved;
+    setupGame(saved, 6, 11, 12, 9, true);
+    const QByteArray data = GameSnapshot::serialize(saved);
+    Game loaded;
+    setupGame(loaded, 4, 4, 3, 1, false);
+    for (int i = 0; i < data.size(); i++) {
+        for (const uchar mask : {uchar(0x01), uchar(0x80), uchar(0xff)}) {
+            QByteArray corrupt = data;
+            corrupt[i] = char(uchar(corrupt.at(i)) ^ mask);
+            QVERIFY(!GameSnapshot::deserialize(loaded, reinterpret_cast<const uchar *>(corrupt.constData()),
+                                               corrupt.size()));
+        }
+    }
+    QCOMPARE(loaded.getLength(), 4);
+}
+
+/**
+ * @brief Köpfe mit unbekannter Version oder ungültigen Maßen werden trotz passender Prüfsumme abgelehnt.
+ */
+void TestGameSnapshot::corruptHeader() {
+    Game saved;
+    setupGame(saved, 6, 11, 12, 9, true);
+    const QByteArray data = GameSnapshot::serialize(saved);
+    const struct { int offset; qint32 value; bool wide; } fields[] = {
+        {4, 0, false},                             ///< Version 0
+        {4, GameSnapshot::VERSION + 1, false},     ///< unbekannte Version
+        {8, 0, true},                              ///< keine Zeilen
+        {12, -11, true},                           ///< negative Spaltenzahl
+        {16, -1, true},                            ///< negative Minenzahl
+        {16, 6 * 11 + 1, true},                    ///< mehr Minen als Zellen
+        {20, -1, true},                            ///< negative Spielzeit
+    };
+    Game loaded;
+    loaded.setStatisticsEnabled(false);
+    for (const auto &field : fields) {
+        QByteArray corrupt = data;
+        uchar *bytes = reinterpret_cast<uchar *>(corrupt.data());
+        if (field.wide) {
+            qToLittleEndian<qint32>(field.value, bytes + field.offset);
+        } else {
+            qToLittleEndian<quint16>(quint16(field.value), bytes + field.offset);
+        }
+        seal(corrupt);
+        QVERIFY(!GameSnapshot::deserialize(loaded, bytes, corrupt.size()));
+    }
+    QVERIFY(GameSnapshot::deserialize(loaded, reinterpret_cast<const uchar *>(data.constData()), data.size()));
+}
+
+QTEST_GUILESS_MAIN(TestGameSnapshot)
+
+#include "tst_gamesnapshot.moc"
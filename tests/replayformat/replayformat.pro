@@ -0,0 +1,35 @@
+QT       += core gui concurrent testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_replayformat
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../boardkernels.cpp \
+    ../../cell.cpp \
+    ../../game.cpp \
+    ../../gamearena.cpp \
+    ../../gamejournal.cpp \
+    ../../gamestatistics.cpp \
+    ../../replayplayer.cpp \
+    ../../replayrecorder.cpp \
+    ../../tracing.cpp \
+    tst_replayformat.cpp
+
+HEADERS += \
+    ../../boardkernels.h \
+    ../../boardlayout.h \
+    ../../boardplane.h \
+    ../../cell.h \
+    ../../game.h \
+    ../../gamearena.h \
+    ../../gameclock.h \
+    ../../gamejournal.h \
+    ../../gamestatistics.h \
+    ../../replayformat.h \
+    ../../replayplayer.h \
+    ../../replayrecorder.h \
+    ../../tracing.h
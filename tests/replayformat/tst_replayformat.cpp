@@ -0,0 +1,243 @@
+/**
+ * @file tst_replayformat.cpp
+ * @brief Tests für das Aufzeichnungsformat (replayformat.h).
+ *
+ * Schreibt Aufzeichnungen mit ReplayRecorder und liest sie mit ReplayPlayer zurück. Abgeschnittene
+ * und beschädigte Dateien werden direkt im Speicher nach der Formatbeschreibung erzeugt.
+ *
+ * @author Daniel Schukin
+ */
+
+#include "replayformat.h"
+#include "replayplayer.h"
+#include "replayrecorder.h"
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest>
+#include <cstring>
+
+/**
+ * @brief Erzeugt den Kopf einer Aufzeichnung.
+ * @param length Anzahl der Zeilen.
+ * @param width Anzahl der Spalten.
+ * @param minesNumber Anzahl der Minen.
+ * @param version Formatversion.
+ * @return Kopf mit ReplayFormat::HEADER_SIZE Bytes.
+ */
+static QByteArray header(int length, int width, int minesNumber, quint16 version = ReplayFormat::VERSION) {
+    uchar bytes[ReplayFormat::HEADER_SIZE];
+    std::memcpy(bytes, ReplayFormat::MAGIC, sizeof(ReplayFormat::MAGIC));
+    qToLittleEndian<quint16>(version, bytes + 4);
+    qToLittleEndian<quint16>(0, bytes + 6);
+    qToLittleEndian<qint32>(length, bytes + 8);
+    qToLittleEndian<qint32>(width, bytes + 12);
+    qToLittleEndian<qint32>(minesNumber, bytes + 16);
+    qToLittleEndian<quint64>(42, bytes + 20);
+    return QByteArray(reinterpret_cast<const char *>(bytes), ReplayFormat::HEADER_SIZE);
+}
+
+/**
+ * @brief Hängt eine Aktion wie ReplayRecorder an.
+ * @param data Aufzeichnung.
+ * @param action Art der Aktion.
+ * @param argument Zweiter Varint, falls die Aktion einen hat.
+ * @param timeDelta Zeit seit der letzten Aktion in ms.
+ */
+static void appendAction(QByteArray &data, ReplayFormat::Action action, quint64 argument = 0, quint64 timeDelta = 0) {
+    uchar bytes[20];
+    int n = ReplayFormat::putVarint(bytes, timeDelta << ReplayFormat::ACTION_BITS | action);
+    if (ReplayFormat::hasArgument(action)) {
+        n += ReplayFormat::putVarint(bytes + n, argument);
+    }
+    data.append(reinterpret_cast<const char *>(bytes), n);
+}
+
+/**
+ * @class TestReplayFormat
+ * @brief Rundreise-, Abschneide- und Beschädigungstests für Aufzeichnungen.
+ *
+ * @author Daniel Schukin
+ */
+class TestReplayFormat : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void varintRoundTrip();
+    void varintTruncated();
+    void varintTooLong();
+    void recorderRoundTrip();
+    void truncatedHeader();
+    void truncatedAction();
+    void corruptHeader();
+    void corruptCellIndex();
+};
+
+/**
+ * @brief Varints an den Grenzen der 7-Bit-Gruppen lesen sich so zurück, wie sie geschrieben wurden.
+ */
+void TestReplayFormat::varintRoundTrip() {
+    const quint64 values[] = {0, 1, 127, 128, 16383, 16384, quint64(1) << 35, ~quint64(0)};
+    for (quint64 value : values) {
+        uchar bytes[10];
+        const int n = ReplayFormat::putVarint(bytes, value);
+        const uchar *pos = bytes;
+        quint64 read = 0;
+        QVERIFY(ReplayFormat::getVarint(pos, bytes + n, read));
+        QCOMPARE(read, value);
+        QCOMPARE(int(pos - bytes), n);
+    }
+}
+
+/**
+ * @brief Ein Varint ohne sein letztes Byte wird abgelehnt.
+ */
+void TestReplayFormat::varintTruncated() {
+    uchar bytes[10];
+    const int n = ReplayFormat::putVarint(bytes, 300);
+    QCOMPARE(n, 2);
+    const uchar *pos = bytes;
+    quint64 read = 0;
+    QVERIFY(!ReplayFormat::getVarint(pos, bytes + n - 1, read));
+}
+
+/**
+ * @brief Ein Varint mit mehr als 64 Bit wird abgelehnt, auch wenn noch Bytes folgen.
+ */
+void TestReplayFormat::varintTooLong() {
+    uchar bytes[12];
+    std::memset(bytes, 0xff, sizeof(bytes));
+    bytes[11] = 0x01;
+    const uchar *pos = bytes;
+    quint64 read = 0;
+    QVERIFY(!ReplayFormat::getVarint(pos, bytes + sizeof(bytes), read));
+}
+
+/**
+ * @brief Eine mit ReplayRecorder geschriebene Datei liest ReplayPlayer vollständig zurück.
+ */
+void TestReplayFormat::recorderRoundTrip() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filePath = dir.filePath("round-trip.u3r");
+
+    ReplayRecorder recorder;
+    recorder.start(9, 11, 10, 0x123456789abcdefULL, ReplayFormat::FLAG_SAFE_OPENING, filePath);
+    QVERIFY(recorder.is_recording());
+    recorder.record(ReplayFormat::OPEN, 3, 4);
+    recorder.record(ReplayFormat::MARK, 8, 10);
+    recorder.record(ReplayFormat::UNMARK, 0, 0);
+    recorder.record(ReplayFormat::UNDO);
+    recorder.record(ReplayFormat::REDO);
+    recorder.record(ReplayFormat::PAUSE);
+    recorder.record(ReplayFormat::RESIGN);
+    recorder.recordResult(true, 123456);
+    recorder.finish();
+    QVERIFY(!recorder.is_recording());
+
+    ReplayPlayer player;
+    QVERIFY(player.load(filePath));
+    QCOMPARE(player.getVersion(), ReplayFormat::VERSION);
+    QCOMPARE(player.getLength(), 9);
+    QCOMPARE(player.getWidth(), 11);
+    QCOMPARE(player.getMinesNumber(), 10);
+    QCOMPARE(player.getSeed(), 0x123456789abcdefULL);
+    QVERIFY(player.is_safeOpening());
+
+    const struct { ReplayFormat::Action action; int row; int col; } expected[] = {
+        {ReplayFormat::OPEN, 3, 4}, {ReplayFormat::MARK, 8, 10}, {ReplayFormat::UNMARK, 0, 0},
+        {ReplayFormat::UNDO, 0, 0}, {ReplayFormat::REDO, 0, 0}, {ReplayFormat::PAUSE, 0, 0},
+        {ReplayFormat::RESIGN, 0, 0}, {ReplayFormat::RESULT, 0, 0},
+    };
+    ReplayPlayer::Record record;
+    for (const auto &action : expected) {
+        QVERIFY(player.next(record));
+        QCOMPARE(record.action, action.action);
+        QCOMPARE(record.row, action.row);
+        QCOMPARE(record.col, action.col);
+        QVERIFY(record.timeDelta >= 0);
+    }
+    QVERIFY(record.won);
+    QCOMPARE(record.elapsedTime, qint64(123456));
+    QVERIFY(!player.next(record));
+    QVERIFY(player.atEnd());
+}
+
+/**
+ * @brief Jeder zu kurze Kopf wird abgelehnt.
+ */
+void TestReplayFormat::truncatedHeader() {
+    const QByteArray data = header(9, 9, 10);
+    for (int size = 0; size < ReplayFormat::HEADER_SIZE; size++) {
+        ReplayPlayer player;
+        QVERIFY(!player.open(QByteArray(data.constData(), size)));
+    }
+    ReplayPlayer player;
+    QVERIFY(player.open(data));
+    QVERIFY(player.atEnd());
+}
+
+/**
+ * @brief Eine beim Absturz abgeschnittene letzte Aktion wird verworfen, die davor bleiben lesbar.
+ */
+void TestReplayFormat::truncatedAction() {
+    QByteArray data = header(100, 200, 10);
+    appendAction(data, ReplayFormat::OPEN, 1 * 200 + 2, 5);
+    const int complete = data.size();
+    appendAction(data, ReplayFormat::MARK, 99 * 200 + 199, 300);
+    for (int size = complete + 1; size < data.size(); size++) {
+        ReplayPlayer player;
+        QVERIFY(player.open(QByteArray(data.constData(), size)));
+        ReplayPlayer::Record record;
+        QVERIFY(player.next(record));
+        QCOMPARE(record.action, ReplayFormat::OPEN);
+        QCOMPARE(record.timeDelta, qint64(5));
+        QCOMPARE(record.row, 1);
+        QCOMPARE(record.col, 2);
+        QVERIFY(!player.next(record));
+        QVERIFY(!player.atEnd());
+    }
+}
+
+/**
+ * @brief Köpfe mit falscher Kennung, Version oder Spielfeldgröße werden abgelehnt.
+ */
+void TestReplayFormat::corruptHeader() {
+    ReplayPlayer player;
+    QByteArray data = header(9, 9, 10);
+    data[0] = 'X';
+    QVERIFY(!player.open(data));
+    QVERIFY(!player.open(header(9, 9, 10, 0)));
+    QVERIFY(!player.open(header(9, 9, 10, ReplayFormat::VERSION + 1)));
+    QVERIFY(!player.open(header(0, 9, 10)));
+    QVERIFY(!player.open(header(9, -1, 10)));
+    QVERIFY(!player.open(header(9, 9, -1)));
+    QVERIFY(!player.open(header(9, 9, 82)));
+    QVERIFY(player.open(header(9, 9, 81)));
+}
+
+/**
+ * @brief Ein Zellindex außerhalb des Spielfelds und ein überlanger Varint beenden das Lesen.
+ */
+void TestReplayFormat::corruptCellIndex() {
+    QByteArray data = header(9, 9, 10);
+    appendAction(data, ReplayFormat::OPEN, 80);
+    appendAction(data, ReplayFormat::OPEN, 81);
+    ReplayPlayer player;
+    QVERIFY(player.open(data));
+    ReplayPlayer::Record record;
+    QVERIFY(player.next(record));
+    QCOMPARE(record.row, 8);
+    QCOMPARE(record.col, 8);
+    QVERIFY(!player.next(record));
+    QVERIFY(!player.atEnd());
+
+    data = header(9, 9, 10);
+    data.append(QByteArray(11, char(0xff)));
+    QVERIFY(player.open(data));
+    QVERIFY(!player.next(record));
+}
+
+QTEST_GUILESS_MAIN(TestReplayFormat)
+
+#include "tst_replayformat.moc"
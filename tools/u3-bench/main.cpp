@@ -0,0 +1,166 @@
+/**
+ * @file main.cpp
+ * @brief Kommandozeilenprogramm zum Messen der Spielfeldschleifen.
+ *
+ * Aufruf: u3-bench [-r Wiederholungen] [-s Seed] Länge Breite Minen
+ *
+ * Misst ohne Oberfläche die Schritte, deren Laufzeit mit der Spielfeldgröße wächst: ein neues
+ * Spielfeld anlegen, Nachbarminen zählen, Öffnungen beschriften, den ersten Klick samt Kaskade,
+ * Speichern und Laden eines Spielstands sowie das Füllen der Anzeigeebene nach dem Laden.
+ * Jeder Schritt läuft mit Wiederholung i auf dem Spielfeld mit Seed + i; ausgegeben werden
+ * Median und Minimum in Millisekunden.
+ *
+ * Gemessen wird in einem Thread; für vergleichbare Zahlen mit -O2 bauen und die anderen Kerne
+ * möglichst ruhig halten. Die Gewinnrate und den Durchsatz des Solvers misst u3-sim.
+ *
+ * @author Daniel Schukin
+ */
+
+#include "boardplane.h"
+#include "game.h"
+#include "gamesnapshot.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+
+/// @brief Zu messende Konfiguration.
+struct Config
+{
+    int length = 0;      ///< Anzahl der Zeilen.
+    int width = 0;       ///< Anzahl der Spalten.
+    int minesNumber = 0; ///< Anzahl der Minen.
+    int repeats = 5;     ///< Wiederholungen pro Schritt.
+    quint64 seed = 1;    ///< Grundseed.
+};
+
+/// @brief Ergebnis eines Schritts.
+struct Timing
+{
+    double median = 0.0; ///< Median der Laufzeiten in ms.
+    double min = 0.0;    ///< Kürzeste Laufzeit in ms.
+};
+
+/**
+ * @brief Legt ein Spielfeld wie ReplayPlayer::setupGame() an.
+ * @param game Zielspiel.
+ * @param config Konfiguration.
+ * @param seed Seed des Spielfelds.
+ */
+static void setupBoard(Game &game, const Config &config, quint64 seed) {
+    game.createMatrix(config.length, config.width);
+    game.place_mines(seed);
+    game.count_mines_around();
+    game.resetMarkedCells();
+}
+
+/**
+ * @brief Misst einen Schritt mehrmals.
+ * @param config Konfiguration.
+ * @param prepare Wird vor jeder Messung mit dem Seed aufgerufen und nicht mitgemessen.
+ * @param work Gemessener Schritt, erhält denselben Seed.
+ * @return Median und Minimum der Laufzeiten.
+ */
+static Timing measure(const Config &config, const std::function<void(quint64)> &prepare,
+                      const std::function<void(quint64)> &work) {
+    QVector<double> times;
+    for (int repeat = 0; repeat < config.repeats; repeat++) {
+        const quint64 seed = config.seed + quint64(repeat);
+        prepare(seed);
+        QElapsedTimer clock;
+        clock.start();
+        work(seed);
+        times.append(clock.nsecsElapsed() / 1e6);
+    }
+    std::sort(times.begin(), times.end());
+    return Timing{times.at(times.size() / 2), times.first()};
+}
+
+/**
+ * @brief Hauptfunktion des Messprogramms.
+ * @param argc Anzahl der Kommandozeilenargumente.
+ * @param argv Array der Kommandozeilenargumente.
+ * @return 0 bei Erfolg; 1, wenn ein gespeicherter Spielstand nicht geladen werden kann; 2 bei falschem Aufruf.
+ *
+ * @author Daniel Schukin
+ */
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QStringList args = app.arguments().mid(1);
+
+    Config config;
+    while (!args.isEmpty() && args[0].startsWith("-")) {
+        const QString option = args.takeFirst();
+        if (!args.isEmpty() && option == "-r") {
+            config.repeats = qMax(1, args.takeFirst().toInt());
+        } else if (!args.isEmpty() && option == "-s") {
+            config.seed = args.takeFirst().toULongLong();
+        } else {
+            args.clear(); ///< unbekannte Option
+        }
+    }
+    if (args.size() == 3) {
+        config.length = args[0].toInt();
+        config.width = args[1].toInt();
+        config.minesNumber = args[2].toInt();
+    }
+    if (config.length < 1 || config.width < 1 || config.minesNumber < 1
+        || config.minesNumber >= qint64(config.length) * config.width) {
+        out << "usage: u3-bench [-r repeats] [-s seed] <length> <width> <mines>\n";
+        return 2;
+    }
+
+    Game game;
+    game.setStatisticsEnabled(false);
+    game.changeLength(config.length);
+    game.changeWidth(config.width);
+    game.changeMinesNumber(config.minesNumber);
+    game.setSafeOpening(true);
+    const auto none = [](quint64) {};
+    const auto board = [&](quint64 seed) { setupBoard(game, config, seed); };
+
+    out << config.length << "x" << config.width << " with " << config.minesNumber << " mines, "
+        << config.repeats << " repeats from seed " << config.seed << "\n";
+    out.setRealNumberPrecision(4);
+    const auto report = [&](const char *name, const Timing &timing) {
+        out << name << ": median " << timing.median << " ms, min " << timing.min << " ms\n";
+        out.flush();
+    };
+
+    report("new board", measure(config, none, board));
+    report("count_mines_around", measure(config, board, [&](quint64) { game.count_mines_around(); }));
+    report("label_openings", measure(config, board, [&](quint64) { game.label_openings(); }));
+    report("first click", measure(config, board, [&](quint64) { game.open_cell(config.length / 2, config.width / 2); }));
+
+    ///< Spielstand nach dem ersten Klick, damit aufgedeckte und verdeckte Zellen gemischt sind
+    QByteArray snapshot;
+    report("snapshot serialize", measure(config, [&](quint64 seed) {
+        board(seed);
+        game.open_cell(config.length / 2, config.width / 2);
+    }, [&](quint64) { snapshot = GameSnapshot::serialize(game); }));
+    bool loaded = true;
+    report("snapshot deserialize", measure(config, none, [&](quint64) {
+        loaded = GameSnapshot::deserialize(game, reinterpret_cast<const uchar *>(snapshot.constData()),
+                                           snapshot.size()) && loaded;
+    }));
+    if (!loaded) {
+        out << "snapshot could not be loaded\n";
+        return 1;
+    }
+
+    ///< wie GameEngine nach LOAD_SNAPSHOT
+    BoardPlane plane;
+    report("plane fill", measure(config, none, [&](quint64) {
+        plane.reset(config.length, config.width);
+        for (int row = 0; row < config.length; row++) {
+            for (int col = 0, count = 0; col < config.width; col += count) {
+                quint8 *codes = plane.rowData(row, col, count);
+                game.getCellCodes(row, col, count, codes);
+            }
+        }
+    }));
+    out << "snapshot size " << snapshot.size() / 1024 << " KiB\n";
+    return 0;
+}
@@ -0,0 +1,33 @@
+QT       += core gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = u3-bench
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../boardkernels.cpp \
+    ../../boardplane.cpp \
+    ../../cell.cpp \
+    ../../game.cpp \
+    ../../gamearena.cpp \
+    ../../gamejournal.cpp \
+    ../../gamesnapshot.cpp \
+    ../../gamestatistics.cpp \
+    ../../tracing.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../boardkernels.h \
+    ../../boardlayout.h \
+    ../../boardplane.h \
+    ../../cell.h \
+    ../../game.h \
+    ../../gamearena.h \
+    ../../gameclock.h \
+    ../../gamejournal.h \
+    ../../gamesnapshot.h \
+    ../../gamestatistics.h \
+    ../../tracing.h
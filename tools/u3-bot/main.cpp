@@ -0,0 +1,403 @@
+/**
+ * @file main.cpp
+ * @brief Beispiel-Bot und Lastprogramm für das Bot-Protokoll (siehe botprotocol.h).
+ *
+ * Aufruf: u3-bot [-s Server] [-n Spiele] [-r Seed] [--random [-b Aktionen] [-p Tiefe]] Länge Breite Minen
+ *
+ * Verbindet sich mit einem laufenden `U3 --serve` und spielt dort Spiele:
+ * - ohne --random spielt GameSolver, ein Zug pro Anfrage; das misst die Zeit pro Round-Trip.
+ * - mit --random werden zufällige Zellen geöffnet, -b Aktionen pro Anfrage und bis zu -p
+ *   Anfragen unterwegs, ohne auf die Antworten zu warten; das misst den Durchsatz.
+ *
+ * Ausgegeben werden Spiele, Gewinnrate, Züge pro Sekunde, Anfragen und Bytes pro Zug.
+ *
+ * @author Daniel Schukin
+ */
+
+#include "botprotocol.h"
+#include "gamesolver.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QVector>
+
+static constexpr int TIMEOUT = 30000; ///< Längste Wartezeit auf den Server in ms.
+
+/// @brief Konfiguration eines Laufs.
+struct Config
+{
+    QString server = BotProtocol::DEFAULT_SERVER; ///< Name des lokalen Sockets.
+    int length = 0;       ///< Anzahl der Zeilen.
+    int width = 0;        ///< Anzahl der Spalten.
+    int minesNumber = 0;  ///< Anzahl der Minen.
+    qint64 games = 1000;  ///< Anzahl der Spiele.
+    quint64 seed = 1;     ///< Seed des ersten Spiels; Spiel i hat den Seed seed + i.
+    bool random = false;  ///< Zufällige Züge mit Pipelining statt GameSolver.
+    int batch = 64;       ///< Aktionen pro Anfrage (nur --random).
+    int depth = 8;        ///< Höchstens gleichzeitig unterwegs befindliche Anfragen (nur --random).
+};
+
+/// @brief Zähler eines Laufs.
+struct Tally
+{
+    qint64 games = 0;     ///< Beendete Spiele.
+    qint64 wins = 0;      ///< Gewonnene Spiele.
+    qint64 guesses = 0;   ///< Geratene Züge des Solvers.
+    qint64 actions = 0;   ///< Ausgeführte Aktionen.
+    qint64 effective = 0; ///< Aktionen, die ein laufendes Spiel trafen.
+    qint64 changed = 0;   ///< Gemeldete geänderte Zellen.
+    qint64 requests = 0;  ///< Gesendete ACTIONS-Anfragen.
+    qint64 sent = 0;      ///< Gesendete Bytes.
+    qint64 received = 0;  ///< Empfangene Bytes.
+};
+
+/// @brief Blockierende Verbindung zum Server.
+struct Connection
+{
+    QLocalSocket socket;  ///< Verbindung zum Server.
+    QByteArray input;     ///< Empfangene, noch nicht gelesene Bytes ab consumed.
+    int consumed = 0;     ///< Bereits gelesene Bytes am Anfang von input.
+    Tally *tally = nullptr; ///< Zählt die Bytes.
+
+    /**
+     * @brief Sendet Anfragen.
+     * @param requests Eine oder mehrere vollständige Nachrichten.
+     * @return False, wenn die Verbindung abgebrochen ist.
+     */
+    bool send(const QByteArray &requests) {
+        tally->sent += requests.size();
+        return socket.write(requests) == requests.size() && socket.flush();
+    }
+
+    /**
+     * @brief Wartet auf die nächste vollständige Antwort.
+     * @param type Gibt die Art der Antwort zurück.
+     * @param pos Gibt den Anfang des Inhalts zurück; gültig bis zum nächsten Aufruf.
+     * @param end Gibt das Ende der Antwort zurück.
+     * @return False bei Zeitüberschreitung, Verbindungsabbruch oder ungültiger Länge.
+     */
+    bool receive(BotProtocol::Request &type, const uchar *&pos, const uchar *&end) {
+        for (;;) {
+            const int available = input.size() - consumed;
+            if (available >= BotProtocol::LENGTH_SIZE) {
+                const quint32 length = qFromLittleEndian<quint32>(input.constData() + consumed);
+                if (length < 1 || length > quint32(BotProtocol::MAX_MESSAGE)) {
+                    return false;
+                }
+                if (quint32(available - BotProtocol::LENGTH_SIZE) >= length) {
+                    pos = reinterpret_cast<const uchar *>(input.constData()) + consumed + BotProtocol::LENGTH_SIZE;
+                    end = pos + length;
+                    type = BotProtocol::Request(*pos++);
+                    consumed += BotProtocol::LENGTH_SIZE + int(length);
+                    return true;
+                }
+            }
+            input.remove(0, consumed);
+            consumed = 0;
+            if (!socket.waitForReadyRead(TIMEOUT)) {
+                return false;
+            }
+            const QByteArray data = socket.readAll();
+            tally->received += data.size();
+            input.append(data.constData(), data.size());
+        }
+    }
+};
+
+/**
+ * @brief Hängt eine NEW_GAME-Anfrage an.
+ * @param requests Ausgabepuffer.
+ * @param config Konfiguration.
+ * @param seed Seed des Spiels.
+ */
+static void appendNewGame(QByteArray &requests, const Config &config, quint64 seed) {
+    const int start = BotProtocol::beginMessage(requests, BotProtocol::NEW_GAME);
+    BotProtocol::appendVarint(requests, quint64(config.length));
+    BotProtocol::appendVarint(requests, quint64(config.width));
+    BotProtocol::appendVarint(requests, quint64(config.minesNumber));
+    BotProtocol::appendVarint(requests, seed);
+    BotProtocol::appendVarint(requests, BotProtocol::FLAG_SAFE_OPENING);
+    BotProtocol::finishMessage(requests, start);
+}
+
+/**
+ * @brief Prüft die Antwort auf NEW_GAME.
+ * @param pos Anfang des Inhalts.
+ * @param end Ende der Antwort.
+ * @return True, wenn das Spielfeld erzeugt wurde.
+ */
+static bool newGameCreated(const uchar *pos, const uchar *end) {
+    return pos < end && *pos == BotProtocol::STATUS_OK;
+}
+
+/**
+ * @brief Liest die Antwort auf ACTIONS.
+ * @param pos Anfang des Inhalts.
+ * @param end Ende der Antwort.
+ * @param visible Anzeigecodes, in die die geänderten Zellen geschrieben werden; oder nullptr.
+ * @param cells Anzahl der Zellen des Spielfelds.
+ * @param changed Gibt die Indizes der geänderten Zellen zurück; oder nullptr.
+ * @param tally Zähler.
+ * @param state Gibt den Zustand nach der letzten Aktion zurück.
+ * @return False bei einer fehlerhaften Antwort.
+ */
+static bool readResults(const uchar *pos, const uchar *end, quint8 *visible, qint64 cells, QVector<qint32> *changed,
+                        Tally &tally, quint8 &state) {
+    bool running = true;
+    while (pos < end) {
+        state = *pos++;
+        quint64 count;
+        if (!ReplayFormat::getVarint(pos, end, count)) {
+            return false;
+        }
+        qint64 index = 0;
+        for (quint64 i = 0; i < count; i++) {
+            quint64 difference;
+            if (!ReplayFormat::getVarint(pos, end, difference) || pos == end) {
+                return false;
+            }
+            index += BotProtocol::unzigzag(difference);
+            if (index < 0 || index >= cells) {
+                return false;
+            }
+            const quint8 code = *pos++;
+            if (visible != nullptr) {
+                visible[index] = code;
+            }
+            if (changed != nullptr) {
+                changed->append(qint32(index));
+            }
+        }
+        tally.actions++;
+        tally.effective += running;
+        tally.changed += qint64(count);
+        running = running && (state & BotProtocol::STATE_IN_GAME);
+    }
+    return true;
+}
+
+/**
+ * @brief Lässt GameSolver Spiele spielen, ein Zug pro Anfrage.
+ * @param connection Verbindung.
+ * @param config Konfiguration.
+ * @param tally Zähler.
+ * @return False bei einem Protokollfehler.
+ *
+ * Der Solver bekommt nach jedem Zug nur die geänderten Zellen aus der Antwort. Gewonnen ist ein
+ * Spiel erst, wenn auch alle Minen markiert sind (siehe Game::is_boardComplete()); sind nur
+ * noch Minen verdeckt, markiert eine einzige Anfrage alle.
+ */
+static bool playSolver(Connection &connection, const Config &config, Tally &tally) {
+    const qint64 cells = qint64(config.length) * config.width;
+    GameSolver solver(config.length, config.width, config.minesNumber);
+    QVector<quint8> visible(int(cells), 0);
+    QVector<qint32> changed;
+    QByteArray requests;
+    BotProtocol::Request type;
+    const uchar *pos;
+    const uchar *end;
+    for (qint64 game = 0; game < config.games; game++) {
+        requests.clear();
+        appendNewGame(requests, config, config.seed + quint64(game));
+        if (!connection.send(requests) || !connection.receive(type, pos, end) || type != BotProtocol::NEW_GAME
+            || !newGameCreated(pos, end)) {
+            return false;
+        }
+        visible.fill(0);
+        solver.reset();
+        changed.clear();
+        bool first = true;
+        for (;;) {
+            const GameSolver::Move move = first ? solver.next(visible.constData())
+                                                : solver.next(visible.constData(), changed.constData(), changed.size());
+            first = false;
+            requests.clear();
+            const int start = BotProtocol::beginMessage(requests, BotProtocol::ACTIONS);
+            if (move.cell >= 0) {
+                tally.guesses += !move.safe;
+                BotProtocol::appendVarint(requests, 1);
+                BotProtocol::appendVarint(requests, quint64(move.cell) << ReplayFormat::ACTION_BITS | ReplayFormat::OPEN);
+            } else {
+                ///< nur noch Minen verdeckt: alle in einer Anfrage markieren, das beendet das Spiel
+                QVector<qint32> mines;
+                for (qint32 cell = 0; cell < qint32(cells); cell++) {
+                    if (visible.at(cell) == 0) {
+                        mines.append(cell);
+                    }
+                }
+                if (mines.isEmpty()) {
+                    break; ///< nur bei inkonsistenter Antwort; zählt als verloren
+                }
+                BotProtocol::appendVarint(requests, quint64(mines.size()));
+                for (const qint32 cell : mines) {
+                    BotProtocol::appendVarint(requests, quint64(cell) << ReplayFormat::ACTION_BITS | ReplayFormat::MARK);
+                }
+            }
+            BotProtocol::finishMessage(requests, start);
+            tally.requests++;
+            changed.clear();
+            quint8 state = 0;
+            if (!connection.send(requests) || !connection.receive(type, pos, end) || type != BotProtocol::ACTIONS
+                || !readResults(pos, end, visible.data(), cells, &changed, tally, state)) {
+                return false;
+            }
+            if (!(state & BotProtocol::STATE_IN_GAME)) {
+                tally.wins += (state & BotProtocol::STATE_WON) != 0;
+                break;
+            }
+        }
+        tally.games++;
+    }
+    return true;
+}
+
+/**
+ * @brief Öffnet zufällige Zellen mit mehreren Aktionen pro Anfrage und Pipelining.
+ * @param connection Verbindung.
+ * @param config Konfiguration.
+ * @param tally Zähler.
+ * @return False bei einem Protokollfehler.
+ *
+ * Es sind immer bis zu config.depth Anfragen unterwegs. Endet ein Spiel, laufen die schon
+ * gesendeten Anfragen noch gegen das beendete Spiel (der Server antwortet mit leeren
+ * Ergebnissen); danach folgt NEW_GAME in derselben Sendung wie die nächsten Anfragen.
+ */
+static bool playRandom(Connection &connection, const Config &config, Tally &tally) {
+    const qint64 cells = qint64(config.length) * config.width;
+    QRandomGenerator random(quint32(config.seed));
+    QByteArray requests;
+    appendNewGame(requests, config, config.seed);
+    int inFlight = 0; ///< gesendete ACTIONS-Anfragen ohne Antwort
+    int stale = 0;    ///< davon noch gegen ein beendetes Spiel gesendet
+    BotProtocol::Request type;
+    const uchar *pos;
+    const uchar *end;
+    for (;;) {
+        while (inFlight < config.depth && tally.games < config.games) {
+            const int start = BotProtocol::beginMessage(requests, BotProtocol::ACTIONS);
+            BotProtocol::appendVarint(requests, quint64(config.batch));
+            for (int i = 0; i < config.batch; i++) {
+                const quint64 cell = quint64(random.bounded(int(cells)));
+                BotProtocol::appendVarint(requests, cell << ReplayFormat::ACTION_BITS | ReplayFormat::OPEN);
+            }
+            BotProtocol::finishMessage(requests, start);
+            inFlight++;
+            tally.requests++;
+        }
+        if (!requests.isEmpty()) {
+            if (!connection.send(requests)) {
+                return false;
+            }
+            requests.clear();
+        }
+        if (inFlight == 0) {
+            return true;
+        }
+        if (!connection.receive(type, pos, end)) {
+            return false;
+        }
+        if (type == BotProtocol::NEW_GAME) {
+            if (!newGameCreated(pos, end)) {
+                return false;
+            }
+            continue;
+        }
+        quint8 state = BotProtocol::STATE_IN_GAME;
+        const qint64 effective = tally.effective;
+        if (type != BotProtocol::ACTIONS || !readResults(pos, end, nullptr, cells, nullptr, tally, state)) {
+            return false;
+        }
+        inFlight--;
+        if (stale > 0) {
+            stale--;
+            tally.effective = effective; ///< Aktionen auf dem beendeten Spiel zählen nicht
+            continue;
+        }
+        if (!(state & BotProtocol::STATE_IN_GAME)) {
+            tally.games++;
+            tally.wins += (state & BotProtocol::STATE_WON) != 0;
+            stale = inFlight;
+            if (tally.games < config.games) {
+                appendNewGame(requests, config, config.seed + quint64(tally.games));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Hauptfunktion des Bots.
+ * @param argc Anzahl der Kommandozeilenargumente.
+ * @param argv Array der Kommandozeilenargumente.
+ * @return 0 bei Erfolg; 1 bei Verbindungs- oder Protokollfehlern; 2 bei falschem Aufruf.
+ *
+ * @author Daniel Schukin
+ */
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QStringList args = app.arguments().mid(1);
+
+    Config config;
+    while (!args.isEmpty() && args[0].startsWith("-")) {
+        const QString option = args.takeFirst();
+        if (option == "--random") {
+            config.random = true;
+        } else if (!args.isEmpty() && option == "-s") {
+            config.server = args.takeFirst();
+        } else if (!args.isEmpty() && option == "-n") {
+            config.games = qMax<qint64>(1, args.takeFirst().toLongLong());
+        } else if (!args.isEmpty() && option == "-r") {
+            config.seed = args.takeFirst().toULongLong();
+        } else if (!args.isEmpty() && option == "-b") {
+            config.batch = qBound(1, args.takeFirst().toInt(), 1 << 16);
+        } else if (!args.isEmpty() && option == "-p") {
+            config.depth = qBound(1, args.takeFirst().toInt(), 1 << 10);
+        } else {
+            args.clear(); ///< unbekannte Option
+        }
+    }
+    if (args.size() == 3) {
+        config.length = args[0].toInt();
+        config.width = args[1].toInt();
+        config.minesNumber = args[2].toInt();
+    }
+    if (config.length < 1 || config.width < 1 || config.minesNumber < 1
+        || qint64(config.length) * config.width > BotProtocol::MAX_CELLS
+        || config.minesNumber >= config.length * config.width) {
+        out << "usage: u3-bot [-s server] [-n games] [-r seed] [--random [-b actions] [-p depth]] <length> <width> <mines>\n";
+        return 2;
+    }
+
+    Connection connection;
+    Tally tally;
+    connection.tally = &tally;
+    connection.socket.connectToServer(config.server);
+    if (!connection.socket.waitForConnected(TIMEOUT)) {
+        out << "cannot connect to " << config.server << ": " << connection.socket.errorString() << "\n";
+        return 1;
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    const bool valid = config.random ? playRandom(connection, config, tally) : playSolver(connection, config, tally);
+    const double seconds = qMax<qint64>(1, clock.nsecsElapsed()) / 1e9;
+    if (!valid) {
+        out << "protocol error after " << tally.games << " games: " << connection.socket.errorString() << "\n";
+        return 1;
+    }
+
+    out.setRealNumberPrecision(4);
+    out << config.length << "x" << config.width << " with " << config.minesNumber << " mines, " << tally.games
+        << (config.random ? " random games" : " solver games") << ", win rate " << 100.0 * tally.wins / tally.games
+        << "%\n"
+        << tally.actions / seconds << " actions/s (" << tally.effective / seconds << " on running games), "
+        << tally.requests / seconds << " requests/s, " << 1e6 * seconds / qMax<qint64>(1, tally.requests)
+        << " us/request\n"
+        << double(tally.actions) / qMax<qint64>(1, tally.requests) << " actions/request, "
+        << double(tally.changed) / qMax<qint64>(1, tally.actions) << " cells/action, "
+        << double(tally.sent) / qMax<qint64>(1, tally.actions) << " bytes sent/action, "
+        << double(tally.received) / qMax<qint64>(1, tally.changed) << " bytes received/cell\n";
+    return 0;
+}
@@ -0,0 +1,19 @@
+QT       += core network
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = u3-bot
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../gamesolver.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../boardlayout.h \
+    ../../boardplane.h \
+    ../../botprotocol.h \
+    ../../gamesolver.h \
+    ../../replayformat.h
@@ -0,0 +1,210 @@
+/**
+ * @file main.cpp
+ * @brief Zuschauer für Live-Mitschnitte (siehe DeltaRecorder).
+ *
+ * Aufruf: u3-delta [-f] [-i Intervall] [-t Sekunden] [--board] [Datei oder Ordner]
+ *
+ * Baut das Spielfeld aus einem Mitschnitt nach (Menü "Live-Mitschnitt", Standard: der neueste
+ * im Ordner "deltas") und gibt pro Zug und neuem Spielfeld eine Zeile aus, mit --board
+ * zusätzlich das Spielfeld. Mit -t springt es zum Stand nach so vielen Sekunden: die Datensätze
+ * davor werden ohne Dekodieren übersprungen, nachgespielt wird erst ab dem letzten
+ * vollständigen Stand. Mit -f liest es danach mit, während das Spiel die Datei fortschreibt.
+ *
+ * @author Daniel Schukin
+ */
+
+#include "deltaformat.h"
+#include "boardplane.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QtEndian>
+
+/**
+ * @brief Gibt das Spielfeld als Text aus.
+ * @param out Ausgabe.
+ * @param board Nachgebautes Spielfeld.
+ */
+static void printBoard(QTextStream &out, const DeltaFormat::Board &board) {
+    static const char OPEN_DIGITS[] = ".12345678";
+    for (int row = 0; row < board.length; row++) {
+        QByteArray line;
+        for (int col = 0; col < board.width; col++) {
+            const quint8 code = board.codes.at(row * board.width + col);
+            if (code >= BoardPlane::OPEN_CODE) {
+                line.append(OPEN_DIGITS[qMin(8, code - BoardPlane::OPEN_CODE)]);
+            } else if (code == 0) {
+                line.append('#');
+            } else if (code == 2) {
+                line.append('F');
+            } else {
+                line.append('*'); ///< aufgedeckte Mine oder falsche Markierung am Spielende
+            }
+        }
+        out << line << "\n";
+    }
+}
+
+/**
+ * @brief Gibt eine Zeile mit den Zählern aus.
+ * @param out Ausgabe.
+ * @param board Nachgebautes Spielfeld.
+ * @param what Art der Änderung.
+ */
+static void printState(QTextStream &out, const DeltaFormat::Board &board, const QString &what) {
+    out << QString::number(board.time / 1000.0, 'f', 3) << " s, board " << board.boards << " move " << board.moves
+        << ": " << board.length << "x" << board.width << ", " << board.markedCells << "/" << board.minesNumber
+        << " flags, " << board.elapsedTime / 1000 << " s, "
+        << (board.inGame ? "running" : board.won ? "won" : "over") << ", " << what << "\n";
+}
+
+/**
+ * @brief Sucht den Mitschnitt zu einem Pfad.
+ * @param path Datei oder Ordner.
+ * @return Die Datei selbst oder der neueste *.u3d-Mitschnitt im Ordner; leer, wenn es keinen gibt.
+ */
+static QString resolve(const QString &path) {
+    if (!QFileInfo(path).isDir()) {
+        return path;
+    }
+    const QFileInfoList files = QDir(path).entryInfoList(QStringList{"*.u3d"}, QDir::Files, QDir::Time);
+    return files.isEmpty() ? QString() : files.first().filePath();
+}
+
+/**
+ * @brief Hauptfunktion des Zuschauers.
+ * @param argc Anzahl der Kommandozeilenargumente.
+ * @param argv Array der Kommandozeilenargumente.
+ * @return 0 bei Erfolg; 1 bei einer fehlenden oder ungültigen Datei; 2 bei falschem Aufruf.
+ *
+ * @author Daniel Schukin
+ */
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QStringList args = app.arguments().mid(1);
+
+    QString path = "deltas";
+    bool follow = false;
+    bool boardOutput = false;
+    int interval = 16;
+    qint64 seekTime = -1;
+    while (!args.isEmpty()) {
+        const QString option = args.takeFirst();
+        if (option == "-f") {
+            follow = true;
+        } else if (option == "--board") {
+            boardOutput = true;
+        } else if (!args.isEmpty() && option == "-i") {
+            interval = qMax(1, args.takeFirst().toInt());
+        } else if (!args.isEmpty() && option == "-t") {
+            seekTime = qMax<qint64>(0, qint64(args.takeFirst().toDouble() * 1000));
+        } else if (!option.startsWith("-") && args.isEmpty()) {
+            path = option;
+        } else {
+            out << "usage: u3-delta [-f] [-i interval_ms] [-t seconds] [--board] [file or directory]\n";
+            return 2;
+        }
+    }
+
+    QFile file(resolve(path));
+    if (file.fileName().isEmpty() || !file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        out << "no delta stream: " << path << "\n";
+        return 1;
+    }
+    QByteArray data = file.readAll();
+    while (follow && data.size() < DeltaFormat::HEADER_SIZE) {
+        QThread::msleep(ulong(interval)); ///< der Kopf wird beim Einschalten sofort geschrieben
+        data.append(file.readAll());
+    }
+    const uchar *header = reinterpret_cast<const uchar *>(data.constData());
+    if (data.size() < DeltaFormat::HEADER_SIZE || std::memcmp(header, DeltaFormat::MAGIC, sizeof(DeltaFormat::MAGIC)) != 0
+        || qFromLittleEndian<quint16>(header + 4) != DeltaFormat::VERSION) {
+        out << "not a delta stream: " << file.fileName() << "\n";
+        return 1;
+    }
+    qint64 pos = DeltaFormat::HEADER_SIZE;
+
+    DeltaFormat::Board board;
+    DeltaFormat::Record record;
+    if (seekTime >= 0) {
+        ///< nur die Köpfe lesen, um den letzten vollständigen Stand vor dem Ziel zu finden
+        const uchar *begin = reinterpret_cast<const uchar *>(data.constData());
+        const uchar *end = begin + data.size();
+        qint64 keyframePos = -1;
+        quint64 keyframeTime = 0;
+        quint64 time = 0;
+        qint64 skipped = 0;
+        for (qint64 at = pos, size; (size = DeltaFormat::parseRecord(begin + at, end, record)) > 0; at += size) {
+            if (time + record.timeDelta > quint64(seekTime)) {
+                break;
+            }
+            if (record.kind != DeltaFormat::DELTA) {
+                keyframePos = at;
+                keyframeTime = time;
+            }
+            time += record.timeDelta;
+            skipped++;
+        }
+        if (keyframePos >= 0) {
+            pos = keyframePos;
+            board.time = keyframeTime;
+        }
+        int applied = 0;
+        for (qint64 size; (size = DeltaFormat::parseRecord(begin + pos, end, record)) > 0; pos += size) {
+            if (board.time + record.timeDelta > quint64(seekTime)) {
+                break;
+            }
+            if (!board.apply(record)) {
+                out << "invalid record at " << pos << "\n";
+                return 1;
+            }
+            applied++;
+        }
+        printState(out, board, QString("%1 records decoded, %2 skipped").arg(applied).arg(skipped - applied));
+        if (boardOutput && !board.codes.isEmpty()) {
+            printBoard(out, board);
+        }
+        out.flush();
+        if (!follow) {
+            return 0;
+        }
+    }
+
+    QVector<qint32> changed;
+    while (true) {
+        const uchar *begin = reinterpret_cast<const uchar *>(data.constData());
+        qint64 size;
+        while ((size = DeltaFormat::parseRecord(begin + pos, begin + data.size(), record)) > 0) {
+            changed.clear();
+            if (!board.apply(record, &changed)) {
+                out << "invalid record at " << pos << "\n";
+                return 1;
+            }
+            pos += size;
+            if (record.kind == DeltaFormat::KEYFRAME) {
+                continue; ///< ändert nichts am Stand
+            }
+            printState(out, board, record.kind == DeltaFormat::BOARD ? QString("new board")
+                                                                       : QString("%1 changed cells").arg(changed.size()));
+            if (boardOutput) {
+                printBoard(out, board);
+            }
+        }
+        if (size < 0) {
+            out << "invalid record at " << pos << "\n";
+            return 1;
+        }
+        out.flush();
+        if (!follow) {
+            return 0;
+        }
+        data.remove(0, int(pos)); ///< gelesene Datensätze verwerfen
+        pos = 0;
+        QThread::msleep(ulong(interval));
+        data.append(file.readAll());
+    }
+}
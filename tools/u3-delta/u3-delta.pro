@@ -0,0 +1,16 @@
+QT       += core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = u3-delta
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    ../../boardplane.h \
+    ../../deltaformat.h \
+    ../../replayformat.h
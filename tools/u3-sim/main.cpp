@@ -0,0 +1,245 @@
+/**
+ * @file main.cpp
+ * @brief Kommandozeilenprogramm zum Schätzen der Gewinnrate einer Spielfeldkonfiguration.
+ *
+ * Aufruf: u3-sim [-j Threads] [-n Spiele] [-s Seed] [-o Statistikdatei] [--scaling] Länge Breite Minen
+ *
+ * Lässt GameSolver ohne Oberfläche Spiele mit festen Seeds spielen, verteilt auf alle Kerne,
+ * und gibt Gewinnrate mit 95%-Konfidenzintervall, geratene Züge pro Spiel, den Durchsatz und
+ * die Verteilung auf die Threads aus. Mit -o werden die Ergebnisse im Format von
+ * statistics.json gespeichert, zum Vergleich mit eigenen Spielen. Mit --scaling wird dieselbe
+ * Simulation mit 1, 2, 4, ... Threads wiederholt.
+ *
+ * Jedes Spiel i hat den Seed BatchEnvironment::episodeSeed(Seed, 0, i); das Ergebnis hängt
+ * daher nicht von der Anzahl der Threads ab.
+ *
+ * @author Daniel Schukin
+ */
+
+#include "batchenvironment.h"
+#include "gamesolver.h"
+#include "gamestatistics.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <atomic>
+#include <cmath>
+
+static constexpr qint64 CHUNK_SIZE = 1024; ///< Spiele, die sich ein Thread auf einmal nimmt.
+
+/// @brief Zu simulierende Konfiguration.
+struct Config
+{
+    int length = 0;      ///< Anzahl der Zeilen.
+    int width = 0;       ///< Anzahl der Spalten.
+    int minesNumber = 0; ///< Anzahl der Minen.
+    qint64 games = 100000; ///< Anzahl der Spiele.
+    quint64 seed = 1;    ///< Grundseed.
+};
+
+/// @brief Zähler eines Threads.
+struct Tally
+{
+    qint64 games = 0;     ///< Gespielte Spiele.
+    qint64 wins = 0;      ///< Gewonnene Spiele.
+    qint64 guesses = 0;   ///< Geratene Züge (ohne sicheren ersten Klick).
+    qint64 steps = 0;     ///< Ausgeführte Züge.
+    qint64 bbbv = 0;      ///< Summe der 3BV.
+    qint64 openings = 0;  ///< Summe der Öffnungen.
+    qint64 elapsed = 0;   ///< Laufzeit des Threads in ms.
+};
+
+/**
+ * @brief Spielt Blöcke von Spielen, bis alle vergeben sind.
+ * @param config Konfiguration.
+ * @param next Nächstes noch nicht vergebenes Spiel, von allen Threads geteilt.
+ * @return Zähler dieses Threads.
+ *
+ * Jeder Thread nimmt sich mit einer atomaren Addition den nächsten Block von CHUNK_SIZE
+ * Spielen. Langsame Threads (lange Spiele, geteilter Kern) bekommen so einfach weniger Blöcke,
+ * ohne dass vorab verteilt werden muss. Jeder Thread hat sein eigenes Spielfeld und seinen
+ * eigenen Solver, geteilt wird nur der Zähler.
+ */
+static Tally simulate(const Config &config, std::atomic<qint64> *next) {
+    QElapsedTimer clock;
+    clock.start();
+    BatchEnvironment env(1, config.length, config.width, config.minesNumber, config.seed);
+    GameSolver solver(config.length, config.width, config.minesNumber);
+    Tally tally;
+    for (qint64 first = next->fetch_add(CHUNK_SIZE); first < config.games; first = next->fetch_add(CHUNK_SIZE)) {
+        const qint64 last = qMin(config.games, first + CHUNK_SIZE);
+        for (qint64 game = first; game < last; game++) {
+            env.startEpisode(0, quint32(game));
+            solver.reset();
+            for (;;) {
+                const GameSolver::Move move = solver.next(env.observations());
+                if (move.cell < 0) {
+                    break; ///< kann nur bei inkonsistenter Beobachtung passieren, zählt als verloren
+                }
+                tally.guesses += !move.safe;
+                const qint32 action = move.cell;
+                env.step(&action, false);
+                tally.steps++;
+                if (env.dones()[0]) {
+                    tally.wins += env.wins()[0];
+                    break;
+                }
+            }
+            tally.games++;
+            int openings = 0;
+            tally.bbbv += env.getBbbv(0, &openings);
+            tally.openings += openings;
+        }
+    }
+    tally.elapsed = clock.elapsed();
+    return tally;
+}
+
+/**
+ * @brief Startet die Simulation auf einer Anzahl von Threads.
+ * @param config Konfiguration.
+ * @param threads Anzahl der Threads.
+ * @param elapsed Gibt die Gesamtlaufzeit in ms zurück.
+ * @return Zähler pro Thread.
+ */
+static QVector<Tally> run(const Config &config, int threads, qint64 &elapsed) {
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    std::atomic<qint64> next(0);
+    QElapsedTimer clock;
+    clock.start();
+    QVector<QFuture<Tally>> futures;
+    for (int thread = 0; thread < threads; thread++) {
+        futures.append(QtConcurrent::run(simulate, config, &next));
+    }
+    QVector<Tally> tallies;
+    for (QFuture<Tally> &future : futures) {
+        tallies.append(future.result());
+    }
+    elapsed = qMax<qint64>(1, clock.elapsed());
+    return tallies;
+}
+
+/**
+ * @brief Berechnet das Wilson-Konfidenzintervall einer Gewinnrate.
+ * @param wins Gewonnene Spiele.
+ * @param games Gespielte Spiele.
+ * @param low Gibt die untere Grenze zurück.
+ * @param high Gibt die obere Grenze zurück.
+ *
+ * Anders als p ± 1.96·σ bleibt es auch bei Raten nahe 0 oder 1 innerhalb von [0, 1].
+ */
+static void wilson(qint64 wins, qint64 games, double &low, double &high) {
+    constexpr double z = 1.959964; ///< 95 %
+    const double n = double(qMax<qint64>(1, games));
+    const double p = double(wins) / n;
+    const double denominator = 1.0 + z * z / n;
+    const double centre = (p + z * z / (2.0 * n)) / denominator;
+    const double half = z / denominator * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n));
+    low = qMax(0.0, centre - half);
+    high = qMin(1.0, centre + half);
+}
+
+/**
+ * @brief Hauptfunktion des Simulationsprogramms.
+ * @param argc Anzahl der Kommandozeilenargumente.
+ * @param argv Array der Kommandozeilenargumente.
+ * @return 0 bei Erfolg; 2 bei falschem Aufruf.
+ *
+ * @author Daniel Schukin
+ */
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QStringList args = app.arguments().mid(1);
+
+    Config config;
+    int threads = QThreadPool::globalInstance()->maxThreadCount();
+    QString outputPath;
+    bool scaling = false;
+    while (!args.isEmpty() && args[0].startsWith("-")) {
+        const QString option = args.takeFirst();
+        if (option == "--scaling") {
+            scaling = true;
+        } else if (!args.isEmpty() && option == "-j") {
+            threads = qMax(1, args.takeFirst().toInt());
+        } else if (!args.isEmpty() && option == "-n") {
+            config.games = qMax<qint64>(1, args.takeFirst().toLongLong());
+        } else if (!args.isEmpty() && option == "-s") {
+            config.seed = args.takeFirst().toULongLong();
+        } else if (!args.isEmpty() && option == "-o") {
+            outputPath = args.takeFirst();
+        } else {
+            args.clear(); ///< unbekannte Option
+        }
+    }
+    if (args.size() == 3) {
+        config.length = args[0].toInt();
+        config.width = args[1].toInt();
+        config.minesNumber = args[2].toInt();
+    }
+    if (config.length < 1 || config.width < 1 || config.minesNumber < 1
+        || config.minesNumber >= config.length * config.width || config.games > qint64(UINT_MAX) + 1) {
+        out << "usage: u3-sim [-j threads] [-n games] [-s seed] [-o statistics.json] [--scaling] <length> <width> <mines>\n";
+        return 2;
+    }
+
+    qint64 elapsed = 0;
+    const QVector<Tally> tallies = run(config, threads, elapsed);
+    Tally total;
+    for (const Tally &tally : tallies) {
+        total.games += tally.games;
+        total.wins += tally.wins;
+        total.guesses += tally.guesses;
+        total.steps += tally.steps;
+        total.bbbv += tally.bbbv;
+        total.openings += tally.openings;
+    }
+
+    double low, high;
+    wilson(total.wins, total.games, low, high);
+    out.setRealNumberPrecision(4);
+    out << config.length << "x" << config.width << " with " << config.minesNumber << " mines, " << total.games
+        << " games from seed " << config.seed << " on " << threads << " threads\n"
+        << "win rate " << 100.0 * total.wins / total.games << "% (95% CI " << 100.0 * low << "% - " << 100.0 * high
+        << "%)\n"
+        << double(total.guesses) / total.games << " guesses/game, " << double(total.bbbv) / total.games
+        << " 3BV/game, " << double(total.openings) / total.games << " openings/game\n"
+        << total.games * 1000.0 / elapsed << " games/s, " << total.steps * 1000.0 / elapsed << " steps/s\n";
+    for (int thread = 0; thread < tallies.size(); thread++) {
+        const Tally &tally = tallies.at(thread);
+        out << "  thread " << thread << ": " << tally.games << " games, "
+            << tally.games * 1000.0 / qMax<qint64>(1, tally.elapsed) << " games/s\n";
+    }
+
+    if (scaling) {
+        ///< 1, 2, 4, ... Threads und zuletzt die gewählte Anzahl, jeweils mit denselben Spielen
+        double baseline = 0.0;
+        for (int count = 1; count <= threads; count = count == threads ? threads + 1 : qMin(threads, count * 2)) {
+            qint64 seriesElapsed = 0;
+            run(config, count, seriesElapsed);
+            const double gamesPerSecond = config.games * 1000.0 / seriesElapsed;
+            if (count == 1) {
+                baseline = gamesPerSecond;
+            }
+            out << "scaling " << count << " threads: " << gamesPerSecond << " games/s, speedup "
+                << gamesPerSecond / baseline << "\n";
+        }
+    }
+
+    if (!outputPath.isEmpty()) {
+        ///< statistics.json zählt in int; sehr lange Läufe werden dort gekappt
+        const auto clamp = [](qint64 value) { return int(qMin<qint64>(INT_MAX, value)); };
+        GameStats stats(config.length, config.width, config.minesNumber);
+        stats.gamesPlayed = clamp(total.games);
+        stats.gamesWon = clamp(total.wins);
+        stats.gamesLost = clamp(total.games - total.wins);
+        stats.bbbvTotal = clamp(total.bbbv);
+        stats.openingsTotal = clamp(total.openings);
+        GameStatistics statistics;
+        statistics.mergeStats(stats);
+        statistics.saveToFile(outputPath);
+    }
+    return 0;
+}
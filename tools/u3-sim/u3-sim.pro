@@ -0,0 +1,23 @@
+QT       += core concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = u3-sim
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../batchenvironment.cpp \
+    ../../gamesolver.cpp \
+    ../../gamestatistics.cpp \
+    ../../tracing.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../batchenvironment.h \
+    ../../boardlayout.h \
+    ../../boardplane.h \
+    ../../gamesolver.h \
+    ../../gamestatistics.h \
+    ../../tracing.h
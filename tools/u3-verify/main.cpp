@@ -0,0 +1,74 @@
+/**
+ * @file main.cpp
+ * @brief Kommandozeilenprogramm zum Prüfen von Aufzeichnungen.
+ *
+ * Aufruf: u3-verify [-j Threads] Ordner
+ *
+ * Spielt alle *.u3r-Dateien des Ordners parallel ohne Oberfläche nach, gibt jede abweichende
+ * Aufzeichnung aus und meldet am Ende den Durchsatz in Spielen pro Sekunde. Der Rückgabewert
+ * ist 0, wenn alle beendeten Spiele gültig sind.
+ *
+ * @author Daniel Schukin
+ */
+
+#include "replayverifier.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThreadPool>
+
+/**
+ * @brief Hauptfunktion des Prüfprogramms.
+ * @param argc Anzahl der Kommandozeilenargumente.
+ * @param argv Array der Kommandozeilenargumente.
+ * @return 0, wenn keine Aufzeichnung abweicht; 1 bei Abweichungen; 2 bei falschem Aufruf.
+ *
+ * @author Daniel Schukin
+ */
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QStringList args = app.arguments().mid(1);
+
+    ///< optional die Anzahl der Threads festlegen, sonst alle Kerne
+    if (args.size() == 3 && args[0] == "-j") {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, args[1].toInt()));
+        args = args.mid(2);
+    }
+    if (args.size() != 1) {
+        out << "usage: u3-verify [-j threads] <replay directory>\n";
+        return 2;
+    }
+
+    QDir dir(args[0]);
+    QStringList filePaths;
+    for (const QString &fileName : dir.entryList({"*.u3r"}, QDir::Files, QDir::Name)) {
+        filePaths.append(dir.filePath(fileName));
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    const QList<ReplayVerifier::Result> results = ReplayVerifier::verifyAll(filePaths);
+    const qint64 elapsed = qMax<qint64>(1, clock.elapsed());
+
+    int valid = 0, unfinished = 0, mismatches = 0;
+    qint64 actions = 0;
+    for (const ReplayVerifier::Result &result : results) {
+        actions += result.actions;
+        if (result.status == ReplayVerifier::VALID) {
+            valid++;
+        } else if (result.status == ReplayVerifier::NO_RESULT) {
+            unfinished++; ///< abgebrochene Spiele haben nichts zu prüfen
+        } else {
+            mismatches++;
+            out << result.filePath << ": " << ReplayVerifier::statusName(result.status)
+                << " (claimed " << (result.won ? "win" : "loss") << " in " << result.claimedTime
+                << " ms, replayed " << result.playedTime << " ms after " << result.actions << " actions)\n";
+        }
+    }
+    out << results.size() << " replays on " << QThreadPool::globalInstance()->maxThreadCount()
+        << " threads: " << valid << " valid, " << unfinished << " unfinished, " << mismatches << " mismatches\n"
+        << results.size() * 1000.0 / elapsed << " games/s, " << actions * 1000.0 / elapsed << " actions/s\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+QT       += core gui concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = u3-verify
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../boardkernels.cpp \
+    ../../cell.cpp \
+    ../../game.cpp \
+    ../../gamearena.cpp \
+    ../../gamejournal.cpp \
+    ../../gamestatistics.cpp \
+    ../../replayplayer.cpp \
+    ../../replayverifier.cpp \
+    ../../tracing.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../boardkernels.h \
+    ../../boardlayout.h \
+    ../../boardplane.h \
+    ../../cell.h \
+    ../../game.h \
+    ../../gamearena.h \
+    ../../gameclock.h \
+    ../../gamejournal.h \
+    ../../gamestatistics.h \
+    ../../replayformat.h \
+    ../../replayplayer.h \
+    ../../replayverifier.h \
+    ../../tracing.h
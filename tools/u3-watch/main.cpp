@@ -0,0 +1,144 @@
+/**
+ * @file main.cpp
+ * @brief Beispiel-Beobachter für das veröffentlichte Spielfeld (siehe BoardExport).
+ *
+ * Aufruf: u3-watch [-k Segment] [-i Intervall] [--board]
+ *
+ * Hängt sich lesend an das Segment eines laufenden Spiels an (Menü "Spielfeld freigeben") und
+ * gibt nach jedem Zug und beim Ende der Freigabe ("closed") eine Zeile mit den Zählern aus, mit
+ * --board zusätzlich das Spielfeld.
+ * Die Codes werden in eine eigene Kopie übernommen: nach einem neuen Spielfeld oder wenn der
+ * Beobachter mehr als CHANGE_RING Zellen zurückliegt alle, sonst nur die Zellen aus dem Ring.
+ *
+ * @author Daniel Schukin
+ */
+
+#include "boardexport.h"
+#include "boardplane.h"
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+
+/// @brief Eigene Kopie des Spielfelds.
+struct View
+{
+    BoardExportReader::Snapshot counters; ///< Zähler beim letzten Lesen (Zeiger ungültig).
+    QVector<quint8> codes;                ///< Anzeigecodes, zeilenweise.
+    int updated = 0;                      ///< Beim letzten Lesen übernommene Zellen.
+    bool full = false;                    ///< True, wenn beim letzten Lesen alle Codes übernommen wurden.
+};
+
+/**
+ * @brief Übernimmt den aktuellen Stand in die eigene Kopie.
+ * @param snapshot Stand im Segment.
+ * @param view Eigene Kopie; wird an Ort und Stelle fortgeschrieben.
+ * @param previous Zuletzt stimmig gelesener Stand.
+ */
+static void update(const BoardExportReader::Snapshot &snapshot, View &view, const BoardExportReader::Snapshot &previous) {
+    const int cells = snapshot.length * snapshot.width;
+    const quint64 behind = snapshot.changes - previous.changes;
+    view.full = snapshot.boards != previous.boards || behind > quint64(BoardExport::CHANGE_RING)
+                || view.codes.size() != cells;
+    view.counters = snapshot;
+    if (view.full) {
+        view.codes.resize(cells);
+        std::copy(snapshot.codes, snapshot.codes + cells, view.codes.begin());
+        view.updated = cells;
+        return;
+    }
+    for (quint64 change = previous.changes; change < snapshot.changes; change++) {
+        const qint32 index = snapshot.ring[change & (BoardExport::CHANGE_RING - 1)];
+        if (index >= 0 && index < cells) {
+            view.codes[index] = snapshot.codes[index];
+        }
+    }
+    view.updated = int(behind);
+}
+
+/**
+ * @brief Gibt das Spielfeld als Text aus.
+ * @param out Ausgabe.
+ * @param view Eigene Kopie.
+ */
+static void printBoard(QTextStream &out, const View &view) {
+    static const char OPEN_DIGITS[] = ".12345678";
+    for (int row = 0; row < view.counters.length; row++) {
+        QByteArray line;
+        for (int col = 0; col < view.counters.width; col++) {
+            const quint8 code = view.codes.at(row * view.counters.width + col);
+            if (code >= BoardPlane::OPEN_CODE) {
+                line.append(OPEN_DIGITS[qMin(8, code - BoardPlane::OPEN_CODE)]);
+            } else if (code == 0) {
+                line.append('#');
+            } else if (code == 2) {
+                line.append('F');
+            } else {
+                line.append('*'); ///< aufgedeckte Mine oder falsche Markierung am Spielende
+            }
+        }
+        out << line << "\n";
+    }
+}
+
+/**
+ * @brief Hauptfunktion des Beobachters.
+ * @param argc Anzahl der Kommandozeilenargumente.
+ * @param argv Array der Kommandozeilenargumente.
+ * @return 0 bei Erfolg; 2 bei falschem Aufruf.
+ *
+ * @author Daniel Schukin
+ */
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QStringList args = app.arguments().mid(1);
+
+    QString key = BoardExport::DEFAULT_KEY;
+    int interval = 16;
+    bool board = false;
+    while (!args.isEmpty()) {
+        const QString option = args.takeFirst();
+        if (option == "--board") {
+            board = true;
+        } else if (!args.isEmpty() && option == "-k") {
+            key = args.takeFirst();
+        } else if (!args.isEmpty() && option == "-i") {
+            interval = qMax(1, args.takeFirst().toInt());
+        } else {
+            out << "usage: u3-watch [-k key] [-i interval_ms] [--board]\n";
+            return 2;
+        }
+    }
+
+    BoardExportReader reader(key);
+    View view;
+    BoardExportReader::Snapshot previous;
+    for (;;) {
+        if (!reader.isAttached() && !reader.attach()) {
+            QThread::msleep(500); ///< das Spiel hat noch nicht freigegeben
+            continue;
+        }
+        ///< ein abgebrochener Versuch hinterlässt nur Codes, die ein späterer Zug ohnehin neu meldet
+        const bool consistent = reader.read([&](const BoardExportReader::Snapshot &snapshot) {
+            update(snapshot, view, previous);
+        });
+        if (consistent && (view.counters.boards != previous.boards || view.counters.moves != previous.moves
+                           || view.counters.flags != previous.flags)) {
+            previous = view.counters;
+            const quint32 flags = view.counters.flags;
+            out << "board " << view.counters.boards << " move " << view.counters.moves << ": "
+                << view.counters.length << "x" << view.counters.width << ", " << view.counters.markedCells << "/"
+                << view.counters.minesNumber << " flags, " << view.counters.elapsedTime / 1000 << " s, "
+                << ((flags & BoardExport::FLAG_CLOSED) ? "closed"
+                    : (flags & BoardExport::FLAG_IN_GAME) ? "running" : (flags & BoardExport::FLAG_WON) ? "won" : "over")
+                << ", " << view.updated << (view.full ? " cells read" : " changed cells") << "\n";
+            if (board && !(flags & BoardExport::FLAG_TOO_LARGE)) {
+                printBoard(out, view);
+            }
+            out.flush();
+        }
+        QThread::msleep(ulong(interval));
+    }
+}
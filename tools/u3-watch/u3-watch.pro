@@ -0,0 +1,15 @@
+QT       += core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = u3-watch
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    ../../boardexport.h \
+    ../../boardplane.h
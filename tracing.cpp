@@ -0,0 +1,107 @@
+#include "tracing.h"
+
+Q_LOGGING_CATEGORY(lcUi, "u3.ui", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcEngine, "u3.engine", QtInfoMsg)
+
+#ifdef U3_TRACING
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+namespace {
+
+/// @brief Ein abgeschlossener Span.
+struct Event
+{
+    const char *name; ///< Name des Spans.
+    qint64 start;     ///< Beginn in ns.
+    qint64 duration;  ///< Dauer in ns.
+    quintptr thread;  ///< Thread, in dem der Span lief.
+};
+
+QMutex eventsMutex; ///< Schützt events.
+QVector<Event> events; ///< Gesammelte Spans.
+
+/**
+ * @brief Gibt die gemeinsame Uhr aller Spans zurück.
+ * @return Beim ersten Aufruf gestartete Uhr.
+ */
+const QElapsedTimer &clock() {
+    static const QElapsedTimer timer = [] {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+}
+
+/**
+ * @brief Gibt die Zeit seit dem ersten Aufruf zurück.
+ * @return Zeit in ns.
+ */
+qint64 Tracing::now() {
+    return clock().nsecsElapsed();
+}
+
+/**
+ * @brief Trägt einen abgeschlossenen Span ein.
+ * @param name Name des Spans, muss ein String-Literal sein.
+ * @param start Beginn in ns (siehe now()).
+ * @param end Ende in ns (siehe now()).
+ */
+void Tracing::record(const char *name, qint64 start, qint64 end) {
+    const quintptr thread = quintptr(QThread::currentThreadId());
+    QMutexLocker locker(&eventsMutex);
+    if (events.size() < MAX_EVENTS) {
+        events.append({name, start, end - start, thread});
+    }
+}
+
+/**
+ * @brief Schreibt alle gesammelten Spans als Chrome-Trace-JSON und leert die Sammlung.
+ * @param filePath Pfad der Datei.
+ * @return True bei Erfolg.
+ *
+ * Jeder Span wird ein "Complete Event" (ph "X") mit Zeiten in Mikrosekunden.
+ */
+bool Tracing::writeChromeTrace(const QString &filePath) {
+    QVector<Event> collected;
+    {
+        QMutexLocker locker(&eventsMutex);
+        collected.swap(events); ///< das Schreiben blockiert keine laufenden Spans
+    }
+
+    QJsonArray traceEvents;
+    for (const Event &event : collected) {
+        QJsonObject object;
+        object["name"] = QString::fromLatin1(event.name);
+        object["ph"] = "X";
+        object["ts"] = event.start / 1000.0;
+        object["dur"] = event.duration / 1000.0;
+        object["pid"] = 1;
+        object["tid"] = qint64(event.thread);
+        traceEvents.append(object);
+    }
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0) {
+        qWarning() << "Failed to write trace: " << filePath;
+        return false;
+    }
+    return true;
+}
+
+#endif // U3_TRACING
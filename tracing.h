@@ -0,0 +1,95 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QLoggingCategory>
+#include <QString>
+
+/**
+ * @file tracing.h
+ * @brief Logging-Kategorien und Zeitmessung in benannten Abschnitten (Spans).
+ *
+ * Logging: Ausgaben laufen über die Kategorien lcUi ("u3.ui") und lcEngine ("u3.engine"),
+ * deren Debug-Ausgaben standardmäßig aus sind. Einschalten z.B. mit
+ * QT_LOGGING_RULES="u3.*.debug=true".
+ *
+ * Tracing: TRACE_SPAN("name") misst die Zeit bis zum Ende des umgebenden Blocks. Die Spans
+ * werden im Speicher gesammelt und mit Tracing::writeChromeTrace() als Chrome-Trace-JSON
+ * geschrieben, das chrome://tracing und ui.perfetto.dev öffnen können.
+ *
+ * Technische Entscheidung:
+ * Tracing wird nur mit `qmake CONFIG+=tracing` (Define U3_TRACING) übersetzt. Ohne das Define
+ * ist TRACE_SPAN leer und kostet weder Zeit noch Code. Mit dem Define kostet ein Span zwei
+ * Zeitstempel und einen kurzen Lock beim Eintragen; die Namen sind String-Literale und werden
+ * nicht kopiert. Es werden höchstens MAX_EVENTS Spans gesammelt.
+ *
+ * @author Daniel Schukin
+ */
+
+Q_DECLARE_LOGGING_CATEGORY(lcUi)
+Q_DECLARE_LOGGING_CATEGORY(lcEngine)
+
+#ifdef U3_TRACING
+
+namespace Tracing {
+
+constexpr int MAX_EVENTS = 1 << 20; ///< Höchstzahl gesammelter Spans (32 MB).
+
+/**
+ * @brief Gibt die Zeit seit dem ersten Aufruf zurück.
+ * @return Zeit in ns.
+ *
+ * @author Daniel Schukin
+ */
+qint64 now();
+
+/**
+ * @brief Trägt einen abgeschlossenen Span ein.
+ * @param name Name des Spans, muss ein String-Literal sein.
+ * @param start Beginn in ns (siehe now()).
+ * @param end Ende in ns (siehe now()).
+ *
+ * @author Daniel Schukin
+ */
+void record(const char *name, qint64 start, qint64 end);
+
+/**
+ * @brief Schreibt alle gesammelten Spans als Chrome-Trace-JSON und leert die Sammlung.
+ * @param filePath Pfad der Datei.
+ * @return True bei Erfolg.
+ *
+ * @author Daniel Schukin
+ */
+bool writeChromeTrace(const QString &filePath);
+
+/**
+ * @class Span
+ * @brief Misst die Zeit von der Erzeugung bis zur Zerstörung; siehe TRACE_SPAN.
+ *
+ * @author Daniel Schukin
+ */
+class Span
+{
+public:
+    explicit Span(const char *name) : name(name), start(now()) {}
+    ~Span() { record(name, start, now()); }
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *name; ///< Name des Spans.
+    qint64 start; ///< Beginn in ns.
+};
+
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(name) Tracing::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+#else
+
+#define TRACE_SPAN(name)
+
+#endif // U3_TRACING
+
+#endif // TRACING_H